@@ -154,13 +154,14 @@ void Animator::readNodeHierarchy(int boneIndex,
     }
 }
 
-CharacterState CharacterController::update(double dt, bool forward, const glm::vec3& moveDirection){
+CharacterState CharacterController::update(bool forward, const glm::vec3& moveDirection){
     if(forward){
         // W pressed: Movement with animation
-        glm::vec3 moveVec = moveDirection * moveSpeed * static_cast<float>(dt);
-        position += moveVec;
+        velocity.x = moveDirection.x * moveSpeed;
+        velocity.z = moveDirection.z * moveSpeed;
         return CharacterState::Idle;
     }
     // No keys: No movement
+    velocity.x = velocity.z = 0.0f;
     return CharacterState::Run;
 }
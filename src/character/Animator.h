@@ -45,6 +45,9 @@ struct CharacterController {
     glm::vec3 position{0.0f, 0.0f, 0.0f};
     float yaw = 0.0f;
     float moveSpeed = 6.0f;  // Run speed when W is pressed
+    glm::vec3 velocity{0.0f};  // x/z: walking velocity; y: vertical speed (see CharacterMove)
+    bool grounded = false;
 
-    CharacterState update(double dt, bool forward, const glm::vec3& moveDirection);
+    // Sets the walking velocity; the position is moved by CollisionSystem::moveCharacters
+    CharacterState update(bool forward, const glm::vec3& moveDirection);
 };
@@ -40,6 +40,13 @@ void ThirdPersonCamera::update(double dt, float mouseDX, float mouseDY,
         float terrainY = terrainHeightFn(desiredPos.x, desiredPos.z);
         desiredPos.y = std::max(desiredPos.y, terrainY + 1.0f);
     }
+    float hitFraction = 1.0f;
+    if(m_occlusionFn && m_occlusionFn(pivot, desiredPos, hitFraction)){
+        const float clearance = 0.3f;
+        float dist = glm::length(desiredPos - pivot);
+        float keep = std::max(0.0f, hitFraction * dist - clearance);
+        if(dist > 1e-4f) desiredPos = pivot + (desiredPos - pivot) * (keep / dist);
+    }
     m_cameraPos = smoothPos(desiredPos, dt);
     glm::vec3 look = pivot - m_cameraPos;
     if(glm::length2(look) < 1e-6f){
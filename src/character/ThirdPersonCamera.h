@@ -2,6 +2,7 @@
 // Third-person follow camera with gentle smoothing.
 
 #include <functional>
+#include <utility>
 #include <glm/glm.hpp>
 
 class ThirdPersonCamera {
@@ -11,6 +12,11 @@ public:
 
     void update(double dt, float mouseDeltaX, float mouseDeltaY,
                 const std::function<float(float, float)>& terrainHeightFn);
+    // Optional occluder test: returns true and the fraction (0..1) along from->to of the first
+    // blocking hit. The camera is pulled in front of it so hills never cover the character.
+    void setOcclusionFn(std::function<bool(const glm::vec3& from, const glm::vec3& to, float& hitFraction)> fn){
+        m_occlusionFn = std::move(fn);
+    }
 
     glm::mat4 viewMatrix() const;
     glm::mat4 projectionMatrix(float fovDeg, float aspect, float nearPlane, float farPlane) const;
@@ -31,6 +37,7 @@ private:
 
     glm::vec3 m_cameraPos{0.0f};
     glm::vec3 m_forward{0.0f};
+    std::function<bool(const glm::vec3&, const glm::vec3&, float&)> m_occlusionFn;
 
     glm::vec3 smoothPos(glm::vec3 desired, double dt);
 };
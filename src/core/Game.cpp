@@ -7,10 +7,17 @@
 #include "render/Renderer.h"
 #include "render/Shader.h"
 #include "render/Camera.h"
+#include "render/MeshLod.h"
+#include "render/Impostor.h"
+#include "render/GridMeshCache.h"
 #include "scene/Terrain.h"
 #include "scene/TerrainSampler.h"
+#include "scene/ShoreDistanceField.h"
 #include "scene/Sky.h"
 #include "scene/Water.h"
+#include "scene/Ocean.h"
+#include "util/ThreadPool.h"
+#include "util/WorldCache.h"
 #include "platform/Window.h"
 #include "core/Time.h"
 #include <glm/glm.hpp>
@@ -28,7 +35,9 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <chrono>
 #include <exception>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/norm.hpp>
@@ -45,9 +54,38 @@ extern Window* g_windowPtr; // declared in main for access
 // TerrainSampler.h is not included through other translation units.
 void setActiveTerrain(Terrain* terrain);
 float getTerrainHeightAt(float worldX, float worldZ);
+std::shared_ptr<const TerrainSampler> activeTerrainSampler();
 
 namespace {
 constexpr size_t kMaxBones = 128;
+// Debug height brush: world radius, reach of the aim ray and normalized height change per second
+constexpr float kBrushRadius = 6.0f;
+constexpr float kBrushReach = 400.0f;
+constexpr float kBrushRate = 0.05f;
+const char* const kWorldCachePath = "cache/world.bin";
+// World cache sections (see WorldCache)
+constexpr uint32_t kCacheTerrainHeights = WorldCache::sectionId("THGT");
+constexpr uint32_t kCacheTerrainMicroX = WorldCache::sectionId("TMNX");
+constexpr uint32_t kCacheTerrainMicroZ = WorldCache::sectionId("TMNZ");
+constexpr uint32_t kCacheTerrainMicroFreq = WorldCache::sectionId("TMNF");
+constexpr uint32_t kCacheGrassTexture = WorldCache::sectionId("GTEX");
+constexpr uint32_t kCacheWaveHeight0 = WorldCache::sectionId("WVH0");
+constexpr uint32_t kCacheWaveHeight1 = WorldCache::sectionId("WVH1");
+constexpr uint32_t kCacheWaveNormal0 = WorldCache::sectionId("WVN0");
+constexpr uint32_t kCacheWaveNormal1 = WorldCache::sectionId("WVN1");
+constexpr uint32_t kCacheGrassInstances = WorldCache::sectionId("GRSI");
+constexpr uint32_t kCacheTreePlacements = WorldCache::sectionId("TREE");
+const char* const kColliderCachePath = "cache/colliders.bin";
+// Collider cache sections (see TriangleMesh::assign): vertices, triangle indices and nodes per model
+constexpr uint32_t kCacheLighthouseVertices = WorldCache::sectionId("LHVX");
+constexpr uint32_t kCacheLighthouseIndices = WorldCache::sectionId("LHIX");
+constexpr uint32_t kCacheLighthouseNodes = WorldCache::sectionId("LHND");
+constexpr uint32_t kCacheCampfireVertices = WorldCache::sectionId("CFVX");
+constexpr uint32_t kCacheCampfireIndices = WorldCache::sectionId("CFIX");
+constexpr uint32_t kCacheCampfireNodes = WorldCache::sectionId("CFND");
+constexpr uint32_t kCacheForestHutVertices = WorldCache::sectionId("FHVX");
+constexpr uint32_t kCacheForestHutIndices = WorldCache::sectionId("FHIX");
+constexpr uint32_t kCacheForestHutNodes = WorldCache::sectionId("FHND");
 constexpr int kMaxFireParticles = 96;
 constexpr int kFireQuadVertexCount = 6;
 constexpr int kMaxPointLights = 2;
@@ -87,18 +125,8 @@ std::string resolveExistingPath(const std::vector<std::string>& candidates){
 }
 
 glm::vec3 sampleTerrainNormal(float worldX, float worldZ){
-    const float eps = 0.25f;
-    float hL = getTerrainHeightAt(worldX - eps, worldZ);
-    float hR = getTerrainHeightAt(worldX + eps, worldZ);
-    float hB = getTerrainHeightAt(worldX, worldZ - eps);
-    float hF = getTerrainHeightAt(worldX, worldZ + eps);
-    glm::vec3 tangentX(2.0f * eps, hR - hL, 0.0f);
-    glm::vec3 tangentZ(0.0f, hF - hB, 2.0f * eps);
-    glm::vec3 normal = glm::normalize(glm::cross(tangentZ, tangentX));
-    if(glm::length2(normal) < 1e-4f){
-        normal = glm::vec3(0.0f, 1.0f, 0.0f);
-    }
-    return normal;
+    // Analytic normal of the bilinear height surface (one cell lookup instead of four height queries)
+    return activeTerrainSampler()->normal(worldX, worldZ);
 }
 
 glm::vec3 extractBindPosition(const BoneInfo& bone){
@@ -125,45 +153,46 @@ glm::mat4 composeTransform(const glm::vec3& position,
 }
 }
 
-static const char* kVertex = R"GLSL(
+// Terrain shaders are assembled as header + TerrainQuadtree::glslVertexCommon() + body.
+static const char* kTerrainVertexHeader = R"GLSL(
 #version 450 core
-layout(location=0) in vec3 aPos;
-layout(location=1) in vec3 aNormal;
-layout(location=2) in vec2 aUV;
-layout(location=3) in vec3 aTangent; // unused
-uniform mat4 uModel; uniform mat4 uView; uniform mat4 uProj;
-uniform mat4 uLightSpace;
 uniform sampler2D uHeightMap;
 uniform float uHeightScale; // vertical scale (world units)
-uniform vec2 uTexelSize;    // 1/textureSize
+)GLSL";
+
+static const char* kVertex = R"GLSL(
+uniform mat4 uView; uniform mat4 uProj;
+uniform mat4 uLightSpace;
 out vec3 vNormal;
 out vec3 vWorldPos;
 out vec2 vUV;
 out vec4 vFragPosLightSpace;
 void main(){
-    // Sample heightmap for displacement but use CPU-computed vertex normal (attribute)
-    float h = texture(uHeightMap, aUV).r;
-    vec3 displaced = vec3(aPos.x, h * uHeightScale, aPos.z);
-    vec4 wp = uModel * vec4(displaced,1.0);
-    // Transform the precomputed normal to world space
-    vNormal = normalize(mat3(uModel) * aNormal);
-    vWorldPos = wp.xyz; vUV = aUV;
+    // Morphed, heightmap-displaced patch vertex; lighting normal from the CPU-computed normal map
+    vec2 uv;
+    vec3 wp = terrainLodPosition(uv);
+    vNormal = terrainLodNormal(uv);
+    vWorldPos = wp; vUV = uv;
     // Position in light space for shadow mapping
-    vFragPosLightSpace = uLightSpace * wp;
-    gl_Position = uProj * uView * wp;
+    vFragPosLightSpace = uLightSpace * vec4(wp, 1.0);
+    gl_Position = uProj * uView * vec4(wp, 1.0);
 }
 )GLSL";
 
+static std::string terrainVertexSource(const char* body, bool paged){
+    return std::string(kTerrainVertexHeader) + (paged ? "#define TERRAIN_PAGED\n" : "") +
+           TerrainQuadtree::glslVertexCommon() + body;
+}
+
 static const char* kFragment = R"GLSL(
 #version 450 core
 in vec3 vNormal; in vec3 vWorldPos; in vec2 vUV; in vec4 vFragPosLightSpace;
 out vec4 FragColor;
 uniform vec3 uLightDir; uniform vec3 uLightColor; uniform float uAmbient; uniform bool uIsNight;
 uniform float uSpecularStrength; uniform float uShininess; uniform vec3 uCameraPos;
-uniform float uHeightScale;
 uniform sampler2D uGrassTex; // tiled grass detail
 uniform float uGrassScale;
-uniform sampler2D uHeightMap;
+uniform sampler2D uSplatMap; // baked biome weights: fungus, sandgrass, rocks, light-brown tint
 uniform sampler2D uTexFungus;
 uniform sampler2D uTexSandgrass;
 uniform sampler2D uTexRocks;
@@ -236,30 +265,14 @@ void main(){
     vec3 grassSample = texture(uGrassTex, vUV * uGrassScale).rgb;
     base = mix(base, grassSample, 0.5);
 
-    // Sample biome textures
+    // Height-driven biome blend, baked on the CPU (TerrainSplat.h); the grass base keeps
+    // whatever weight the biome textures and the high-altitude tint leave over
+    vec4 splat = texture(uSplatMap, vUV);
     vec3 fungus = texture(uTexFungus, vUV * uGrassScale).rgb;
     vec3 sandgrass = texture(uTexSandgrass, vUV * uGrassScale).rgb;
     vec3 rocks = texture(uTexRocks, vUV * uGrassScale).rgb;
-
-    // Height-based mapping using heightmap value (0..1)
-    float hVal = texture(uHeightMap, vUV).r;
-    vec3 mappedColor;
-    if (hVal <= 0.15) {
-        mappedColor = fungus;
-    } else if (hVal <= 0.30) {
-        float f = smoothstep(0.15, 0.30, hVal);
-        mappedColor = mix(fungus, sandgrass, f);
-    } else if (hVal <= 0.60) {
-        mappedColor = sandgrass;
-    } else if (hVal <= 0.85) {
-        float f = smoothstep(0.60, 0.85, hVal);
-        mappedColor = mix(sandgrass, rocks, f);
-    } else {
-        mappedColor = rocks;
-    }
-
-    // Blend texture mapping into base color (texture influence weight)
-    base = mix(base, mappedColor, 0.8);
+    float baseWeight = max(1.0 - splat.r - splat.g - splat.b - splat.a, 0.0);
+    base = base * baseWeight + fungus * splat.r + sandgrass * splat.g + rocks * splat.b + lightBrown * splat.a;
 
     // Simple shadow lookup using shadow map
     // Transform fragment pos into light space and compute shadow factor
@@ -288,11 +301,6 @@ void main(){
     // Convert to direct-light multiplier (0 = fully shadowed, 1 = fully lit)
     float shadowFactor = clamp(1.0 - shadow, 0.05, 1.0);
 
-    // Height-based tint: higher areas get a light-brown tint (e.g., sparse vegetation / plateau)
-    float heightFactor = clamp(vWorldPos.y / uHeightScale, 0.0, 1.0);
-    float heightBlend = smoothstep(0.6, 0.95, heightFactor);
-    base = mix(base, lightBrown, heightBlend);
-
     // Simple ambient occlusion-like darkening for very steep areas
     float ao = 1.0 - smoothstep(0.45, 0.9, steepness) * 0.28;
 
@@ -388,9 +396,21 @@ void main(){
 
 static const char* kWaterVertex = R"GLSL(
 #version 450 core
-layout(location=0) in vec3 aPos;
-layout(location=1) in vec3 aNormal;
-layout(location=2) in vec2 aUV;
+// Attribute-less: grid position is rebuilt from gl_VertexID (see Water::setUniforms)
+uniform int uWaterQuads;
+uniform int uWaterChunkQuads;
+uniform int uWaterChunksPerSide;
+uniform float uWaterExtent;
+uniform float uWaterLevel;
+uniform bool uWaterProjected;    // camera-projected LOD grid instead of the uniform plane
+uniform mat4 uWaterInvViewProj;
+uniform float uWaterHorizon;
+uniform float uWaterMargin;
+uniform bool uWaterBounded;
+uniform sampler2D uShoreField;   // ShoreDistanceField: signed distance to shore, still-water depth
+uniform float uWorldSize;
+uniform float uShoreWaveFade;    // waves flatten to uShoreWaveMin over this distance from the shore
+uniform float uShoreWaveMin;
 
 uniform mat4 uModel;
 uniform mat4 uView;
@@ -404,6 +424,14 @@ uniform vec2 uLayer1Speed;
 uniform float uLayer0Strength;
 uniform float uLayer1Strength;
 uniform float uBlendSharpness;
+uniform float uLayer0Tiling;
+uniform float uLayer1Tiling;
+uniform float uWaveGain;
+// WaveSampler (scene/WaveSampler.h) evaluates the same displacement on the CPU; keep them in step
+uniform bool uOceanEnabled;
+uniform sampler2D uOceanDisplacement;  // FFT detail tile (x offset, height, z offset); Ocean::frame() on the CPU
+uniform float uOceanPatchSize;
+uniform float uOceanStrength;
 
 out VS_OUT {
     vec3 worldPos;
@@ -411,19 +439,62 @@ out VS_OUT {
     vec2 uv1;
     vec4 fragPosLightSpace;
     float layerBlend;
+    vec2 oceanUV;
 } vs_out;
 
+// ShoreDistanceField texel i holds the lattice sample at i * step - worldSize / 2, so the
+// terrain's 0..1 span maps onto the first to last texel centers, not the texture edges
+vec2 shoreFieldUV(vec2 worldXZ){
+    vec2 n = vec2(textureSize(uShoreField, 0));
+    return (worldXZ / uWorldSize + vec2(0.5)) * (n - 1.0) / n + 0.5 / n;
+}
+
 void main(){
-    vec2 scroll0 = aUV * 0.25 + uLayer0Speed * uTime;
-    vec2 scroll1 = aUV * 0.45 + uLayer1Speed * uTime;
+    // gl_VertexID includes the chunk's base vertex: chunk-major, row-major within a chunk
+    int chunkSide = uWaterChunkQuads + 1;
+    int chunkVerts = chunkSide * chunkSide;
+    int chunk = gl_VertexID / chunkVerts;
+    int local = gl_VertexID - chunk * chunkVerts;
+    ivec2 grid = ivec2(chunk % uWaterChunksPerSide, chunk / uWaterChunksPerSide) * uWaterChunkQuads
+               + ivec2(local % chunkSide, local / chunkSide);
+    vec2 aUV = vec2(grid) / float(uWaterQuads);
+    vec3 aPos = vec3((aUV.x - 0.5) * uWaterExtent, uWaterLevel, (aUV.y - 0.5) * uWaterExtent);
+    if(uWaterProjected){
+        // The grid spans the screen (plus a margin): cast each vertex's pixel ray onto the plane.
+        // Grid +z runs down the screen, like the plane seen from above, so winding is unchanged.
+        vec2 ndc = vec2(aUV.x * 2.0 - 1.0, 1.0 - aUV.y * 2.0) * uWaterMargin;
+        vec4 nearH = uWaterInvViewProj * vec4(ndc, -1.0, 1.0);
+        vec4 farH = uWaterInvViewProj * vec4(ndc, 1.0, 1.0);
+        vec3 origin = nearH.xyz / nearH.w;
+        vec3 dir = farH.xyz / farH.w - origin;
+        float t = abs(dir.y) > 1e-6 ? (uWaterLevel - origin.y) / dir.y : -1.0;
+        vec2 offset = (t >= 0.0 && t <= 1.0) ? dir.xz * t : dir.xz * uWaterHorizon / max(length(dir.xz), 1e-6);
+        float dist = length(offset);
+        if(dist > uWaterHorizon) offset *= uWaterHorizon / dist;
+        vec2 xz = origin.xz + offset;
+        if(uWaterBounded) xz = clamp(xz, vec2(-0.5 * uWaterExtent), vec2(0.5 * uWaterExtent));
+        aPos = vec3(xz.x, uWaterLevel, xz.y);
+        aUV = xz / uWaterExtent + vec2(0.5);
+    }
+
+    vec2 scroll0 = aUV * uLayer0Tiling + uLayer0Speed * uTime;
+    vec2 scroll1 = aUV * uLayer1Tiling + uLayer1Speed * uTime;
 
     float h0 = texture(uWaveHeight0, scroll0).r * uLayer0Strength;
     float h1 = texture(uWaveHeight1, scroll1).r * uLayer1Strength;
     float blend = smoothstep(0.0, 1.0, (h0 - h1) * uBlendSharpness * 0.5 + 0.5);
-    float height = mix(h0, h1, blend) * 1.05;
+    float height = mix(h0, h1, blend) * uWaveGain;
+    float shoreDist = texture(uShoreField, shoreFieldUV(aPos.xz)).r;
+    float shoreScale = mix(uShoreWaveMin, 1.0, smoothstep(0.0, uShoreWaveFade, shoreDist));
+    height *= shoreScale;
 
     vec3 pos = aPos;
     pos.y += height;
+    vec2 oceanUV = aPos.xz / uOceanPatchSize;
+    if(uOceanEnabled){
+        // Choppy FFT detail rides on the layered swell, calmed near the shore the same way
+        pos += textureLod(uOceanDisplacement, oceanUV, 0.0).xyz * (uOceanStrength * shoreScale);
+    }
 
     vec4 world = uModel * vec4(pos, 1.0);
     vs_out.worldPos = world.xyz;
@@ -431,6 +502,7 @@ void main(){
     vs_out.uv1 = scroll1;
     vs_out.fragPosLightSpace = uLightSpace * world;
     vs_out.layerBlend = blend;
+    vs_out.oceanUV = oceanUV;
     gl_Position = uProj * uView * world;
 }
 )GLSL";
@@ -443,6 +515,7 @@ in VS_OUT {
     vec2 uv1;
     vec4 fragPosLightSpace;
     float layerBlend;
+    vec2 oceanUV;
 } fs_in;
 
 out vec4 FragColor;
@@ -473,11 +546,17 @@ uniform float uFogDensity;
 uniform int uFogMode;
 uniform sampler2D uWaveNormal0;
 uniform sampler2D uWaveNormal1;
+uniform bool uOceanEnabled;
+uniform sampler2D uOceanDisplacement;  // .a = surface Jacobian, < 1 where the choppy offset compresses it
+uniform sampler2D uOceanSlope;
+uniform float uOceanStrength;
+uniform float uOceanFoamJacobian;      // crests foam once the Jacobian drops below this
 uniform samplerCube uEnvMap;
-uniform sampler2D uTerrainHeightMap;
+uniform sampler2D uShoreField;
 uniform sampler2D uShadowMap;
 uniform float uWorldSize;
-uniform float uHeightScale;
+uniform float uWaterLevel;
+uniform float uShoreFoamWidth;
 uniform float uFoamThreshold;
 uniform float uFoamIntensity;
 uniform float uRefractStrength;
@@ -485,6 +564,13 @@ uniform float uReflectStrength;
 
 float shadowFactor(vec4 lightSpacePos);
 
+// ShoreDistanceField texel i holds the lattice sample at i * step - worldSize / 2, so the
+// terrain's 0..1 span maps onto the first to last texel centers, not the texture edges
+vec2 shoreFieldUV(vec2 worldXZ){
+    vec2 n = vec2(textureSize(uShoreField, 0));
+    return (worldXZ / uWorldSize + vec2(0.5)) * (n - 1.0) / n + 0.5 / n;
+}
+
 void main(){
     vec3 V = normalize(uCameraPos - fs_in.worldPos);
     vec3 L = normalize(-uLightDir);
@@ -492,10 +578,19 @@ void main(){
     vec3 n0 = texture(uWaveNormal0, fs_in.uv0).xyz * 2.0 - 1.0;
     vec3 n1 = texture(uWaveNormal1, fs_in.uv1).xyz * 2.0 - 1.0;
     vec3 n = normalize(mix(n0, n1, fs_in.layerBlend));
+    float oceanFoam = 0.0;
+    if(uOceanEnabled){
+        // Add the FFT height slopes to the layered normal's (-dh/dx, 1, -dh/dz) form
+        vec2 slope = texture(uOceanSlope, fs_in.oceanUV).rg * uOceanStrength;
+        n = normalize(vec3(n.x - slope.x * n.y, n.y, n.z - slope.y * n.y));
+        float jacobian = 1.0 + (texture(uOceanDisplacement, fs_in.oceanUV).a - 1.0) * uOceanStrength;
+        oceanFoam = 1.0 - smoothstep(uOceanFoamJacobian - 0.25, uOceanFoamJacobian, jacobian);
+    }
 
-    vec2 terrainUV = (fs_in.worldPos.xz / uWorldSize) + vec2(0.5);
-    float terrainH = texture(uTerrainHeightMap, terrainUV).r * uHeightScale;
-    float depth = clamp((fs_in.worldPos.y - terrainH) / 20.0, 0.0, 1.0);
+    // One fetch for both shoreline terms: x = signed distance to shore, y = still-water depth
+    vec2 shore = texture(uShoreField, shoreFieldUV(fs_in.worldPos.xz)).rg;
+    float depth = clamp((shore.y + fs_in.worldPos.y - uWaterLevel) / 20.0, 0.0, 1.0);
+    float shoreFoam = 1.0 - smoothstep(0.0, uShoreFoamWidth, shore.x);
 
     // Rich blue ocean colors
     vec3 shallow = vec3(0.12, 0.45, 0.75);  // Bright blue shallow
@@ -524,7 +619,8 @@ void main(){
 
     // Foam on wave crests
     float curvature = clamp(length(vec2(dFdx(n.y), dFdy(n.y))) * 25.0, 0.0, 1.0);
-    float foamMask = smoothstep(uFoamThreshold, 1.2, curvature + (1.0 - depth));
+    float foamMask = smoothstep(uFoamThreshold, 1.2, curvature + max(1.0 - depth, shoreFoam));
+    foamMask = max(foamMask, oceanFoam * 0.8);
     vec3 foam = vec3(0.9) * foamMask * uFoamIntensity;
     waterColor = mix(waterColor, foam, foamMask);
 
@@ -962,6 +1058,15 @@ void main(){
 }
 )GLSL";
 
+// Terrain depth: same patch geometry as the color pass so the terrain casts displaced shadows
+static const char* kTerrainDepthVertex = R"GLSL(
+uniform mat4 uLightSpace;
+void main(){
+    vec2 uv;
+    gl_Position = uLightSpace * vec4(terrainLodPosition(uv), 1.0);
+}
+)GLSL";
+
 static const char* kDepthFragment = R"GLSL(
 #version 450 core
 void main(){
@@ -1011,8 +1116,6 @@ bool Game::init(){
     m_bonePalette.fill(glm::mat4(1.0f));
     m_renderer = new Renderer();
     if(!m_renderer->init()) return false;
-    m_shader = new Shader();
-    if(!m_shader->compile(kVertex, kFragment)) return false;
     m_camera = new Camera();
     m_camera->setViewport(g_windowPtr->width(), g_windowPtr->height());
     m_freeCamera = new Camera();
@@ -1020,8 +1123,55 @@ bool Game::init(){
     m_sky = new Sky();
     if(!m_sky->init()) return false;
     m_terrain = new Terrain();
+    // Biome weights are baked next to the heightmap instead of being re-derived per pixel
+    m_terrain->setSplatSettings(TerrainSplatSettings());
+    const int terrainQuads = 256;
+    const float terrainWorldSize = 384.0f;
+    m_waterLevel = 10.0f;
+
+    // Everything below that is procedural and seeded (heights, textures, placements) is keyed
+    // by its inputs and reused from the world cache when they all match. Bump the version
+    // whenever a generator's code changes.
+    const uint32_t kWorldGenVersion = 2;
+    auto worldCache = std::make_shared<WorldCache>(WorldCache::KeyBuilder()
+        .add(kWorldGenVersion).add(terrainQuads).add(terrainWorldSize).add(m_streamTerrain)
+        .add(m_terrain->heightScaleMultiplier()).add(m_terrain->microFrequency())
+        .add(m_waterLevel).add(m_grassWaterGap).key());
+    const bool worldCacheWarm = worldCache->load(kWorldCachePath);
+    bool worldCacheDirty = false;
+    // Fills out from the cache, or runs generate() and records its output for the next launch
+    auto cachedOrGenerate = [&](uint32_t section, auto& out, auto&& generate){
+        if(worldCache->get(section, out)) return;
+        generate();
+        worldCache->put(section, out);
+        worldCacheDirty = true;
+    };
+
     // Rectangular terrain: widthQuads, widthWorldScale (length=2*width)
-        m_terrain->generate(256, 384.0f);  // Full size
+    if(m_streamTerrain){
+        TerrainPagerSettings pages;
+        pages.pageDirectory = "cache/terrain_pages";
+        m_terrain->generateStreaming(terrainQuads, terrainWorldSize, pages);
+    } else {
+        TerrainBake bake;
+        std::vector<float> microFrequency;
+        bool fromCache = worldCache->get(kCacheTerrainHeights, bake.heights)
+            && worldCache->get(kCacheTerrainMicroX, bake.microNoiseX)
+            && worldCache->get(kCacheTerrainMicroZ, bake.microNoiseZ)
+            && worldCache->get(kCacheTerrainMicroFreq, microFrequency) && microFrequency.size() == 1;
+        if(fromCache) bake.microFrequency = microFrequency[0];
+        if(!fromCache || !m_terrain->generateFromBake(terrainQuads, terrainWorldSize, std::move(bake))){
+            m_terrain->generate(terrainQuads, terrainWorldSize);  // Full size
+            TerrainBake generated = m_terrain->bake();
+            worldCache->put(kCacheTerrainHeights, generated.heights);
+            worldCache->put(kCacheTerrainMicroX, generated.microNoiseX);
+            worldCache->put(kCacheTerrainMicroZ, generated.microNoiseZ);
+            worldCache->put(kCacheTerrainMicroFreq, std::vector<float>{generated.microFrequency});
+            worldCacheDirty = true;
+        }
+    }
+    m_shader = new Shader();
+    if(!m_shader->compile(terrainVertexSource(kVertex, m_terrain->streaming()), kFragment)) return false;
     setActiveTerrain(m_terrain);
     float startH = m_terrain->getHeight(0.0f, 0.0f);
         // Start camera near lighthouse position for easy viewing
@@ -1042,8 +1192,17 @@ bool Game::init(){
     m_grassShader = new Shader();
     if(!m_grassShader->compileWithGeometry(kGrassVertex, kGrassGeometry, kGrassFragment)) return false;
     m_water = new Water();
-    m_waterLevel = 10.0f;
-    m_water->generate(384, 384.0f, m_waterLevel); // Higher resolution for better waves
+    // Screen-projected LOD grid bounded to the island's square: ~37k vertices however much of
+    // the plane is in view (the uniform 384x384 plane was ~150k, drawn in full)
+    m_water->generateProjected(192, 384.0f, m_waterLevel, 1500.0f);
+    // FFT ocean detail: a 128^2 JONSWAP tile re-evaluated 30 times a second on the thread pool
+    m_ocean = new Ocean();
+    if(!m_ocean->init(OceanSettings())){
+        delete m_ocean;
+        m_ocean = nullptr;
+    }
+    refreshShoreField();  // shoreline distance for water foam / wave damping
+    refreshTerrainCollider();
     
     // Initialize terrain region definitions
     initTerrainRegions();
@@ -1051,25 +1210,29 @@ bool Game::init(){
     // Create a simple procedural grass texture (tiles) so the terrain has detailed look
     // 512x512 RGB texture with subtle noise
     const int gw = 512, gh = 512;
-    std::vector<unsigned char> grassData(gw * gh * 3);
-    std::mt19937 rng(12345);
-    std::uniform_int_distribution<int> noise(-28, 28);
-    for (int y = 0; y < gh; ++y) {
-        for (int x = 0; x < gw; ++x) {
-            int i = (y * gw + x) * 3;
-            // darker base green for less glowing, more natural look
-            int g = 110 + noise(rng);
-            int r = 40 + noise(rng) / 4;
-            int b = 30 + noise(rng) / 4;
-            if (((x * 31 + y * 17) & 31) == 0) {
-                g = std::max(0, g - 36);
-                r = std::max(0, r - 12);
+    std::vector<unsigned char> grassData;
+    cachedOrGenerate(kCacheGrassTexture, grassData, [&](){
+        grassData.resize(gw * gh * 3);
+        std::mt19937 rng(12345);
+        std::uniform_int_distribution<int> noise(-28, 28);
+        for (int y = 0; y < gh; ++y) {
+            for (int x = 0; x < gw; ++x) {
+                int i = (y * gw + x) * 3;
+                // darker base green for less glowing, more natural look
+                int g = 110 + noise(rng);
+                int r = 40 + noise(rng) / 4;
+                int b = 30 + noise(rng) / 4;
+                if (((x * 31 + y * 17) & 31) == 0) {
+                    g = std::max(0, g - 36);
+                    r = std::max(0, r - 12);
+                }
+                grassData[i + 0] = (unsigned char)std::clamp(r, 0, 255);
+                grassData[i + 1] = (unsigned char)std::clamp(g, 0, 255);
+                grassData[i + 2] = (unsigned char)std::clamp(b, 0, 255);
             }
-            grassData[i + 0] = (unsigned char)std::clamp(r, 0, 255);
-            grassData[i + 1] = (unsigned char)std::clamp(g, 0, 255);
-            grassData[i + 2] = (unsigned char)std::clamp(b, 0, 255);
         }
-    }
+    });
+    if(grassData.size() != static_cast<size_t>(gw * gh * 3)) grassData.assign(gw * gh * 3, 0);
     glGenTextures(1, &m_grassTexture);
     glBindTexture(GL_TEXTURE_2D, m_grassTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, gw, gh, 0, GL_RGB, GL_UNSIGNED_BYTE, grassData.data());
@@ -1198,17 +1361,20 @@ bool Game::init(){
         return (a + b * 0.6f + c * 0.4f);
     };
 
-    auto createWaveHeightTex = [&](int size, float freq, float amplitude) -> GLuint {
-        std::vector<float> data(size * size);
-        for (int y = 0; y < size; ++y) {
-            for (int x = 0; x < size; ++x) {
-                float u = static_cast<float>(x) / static_cast<float>(size);
-                float v = static_cast<float>(y) / static_cast<float>(size);
-                float n = waveNoise(u, v, freq);
-                float val = 0.5f + 0.5f * glm::clamp(n * 0.5f, -1.0f, 1.0f);
-                data[y * size + x] = glm::clamp(val * amplitude, 0.0f, 1.0f);
+    auto createWaveHeightTex = [&](uint32_t section, int size, float freq, float amplitude, std::vector<float>& data) -> GLuint {
+        cachedOrGenerate(section, data, [&](){
+            data.resize(size * size);
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    float u = static_cast<float>(x) / static_cast<float>(size);
+                    float v = static_cast<float>(y) / static_cast<float>(size);
+                    float n = waveNoise(u, v, freq);
+                    float val = 0.5f + 0.5f * glm::clamp(n * 0.5f, -1.0f, 1.0f);
+                    data[y * size + x] = glm::clamp(val * amplitude, 0.0f, 1.0f);
+                }
             }
-        }
+        });
+        data.resize(size * size);
         GLuint tex = 0;
         glGenTextures(1, &tex);
         glBindTexture(GL_TEXTURE_2D, tex);
@@ -1222,26 +1388,30 @@ bool Game::init(){
         return tex;
     };
 
-    auto createWaveNormalTex = [&](int size, float freq, float slopeScale) -> GLuint {
-        std::vector<float> data(size * size * 3);
-        float eps = 1.0f / static_cast<float>(size);
-        for (int y = 0; y < size; ++y) {
-            for (int x = 0; x < size; ++x) {
-                float u = static_cast<float>(x) / static_cast<float>(size);
-                float v = static_cast<float>(y) / static_cast<float>(size);
-                float hL = waveNoise(u - eps, v, freq);
-                float hR = waveNoise(u + eps, v, freq);
-                float hD = waveNoise(u, v - eps, freq);
-                float hU = waveNoise(u, v + eps, freq);
-                float dx = (hR - hL) * slopeScale;
-                float dz = (hU - hD) * slopeScale;
-                glm::vec3 n = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
-                int idx = (y * size + x) * 3;
-                data[idx + 0] = n.x * 0.5f + 0.5f;
-                data[idx + 1] = n.y * 0.5f + 0.5f;
-                data[idx + 2] = n.z * 0.5f + 0.5f;
+    auto createWaveNormalTex = [&](uint32_t section, int size, float freq, float slopeScale) -> GLuint {
+        std::vector<float> data;
+        cachedOrGenerate(section, data, [&](){
+            data.resize(size * size * 3);
+            float eps = 1.0f / static_cast<float>(size);
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    float u = static_cast<float>(x) / static_cast<float>(size);
+                    float v = static_cast<float>(y) / static_cast<float>(size);
+                    float hL = waveNoise(u - eps, v, freq);
+                    float hR = waveNoise(u + eps, v, freq);
+                    float hD = waveNoise(u, v - eps, freq);
+                    float hU = waveNoise(u, v + eps, freq);
+                    float dx = (hR - hL) * slopeScale;
+                    float dz = (hU - hD) * slopeScale;
+                    glm::vec3 n = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+                    int idx = (y * size + x) * 3;
+                    data[idx + 0] = n.x * 0.5f + 0.5f;
+                    data[idx + 1] = n.y * 0.5f + 0.5f;
+                    data[idx + 2] = n.z * 0.5f + 0.5f;
+                }
             }
-        }
+        });
+        data.resize(size * size * 3);
         GLuint tex = 0;
         glGenTextures(1, &tex);
         glBindTexture(GL_TEXTURE_2D, tex);
@@ -1291,10 +1461,15 @@ bool Game::init(){
         return tex;
     };
 
-    m_waveHeightTex[0] = createWaveHeightTex(256, 3.5f, 0.9f);
-    m_waveHeightTex[1] = createWaveHeightTex(256, 6.5f, 0.7f);
-    m_waveNormalTex[0] = createWaveNormalTex(256, 3.5f, 0.8f);
-    m_waveNormalTex[1] = createWaveNormalTex(256, 6.5f, 1.2f);
+    const int waveTexSize = 256;
+    std::vector<float> waveHeights0, waveHeights1;
+    m_waveHeightTex[0] = createWaveHeightTex(kCacheWaveHeight0, waveTexSize, 3.5f, 0.9f, waveHeights0);
+    m_waveHeightTex[1] = createWaveHeightTex(kCacheWaveHeight1, waveTexSize, 6.5f, 0.7f, waveHeights1);
+    // CPU copy of the displaced surface for gameplay; the shore field was baked above
+    m_waveSampler = WaveSampler(waveHeights0, waveHeights1, waveTexSize, m_waveSettings, m_waterLevel, 384.0f)
+        .withShore(m_shoreField);
+    m_waveNormalTex[0] = createWaveNormalTex(kCacheWaveNormal0, 256, 3.5f, 0.8f);
+    m_waveNormalTex[1] = createWaveNormalTex(kCacheWaveNormal1, 256, 6.5f, 1.2f);
     m_envCubemap = createEnvCubemap();
 
     const glm::vec2 campfireClearingCenter(140.0f, 83.0f);
@@ -1345,7 +1520,8 @@ bool Game::init(){
         return instances;
     };
 
-    std::vector<glm::vec4> grassInstances = generateGrassInstances();
+    std::vector<glm::vec4> grassInstances;
+    cachedOrGenerate(kCacheGrassInstances, grassInstances, [&](){ grassInstances = generateGrassInstances(); });
     if(!grassInstances.empty()){
         glGenVertexArrays(1, &m_grassVAO);
         glGenBuffers(1, &m_grassVBO);
@@ -1433,17 +1609,33 @@ bool Game::init(){
         float followDistance = 13.0f;  // Further back
         m_thirdPersonCamera.setTarget(&m_characterAimPoint);
         m_thirdPersonCamera.setFollowConfig(pivotHeight, verticalOffset, followDistance);
+        // Keep hills from swallowing the character: pull the camera in front of any terrain hit
+        m_thirdPersonCamera.setOcclusionFn([this](const glm::vec3& from, const glm::vec3& to, float& hitFraction){
+            if(!m_terrain) return false;
+            TerrainRay ray;
+            ray.origin = from;
+            ray.direction = to - from;
+            ray.maxDistance = 1.0f;
+            TerrainRayHit hit;
+            if(!m_terrain->raycaster()->raycast(ray, hit)) return false;
+            hitFraction = hit.distance;
+            return true;
+        });
         m_thirdPersonCamera.update(0.0, 0.0f, 0.0f, getTerrainHeightAt);
         
-        // Setup character collision (capsule)
+        // Setup character collision (capsule standing at the feet)
         CollisionBody characterBody;
         characterBody.shape = CollisionShape::Capsule;
-        characterBody.position = m_characterController.position;
+        characterBody.position = spawn;
         characterBody.radius = m_characterScale * m_characterHeight * 0.3f;  // Roughly body width
         characterBody.height = m_characterHeight * m_characterScale;
         characterBody.isStatic = false;
         characterBody.userData = this;
         m_characterCollisionBody = m_collisionSystem.addBody(characterBody);
+        m_characterController.grounded = true;
+        // Walking rules in proportion to the model: steps up to a fifth of its height
+        m_characterMoveSettings.stepHeight = characterBody.height * 0.2f;
+        m_characterMoveSettings.snapDistance = characterBody.height * 0.15f;
         
         if(m_characterMesh.albedoTex != 0){
             m_characterAlbedoTex = m_characterMesh.albedoTex;
@@ -1539,15 +1731,8 @@ bool Game::init(){
                 return glm::vec3(x, terrainY + feetOffset * scale, z);
             };
 
-            auto findRegion = [&](const std::string& name)->const TerrainRegion*{
-                auto it = std::find_if(m_terrainRegions.begin(), m_terrainRegions.end(), [&](const TerrainRegion& region){
-                    return region.name == name;
-                });
-                return it != m_terrainRegions.end() ? &(*it) : nullptr;
-            };
-
             auto emitTreesInRegion = [&](const std::string& regionName, int desiredCount, std::mt19937& rng){
-                const TerrainRegion* region = findRegion(regionName);
+                const TerrainRegion* region = m_terrainRegions.region(m_terrainRegions.find(regionName));
                 if(!region || desiredCount <= 0) return;
                 std::uniform_real_distribution<float> distX(region->minXZ.x, region->maxXZ.x);
                 std::uniform_real_distribution<float> distZ(region->minXZ.y, region->maxXZ.y);
@@ -1577,20 +1762,31 @@ bool Game::init(){
                 }
             };
 
-            m_treeInstances.clear();
-            m_treeInstances.reserve(80);
-
             // Anchor tree in the southern center of the grass valley for easy visual reference
             float anchorX = 0.0f;
             float anchorZ = 128.0f;  // Midpoint of grassland_south strip (64..192)
-            glm::vec3 anchorPosition = computeTreePosition(anchorX, anchorZ, baseScale);
-            m_treeInstances.push_back({anchorPosition, baseScale});
             float anchorTerrainY = m_terrain->getHeight(anchorX, anchorZ);
 
-            std::mt19937 treeRng(860321);
-            emitTreesInRegion("grassland_south", 35, treeRng);
-            emitTreesInRegion("grassland_center", 28, treeRng);
-            emitTreesInRegion("grassland_north", 12, treeRng);
+            // Placements are cached as (x, z, scale); heights come from the terrain each launch
+            // because the feet offset depends on the loaded model.
+            std::vector<glm::vec4> treePlacements;
+            cachedOrGenerate(kCacheTreePlacements, treePlacements, [&](){
+                m_treeInstances.clear();
+                m_treeInstances.reserve(80);
+                m_treeInstances.push_back({computeTreePosition(anchorX, anchorZ, baseScale), baseScale});
+                std::mt19937 treeRng(860321);
+                emitTreesInRegion("grassland_south", 35, treeRng);
+                emitTreesInRegion("grassland_center", 28, treeRng);
+                emitTreesInRegion("grassland_north", 12, treeRng);
+                for(const TreeInstance& tree : m_treeInstances){
+                    treePlacements.emplace_back(tree.position.x, tree.position.z, tree.scale, 0.0f);
+                }
+            });
+            m_treeInstances.clear();
+            m_treeInstances.reserve(treePlacements.size());
+            for(const glm::vec4& placement : treePlacements){
+                m_treeInstances.push_back({computeTreePosition(placement.x, placement.y, placement.z), placement.z});
+            }
 
             if(m_treeInstances.empty()){
                 std::cerr << "[Game] No valid placement found for tree instances" << std::endl;
@@ -1605,6 +1801,20 @@ bool Game::init(){
                           << " (terrain), " << anchorZ << ")" << std::endl;
                 std::cout << "[Game] Spawned " << (m_treeInstances.size() - 1)
                           << " additional tree instances across grassland regions" << std::endl;
+
+                m_treeImpostor = new Impostor();
+                bool baked = m_treeImpostor->init() &&
+                    m_treeImpostor->bake(m_treeMesh.minBounds, m_treeMesh.maxBounds, [&](){
+                        for(const auto& part : m_treeMesh.parts){
+                            glBindTexture(GL_TEXTURE_2D, part.albedoTex);
+                            drawStaticMeshPart(part, 0);
+                        }
+                    });
+                if(!baked){
+                    std::cerr << "[Game] Tree impostor bake failed; distant trees stay as meshes" << std::endl;
+                    delete m_treeImpostor;
+                    m_treeImpostor = nullptr;
+                }
             }
         }
     } else {
@@ -1761,6 +1971,8 @@ bool Game::init(){
         std::cerr << "[Game] Could not locate assets/models/forest_hut.glb" << std::endl;
     }
 
+    initStaticColliders(lighthousePath, campfirePath, forestHutPath);
+
     // Enhanced sun lighting for professional outdoor look
     // Sun angle: 45° elevation for natural midday lighting
     m_light.direction = glm::normalize(glm::vec3(0.5f, -0.7f, -0.3f));
@@ -1784,6 +1996,11 @@ bool Game::init(){
         std::cerr << "[Game] Failed to compile depth shader" << std::endl;
         return false;
     }
+    m_terrainDepthShader = new Shader();
+    if(!m_terrainDepthShader->compile(terrainVertexSource(kTerrainDepthVertex, m_terrain->streaming()), kDepthFragment)){
+        std::cerr << "[Game] Failed to compile terrain depth shader" << std::endl;
+        return false;
+    }
     m_skinnedDepthShader = new Shader();
     if(!m_skinnedDepthShader->compile(kSkinnedDepthVertex, kSkinnedDepthFragment)){
         std::cerr << "[Game] Failed to compile skinned depth shader" << std::endl;
@@ -1808,6 +2025,17 @@ bool Game::init(){
         std::cerr << "[Game] Shadow FBO not complete" << std::endl;
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(worldCacheDirty){
+        // Serialize and write off the main thread; the next launch starts warm
+        m_worldCacheSave = ThreadPool::shared().submit([worldCache]{
+            if(worldCache->save(kWorldCachePath)){
+                std::cout << "[WorldCache] Saved " << kWorldCachePath << std::endl;
+            }
+        });
+    } else if(worldCacheWarm){
+        std::cout << "[WorldCache] Warm start from " << kWorldCachePath << std::endl;
+    }
     return true;
 }
 
@@ -1830,10 +2058,22 @@ void Game::update(){
         }
     };
 
+    // The collision system walks the character over the terrain heightfield and against the
+    // placed colliders; its body stands at the feet, below the model origin by the feet offset
+    auto moveCharacter = [&](){
+        if(!m_collisionSystem.isValid(m_characterCollisionBody)) return;
+        CharacterMove move;
+        move.body = m_characterCollisionBody;
+        move.velocity = m_characterController.velocity;
+        move.grounded = m_characterController.grounded;
+        m_collisionSystem.moveCharacters({&move, 1}, static_cast<float>(dt), m_characterMoveSettings);
+        m_characterController.velocity = move.velocity;
+        m_characterController.grounded = move.grounded;
+        m_characterController.position = move.position - glm::vec3(0.0f, m_characterFeetOffset * m_characterScale, 0.0f);
+    };
+
     auto updateCharacterPlacement = [&](){
         if(!m_characterReady) return;
-        float terrainY = getTerrainHeightAt(m_characterController.position.x, m_characterController.position.z);
-        m_characterController.position.y = terrainY - m_characterFeetOffset * m_characterScale;
         float pivotHeight = m_characterHeight * m_characterScale * 1.5f;
         float verticalOffset = m_characterHeight * m_characterScale * 1.4f;
         float followDistance = 13.0f;
@@ -1898,8 +2138,34 @@ void Game::update(){
         } else if(tState == GLFW_RELEASE){
             m_nightToggleHeld = false;
         }
+
+        // Debug height brush: hold B to raise / V to lower the terrain where the camera looks.
+        // The edit goes through the dirty-rect upload and sampler snapshot swap, and the collider
+        // refresh below picks up the new snapshot
+        int raiseState = glfwGetKey(window, GLFW_KEY_B);
+        int lowerState = glfwGetKey(window, GLFW_KEY_V);
+        bool brushing = (raiseState == GLFW_PRESS) != (lowerState == GLFW_PRESS);
+        if(brushing && m_camera && m_terrain && !m_terrain->streaming()){
+            float yaw = glm::radians(m_camera->yaw());
+            float pitch = glm::radians(m_camera->pitch());
+            TerrainRay ray;
+            ray.origin = m_camera->position();
+            ray.direction = glm::vec3(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+            ray.maxDistance = kBrushReach;
+            TerrainRayHit hit;
+            if(m_terrain->raycaster()->raycast(ray, hit)){
+                float delta = kBrushRate * static_cast<float>(dt) * (raiseState == GLFW_PRESS ? 1.0f : -1.0f);
+                m_terrain->applyHeightBrush(hit.position.x, hit.position.z, kBrushRadius, delta);
+                if(!m_brushHeld){
+                    std::cout << "[Game] Height brush " << (delta > 0.0f ? "raising" : "lowering")
+                              << " at (" << hit.position.x << ", " << hit.position.z << ")" << std::endl;
+                }
+            }
+        }
+        m_brushHeld = brushing;
     }
 
+    refreshTerrainCollider();
     bool placementUpdated = false;
     if(m_characterReady && window){
         double mouseX = 0.0;
@@ -1936,19 +2202,8 @@ void Game::update(){
                 moveDir = glm::vec3(normalized.x, 0.0f, normalized.y);
             }
             
-            // Store old position for collision resolution
-            glm::vec3 oldPos = m_characterController.position;
-            CharacterState desired = m_characterController.update(dt, moveForward, moveDir);
-            
-            // Apply collision resolution
-            if(moveForward){
-                glm::vec3 resolvedPos = m_collisionSystem.resolveMovement(
-                    m_characterCollisionBody, oldPos, m_characterController.position);
-                m_characterController.position = resolvedPos;
-            }
-            
-            // Update collision body position
-            m_collisionSystem.updateBodyPosition(m_characterCollisionBody, m_characterController.position);
+            CharacterState desired = m_characterController.update(moveForward, moveDir);
+            moveCharacter();
             
             if(m_animator){
                 m_animator->play(desired);
@@ -1964,8 +2219,13 @@ void Game::update(){
             }
             updateCharacterPlacement();
             placementUpdated = true;
-            m_thirdPersonCamera.update(dt, mouseDX, mouseDY, [](float x, float z){
-                return getTerrainHeightAt(x, z);
+            // The camera floor is the higher of the ground and the displaced water surface, so
+            // swell crests never cut through the near plane
+            std::shared_ptr<const WaveSampler> waves = m_waveSampler;
+            const float waveTime = Time::elapsed();
+            m_thirdPersonCamera.update(dt, mouseDX, mouseDY, [&waves, waveTime](float x, float z){
+                float ground = getTerrainHeightAt(x, z);
+                return waves ? std::max(ground, waves->height(x, z, waveTime)) : ground;
             });
             if(m_camera){
                 glm::vec3 eye = m_thirdPersonCamera.position();
@@ -1991,6 +2251,9 @@ void Game::update(){
     }
 
     if(m_characterReady && !placementUpdated){
+        // Not steered this frame: stand still, but keep falling and following the ground
+        m_characterController.update(false, glm::vec3(0.0f));
+        moveCharacter();
         updateCharacterPlacement();
     }
 
@@ -2010,6 +2273,7 @@ void Game::update(){
 
     if(m_camera){
         m_camera->setViewport(g_windowPtr->width(), g_windowPtr->height());
+        if(m_terrain) m_terrain->update(m_camera->position());
     }
     // (Debug modes removed in simplified pipeline.)
 }
@@ -2092,6 +2356,25 @@ void Game::render(){
         }
     };
 
+    // Pick static mesh LODs once per frame; the shadow pass reuses them with m_shadowLodBias.
+    if(m_lighthouseReady) m_lighthouseLod = selectStaticMeshLod(m_lighthouseMesh, m_lighthousePosition, m_lighthouseScale, m_lighthouseLod);
+    if(m_campfireReady) m_campfireLod = selectStaticMeshLod(m_campfireMesh, m_campfirePosition, m_campfireScale, m_campfireLod);
+    if(m_forestHutReady) m_forestHutLod = selectStaticMeshLod(m_forestHutMesh, m_forestHutPosition, m_forestHutScale, m_forestHutLod);
+    if(m_treeReady){
+        m_treeImpostorInstances.clear();
+        const glm::vec3 eye = m_camera->position();
+        for(TreeInstance& tree : m_treeInstances){
+            tree.lod = selectStaticMeshLod(m_treeMesh, tree.position, tree.scale, tree.lod);
+            if(m_treeImpostor){
+                float dist = glm::length(tree.position - eye);
+                float switchDist = m_treeImpostorDistance * (tree.impostor ? 1.0f - m_lodHysteresis : 1.0f);
+                tree.impostor = dist > switchDist;
+                if(tree.impostor) m_treeImpostorInstances.emplace_back(tree.position, tree.scale);
+            }
+        }
+        if(m_treeImpostor) m_treeImpostor->setInstances(m_treeImpostorInstances);
+    }
+
     glViewport(0,0,m_shadowMapSize,m_shadowMapSize);
     glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFBO);
     glClear(GL_DEPTH_BUFFER_BIT);
@@ -2114,10 +2397,9 @@ void Game::render(){
 
         m_depthShader->bind();
         m_depthShader->setMat4("uLightSpace", lightSpace);
+        m_depthShader->setMat4("uModel", lighthouseModel);
         for(const auto& part : m_lighthouseMesh.parts){
-            m_depthShader->setMat4("uModel", lighthouseModel);
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_lighthouseLod + m_shadowLodBias);
         }
         glBindVertexArray(0);
     }
@@ -2132,8 +2414,7 @@ void Game::render(){
             treeModel = glm::scale(treeModel, glm::vec3(tree.scale));
             m_depthShader->setMat4("uModel", treeModel);
             for(const auto& part : m_treeMesh.parts){
-                glBindVertexArray(part.vao);
-                glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+                drawStaticMeshPart(part, tree.lod + m_shadowLodBias);
             }
         }
         glBindVertexArray(0);
@@ -2149,8 +2430,7 @@ void Game::render(){
         m_depthShader->setMat4("uLightSpace", lightSpace);
         m_depthShader->setMat4("uModel", campfireModel);
         for(const auto& part : m_campfireMesh.parts){
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_campfireLod + m_shadowLodBias);
         }
         glBindVertexArray(0);
     }
@@ -2179,8 +2459,7 @@ void Game::render(){
         m_depthShader->setMat4("uLightSpace", lightSpace);
         m_depthShader->setMat4("uModel", hutModel);
         for(const auto& part : m_forestHutMesh.parts){
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_forestHutLod + m_shadowLodBias);
         }
         glBindVertexArray(0);
     }
@@ -2197,12 +2476,19 @@ void Game::render(){
         glBindVertexArray(0);
     }
     
-    // Draw terrain to shadow map
-    m_depthShader->bind();
-    m_depthShader->setMat4("uLightSpace", lightSpace);
-    glm::mat4 lightModel(1.0f);
-    m_depthShader->setMat4("uModel", lightModel);
-    m_renderer->drawMesh(*m_terrain->mesh(), *m_depthShader, *m_camera, lightModel);
+    // Draw terrain to shadow map: LOD is chosen from the camera so shadows match the visible
+    // surface, culling uses the light frustum
+    float heightScale = m_terrain->recommendedHeightScale();
+    TerrainQuadtree& terrainLod = m_terrain->quadtree();
+    terrainLod.select(m_camera->position(), Frustum::fromMatrix(lightSpace), heightScale, m_terrainShadowSelection);
+    m_terrainDepthShader->bind();
+    m_terrainDepthShader->setMat4("uLightSpace", lightSpace);
+    terrainLod.setUniforms(*m_terrainDepthShader, m_camera->position(), heightScale);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_terrain->heightTexture());
+    m_terrainDepthShader->setInt("uHeightMap", 0);
+    if(m_terrain->streaming()) m_terrain->pager().bind(*m_terrainDepthShader, 8, 9);
+    terrainLod.draw(m_terrainShadowSelection);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     // restore viewport
     m_renderer->beginFrame(g_windowPtr->width(), g_windowPtr->height());
@@ -2222,8 +2508,11 @@ void Game::render(){
     uploadPointLights(m_shader);
     uploadSpotLight(m_shader);
     // Terrain displacement + texture fetch uniforms
-    float heightScale = m_terrain->recommendedHeightScale();
-    m_shader->setFloat("uHeightScale", heightScale);
+    terrainLod.select(m_camera->position(), Frustum::fromMatrix(m_camera->projectionMatrix() * m_camera->viewMatrix()),
+                      heightScale, m_terrainSelection);
+    terrainLod.setUniforms(*m_shader, m_camera->position(), heightScale);
+    m_shader->setMat4("uView", m_camera->viewMatrix());
+    m_shader->setMat4("uProj", m_camera->projectionMatrix());
     // Pass light space matrix and shadow map to terrain shader
     m_shader->setMat4("uLightSpace", lightSpace);
     glActiveTexture(GL_TEXTURE3);
@@ -2244,13 +2533,18 @@ void Game::render(){
     glActiveTexture(GL_TEXTURE6);
     glBindTexture(GL_TEXTURE_2D, m_texRocks);
     m_shader->setInt("uTexRocks", 6);
-    glm::vec2 texelSize(1.0f / (float)m_terrain->widthResolution(), 1.0f / (float)m_terrain->lengthResolution());
-    m_shader->setVec2("uTexelSize", texelSize);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_terrain->splatTexture());
+    m_shader->setInt("uSplatMap", 1);
+    glActiveTexture(GL_TEXTURE7);
+    glBindTexture(GL_TEXTURE_2D, m_terrain->normalTexture());
+    m_shader->setInt("uNormalMap", 7);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, m_terrain->heightTexture());
     m_shader->setInt("uHeightMap", 0);
+    if(m_terrain->streaming()) m_terrain->pager().bind(*m_shader, 8, 9);
         m_shader->setVec3("uSkyColor", skyColor);
-    m_renderer->drawMesh(*m_terrain->mesh(), *m_shader, *m_camera, model);
+    terrainLod.draw(m_terrainSelection);
 
     if(m_characterReady && m_characterShader){
         m_characterShader->bind();
@@ -2319,8 +2613,7 @@ void Game::render(){
         m_characterShader->setInt("uAlbedo", 8);
         for(const auto& part : m_lighthouseMesh.parts){
             glBindTexture(GL_TEXTURE_2D, part.albedoTex);
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_lighthouseLod);
         }
         glBindVertexArray(0);
         glActiveTexture(GL_TEXTURE0);
@@ -2354,18 +2647,24 @@ void Game::render(){
         m_characterShader->setInt("uAlbedo", 8);
 
         for(const TreeInstance& tree : m_treeInstances){
+            if(tree.impostor) continue;
             glm::mat4 treeModel = glm::mat4(1.0f);
             treeModel = glm::translate(treeModel, tree.position);
             treeModel = glm::scale(treeModel, glm::vec3(tree.scale));
             m_characterShader->setMat4("uModel", treeModel);
             for(const auto& part : m_treeMesh.parts){
                 glBindTexture(GL_TEXTURE_2D, part.albedoTex);
-                glBindVertexArray(part.vao);
-                glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+                drawStaticMeshPart(part, tree.lod);
             }
         }
         glBindVertexArray(0);
         glActiveTexture(GL_TEXTURE0);
+
+        if(m_treeImpostor && m_treeImpostor->instanceCount() > 0){
+            m_treeImpostor->shader().bind();
+            uploadFog(&m_treeImpostor->shader());
+            m_treeImpostor->render(*m_camera, m_light.direction, m_light.color, ambientColor);
+        }
     }
 
     // Render campfire (static model)
@@ -2399,8 +2698,7 @@ void Game::render(){
         m_characterShader->setInt("uAlbedo", 8);
         for(const auto& part : m_campfireMesh.parts){
             glBindTexture(GL_TEXTURE_2D, part.albedoTex);
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_campfireLod);
         }
         glBindVertexArray(0);
         glActiveTexture(GL_TEXTURE0);
@@ -2475,8 +2773,7 @@ void Game::render(){
         m_characterShader->setInt("uAlbedo", 8);
         for(const auto& part : m_forestHutMesh.parts){
             glBindTexture(GL_TEXTURE_2D, part.albedoTex);
-            glBindVertexArray(part.vao);
-            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            drawStaticMeshPart(part, m_forestHutLod);
         }
         glBindVertexArray(0);
         glActiveTexture(GL_TEXTURE0);
@@ -2527,6 +2824,7 @@ void Game::render(){
     renderBeaconGlow(viewProj, view);
 
     // Render water
+    refreshShoreField();
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDepthMask(GL_FALSE); // Don't write to depth for transparency
@@ -2554,29 +2852,51 @@ void Game::render(){
     glBindTexture(GL_TEXTURE_2D, m_waveNormalTex[1]);
     m_waterShader->setInt("uWaveNormal1", 3);
     glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, m_terrain->heightTexture());
-    m_waterShader->setInt("uTerrainHeightMap", 4);
+    glBindTexture(GL_TEXTURE_2D, m_shoreFieldTex);
+    m_waterShader->setInt("uShoreField", 4);
     glActiveTexture(GL_TEXTURE5);
     glBindTexture(GL_TEXTURE_2D, m_shadowTex);
     m_waterShader->setInt("uShadowMap", 5);
     glActiveTexture(GL_TEXTURE6);
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_envCubemap);
     m_waterShader->setInt("uEnvMap", 6);
+    if(m_ocean){
+        m_ocean->update(Time::elapsed());  // polls the FFT job; never waits on it
+        m_ocean->bind(*m_waterShader, 7, 8);
+        // Gameplay sees the same tile the shader just bound
+        if(m_waveSampler && m_waveSampler->ocean() != m_ocean->frame()){
+            m_waveSampler = m_waveSampler->withOcean(m_ocean->frame(), m_ocean->settings().patchSize);
+        }
+    } else {
+        m_waterShader->setBool("uOceanEnabled", false);
+    }
+    m_waterShader->setFloat("uOceanStrength", m_waveSettings.oceanStrength);
+    m_waterShader->setFloat("uOceanFoamJacobian", 0.75f);
     // Enhanced ocean-like water parameters with sharp ridges
-    m_waterShader->setVec2("uLayer0Speed", glm::vec2(0.025f, 0.018f));  // Moderate speed
-    m_waterShader->setVec2("uLayer1Speed", glm::vec2(-0.015f, 0.028f));  // Cross-wave pattern
-    m_waterShader->setFloat("uLayer0Strength", 2.8f);  // Higher waves
-    m_waterShader->setFloat("uLayer1Strength", 2.2f);  // Stronger secondary waves
-    m_waterShader->setFloat("uBlendSharpness", 4.5f);  // Much sharper ridges
+    // Wave shape comes from the same settings the CPU WaveSampler uses
+    m_waterShader->setVec2("uLayer0Speed", m_waveSettings.layer0Speed);
+    m_waterShader->setVec2("uLayer1Speed", m_waveSettings.layer1Speed);
+    m_waterShader->setFloat("uLayer0Strength", m_waveSettings.layer0Strength);
+    m_waterShader->setFloat("uLayer1Strength", m_waveSettings.layer1Strength);
+    m_waterShader->setFloat("uBlendSharpness", m_waveSettings.blendSharpness);
+    m_waterShader->setFloat("uLayer0Tiling", m_waveSettings.layer0Tiling);
+    m_waterShader->setFloat("uLayer1Tiling", m_waveSettings.layer1Tiling);
+    m_waterShader->setFloat("uWaveGain", m_waveSettings.gain);
+    m_waterShader->setFloat("uShoreWaveMin", m_waveSettings.shoreMinScale);
     m_waterShader->setFloat("uFoamThreshold", 0.18f);  // More foam coverage
     m_waterShader->setFloat("uFoamIntensity", 1.5f);  // Brighter foam
     m_waterShader->setFloat("uRefractStrength", 0.30f);  // Less refraction
     m_waterShader->setFloat("uReflectStrength", 0.95f);  // Strong sun reflection
-    m_waterShader->setFloat("uHeightScale", heightScale);
+    m_waterShader->setFloat("uShoreWaveFade", m_waveSettings.shoreFade);  // Calmer water right at the beach
+    m_waterShader->setFloat("uShoreFoamWidth", 2.5f);  // Foam line along the shore
     m_waterShader->setFloat("uWorldSize", m_terrain->worldSize());
     // Restore default active texture for other passes
     glActiveTexture(GL_TEXTURE0);
-    m_renderer->drawMesh(*m_water->mesh(), *m_waterShader, *m_camera, model);
+    m_waterShader->setMat4("uModel", model);
+    m_waterShader->setMat4("uView", m_camera->viewMatrix());
+    m_waterShader->setMat4("uProj", m_camera->projectionMatrix());
+    m_water->setUniforms(*m_waterShader, m_camera->projectionMatrix() * m_camera->viewMatrix());
+    m_water->draw();
     glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
     
@@ -2603,19 +2923,20 @@ void Game::render(){
         // Current position
         glm::vec3 camPos = m_camera->position();
         float terrainHeight = m_terrain ? m_terrain->getHeight(camPos.x, camPos.z) : 0.0f;
-        std::string currentRegion = getRegionAtPosition(camPos);
+        RegionId currentRegion = getRegionAtPosition(camPos);
         
         ImGui::Text("Camera Position:");
         ImGui::Text("  X: %.1f  Y: %.1f  Z: %.1f", camPos.x, camPos.y, camPos.z);
         ImGui::Text("  Terrain Height: %.1f", terrainHeight);
-        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.2f, 1.0f), "  Region: %s", currentRegion.c_str());
+        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.2f, 1.0f), "  Region: %s", m_terrainRegions.name(currentRegion).c_str());
         
         ImGui::Separator();
         ImGui::Text("Available Regions (%zu):", m_terrainRegions.size());
         ImGui::BeginChild("RegionList", ImVec2(400, 300), true);
         
-        for(const auto& region : m_terrainRegions){
-            bool isCurrentRegion = (region.name == currentRegion);
+        for(size_t i = 0; i < m_terrainRegions.size(); ++i){
+            const TerrainRegion& region = m_terrainRegions.regions()[i];
+            bool isCurrentRegion = (i == currentRegion);
             if(isCurrentRegion){
                 ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.2f, 1.0f));
             }
@@ -2657,6 +2978,17 @@ void Game::render(){
             m_terrain->setMicroFrequency(mf);
             m_terrain->recomputeNormals();
         }
+        int terrainPatches = m_terrainSelection.patchCount();
+        ImGui::Text("LOD patches: %d (%d tris), shadow: %d", terrainPatches,
+                    terrainPatches * m_terrain->quadtree().trianglesPerPatch(), m_terrainShadowSelection.patchCount());
+        if(m_terrain->streaming()){
+            ImGui::Text("Height pages: %d resident, %d pending", m_terrain->pager().residentCount(),
+                        m_terrain->pager().pendingCount());
+        }
+        if(m_ocean){
+            ImGui::Text("Ocean FFT: %dx%d, %llu uploads, %llu fence stalls", m_ocean->settings().resolution,
+                        m_ocean->settings().resolution, m_ocean->uploads(), m_ocean->fenceStalls());
+        }
         ImGui::End();
     }
 
@@ -2669,7 +3001,7 @@ void Game::render(){
         float currentTime = Time::elapsed();
         if(currentTime - lastPrintTime > 2.0f){
             glm::vec3 camPos = m_camera->position();
-            std::string region = getRegionAtPosition(camPos);
+            const std::string& region = m_terrainRegions.name(getRegionAtPosition(camPos));
             std::cout << "[Region] Current: " << region 
                       << " at (" << camPos.x << ", " << camPos.y << ", " << camPos.z << ")" << std::endl;
             lastPrintTime = currentTime;
@@ -3046,6 +3378,8 @@ void Game::updateBeaconLight(float dt){
 
 void Game::shutdown(){
     std::cout << "[Game] Shutdown" << std::endl;
+    if(m_worldCacheSave.valid()) m_worldCacheSave.wait();
+    if(m_colliderCacheSave.valid()) m_colliderCacheSave.wait();
 #ifdef BUILD_IMGUI
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -3054,6 +3388,7 @@ void Game::shutdown(){
     if(m_shadowTex) { glDeleteTextures(1, &m_shadowTex); m_shadowTex = 0; }
     if(m_shadowFBO) { glDeleteFramebuffers(1, &m_shadowFBO); m_shadowFBO = 0; }
     delete m_depthShader; m_depthShader = nullptr;
+    delete m_terrainDepthShader; m_terrainDepthShader = nullptr;
     delete m_skinnedDepthShader; m_skinnedDepthShader = nullptr;
     if(m_fireTexture) { glDeleteTextures(1, &m_fireTexture); m_fireTexture = 0; }
     if(m_fireInstanceVBO) { glDeleteBuffers(1, &m_fireInstanceVBO); m_fireInstanceVBO = 0; }
@@ -3075,6 +3410,10 @@ void Game::shutdown(){
     if(m_texFungus) { glDeleteTextures(1, &m_texFungus); m_texFungus = 0; }
     if(m_texSandgrass) { glDeleteTextures(1, &m_texSandgrass); m_texSandgrass = 0; }
     if(m_texRocks) { glDeleteTextures(1, &m_texRocks); m_texRocks = 0; }
+    if(m_shoreFieldTex) { glDeleteTextures(1, &m_shoreFieldTex); m_shoreFieldTex = 0; }
+    m_shoreField.reset();
+    m_waveSampler.reset();
+    if(m_ocean){ m_ocean->shutdown(); delete m_ocean; m_ocean = nullptr; }
     if(m_grassBillboardTex) { glDeleteTextures(1, &m_grassBillboardTex); m_grassBillboardTex = 0; }
     for(unsigned int& tex : m_waveHeightTex){ if(tex){ glDeleteTextures(1, &tex); tex = 0; } }
     for(unsigned int& tex : m_waveNormalTex){ if(tex){ glDeleteTextures(1, &tex); tex = 0; } }
@@ -3108,7 +3447,9 @@ void Game::shutdown(){
     releaseStaticMesh(m_campfireMesh);
     releaseStaticMesh(m_forestHutMesh);
     delete m_renderer; delete m_shader; delete m_waterShader; delete m_grassShader; delete m_camera; delete m_terrain; delete m_water; delete m_sky;
+    delete m_treeImpostor; m_treeImpostor = nullptr;
     m_grassShader = nullptr;
+    GridMeshCache::shared().shutdown();  // after the terrain and water that draw with it
 }
 
 void Game::initTerrainRegions(){
@@ -3133,7 +3474,7 @@ void Game::initTerrainRegions(){
     m_terrainRegions.clear();
     
     // === UNDERWATER REGIONS ===
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "underwater_north",
         glm::vec2(-halfSize, -halfSize),
         glm::vec2(halfSize, -halfSize/3.0f),
@@ -3141,7 +3482,7 @@ void Game::initTerrainRegions(){
         "Underwater area - northern section"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "underwater_center",
         glm::vec2(-halfSize, -halfSize/3.0f),
         glm::vec2(halfSize, halfSize/3.0f),
@@ -3149,7 +3490,7 @@ void Game::initTerrainRegions(){
         "Underwater area - central section"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "underwater_south",
         glm::vec2(-halfSize, halfSize/3.0f),
         glm::vec2(halfSize, halfSize),
@@ -3159,7 +3500,7 @@ void Game::initTerrainRegions(){
     
     // === BEACH REGIONS (First strip above water) ===
     // Height: water level (10) to ~18 units
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "beach_north",
         glm::vec2(-halfSize, -halfSize),
         glm::vec2(halfSize, -halfSize/3.0f),
@@ -3167,7 +3508,7 @@ void Game::initTerrainRegions(){
         "Beach - northern coastline"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "beach_center",
         glm::vec2(-halfSize, -halfSize/3.0f),
         glm::vec2(halfSize, halfSize/3.0f),
@@ -3175,7 +3516,7 @@ void Game::initTerrainRegions(){
         "Beach - central coastline"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "beach_south",
         glm::vec2(-halfSize, halfSize/3.0f),
         glm::vec2(halfSize, halfSize),
@@ -3185,7 +3526,7 @@ void Game::initTerrainRegions(){
     
     // === GRASSLAND REGIONS (Second strip) ===
     // Height: ~18 to ~35 units
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "grassland_north",
         glm::vec2(-halfSize, -halfSize),
         glm::vec2(halfSize, -halfSize/3.0f),
@@ -3193,7 +3534,7 @@ void Game::initTerrainRegions(){
         "Grassland - northern area"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "grassland_center",
         glm::vec2(-halfSize, -halfSize/3.0f),
         glm::vec2(halfSize, halfSize/3.0f),
@@ -3201,7 +3542,7 @@ void Game::initTerrainRegions(){
         "Grassland - central plains"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "grassland_south",
         glm::vec2(-halfSize, halfSize/3.0f),
         glm::vec2(halfSize, halfSize),
@@ -3211,7 +3552,7 @@ void Game::initTerrainRegions(){
     
     // === PLATEAU REGIONS (High elevation) ===
     // Height: 35+ units
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "plateau_north",
         glm::vec2(-halfSize, -halfSize),
         glm::vec2(halfSize, -halfSize/3.0f),
@@ -3219,7 +3560,7 @@ void Game::initTerrainRegions(){
         "Plateau - northern highlands"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "plateau_center",
         glm::vec2(-halfSize, -halfSize/3.0f),
         glm::vec2(halfSize, halfSize/3.0f),
@@ -3227,7 +3568,7 @@ void Game::initTerrainRegions(){
         "Plateau - central highlands"
     });
     
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "plateau_south",
         glm::vec2(-halfSize, halfSize/3.0f),
         glm::vec2(halfSize, halfSize),
@@ -3236,13 +3577,14 @@ void Game::initTerrainRegions(){
     });
     
     // === SPECIAL REGIONS ===
-    m_terrainRegions.push_back({
+    m_terrainRegions.add({
         "spawn_area",
         glm::vec2(-20.0f, -20.0f),
         glm::vec2(20.0f, 20.0f),
         0.0f, 200.0f,
         "Starting area near origin"
     });
+    m_terrainRegions.build();
     
     std::cout << "[Game] Initialized " << m_terrainRegions.size() << " terrain regions" << std::endl;
     std::cout << "\n=== CONTROLS ===" << std::endl;
@@ -3255,17 +3597,45 @@ void Game::initTerrainRegions(){
     std::cout << "================\n" << std::endl;
 }
 
-std::string Game::getRegionAtPosition(const glm::vec3& pos) const {
-    // Check special regions first (smaller, higher priority)
-    for(int i = m_terrainRegions.size() - 1; i >= 0; --i){
-        const auto& region = m_terrainRegions[i];
-        if(pos.x >= region.minXZ.x && pos.x <= region.maxXZ.x &&
-           pos.z >= region.minXZ.y && pos.z <= region.maxXZ.y &&
-           pos.y >= region.minY && pos.y <= region.maxY){
-            return region.name;
-        }
-    }
-    return "unknown";
+RegionId Game::getRegionAtPosition(const glm::vec3& pos) const {
+    // Special regions are added last, so they win where they overlap the broad strips
+    return m_terrainRegions.at(pos);
+}
+
+void Game::refreshTerrainCollider(){
+    std::shared_ptr<const TerrainSampler> terrain = m_terrain ? m_terrain->sampler() : nullptr;
+    if(terrain == m_terrainColliderSource) return;
+    // The body points at m_terrainCollider, so it goes before the heights are replaced
+    m_collisionSystem.removeBody(m_terrainColliderBody);
+    m_terrainColliderBody = CollisionHandle();
+    m_terrainColliderSource = terrain;
+    m_terrainCollider.clear();
+    if(!terrain || !terrain->valid()) return;
+    std::vector<float> heights = terrain->normalizedHeights();
+    for(float& h : heights) h *= terrain->heightScale();
+    m_terrainCollider.assign(std::move(heights), terrain->resolution(), terrain->worldSize());
+    CollisionBody body;
+    body.shape = CollisionShape::Heightfield;
+    body.heightfield = &m_terrainCollider;
+    body.isStatic = true;
+    m_terrainColliderBody = m_collisionSystem.addBody(body);
+}
+
+void Game::refreshShoreField(){
+    std::shared_ptr<const TerrainSampler> terrain = m_terrain->sampler();
+    if(m_shoreField && m_shoreField->terrain() == terrain && m_shoreField->waterLevel() == m_waterLevel) return;
+    m_shoreField = std::make_shared<const ShoreDistanceField>(terrain, m_waterLevel);
+    if(m_waveSampler) m_waveSampler = m_waveSampler->withShore(m_shoreField);
+    if(!m_shoreField->valid()) return;
+    const int res = m_shoreField->resolution();
+    if(!m_shoreFieldTex) glGenTextures(1, &m_shoreFieldTex);
+    glBindTexture(GL_TEXTURE_2D, m_shoreFieldTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, res, res, 0, GL_RG, GL_FLOAT, m_shoreField->texels().data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Game::renderRegionOverlay(){
@@ -3494,6 +3864,8 @@ bool Game::loadStaticModel(const std::string& path, StaticMesh& outMesh){
             if(part.albedoTex){ glDeleteTextures(1, &part.albedoTex); part.albedoTex = 0; }
         }
         mesh.parts.clear();
+        mesh.collisionPositions.clear();
+        mesh.collisionIndices.clear();
         mesh.totalVertexCount = 0;
         mesh.totalIndexCount = 0;
         mesh.minBounds = glm::vec3(0.0f);
@@ -3632,6 +4004,29 @@ bool Game::loadStaticModel(const std::string& path, StaticMesh& outMesh){
             }
         }
 
+        const uint32_t collisionBase = static_cast<uint32_t>(outMesh.collisionPositions.size());
+        for(unsigned int i = 0; i < mesh->mNumVertices; ++i){
+            outMesh.collisionPositions.emplace_back(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        }
+        for(unsigned int index : indices){
+            outMesh.collisionIndices.push_back(collisionBase + index);
+        }
+
+        // Simplified LODs only add index ranges; they are appended after LOD 0 in the same IBO.
+        const unsigned int fullIndexCount = static_cast<unsigned int>(indices.size());
+        part.lods.push_back({0u, fullIndexCount});
+        {
+            std::vector<glm::vec3> positions(mesh->mNumVertices);
+            for(unsigned int i = 0; i < mesh->mNumVertices; ++i){
+                positions[i] = glm::vec3(vertices[i * 8 + 0], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+            }
+            std::vector<LodLevel> chain = buildLodChain(positions, indices);
+            for(const LodLevel& level : chain){
+                part.lods.push_back({static_cast<unsigned int>(indices.size()), static_cast<unsigned int>(level.indices.size())});
+                indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+            }
+        }
+
         glGenVertexArrays(1, &part.vao);
         glGenBuffers(1, &part.vbo);
         glGenBuffers(1, &part.ibo);
@@ -3651,7 +4046,7 @@ bool Game::loadStaticModel(const std::string& path, StaticMesh& outMesh){
         glBindVertexArray(0);
 
         part.vertexCount = mesh->mNumVertices;
-        part.indexCount = static_cast<unsigned int>(indices.size());
+        part.indexCount = fullIndexCount;
         part.minBounds = partMinBounds;
         part.maxBounds = partMaxBounds;
 
@@ -3710,7 +4105,9 @@ bool Game::loadStaticModel(const std::string& path, StaticMesh& outMesh){
         if(outMesh.parts.empty()){
             outMesh.minBounds = part.minBounds;
             outMesh.maxBounds = part.maxBounds;
+            outMesh.lodCount = static_cast<int>(part.lods.size());
         } else {
+            outMesh.lodCount = std::min(outMesh.lodCount, static_cast<int>(part.lods.size()));
             outMesh.minBounds = glm::min(outMesh.minBounds, part.minBounds);
             outMesh.maxBounds = glm::max(outMesh.maxBounds, part.maxBounds);
         }
@@ -3720,7 +4117,119 @@ bool Game::loadStaticModel(const std::string& path, StaticMesh& outMesh){
 
     std::cout << "[Game] Loaded static model: " << path << " ("
               << outMesh.totalVertexCount << " vertices across "
-              << outMesh.parts.size() << " mesh parts)" << std::endl;
+              << outMesh.parts.size() << " mesh parts, "
+              << outMesh.lodCount << " LODs)" << std::endl;
 
     return true;
 }
+
+void Game::initStaticColliders(const std::string& lighthousePath, const std::string& campfirePath,
+                               const std::string& forestHutPath){
+    struct Collider {
+        const char* name;
+        const std::string* path;
+        StaticMesh* mesh;
+        bool ready;
+        glm::mat4 model;
+        TriangleMesh* collider;
+        uint32_t vertexSection, indexSection, nodeSection;
+    };
+    glm::mat4 lighthouseModel = glm::translate(glm::mat4(1.0f), m_lighthousePosition);
+    lighthouseModel = glm::scale(lighthouseModel, glm::vec3(m_lighthouseScale));
+    glm::mat4 campfireModel = glm::translate(glm::mat4(1.0f), m_campfirePosition);
+    campfireModel = glm::scale(campfireModel, glm::vec3(m_campfireScale));
+    glm::mat4 hutModel = glm::translate(glm::mat4(1.0f), m_forestHutPosition);
+    hutModel = glm::rotate(hutModel, glm::radians(m_forestHutYawDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+    hutModel = glm::rotate(hutModel, glm::radians(m_forestHutPitchDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+    hutModel = glm::scale(hutModel, glm::vec3(m_forestHutScale));
+    Collider colliders[] = {
+        {"Lighthouse", &lighthousePath, &m_lighthouseMesh, m_lighthouseReady, lighthouseModel, &m_lighthouseCollider,
+         kCacheLighthouseVertices, kCacheLighthouseIndices, kCacheLighthouseNodes},
+        {"Campfire", &campfirePath, &m_campfireMesh, m_campfireReady, campfireModel, &m_campfireCollider,
+         kCacheCampfireVertices, kCacheCampfireIndices, kCacheCampfireNodes},
+        {"Forest hut", &forestHutPath, &m_forestHutMesh, m_forestHutReady, hutModel, &m_forestHutCollider,
+         kCacheForestHutVertices, kCacheForestHutIndices, kCacheForestHutNodes},
+    };
+
+    // Hierarchies are keyed by each model file (path, size, modification time) and its placement.
+    // Bump the version whenever TriangleMesh::build changes.
+    const uint32_t kColliderVersion = 1;
+    WorldCache::KeyBuilder keyBuilder;
+    keyBuilder.add(kColliderVersion);
+    for(const Collider& c : colliders){
+        keyBuilder.add(c.ready);
+        if(!c.ready) continue;
+        std::error_code ec;
+        const auto fileSize = std::filesystem::file_size(*c.path, ec);
+        const auto writeTime = std::filesystem::last_write_time(*c.path, ec).time_since_epoch().count();
+        keyBuilder.add(*c.path).add(static_cast<uint64_t>(ec ? 0 : fileSize)).add(writeTime).add(c.model);
+    }
+    auto colliderCache = std::make_shared<WorldCache>(keyBuilder.key());
+    colliderCache->load(kColliderCachePath);
+    bool colliderCacheDirty = false;
+
+    for(Collider& c : colliders){
+        if(c.ready && !c.mesh->collisionIndices.empty()){
+            std::vector<glm::vec3> vertices;
+            std::vector<uint32_t> indices;
+            std::vector<TriangleMesh::Node> nodes;
+            const auto start = std::chrono::steady_clock::now();
+            bool cached = colliderCache->get(c.vertexSection, vertices)
+                && colliderCache->get(c.indexSection, indices)
+                && colliderCache->get(c.nodeSection, nodes)
+                && c.collider->assign(std::move(vertices), std::move(indices), std::move(nodes));
+            if(!cached){
+                c.collider->build(c.mesh->collisionPositions, c.mesh->collisionIndices, c.model);
+                colliderCache->put(c.vertexSection, c.collider->vertices());
+                colliderCache->put(c.indexSection, c.collider->indices());
+                colliderCache->put(c.nodeSection, c.collider->nodes());
+                colliderCacheDirty = true;
+            }
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            // Vertices are already in world space, so the body sits at the origin
+            CollisionBody body;
+            body.shape = CollisionShape::Mesh;
+            body.mesh = c.collider;
+            body.isStatic = true;
+            m_collisionSystem.addBody(body);
+            std::cout << "[Game] " << c.name << " collider: " << c.collider->triangleCount() << " triangles ("
+                      << (cached ? "cached, " : "built in ") << ms << " ms)" << std::endl;
+        }
+        c.mesh->collisionPositions = {};
+        c.mesh->collisionIndices = {};
+    }
+    // Models without colliders do not need their CPU-side triangles either
+    for(StaticMesh* mesh : {&m_treeMesh, &m_stickMesh}){
+        mesh->collisionPositions = {};
+        mesh->collisionIndices = {};
+    }
+
+    if(colliderCacheDirty){
+        m_colliderCacheSave = ThreadPool::shared().submit([colliderCache]{
+            if(colliderCache->save(kColliderCachePath)){
+                std::cout << "[WorldCache] Saved " << kColliderCachePath << std::endl;
+            }
+        });
+    }
+}
+
+int Game::selectStaticMeshLod(const StaticMesh& mesh, const glm::vec3& position, float scale, int currentLod) const {
+    if(!m_camera || mesh.lodCount <= 1) return 0;
+    glm::vec3 center = position + 0.5f * (mesh.minBounds + mesh.maxBounds) * scale;
+    float radius = 0.5f * glm::length(mesh.maxBounds - mesh.minBounds) * scale;
+    float projScaleY = m_camera->projectionMatrix()[1][1];
+    float screenSize = projectedScreenSize(center, radius, m_camera->position(), projScaleY);
+    return selectLod(screenSize, currentLod, mesh.lodCount, m_lodScreenThresholds, m_lodHysteresis);
+}
+
+void Game::drawStaticMeshPart(const StaticMesh::Part& part, int lod) const {
+    glBindVertexArray(part.vao);
+    if(part.lods.empty()){
+        glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+        return;
+    }
+    const auto& range = part.lods[std::clamp(lod, 0, static_cast<int>(part.lods.size()) - 1)];
+    glDrawElements(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+                   reinterpret_cast<void*>(static_cast<uintptr_t>(range.firstIndex) * sizeof(unsigned int)));
+}
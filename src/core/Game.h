@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <array>
+#include <future>
 #include <memory>
 #include <vector>
 #include <random>
@@ -17,6 +18,9 @@
 #include "systems/InteractionSystem.h"
 #include "systems/MonsterAI.h"
 #include "audio/AudioSystem.h"
+#include "scene/TerrainQuadtree.h"
+#include "scene/TerrainRegions.h"
+#include "scene/WaveSampler.h"
 class Game {
 public:
     // init(): Set up subsystems & load initial assets.
@@ -35,11 +39,23 @@ private:
     class Camera* m_camera = nullptr;
     class Camera* m_freeCamera = nullptr;
     class Terrain* m_terrain = nullptr;
+    // Stream full-resolution height pages around the camera instead of generating the whole
+    // map up front. Init-time placement (grass, trees, props) then sees only the coarse
+    // overview outside the initially streamed area, so the finite island keeps eager generation.
+    bool m_streamTerrain = false;
+    // Background write of the procedural world cache after a cold start (waited on in shutdown)
+    std::future<void> m_worldCacheSave;
     class Water* m_water = nullptr;
+    class Ocean* m_ocean = nullptr;  // FFT detail on the water, simulated off the main thread
     class Sky* m_sky = nullptr;
+    class Impostor* m_treeImpostor = nullptr;
     // Shadow mapping resources
     class Shader* m_depthShader = nullptr;
     class Shader* m_skinnedDepthShader = nullptr;
+    class Shader* m_terrainDepthShader = nullptr;
+    // Terrain patches picked each frame for the shadow and main passes
+    TerrainQuadtree::Selection m_terrainShadowSelection;
+    TerrainQuadtree::Selection m_terrainSelection;
     unsigned int m_shadowFBO = 0;
     unsigned int m_shadowTex = 0;
     int m_shadowMapSize = 4096;  // Higher quality shadows
@@ -143,6 +159,15 @@ private:
 
     float m_waterLevel = 10.0f;
     float m_grassWaterGap = 6.0f; // keep grass at least 6 units above water plane
+    // Signed distance to the shoreline (CPU queries) and its RG16F copy for the water shader
+    std::shared_ptr<const class ShoreDistanceField> m_shoreField;
+    unsigned int m_shoreFieldTex = 0;
+    // Rebakes both when the terrain snapshot or the water level changed
+    void refreshShoreField();
+    // Wave shape shared by the water shader and m_waveSampler, the CPU copy of the displaced
+    // surface for buoyancy / wading / splash queries (uTime is Time::elapsed())
+    WaveSettings m_waveSettings;
+    std::shared_ptr<const WaveSampler> m_waveSampler;
 
     class Shader* m_characterShader = nullptr;
     SkinnedMesh m_characterMesh;
@@ -163,6 +188,7 @@ private:
     // Day/Night cycle
     bool m_isNightMode = false;
     bool m_nightToggleHeld = false;
+    bool m_brushHeld = false;
     float m_characterScale = 1.0f;
     float m_characterHeight = 1.0f;
     float m_characterFeetOffset = 0.0f;
@@ -170,18 +196,24 @@ private:
     
     // Collision system
     CollisionSystem m_collisionSystem;
-    size_t m_characterCollisionBody = 0;
+    CollisionHandle m_characterCollisionBody;
+    // Triangle-mesh colliders of the placed static models, in world space
+    TriangleMesh m_lighthouseCollider;
+    TriangleMesh m_campfireCollider;
+    TriangleMesh m_forestHutCollider;
+    // Background write of the collider cache after any collider was rebuilt (waited on in shutdown)
+    std::future<void> m_colliderCacheSave;
+    // Terrain heightfield the character walks on, from the terrain snapshot it was built from (the
+    // coarse overview when the terrain streams)
+    Heightfield m_terrainCollider;
+    std::shared_ptr<const class TerrainSampler> m_terrainColliderSource;
+    CollisionHandle m_terrainColliderBody;
+    CharacterSettings m_characterMoveSettings;
+    // Rebuilds the terrain collider when the terrain hands out a new snapshot
+    void refreshTerrainCollider();
     
     // Terrain Region System
-    struct TerrainRegion {
-        std::string name;
-        glm::vec2 minXZ;  // Minimum X,Z bounds
-        glm::vec2 maxXZ;  // Maximum X,Z bounds
-        float minY;       // Minimum Y (height)
-        float maxY;       // Maximum Y (height)
-        std::string description;
-    };
-    std::vector<TerrainRegion> m_terrainRegions;
+    TerrainRegionIndex m_terrainRegions;
     bool m_showRegions = false;
     bool m_regionToggleHeld = false;
     
@@ -196,12 +228,24 @@ private:
             unsigned int albedoTex = 0;
             glm::vec3 minBounds{0.0f};
             glm::vec3 maxBounds{0.0f};
+            // Index ranges inside ibo, one per LOD (lods[0] is the full mesh).
+            // All levels share the same vertex buffer.
+            struct LodRange {
+                unsigned int firstIndex = 0;
+                unsigned int indexCount = 0;
+            };
+            std::vector<LodRange> lods;
         };
         std::vector<Part> parts;
+        // LOD 0 triangles of all parts in model space, kept on the CPU until a collider has been
+        // built from them (see initStaticColliders)
+        std::vector<glm::vec3> collisionPositions;
+        std::vector<uint32_t> collisionIndices;
         glm::vec3 minBounds{0.0f};
         glm::vec3 maxBounds{0.0f};
         unsigned int totalVertexCount = 0;
         unsigned int totalIndexCount = 0;
+        int lodCount = 1;           // smallest LOD count over all parts
     };
 
     struct WorldItem {
@@ -214,33 +258,47 @@ private:
         glm::mat4 worldMatrix{1.0f};
     };
     
+    // Static mesh LOD selection: thresholds are projected bounding-sphere size (fraction of
+    // viewport height) below which LOD i+1 is used. The shadow pass adds m_shadowLodBias.
+    std::vector<float> m_lodScreenThresholds{0.25f, 0.12f, 0.05f};
+    float m_lodHysteresis = 0.15f;
+    int m_shadowLodBias = 1;
+
     // Lighthouse model
     StaticMesh m_lighthouseMesh;
     glm::vec3 m_lighthousePosition{0.0f};
     float m_lighthouseScale = 1.0f;
+    int m_lighthouseLod = 0;
     bool m_lighthouseReady = false;
     glm::vec3 m_lighthouseBeaconLocal{0.0f};
     
     struct TreeInstance {
         glm::vec3 position{0.0f};
         float scale = 1.0f;
+        int lod = 0;
+        bool impostor = false;
     };
 
     // Tree model
     StaticMesh m_treeMesh;
     std::vector<TreeInstance> m_treeInstances;
     bool m_treeReady = false;
+    // Trees beyond this distance draw as one instanced octahedral impostor batch.
+    float m_treeImpostorDistance = 140.0f;
+    std::vector<glm::vec4> m_treeImpostorInstances;
 
     // Campfire model
     StaticMesh m_campfireMesh;
     glm::vec3 m_campfirePosition{0.0f};
     float m_campfireScale = 1.0f;
+    int m_campfireLod = 0;
     bool m_campfireReady = false;
 
     // Forest hut model
     StaticMesh m_forestHutMesh;
     glm::vec3 m_forestHutPosition{0.0f};
     float m_forestHutScale = 1.0f;
+    int m_forestHutLod = 0;
     float m_forestHutYawDegrees = 0.0f;
     float m_forestHutPitchDegrees = 0.0f;
     bool m_forestHutReady = false;
@@ -303,8 +361,14 @@ private:
     void initTerrainRegions();
     void renderRegionOverlay();
     void renderUI();
-    std::string getRegionAtPosition(const glm::vec3& pos) const;
+    RegionId getRegionAtPosition(const glm::vec3& pos) const;
     bool loadStaticModel(const std::string& path, StaticMesh& outMesh);
+    // Registers the placed lighthouse, campfire and hut as mesh colliders, reusing hierarchies
+    // from the collider cache while the model files and placements match
+    void initStaticColliders(const std::string& lighthousePath, const std::string& campfirePath,
+                             const std::string& forestHutPath);
+    int selectStaticMeshLod(const StaticMesh& mesh, const glm::vec3& position, float scale, int currentLod) const;
+    void drawStaticMeshPart(const StaticMesh::Part& part, int lod) const;
     void updateStickInteraction();
     void refreshStickWorldMatrix();
     void attachStickToHand();
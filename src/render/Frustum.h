@@ -0,0 +1,39 @@
+// render/Frustum.h
+// View-frustum planes extracted from a view-projection matrix (Gribb/Hartmann),
+// with a conservative AABB test for culling.
+#pragma once
+#include <glm/glm.hpp>
+
+struct Frustum {
+    // Plane (n, d): points with dot(n, p) + d >= 0 are inside. Order: L, R, B, T, N, F.
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& viewProj) {
+        Frustum f;
+        for(int i = 0; i < 3; ++i){
+            for(int side = 0; side < 2; ++side){
+                glm::vec4 p;
+                for(int c = 0; c < 4; ++c){
+                    float row3 = viewProj[c][3];
+                    float rowI = viewProj[c][i];
+                    p[c] = side == 0 ? row3 + rowI : row3 - rowI;
+                }
+                float len = glm::length(glm::vec3(p));
+                f.planes[i * 2 + side] = len > 0.0f ? p / len : p;
+            }
+        }
+        return f;
+    }
+
+    // False only when the box is entirely outside one plane, so boxes straddling a
+    // frustum corner may pass; that is fine for culling.
+    bool intersectsAABB(const glm::vec3& bmin, const glm::vec3& bmax) const {
+        for(const glm::vec4& p : planes){
+            glm::vec3 positive(p.x >= 0.0f ? bmax.x : bmin.x,
+                               p.y >= 0.0f ? bmax.y : bmin.y,
+                               p.z >= 0.0f ? bmax.z : bmin.z);
+            if(glm::dot(glm::vec3(p), positive) + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,73 @@
+// render/GridMeshCache.cpp
+#include "GridMeshCache.h"
+#include <iostream>
+
+GridMeshCache& GridMeshCache::shared() {
+    static GridMeshCache cache;
+    return cache;
+}
+
+std::vector<uint32_t> GridMeshCache::buildStripIndices(int quads, uint32_t restartIndex, GLsizei* quadrantCount) {
+    std::vector<uint32_t> indices;
+    if(quads <= 0) return indices;
+    const int side = quads + 1;
+    // One strip per row of quads: bottom/top vertex pairs left to right. Starting on the
+    // lower row keeps the winding of the old (TL, TR, BL) / (TR, BR, BL) triangle lists.
+    auto emitRows = [&](int x0, int x1, int z0, int z1){
+        for(int z = z0; z < z1; ++z){
+            for(int x = x0; x <= x1; ++x){
+                indices.push_back(static_cast<uint32_t>((z + 1) * side + x));
+                indices.push_back(static_cast<uint32_t>(z * side + x));
+            }
+            indices.push_back(restartIndex);
+        }
+    };
+    const bool quadrants = quads % 2 == 0;
+    if(quadrants){
+        const int half = quads / 2;
+        indices.reserve(static_cast<size_t>(quads) * (2 * (half + 1) + 1) * 2);
+        for(int q = 0; q < 4; ++q){
+            const int qx = (q & 1) * half;
+            const int qz = (q >> 1) * half;
+            emitRows(qx, qx + half, qz, qz + half);
+        }
+    } else {
+        indices.reserve(static_cast<size_t>(quads) * (2 * side + 1));
+        emitRows(0, quads, 0, quads);
+    }
+    if(quadrantCount) *quadrantCount = quadrants ? static_cast<GLsizei>(indices.size() / 4) : 0;
+    return indices;
+}
+
+const GridIndexBuffer& GridMeshCache::strips(int quads) {
+    auto it = m_strips.find(quads);
+    if(it != m_strips.end()) return it->second;
+
+    GridIndexBuffer grid;
+    grid.quads = quads;
+    const bool shortIndices = fits16Bit(quads);
+    grid.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    std::vector<uint32_t> indices = buildStripIndices(quads, shortIndices ? 0xFFFFu : 0xFFFFFFFFu, &grid.quadrantCount);
+    grid.count = static_cast<GLsizei>(indices.size());
+
+    // Direct state access: callers may have a VAO bound, whose element binding must not change.
+    glCreateBuffers(1, &grid.buffer);
+    if(shortIndices){
+        std::vector<GLushort> packed(indices.begin(), indices.end());
+        glNamedBufferData(grid.buffer, packed.size() * sizeof(GLushort), packed.data(), GL_STATIC_DRAW);
+    } else {
+        glNamedBufferData(grid.buffer, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    }
+
+    std::cout << "[GridMeshCache] " << quads << "x" << quads << " strip grid: " << grid.count << " "
+              << (shortIndices ? "16" : "32") << "-bit indices (triangle list would need "
+              << static_cast<size_t>(quads) * quads * 6 << ")" << std::endl;
+    return m_strips.emplace(quads, grid).first->second;
+}
+
+void GridMeshCache::shutdown() {
+    for(auto& entry : m_strips){
+        if(entry.second.buffer) glDeleteBuffers(1, &entry.second.buffer);
+    }
+    m_strips.clear();
+}
@@ -0,0 +1,46 @@
+// render/GridMeshCache.h
+// Index buffers for regular (quads + 1) x (quads + 1) vertex grids, built once per resolution
+// and shared by every grid mesh (terrain LOD patches, water chunks). Vertices are assumed
+// row-major (index = z * (quads + 1) + x). Each row of quads is one triangle strip ending in
+// a primitive-restart index, and for even grids the rows are ordered quadrant by quadrant so
+// any single quadrant is a contiguous quarter of the buffer. Grids whose vertex count fits
+// below the 16-bit restart index use GL_UNSIGNED_SHORT.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <glad/glad.h>
+
+struct GridIndexBuffer {
+    GLuint buffer = 0;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    int quads = 0;
+    GLsizei count = 0;          // whole grid
+    GLsizei quadrantCount = 0;  // per quadrant; 0 for odd grids, which are not quadrant ordered
+
+    size_t indexSize() const { return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+    // Byte offset of quadrant q (0..3: +x is bit 0, +z is bit 1) for glDrawElements*
+    const void* quadrantOffset(int q) const {
+        return reinterpret_cast<const void*>(static_cast<size_t>(q) * quadrantCount * indexSize());
+    }
+};
+
+class GridMeshCache {
+public:
+    // Process-wide cache (GL objects: main thread only), created on first use.
+    static GridMeshCache& shared();
+
+    // Restart-strip indices for a quads x quads grid, drawn with GL_TRIANGLE_STRIP and
+    // GL_PRIMITIVE_RESTART_FIXED_INDEX enabled. The buffer stays owned by the cache.
+    const GridIndexBuffer& strips(int quads);
+
+    // CPU side of strips(): the same index sequence, restart entries as restartIndex.
+    static std::vector<uint32_t> buildStripIndices(int quads, uint32_t restartIndex, GLsizei* quadrantCount = nullptr);
+    static bool fits16Bit(int quads) { return (quads + 1) * (quads + 1) <= 0xFFFF; }
+
+    void shutdown();
+
+private:
+    std::map<int, GridIndexBuffer> m_strips;
+};
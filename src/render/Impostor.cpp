@@ -0,0 +1,396 @@
+// render/Impostor.cpp
+#include "Impostor.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Shared GLSL helpers. Hemi-octahedral mapping covers the upper hemisphere only:
+// distant props are never seen from below, so all frames go to useful directions.
+// The frame basis must match between baking (glm::lookAt) and drawing.
+static const char* kImpostorGlslCommon = R"GLSL(
+vec3 hemiOctDecode(vec2 e){
+    vec3 v = vec3((e.x + e.y) * 0.5, 0.0, (e.x - e.y) * 0.5);
+    v.y = 1.0 - abs(v.x) - abs(v.z);
+    return normalize(v);
+}
+vec2 hemiOctEncode(vec3 d){
+    d /= (abs(d.x) + abs(d.y) + abs(d.z));
+    return vec2(d.x + d.z, d.x - d.z);
+}
+void frameBasis(vec3 dir, out vec3 right, out vec3 up){
+    vec3 ref = abs(dir.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(ref, dir));
+    up = cross(dir, right);
+}
+)GLSL";
+
+static const char* kImpostorBakeVert = R"GLSL(
+#version 450 core
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec3 aNormal;
+layout(location=2) in vec2 aUV;
+uniform mat4 uViewProj;
+uniform vec3 uEye;
+uniform vec3 uViewDir;
+out vec3 vNormal;
+out vec2 vUV;
+out float vViewDepth;
+void main(){
+    vNormal = aNormal;
+    vUV = aUV;
+    // Planar view depth, as the orthographic bake projects it (not the distance to the eye)
+    vViewDepth = dot(aPos - uEye, uViewDir);
+    gl_Position = uViewProj * vec4(aPos, 1.0);
+}
+)GLSL";
+
+static const char* kImpostorBakeFrag = R"GLSL(
+#version 450 core
+in vec3 vNormal;
+in vec2 vUV;
+in float vViewDepth;
+layout(location=0) out vec4 outAlbedo;
+layout(location=1) out vec4 outNormal;
+layout(location=2) out float outDepth;
+uniform sampler2D uAlbedo;
+uniform float uEyeDistance;
+uniform float uRadius;
+void main(){
+    vec4 albedo = texture(uAlbedo, vUV);
+    if(albedo.a < 0.5) discard;
+    outAlbedo = vec4(albedo.rgb, 1.0);
+    outNormal = vec4(normalize(vNormal) * 0.5 + 0.5, 1.0);
+    // Offset towards the viewer from the bounding-sphere centre plane, in radii.
+    outDepth = (uEyeDistance - vViewDepth) / uRadius;
+}
+)GLSL";
+
+static const std::string kImpostorDrawVert = std::string(R"GLSL(
+#version 450 core
+layout(location=0) in vec2 aCorner;
+layout(location=1) in vec4 aInstance;
+uniform mat4 uViewProj;
+uniform vec3 uCameraPos;
+uniform vec3 uCenter;
+uniform float uRadius;
+uniform float uFramesPerSide;
+out vec3 vWorldPos;
+out vec3 vViewDir;
+out float vScale;
+out vec2 vFrameLocal[4];
+flat out vec2 vFrameBase[4];
+out vec4 vWeights;
+)GLSL") + kImpostorGlslCommon + R"GLSL(
+void main(){
+    float scale = aInstance.w;
+    vec3 center = aInstance.xyz + uCenter * scale;
+    vec3 viewDir = normalize(uCameraPos - center);
+    viewDir.y = max(viewDir.y, 0.0);
+    viewDir = normalize(viewDir + vec3(0.0, 1e-4, 0.0));
+
+    vec3 right, up;
+    frameBasis(viewDir, right, up);
+    vec3 local = (aCorner.x * right + aCorner.y * up) * uRadius;
+    vWorldPos = center + local * scale;
+    vViewDir = viewDir;
+    vScale = scale;
+
+    // Bilinear blend between the four frames surrounding the view direction.
+    vec2 grid = (hemiOctEncode(viewDir) * 0.5 + 0.5) * uFramesPerSide - 0.5;
+    vec2 base = clamp(floor(grid), vec2(0.0), vec2(uFramesPerSide - 1.0));
+    vec2 f = clamp(grid - base, 0.0, 1.0);
+    vWeights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+    const vec2 offsets[4] = vec2[4](vec2(0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0));
+    for(int i = 0; i < 4; ++i){
+        vec2 frame = min(base + offsets[i], vec2(uFramesPerSide - 1.0));
+        vec3 frameDir = hemiOctDecode((frame + 0.5) / uFramesPerSide * 2.0 - 1.0);
+        vec3 fr, fu;
+        frameBasis(frameDir, fr, fu);
+        vFrameLocal[i] = vec2(dot(local, fr), dot(local, fu)) / (2.0 * uRadius) + 0.5;
+        vFrameBase[i] = frame;
+    }
+    gl_Position = uViewProj * vec4(vWorldPos, 1.0);
+}
+)GLSL";
+
+static const char* kImpostorDrawFrag = R"GLSL(
+#version 450 core
+in vec3 vWorldPos;
+in vec3 vViewDir;
+in float vScale;
+in vec2 vFrameLocal[4];
+flat in vec2 vFrameBase[4];
+in vec4 vWeights;
+out vec4 FragColor;
+uniform sampler2D uAlbedoAtlas;
+uniform sampler2D uNormalAtlas;
+uniform sampler2D uDepthAtlas;
+uniform mat4 uViewProj;
+uniform vec3 uCameraPos;
+uniform float uRadius;
+uniform float uFramesPerSide;
+uniform vec3 uLightDir;
+uniform vec3 uLightColor;
+uniform vec3 uAmbientColor;
+uniform bool uFogEnabled;
+uniform vec3 uFogColor;
+uniform float uFogStart;
+uniform float uFogEnd;
+uniform float uFogDensity;
+uniform int uFogMode;
+
+void main(){
+    vec4 albedo = vec4(0.0);
+    vec3 normal = vec3(0.0);
+    float depth = 0.0;
+    for(int i = 0; i < 4; ++i){
+        // Samples that project outside their own frame are dropped so neighbours don't bleed in.
+        vec2 local = vFrameLocal[i];
+        float inside = float(all(greaterThanEqual(local, vec2(0.0))) && all(lessThanEqual(local, vec2(1.0))));
+        vec2 uv = (vFrameBase[i] + clamp(local, 0.0, 1.0)) / uFramesPerSide;
+        vec4 a = texture(uAlbedoAtlas, uv);
+        float w = vWeights[i] * a.a * inside;
+        albedo += vec4(a.rgb * w, w);
+        normal += (texture(uNormalAtlas, uv).xyz * 2.0 - 1.0) * w;
+        depth += texture(uDepthAtlas, uv).r * w;
+    }
+    if(albedo.a < 0.5) discard;
+    vec3 base = albedo.rgb / albedo.a;
+    normal = normalize(normal);
+    depth /= albedo.a;
+
+    // Push the fragment back onto the baked surface so impostors intersect terrain correctly.
+    vec3 surfacePos = vWorldPos + vViewDir * depth * uRadius * vScale;
+    vec4 clip = uViewProj * vec4(surfacePos, 1.0);
+    gl_FragDepth = clamp(clip.z / clip.w * 0.5 + 0.5, 0.0, 1.0);
+
+    float diff = max(dot(normal, normalize(-uLightDir)), 0.0);
+    vec3 color = base * uAmbientColor + base * diff * uLightColor;
+
+    float fogAmount = 0.0;
+    if(uFogEnabled){
+        float dist = length(uCameraPos - surfacePos);
+        if(uFogMode == 0){
+            fogAmount = clamp((dist - uFogStart) / max(uFogEnd - uFogStart, 0.0001), 0.0, 1.0);
+        } else if(uFogMode == 1){
+            fogAmount = clamp(1.0 - exp(-dist * uFogDensity), 0.0, 1.0);
+        } else {
+            float d = dist * uFogDensity;
+            fogAmount = clamp(1.0 - exp(-(d * d)), 0.0, 1.0);
+        }
+    }
+    FragColor = vec4(mix(color, uFogColor, fogAmount), 1.0);
+}
+)GLSL";
+
+static glm::vec3 hemiOctDecode(glm::vec2 e){
+    glm::vec3 v((e.x + e.y) * 0.5f, 0.0f, (e.x - e.y) * 0.5f);
+    v.y = 1.0f - std::abs(v.x) - std::abs(v.z);
+    return glm::normalize(v);
+}
+
+static unsigned int createAtlasTexture(GLenum internalFormat, int size, int mipLevels){
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, mipLevels, internalFormat, size, size);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+Impostor::~Impostor(){
+    shutdown();
+}
+
+bool Impostor::init(){
+    if(!m_bakeShader.compile(kImpostorBakeVert, kImpostorBakeFrag)){
+        std::cerr << "[Impostor] Failed to compile bake shader" << std::endl;
+        return false;
+    }
+    if(!m_drawShader.compile(kImpostorDrawVert, kImpostorDrawFrag)){
+        std::cerr << "[Impostor] Failed to compile draw shader" << std::endl;
+        return false;
+    }
+
+    const float corners[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    glGenVertexArrays(1, &m_quadVAO);
+    glGenBuffers(1, &m_quadVBO);
+    glGenBuffers(1, &m_instanceVBO);
+    glBindVertexArray(m_quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+bool Impostor::bake(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                    const std::function<void()>& drawMesh,
+                    int framesPerSide, int frameSize){
+    if(framesPerSide <= 0 || frameSize <= 0 || !drawMesh) return false;
+    if(m_albedoTex){ glDeleteTextures(1, &m_albedoTex); m_albedoTex = 0; }
+    if(m_normalTex){ glDeleteTextures(1, &m_normalTex); m_normalTex = 0; }
+    if(m_depthTex){ glDeleteTextures(1, &m_depthTex); m_depthTex = 0; }
+
+    m_framesPerSide = framesPerSide;
+    m_center = 0.5f * (boundsMin + boundsMax);
+    m_radius = std::max(0.5f * glm::length(boundsMax - boundsMin), 1e-3f);
+
+    const int atlasSize = framesPerSide * frameSize;
+    // Stop mipmapping before a frame shrinks below a few texels and bleeds into its neighbours.
+    const int mipLevels = std::max(1, static_cast<int>(std::log2(static_cast<float>(frameSize))) - 3);
+    m_albedoTex = createAtlasTexture(GL_RGBA8, atlasSize, mipLevels);
+    m_normalTex = createAtlasTexture(GL_RGBA8, atlasSize, mipLevels);
+    m_depthTex = createAtlasTexture(GL_R16F, atlasSize, 1);
+
+    GLint prevFBO = 0;
+    GLint prevViewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFBO);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+
+    GLuint fbo = 0, depthRbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_depthTex, 0);
+    glGenRenderbuffers(1, &depthRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRbo);
+    const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, drawBuffers);
+
+    bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if(ok){
+        glViewport(0, 0, atlasSize, atlasSize);
+        const float clearAlbedo[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const float clearNormal[4] = {0.5f, 1.0f, 0.5f, 0.0f};
+        const float clearDepth[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const float clearZ = 1.0f;
+        glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+        glClearBufferfv(GL_COLOR, 1, clearNormal);
+        glClearBufferfv(GL_COLOR, 2, clearDepth);
+        glClearBufferfv(GL_DEPTH, 0, &clearZ);
+
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE); // leaf cards are single-sided quads
+        glDisable(GL_BLEND);
+
+        m_bakeShader.bind();
+        m_bakeShader.setInt("uAlbedo", 0);
+        m_bakeShader.setFloat("uRadius", m_radius);
+        m_bakeShader.setFloat("uEyeDistance", 2.0f * m_radius);
+        glActiveTexture(GL_TEXTURE0);
+        const glm::mat4 proj = glm::ortho(-m_radius, m_radius, -m_radius, m_radius, m_radius, 3.0f * m_radius);
+        for(int fy = 0; fy < framesPerSide; ++fy){
+            for(int fx = 0; fx < framesPerSide; ++fx){
+                glm::vec2 e = (glm::vec2(fx, fy) + 0.5f) / static_cast<float>(framesPerSide) * 2.0f - 1.0f;
+                glm::vec3 dir = hemiOctDecode(e);
+                glm::vec3 ref = std::abs(dir.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                glm::vec3 eye = m_center + dir * (2.0f * m_radius);
+                glm::mat4 view = glm::lookAt(eye, m_center, ref);
+                glViewport(fx * frameSize, fy * frameSize, frameSize, frameSize);
+                m_bakeShader.setMat4("uViewProj", proj * view);
+                m_bakeShader.setVec3("uEye", eye);
+                m_bakeShader.setVec3("uViewDir", -dir);
+                drawMesh();
+            }
+        }
+        glBindVertexArray(0);
+
+        if(mipLevels > 1){
+            glBindTexture(GL_TEXTURE_2D, m_albedoTex);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, m_normalTex);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        std::cout << "[Impostor] Baked " << framesPerSide * framesPerSide << " views into "
+                  << atlasSize << "x" << atlasSize << " atlas (radius " << m_radius << ")" << std::endl;
+    } else {
+        std::cerr << "[Impostor] Bake framebuffer incomplete" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFBO);
+    glDeleteRenderbuffers(1, &depthRbo);
+    glDeleteFramebuffers(1, &fbo);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    if(cullEnabled) glEnable(GL_CULL_FACE);
+    if(blendEnabled) glEnable(GL_BLEND);
+
+    if(!ok){
+        glDeleteTextures(1, &m_albedoTex); m_albedoTex = 0;
+        glDeleteTextures(1, &m_normalTex); m_normalTex = 0;
+        glDeleteTextures(1, &m_depthTex); m_depthTex = 0;
+    }
+    return ok;
+}
+
+void Impostor::setInstances(const std::vector<glm::vec4>& instances){
+    m_instanceCount = static_cast<int>(instances.size());
+    if(instances.empty() || !m_instanceVBO) return;
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if(instances.size() > m_instanceCapacity){
+        m_instanceCapacity = std::max(instances.size(), m_instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(glm::vec4), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Impostor::render(const Camera& cam, const glm::vec3& lightDir, const glm::vec3& lightColor, const glm::vec3& ambientColor){
+    if(!baked() || m_instanceCount == 0) return;
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_CULL_FACE);
+
+    m_drawShader.bind();
+    m_drawShader.setMat4("uViewProj", cam.projectionMatrix() * cam.viewMatrix());
+    m_drawShader.setVec3("uCameraPos", cam.position());
+    m_drawShader.setVec3("uCenter", m_center);
+    m_drawShader.setFloat("uRadius", m_radius);
+    m_drawShader.setFloat("uFramesPerSide", static_cast<float>(m_framesPerSide));
+    m_drawShader.setVec3("uLightDir", lightDir);
+    m_drawShader.setVec3("uLightColor", lightColor);
+    m_drawShader.setVec3("uAmbientColor", ambientColor);
+    m_drawShader.setInt("uAlbedoAtlas", 0);
+    m_drawShader.setInt("uNormalAtlas", 1);
+    m_drawShader.setInt("uDepthAtlas", 2);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_albedoTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_normalTex);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, m_depthTex);
+
+    glBindVertexArray(m_quadVAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_instanceCount);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    if(cullEnabled) glEnable(GL_CULL_FACE);
+}
+
+void Impostor::shutdown(){
+    if(m_albedoTex){ glDeleteTextures(1, &m_albedoTex); m_albedoTex = 0; }
+    if(m_normalTex){ glDeleteTextures(1, &m_normalTex); m_normalTex = 0; }
+    if(m_depthTex){ glDeleteTextures(1, &m_depthTex); m_depthTex = 0; }
+    if(m_instanceVBO){ glDeleteBuffers(1, &m_instanceVBO); m_instanceVBO = 0; }
+    if(m_quadVBO){ glDeleteBuffers(1, &m_quadVBO); m_quadVBO = 0; }
+    if(m_quadVAO){ glDeleteVertexArrays(1, &m_quadVAO); m_quadVAO = 0; }
+    m_instanceCapacity = 0;
+    m_instanceCount = 0;
+}
@@ -0,0 +1,51 @@
+// render/Impostor.h
+// Octahedral impostors: bakes a static mesh from a hemi-octahedral grid of view
+// directions into albedo / normal / depth atlases, then draws any number of distant
+// instances as one instanced camera-facing quad batch that blends the nearest views.
+#pragma once
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "render/Shader.h"
+#include "render/Camera.h"
+
+class Impostor {
+public:
+    Impostor() = default;
+    ~Impostor();
+
+    bool init();
+
+    // Render the mesh once per octahedral frame into the atlases.
+    // drawMesh is invoked with the bake shader bound; it must bind each part's albedo to
+    // texture unit 0 and issue the draws (attribute layout 0=pos, 1=normal, 2=uv, object space).
+    bool bake(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+              const std::function<void()>& drawMesh,
+              int framesPerSide = 8, int frameSize = 256);
+
+    // xyz = object origin in world space, w = uniform scale.
+    void setInstances(const std::vector<glm::vec4>& instances);
+    int instanceCount() const { return m_instanceCount; }
+
+    // The draw shader is exposed so callers can upload shared uniforms (fog) beforehand.
+    Shader& shader() { return m_drawShader; }
+    void render(const Camera& cam, const glm::vec3& lightDir, const glm::vec3& lightColor, const glm::vec3& ambientColor);
+
+    bool baked() const { return m_albedoTex != 0; }
+    void shutdown();
+
+private:
+    Shader m_bakeShader;
+    Shader m_drawShader;
+    unsigned int m_albedoTex = 0;
+    unsigned int m_normalTex = 0;
+    unsigned int m_depthTex = 0;
+    unsigned int m_quadVAO = 0;
+    unsigned int m_quadVBO = 0;
+    unsigned int m_instanceVBO = 0;
+    size_t m_instanceCapacity = 0;
+    int m_instanceCount = 0;
+    int m_framesPerSide = 0;
+    glm::vec3 m_center{0.0f};
+    float m_radius = 1.0f;
+};
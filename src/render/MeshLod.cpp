@@ -0,0 +1,338 @@
+// render/MeshLod.cpp
+#include "MeshLod.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+// Symmetric 4x4 quadric stored as its upper triangle.
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+
+    static Quadric fromPlane(double a, double b, double c, double d, double w) {
+        Quadric q;
+        q.a2 = a * a * w; q.ab = a * b * w; q.ac = a * c * w; q.ad = a * d * w;
+        q.b2 = b * b * w; q.bc = b * c * w; q.bd = b * d * w;
+        q.c2 = c * c * w; q.cd = c * d * w;
+        q.d2 = d * d * w;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+        b2 += o.b2; bc += o.bc; bd += o.bd;
+        c2 += o.c2; cd += o.cd;
+        d2 += o.d2;
+        return *this;
+    }
+
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+                 + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+                 + c2 * z * z + 2.0 * cd * z
+                 + d2;
+        return e > 0.0 ? e : 0.0;
+    }
+};
+
+struct Collapse {
+    double cost;
+    unsigned from;
+    unsigned to;
+    unsigned fromVersion;
+    unsigned toVersion;
+    bool operator>(const Collapse& o) const { return cost > o.cost; }
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        auto h = [](float f) {
+            unsigned u;
+            static_assert(sizeof(u) == sizeof(f), "float size");
+            std::memcpy(&u, &f, sizeof(u));
+            return static_cast<size_t>(u);
+        };
+        return h(p.x) * 73856093u ^ h(p.y) * 19349663u ^ h(p.z) * 83492791u;
+    }
+};
+
+// Boundary edges get a perpendicular constraint plane weighted this much more than
+// regular faces so open borders (leaf cards, cut-off trunks) keep their outline.
+constexpr double kBoundaryWeight = 10.0;
+// Collapses that tilt an adjacent face normal past this cosine are rejected.
+constexpr float kFlipCosine = 0.2f;
+
+} // namespace
+
+std::vector<unsigned> simplifyMesh(const std::vector<glm::vec3>& positions,
+                                   const std::vector<unsigned>& indices,
+                                   size_t targetIndexCount,
+                                   float maxRelativeError,
+                                   float* outRelativeError) {
+    if (outRelativeError) *outRelativeError = 0.0f;
+    const size_t vertexCount = positions.size();
+    const size_t faceCount = indices.size() / 3;
+    if (faceCount == 0 || indices.size() <= targetIndexCount) return indices;
+
+    glm::vec3 bmin(1e30f), bmax(-1e30f);
+    for (unsigned idx : indices) {
+        bmin = glm::min(bmin, positions[idx]);
+        bmax = glm::max(bmax, positions[idx]);
+    }
+    const double diagonal = std::max(1e-6, static_cast<double>(glm::length(bmax - bmin)));
+    const double maxError = static_cast<double>(maxRelativeError) * diagonal;
+    const double maxCost = maxError * maxError;
+
+    // Vertices that share a position with another vertex sit on a UV/normal seam.
+    // Collapsing them would tear the seam open, so they are locked in place.
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<glm::vec3, unsigned, PositionHash> firstAt;
+        firstAt.reserve(vertexCount);
+        std::vector<bool> referenced(vertexCount, false);
+        for (unsigned idx : indices) referenced[idx] = true;
+        for (unsigned v = 0; v < vertexCount; ++v) {
+            if (!referenced[v]) continue;
+            auto [it, inserted] = firstAt.emplace(positions[v], v);
+            if (!inserted) {
+                locked[v] = true;
+                locked[it->second] = true;
+            }
+        }
+    }
+
+    std::vector<unsigned> faces(indices.begin(), indices.begin() + faceCount * 3);
+    std::vector<bool> faceAlive(faceCount, true);
+    std::vector<std::vector<unsigned>> vertexFaces(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    size_t aliveFaces = 0;
+
+    for (size_t f = 0; f < faceCount; ++f) {
+        unsigned i0 = faces[f * 3 + 0], i1 = faces[f * 3 + 1], i2 = faces[f * 3 + 2];
+        if (i0 == i1 || i1 == i2 || i0 == i2) { faceAlive[f] = false; continue; }
+        ++aliveFaces;
+        vertexFaces[i0].push_back(static_cast<unsigned>(f));
+        vertexFaces[i1].push_back(static_cast<unsigned>(f));
+        vertexFaces[i2].push_back(static_cast<unsigned>(f));
+
+        glm::dvec3 p0(positions[i0]), p1(positions[i1]), p2(positions[i2]);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double len = glm::length(n);
+        if (len < 1e-12) continue;
+        n /= len;
+        double area = len * 0.5;
+        Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, p0), area);
+        quadrics[i0] += q;
+        quadrics[i1] += q;
+        quadrics[i2] += q;
+    }
+
+    // Boundary edges: an undirected edge used by exactly one face.
+    {
+        std::unordered_map<unsigned long long, int> edgeUse;
+        edgeUse.reserve(aliveFaces * 3);
+        auto key = [](unsigned a, unsigned b) {
+            if (a > b) std::swap(a, b);
+            return (static_cast<unsigned long long>(a) << 32) | b;
+        };
+        for (size_t f = 0; f < faceCount; ++f) {
+            if (!faceAlive[f]) continue;
+            for (int e = 0; e < 3; ++e) {
+                edgeUse[key(faces[f * 3 + e], faces[f * 3 + (e + 1) % 3])]++;
+            }
+        }
+        for (size_t f = 0; f < faceCount; ++f) {
+            if (!faceAlive[f]) continue;
+            glm::dvec3 p0(positions[faces[f * 3 + 0]]), p1(positions[faces[f * 3 + 1]]), p2(positions[faces[f * 3 + 2]]);
+            glm::dvec3 fn = glm::cross(p1 - p0, p2 - p0);
+            if (glm::length(fn) < 1e-12) continue;
+            fn = glm::normalize(fn);
+            for (int e = 0; e < 3; ++e) {
+                unsigned a = faces[f * 3 + e], b = faces[f * 3 + (e + 1) % 3];
+                if (edgeUse[key(a, b)] != 1) continue;
+                glm::dvec3 pa(positions[a]), pb(positions[b]);
+                glm::dvec3 edge = pb - pa;
+                double edgeLen = glm::length(edge);
+                if (edgeLen < 1e-12) continue;
+                glm::dvec3 n = glm::normalize(glm::cross(edge, fn));
+                Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, pa), edgeLen * edgeLen * kBoundaryWeight);
+                quadrics[a] += q;
+                quadrics[b] += q;
+            }
+        }
+    }
+
+    std::vector<unsigned> version(vertexCount, 0);
+    std::vector<bool> removed(vertexCount, false);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+    auto pushEdge = [&](unsigned a, unsigned b) {
+        // Half-edge collapse a -> b keeps b's position; try both directions, keep the cheaper.
+        double best = 1e300;
+        unsigned from = a, to = b;
+        if (!locked[a]) {
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            best = q.evaluate(positions[b]);
+        }
+        if (!locked[b]) {
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            double c = q.evaluate(positions[a]);
+            if (c < best) { best = c; from = b; to = a; }
+        }
+        if (best < 1e300) heap.push({best, from, to, version[from], version[to]});
+    };
+
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (!faceAlive[f]) continue;
+        for (int e = 0; e < 3; ++e) {
+            unsigned a = faces[f * 3 + e], b = faces[f * 3 + (e + 1) % 3];
+            // Interior edges get pushed once per adjacent face; the duplicate goes stale
+            // after the first collapse touching either end.
+            pushEdge(a, b);
+        }
+    }
+
+    std::vector<unsigned> neighborsFrom, neighborsTo;
+    auto gatherNeighbors = [&](unsigned v, std::vector<unsigned>& out) {
+        out.clear();
+        for (unsigned f : vertexFaces[v]) {
+            if (!faceAlive[f]) continue;
+            for (int k = 0; k < 3; ++k) {
+                unsigned n = faces[f * 3 + k];
+                if (n != v) out.push_back(n);
+            }
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+
+    const size_t targetFaces = targetIndexCount / 3;
+    double acceptedCost = 0.0;
+
+    while (aliveFaces > targetFaces && !heap.empty()) {
+        Collapse c = heap.top();
+        heap.pop();
+        if (removed[c.from] || removed[c.to]) continue;
+        if (version[c.from] != c.fromVersion || version[c.to] != c.toVersion) continue;
+        if (c.cost > maxCost) break;
+
+        // Link condition: an interior edge may share at most two neighbours, otherwise
+        // the collapse pinches the surface into a non-manifold fin.
+        gatherNeighbors(c.from, neighborsFrom);
+        gatherNeighbors(c.to, neighborsTo);
+        size_t shared = 0;
+        for (size_t i = 0, j = 0; i < neighborsFrom.size() && j < neighborsTo.size();) {
+            if (neighborsFrom[i] < neighborsTo[j]) ++i;
+            else if (neighborsFrom[i] > neighborsTo[j]) ++j;
+            else { ++shared; ++i; ++j; }
+        }
+        if (shared > 2) continue;
+
+        // Reject collapses that flip or degenerate any surviving face.
+        bool flips = false;
+        for (unsigned f : vertexFaces[c.from]) {
+            if (!faceAlive[f]) continue;
+            unsigned* tri = &faces[f * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue;
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; ++k) {
+                p[k] = positions[tri[k]];
+                q[k] = tri[k] == c.from ? positions[c.to] : p[k];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            float lb = glm::length(before), la = glm::length(after);
+            if (la < 1e-12f || (lb > 1e-12f && glm::dot(before, after) < kFlipCosine * lb * la)) {
+                flips = true;
+                break;
+            }
+        }
+        if (flips) continue;
+
+        for (unsigned f : vertexFaces[c.from]) {
+            if (!faceAlive[f]) continue;
+            unsigned* tri = &faces[f * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                faceAlive[f] = false;
+                --aliveFaces;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                if (tri[k] == c.from) tri[k] = c.to;
+            }
+            vertexFaces[c.to].push_back(f);
+        }
+        vertexFaces[c.from].clear();
+        quadrics[c.to] += quadrics[c.from];
+        removed[c.from] = true;
+        acceptedCost = std::max(acceptedCost, c.cost);
+
+        auto& faceList = vertexFaces[c.to];
+        faceList.erase(std::remove_if(faceList.begin(), faceList.end(),
+                                      [&](unsigned f) { return !faceAlive[f]; }),
+                       faceList.end());
+
+        // Only the quadric of c.to changed, so only edges touching it need new costs.
+        ++version[c.to];
+        gatherNeighbors(c.to, neighborsTo);
+        for (unsigned n : neighborsTo) pushEdge(n, c.to);
+    }
+
+    std::vector<unsigned> result;
+    result.reserve(aliveFaces * 3);
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (!faceAlive[f]) continue;
+        result.insert(result.end(), faces.begin() + f * 3, faces.begin() + f * 3 + 3);
+    }
+    if (outRelativeError) *outRelativeError = static_cast<float>(std::sqrt(acceptedCost) / diagonal);
+    return result;
+}
+
+std::vector<LodLevel> buildLodChain(const std::vector<glm::vec3>& positions,
+                                    const std::vector<unsigned>& indices,
+                                    const LodChainSettings& settings) {
+    std::vector<LodLevel> chain;
+    const std::vector<unsigned>* previous = &indices;
+    float accumulatedError = 0.0f;
+    for (float ratio : settings.triangleRatios) {
+        size_t target = static_cast<size_t>(static_cast<float>(indices.size() / 3) * ratio) * 3;
+        if (target < 3) break;
+        float levelError = 0.0f;
+        LodLevel level;
+        level.indices = simplifyMesh(positions, *previous, target, settings.maxRelativeError, &levelError);
+        // Not worth an extra draw range if the simplifier got stuck on locked/high-error edges.
+        float reduction = 1.0f - static_cast<float>(level.indices.size()) / static_cast<float>(previous->size());
+        if (level.indices.empty() || reduction < settings.minReduction) break;
+        accumulatedError += levelError;
+        level.relativeError = accumulatedError;
+        chain.push_back(std::move(level));
+        previous = &chain.back().indices;
+    }
+    return chain;
+}
+
+float projectedScreenSize(const glm::vec3& center, float radius, const glm::vec3& eye, float projScaleY) {
+    float d = glm::length(center - eye);
+    if (d <= radius) return 1.0f;
+    return std::min(1.0f, radius * projScaleY / d);
+}
+
+int selectLod(float screenSize, int currentLod, int lodCount,
+              const std::vector<float>& thresholds, float hysteresis) {
+    if (lodCount <= 1) return 0;
+    int maxLod = std::min(lodCount - 1, static_cast<int>(thresholds.size()));
+    int lod = std::clamp(currentLod, 0, maxLod);
+    // Coarsen only once clearly below the threshold, refine only once clearly above it.
+    while (lod < maxLod && screenSize < thresholds[lod] * (1.0f - hysteresis)) ++lod;
+    while (lod > 0 && screenSize > thresholds[lod - 1] * (1.0f + hysteresis)) --lod;
+    return lod;
+}
@@ -0,0 +1,45 @@
+// render/MeshLod.h
+// Quadric-error-metric (Garland-Heckbert) simplification and screen-size LOD selection.
+// Simplification only rewrites the index list (half-edge collapses onto existing
+// vertices), so every LOD of a mesh can share the original vertex buffer and only
+// needs its own index range.
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+struct LodChainSettings {
+    // Target triangle ratios relative to LOD 0 for each generated level (LOD 0 is implicit).
+    std::vector<float> triangleRatios{0.5f, 0.25f, 0.1f};
+    // Maximum error per level, relative to the mesh bounding-box diagonal.
+    float maxRelativeError = 0.05f;
+    // A level is dropped when it removes less than this fraction of the previous level.
+    float minReduction = 0.1f;
+};
+
+struct LodLevel {
+    std::vector<unsigned> indices;
+    float relativeError = 0.0f; // accumulated collapse error / bounding-box diagonal
+};
+
+// Simplify an indexed triangle list down to roughly targetIndexCount indices.
+// Stops early once the next collapse would exceed maxRelativeError. Returns the new
+// index list; outRelativeError (optional) receives the largest error that was accepted.
+std::vector<unsigned> simplifyMesh(const std::vector<glm::vec3>& positions,
+                                   const std::vector<unsigned>& indices,
+                                   size_t targetIndexCount,
+                                   float maxRelativeError,
+                                   float* outRelativeError = nullptr);
+
+// Build LOD 1..N from the full-detail index list (LOD 0 is not included in the result).
+std::vector<LodLevel> buildLodChain(const std::vector<glm::vec3>& positions,
+                                    const std::vector<unsigned>& indices,
+                                    const LodChainSettings& settings = LodChainSettings());
+
+// Projected size of a bounding sphere as a fraction of the viewport height.
+// projScaleY is proj[1][1] (= 1 / tan(fovY / 2)) of the active projection matrix.
+float projectedScreenSize(const glm::vec3& center, float radius, const glm::vec3& eye, float projScaleY);
+
+// Pick a LOD from screen size with hysteresis around each threshold so instances near a
+// boundary don't flicker. thresholds[i] is the screen size below which LOD i+1 is used.
+int selectLod(float screenSize, int currentLod, int lodCount,
+              const std::vector<float>& thresholds, float hysteresis);
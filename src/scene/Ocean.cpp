@@ -0,0 +1,160 @@
+// scene/Ocean.cpp
+#include "Ocean.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "render/Shader.h"
+#include "util/ThreadPool.h"
+
+namespace {
+constexpr size_t kSlotAlignment = 256;
+
+size_t alignUp(size_t value) {
+    return (value + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+
+GLuint createTileTexture(GLenum format, int size) {
+    int levels = 1;
+    while((size >> levels) > 0) ++levels;
+    GLuint tex = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+    glTextureStorage2D(tex, levels, format, size, size);
+    glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return tex;
+}
+}
+
+Ocean::~Ocean() {
+    shutdown();
+}
+
+bool Ocean::init(const OceanSettings& settings) {
+    shutdown();
+    m_spectrum = std::make_shared<OceanSpectrum>(settings);
+    m_settings = m_spectrum->settings();
+    const int size = m_spectrum->size();
+    if(size != settings.resolution){
+        std::cout << "[Ocean] Resolution " << settings.resolution << " is not a power of two in [64, 512]; using "
+                  << size << std::endl;
+    }
+
+    const size_t texels = static_cast<size_t>(size) * size;
+    m_slopeOffset = alignUp(texels * sizeof(uint64_t));
+    m_slotBytes = alignUp(m_slopeOffset + texels * sizeof(uint32_t));
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_uploadBuffer);
+    glNamedBufferStorage(m_uploadBuffer, static_cast<GLsizeiptr>(m_slotBytes * kSlots), nullptr, flags);
+    m_mapped = static_cast<unsigned char*>(glMapNamedBufferRange(m_uploadBuffer, 0, static_cast<GLsizeiptr>(m_slotBytes * kSlots), flags));
+    if(!m_mapped){
+        std::cerr << "[Ocean] Cannot map the upload buffer persistently; ocean detail disabled" << std::endl;
+        shutdown();
+        return false;
+    }
+    m_displacementTex = createTileTexture(GL_RGBA16F, size);
+    m_slopeTex = createTileTexture(GL_RG16F, size);
+
+    std::cout << "[Ocean] " << size << "x" << size << " FFT tile over " << m_settings.patchSize << " units, "
+              << (m_settings.updateRate > 0.0f ? m_settings.updateRate : 0.0f) << " updates/s, "
+              << kSlots << " x " << m_slotBytes / 1024 << " KB upload slots" << std::endl;
+    return true;
+}
+
+void Ocean::update(float time) {
+    if(!m_mapped) return;
+
+    if(m_job && m_job->done.wait_for(std::chrono::seconds(0)) == std::future_status::ready){
+        m_job->done.get();
+        upload(m_job->slot);
+        // Only this class can hand out new references, so a unique frame is safe to overwrite
+        if(m_frame.use_count() == 1) m_spare = std::move(m_frame);
+        m_frame = std::move(m_job->frame);
+        m_job.reset();
+    }
+    if(m_job) return;
+
+    const float interval = m_settings.updateRate > 0.0f ? 1.0f / m_settings.updateRate : 0.0f;
+    if(m_launched && time - m_lastLaunch < interval) return;
+    const int slot = m_nextSlot;
+    if(m_fences[slot]){
+        // The GPU may still be copying out of this slot; try again next frame rather than block
+        if(glClientWaitSync(m_fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED){
+            ++m_fenceStalls;
+            return;
+        }
+        glDeleteSync(m_fences[slot]);
+        m_fences[slot] = nullptr;
+    }
+
+    auto job = std::make_unique<Job>();
+    job->slot = slot;
+    job->frame = m_spare ? std::move(m_spare) : std::make_shared<OceanFrame>();
+    OceanFrame* frame = job->frame.get();
+    unsigned char* displacementDst = m_mapped + m_slotBytes * slot;
+    unsigned char* slopeDst = displacementDst + m_slopeOffset;
+    auto spectrum = m_spectrum;
+    job->done = ThreadPool::shared().submit([spectrum, frame, time, displacementDst, slopeDst]{
+        spectrum->evaluate(time, *frame);
+        // Packed in cached memory first: the mapping is write-combined, so it only gets one
+        // sequential pass per texture
+        std::memcpy(displacementDst, frame->displacement.data(), frame->displacement.size() * sizeof(uint64_t));
+        std::memcpy(slopeDst, frame->slopes.data(), frame->slopes.size() * sizeof(uint32_t));
+    });
+    m_job = std::move(job);
+    m_nextSlot = (slot + 1) % kSlots;
+    m_launched = true;
+    m_lastLaunch = time;
+}
+
+void Ocean::upload(int slot) {
+    const int size = m_spectrum->size();
+    const size_t base = m_slotBytes * slot;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadBuffer);
+    glTextureSubImage2D(m_displacementTex, 0, 0, 0, size, size, GL_RGBA, GL_HALF_FLOAT,
+                        reinterpret_cast<const void*>(base));
+    glTextureSubImage2D(m_slopeTex, 0, 0, 0, size, size, GL_RG, GL_HALF_FLOAT,
+                        reinterpret_cast<const void*>(base + m_slopeOffset));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glGenerateTextureMipmap(m_displacementTex);
+    glGenerateTextureMipmap(m_slopeTex);
+    m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++m_uploads;
+}
+
+void Ocean::bind(Shader& shader, int displacementUnit, int slopeUnit) const {
+    glActiveTexture(GL_TEXTURE0 + displacementUnit);
+    glBindTexture(GL_TEXTURE_2D, m_displacementTex);
+    shader.setInt("uOceanDisplacement", displacementUnit);
+    glActiveTexture(GL_TEXTURE0 + slopeUnit);
+    glBindTexture(GL_TEXTURE_2D, m_slopeTex);
+    shader.setInt("uOceanSlope", slopeUnit);
+    shader.setBool("uOceanEnabled", ready());
+    shader.setFloat("uOceanPatchSize", m_settings.patchSize);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Ocean::shutdown() {
+    // The job writes into the mapping, so it has to finish before the buffer goes away
+    if(m_job && m_job->done.valid()) m_job->done.wait();
+    m_job.reset();
+    for(GLsync& fence : m_fences){
+        if(fence){ glDeleteSync(fence); fence = nullptr; }
+    }
+    if(m_uploadBuffer){
+        if(m_mapped) glUnmapNamedBuffer(m_uploadBuffer);
+        glDeleteBuffers(1, &m_uploadBuffer);
+    }
+    if(m_displacementTex) glDeleteTextures(1, &m_displacementTex);
+    if(m_slopeTex) glDeleteTextures(1, &m_slopeTex);
+    m_uploadBuffer = m_displacementTex = m_slopeTex = 0;
+    m_mapped = nullptr;
+    m_spectrum.reset();
+    m_frame.reset();
+    m_spare.reset();
+    m_nextSlot = 0;
+    m_launched = false;
+    m_uploads = 0;
+    m_fenceStalls = 0;
+}
@@ -0,0 +1,75 @@
+// scene/Ocean.h
+// Animated ocean detail for the water surface. An OceanSpectrum is evaluated on the shared thread
+// pool at a fixed rate; each finished tile is copied into one slot of a persistently mapped pixel
+// unpack buffer and uploaded from there into the displacement (RGBA16F) and slope (RG16F)
+// textures. Every slot carries a fence, so a slot is rewritten only after the GPU has read it.
+// The main thread only polls: while an evaluation is running the last uploaded tile stays bound.
+#pragma once
+#include <future>
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "OceanSpectrum.h"
+
+class Shader;
+
+class Ocean {
+public:
+    Ocean() = default;
+    ~Ocean();
+    Ocean(const Ocean&) = delete;
+    Ocean& operator=(const Ocean&) = delete;
+
+    // Main thread, GL context current. The resolution is clamped to a power of two in [64, 512].
+    bool init(const OceanSettings& settings = OceanSettings());
+
+    // Main thread, once per frame with the shader's uTime: uploads a finished tile and starts the
+    // next evaluation once 1 / updateRate seconds have passed. Never waits on the FFT.
+    void update(float time);
+
+    // Binds both textures and uploads the uOcean* uniforms. uOceanEnabled stays false until the
+    // first tile has been uploaded.
+    void bind(Shader& shader, int displacementUnit, int slopeUnit) const;
+
+    bool ready() const { return m_uploads > 0; }
+    const OceanSettings& settings() const { return m_settings; }
+    unsigned long long uploads() const { return m_uploads; }
+    // Updates postponed because the next buffer slot was still being read by the GPU
+    unsigned long long fenceStalls() const { return m_fenceStalls; }
+
+    // CPU copy of the uploaded tile (null until the first upload). A frame never changes once
+    // handed out: frames still referenced elsewhere (e.g. by a WaveSampler) are not recycled.
+    std::shared_ptr<const OceanFrame> frame() const { return m_frame; }
+
+    void shutdown();
+
+private:
+    static constexpr int kSlots = 3;
+
+    struct Job {
+        int slot = 0;
+        std::shared_ptr<OceanFrame> frame;
+        std::future<void> done;
+    };
+
+    void upload(int slot);
+
+    OceanSettings m_settings;
+    std::shared_ptr<OceanSpectrum> m_spectrum;
+    std::unique_ptr<Job> m_job;           // at most one evaluation in flight
+    std::shared_ptr<OceanFrame> m_frame;  // CPU copy of the uploaded tile
+    std::shared_ptr<OceanFrame> m_spare;  // recycled for the next job
+
+    GLuint m_displacementTex = 0;
+    GLuint m_slopeTex = 0;
+    GLuint m_uploadBuffer = 0;
+    unsigned char* m_mapped = nullptr;
+    size_t m_slotBytes = 0;
+    size_t m_slopeOffset = 0;  // within a slot, after the displacement texels
+    GLsync m_fences[kSlots] = {};
+    int m_nextSlot = 0;
+    bool m_launched = false;
+    float m_lastLaunch = 0.0f;
+    unsigned long long m_uploads = 0;
+    unsigned long long m_fenceStalls = 0;
+};
@@ -0,0 +1,318 @@
+#include "OceanSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <glm/gtc/packing.hpp>
+
+#include "../util/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCEAN_SPECTRUM_SSE2 1
+#endif
+
+namespace {
+constexpr float kGravity = 9.81f;
+constexpr float kPi = 3.14159265358979f;
+constexpr int kMinResolution = 64;
+constexpr int kMaxResolution = 512;
+// Four real outputs pairs, each pair sharing one complex inverse FFT (see buildSpectrum)
+constexpr int kFields = 4;
+// Columns transformed together: one cache line of each plane row, four SSE lanes at a time
+constexpr int kColumnBlock = 16;
+constexpr int kTransposeBlock = 32;
+
+// Directional wave number spectrum: variance per unit area of (kx, kz)
+float spectrumDensity(const OceanSettings& s, float k, float cosTheta) {
+    const float wind = std::max(s.windSpeed, 0.1f);
+    const float smallWave = s.minWavelength / (2.0f * kPi);
+    const float damping = std::exp(-k * k * smallWave * smallWave);
+    if (s.spectrum == OceanSpectrumModel::Phillips) {
+        // 1D Phillips saturation range alpha / 2 k^-3, longest waves cut off at L = U^2 / g;
+        // cos^2 spreading over the full circle, so waves run both with and against the wind
+        const float L = wind * wind / kGravity;
+        const float spread = cosTheta * cosTheta / kPi;
+        return 0.0081f * 0.5f / (k * k * k * k) * std::exp(-1.0f / (k * L * k * L)) * spread * damping;
+    }
+    // JONSWAP in frequency, mapped to wave number with omega = sqrt(g k), d omega / dk = g / (2 omega)
+    const float fetch = std::max(s.fetch, 1.0f);
+    const float alpha = 0.076f * std::pow(wind * wind / (fetch * kGravity), 0.22f);
+    const float peak = 22.0f * std::pow(kGravity * kGravity / (wind * fetch), 1.0f / 3.0f);
+    const float omega = std::sqrt(kGravity * k);
+    const float sigma = omega <= peak ? 0.07f : 0.09f;
+    const float r = std::exp(-(omega - peak) * (omega - peak) / (2.0f * sigma * sigma * peak * peak));
+    const float ratio = peak / omega;
+    const float S = alpha * kGravity * kGravity / std::pow(omega, 5.0f) * std::exp(-1.25f * ratio * ratio * ratio * ratio)
+                  * std::pow(std::max(s.peakEnhancement, 1.0f), r);
+    // cos^2 spreading over the downwind half plane
+    const float spread = cosTheta > 0.0f ? 2.0f / kPi * cosTheta * cosTheta : 0.0f;
+    return S * kGravity / (2.0f * omega) / k * spread * damping;
+}
+
+// b = a - w b, a = a + w b for `count` adjacent columns of a row pair
+inline void butterfly(float* aRe, float* aIm, float* bRe, float* bIm, int count, float wRe, float wIm) {
+    int c = 0;
+#ifdef OCEAN_SPECTRUM_SSE2
+    const __m128 wr = _mm_set1_ps(wRe), wi = _mm_set1_ps(wIm);
+    for (; c + 4 <= count; c += 4) {
+        const __m128 ar = _mm_loadu_ps(aRe + c), ai = _mm_loadu_ps(aIm + c);
+        const __m128 br = _mm_loadu_ps(bRe + c), bi = _mm_loadu_ps(bIm + c);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        _mm_storeu_ps(bRe + c, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + c, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(aRe + c, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + c, _mm_add_ps(ai, ti));
+    }
+#endif
+    for (; c < count; ++c) {
+        const float tr = bRe[c] * wRe - bIm[c] * wIm;
+        const float ti = bRe[c] * wIm + bIm[c] * wRe;
+        bRe[c] = aRe[c] - tr;
+        bIm[c] = aIm[c] - ti;
+        aRe[c] += tr;
+        aIm[c] += ti;
+    }
+}
+
+// Box-Muller on raw mt19937 output, so a seed gives the same ocean with every standard library
+std::pair<float, float> gaussianPair(std::mt19937& rng) {
+    const float u1 = (static_cast<float>(rng() >> 8) + 1.0f) * (1.0f / 16777217.0f);
+    const float u2 = static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+    const float radius = std::sqrt(-2.0f * std::log(u1));
+    return {radius * std::cos(2.0f * kPi * u2), radius * std::sin(2.0f * kPi * u2)};
+}
+
+float unpackHalf(uint16_t bits) {
+    return glm::unpackHalf1x16(bits);
+}
+}
+
+int OceanSpectrum::clampResolution(int resolution) {
+    int size = kMinResolution;
+    while (size < kMaxResolution && size * 2 <= resolution) size *= 2;
+    // Round to the nearer neighbour, not down
+    if (size < kMaxResolution && resolution - size > size * 2 - resolution) size *= 2;
+    return size;
+}
+
+OceanSpectrum::OceanSpectrum(const OceanSettings& settings)
+    : m_settings(settings) {
+    m_size = clampResolution(settings.resolution);
+    m_settings.resolution = m_size;
+    m_settings.patchSize = std::max(settings.patchSize, 1.0f);
+    const int n = m_size;
+    m_count = static_cast<size_t>(n) * n;
+
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    m_bitReverse.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        m_bitReverse[i] = r;
+    }
+    m_twiddleRe.resize(n / 2);
+    m_twiddleIm.resize(n / 2);
+    for (int j = 0; j < n / 2; ++j) {
+        const double angle = 2.0 * 3.14159265358979323846 * j / n;
+        m_twiddleRe[j] = static_cast<float>(std::cos(angle));
+        m_twiddleIm[j] = static_cast<float>(std::sin(angle));
+    }
+
+    const float dk = 2.0f * kPi / m_settings.patchSize;
+    m_k.resize(n);
+    for (int i = 0; i < n; ++i) m_k[i] = dk * static_cast<float>(i < n / 2 ? i : i - n);
+
+    glm::vec2 wind = settings.windDirection;
+    wind = glm::dot(wind, wind) > 1e-12f ? glm::normalize(wind) : glm::vec2(1.0f, 0.0f);
+    m_h0Re.assign(m_count, 0.0f);
+    m_h0Im.assign(m_count, 0.0f);
+    m_omega.assign(m_count, 0.0f);
+    std::mt19937 rng(settings.seed);
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            // Random numbers are drawn for every index so the pattern does not shift with settings
+            const std::pair<float, float> xi = gaussianPair(rng);
+            const size_t i = static_cast<size_t>(z) * n + x;
+            const float kx = m_k[x], kz = m_k[z];
+            const float k = std::sqrt(kx * kx + kz * kz);
+            // The Nyquist row / column has no distinct negative frequency; leaving it empty keeps
+            // every field Hermitian, so the inverse transforms are exactly real
+            if (k <= 0.0f || x == n / 2 || z == n / 2) continue;
+            m_omega[i] = std::sqrt(kGravity * k);
+            const float cosTheta = (kx * wind.x + kz * wind.y) / k;
+            // <|h0|^2> = density * dk^2 / 2, so the height variance is the spectrum's integral
+            const float scale = settings.amplitude * 0.5f * std::sqrt(spectrumDensity(m_settings, k, cosTheta)) * dk;
+            m_h0Re[i] = xi.first * scale;
+            m_h0Im[i] = xi.second * scale;
+        }
+    }
+    m_scratch.resize(m_count * 2 * kFields);
+}
+
+void OceanSpectrum::buildSpectrum(float time) {
+    const int n = m_size;
+    const float lambda = m_settings.choppiness;
+    Field f0 = field(0), f1 = field(1), f2 = field(2), f3 = field(3);
+    // Real outputs a, b share one transform as a + i b. Per wave vector, with h = h~(k, t):
+    //   f0 = height + i x offset           (x offset: i lambda kx / k h)
+    //   f1 = z offset + i dh/dx            (dh/dx: i kx h)
+    //   f2 = dh/dz + i d(x offset)/dx
+    //   f3 = d(z offset)/dz + i d(x offset)/dz
+    // The offsets point towards crests (x' = x - lambda sum(k / |k| sin)), sharpening them.
+    ThreadPool::shared().parallelFor(0, n, 16, [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const int mz = (n - z) & (n - 1);
+            const float kz = m_k[z];
+            for (int x = 0; x < n; ++x) {
+                const size_t i = static_cast<size_t>(z) * n + x;
+                const size_t mirror = static_cast<size_t>(mz) * n + ((n - x) & (n - 1));
+                const float omega = m_omega[i];
+                if (omega <= 0.0f) {
+                    for (int f = 0; f < kFields; ++f) {
+                        Field fl = field(f);
+                        fl.re[i] = 0.0f;
+                        fl.im[i] = 0.0f;
+                    }
+                    continue;
+                }
+                // h~ = h0(k) e^(i w t) + conj(h0(-k)) e^(-i w t)
+                const float c = std::cos(omega * time), s = std::sin(omega * time);
+                const float ar = m_h0Re[i], ai = m_h0Im[i];
+                const float br = m_h0Re[mirror], bi = m_h0Im[mirror];
+                const float hr = (ar + br) * c - (ai + bi) * s;
+                const float hi = (ar - br) * s + (ai - bi) * c;
+
+                const float kx = m_k[x];
+                const float invK = kGravity / (omega * omega);  // 1 / |k|
+                // i * q * h = (-q hi, q hr)
+                const float dxRe = -lambda * kx * invK * hi, dxIm = lambda * kx * invK * hr;
+                const float dzRe = -lambda * kz * invK * hi, dzIm = lambda * kz * invK * hr;
+                const float sxRe = -kx * hi, sxIm = kx * hr;
+                const float szRe = -kz * hi, szIm = kz * hr;
+                // d(offset)/dx = i kx * offset = -lambda kx^2 / k h, and likewise
+                const float jxx = -lambda * kx * kx * invK, jzz = -lambda * kz * kz * invK, jxz = -lambda * kx * kz * invK;
+                const float jxxRe = jxx * hr, jxxIm = jxx * hi;
+                const float jzzRe = jzz * hr, jzzIm = jzz * hi;
+                const float jxzRe = jxz * hr, jxzIm = jxz * hi;
+                // a + i b = (a.re - b.im, a.im + b.re)
+                f0.re[i] = hr - dxIm;
+                f0.im[i] = hi + dxRe;
+                f1.re[i] = dzRe - sxIm;
+                f1.im[i] = dzIm + sxRe;
+                f2.re[i] = szRe - jxxIm;
+                f2.im[i] = szIm + jxxRe;
+                f3.re[i] = jzzRe - jxzIm;
+                f3.im[i] = jzzIm + jxzRe;
+            }
+        }
+    });
+}
+
+void OceanSpectrum::inverseFftColumns() {
+    // Radix-2 decimation in time down the rows of every field. Each task owns a block of adjacent
+    // columns, so a butterfly updates whole row segments and vectorizes without shuffles.
+    const int n = m_size;
+    const int blocks = n / kColumnBlock;
+    ThreadPool::shared().parallelFor(0, kFields * blocks, 1, [&](int begin, int end) {
+        for (int item = begin; item < end; ++item) {
+            Field fl = field(item / blocks);
+            const int col = (item % blocks) * kColumnBlock;
+            for (int r = 0; r < n; ++r) {
+                const int j = m_bitReverse[r];
+                if (j <= r) continue;
+                std::swap_ranges(fl.re + static_cast<size_t>(r) * n + col, fl.re + static_cast<size_t>(r) * n + col + kColumnBlock,
+                                 fl.re + static_cast<size_t>(j) * n + col);
+                std::swap_ranges(fl.im + static_cast<size_t>(r) * n + col, fl.im + static_cast<size_t>(r) * n + col + kColumnBlock,
+                                 fl.im + static_cast<size_t>(j) * n + col);
+            }
+            for (int half = 1; half < n; half *= 2) {
+                const int stride = n / (2 * half);
+                for (int start = 0; start < n; start += 2 * half) {
+                    for (int k = 0; k < half; ++k) {
+                        const size_t a = static_cast<size_t>(start + k) * n + col;
+                        const size_t b = a + static_cast<size_t>(half) * n;
+                        butterfly(fl.re + a, fl.im + a, fl.re + b, fl.im + b, kColumnBlock,
+                                  m_twiddleRe[k * stride], m_twiddleIm[k * stride]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void OceanSpectrum::transpose() {
+    const int n = m_size;
+    const int blocks = n / kTransposeBlock;
+    ThreadPool::shared().parallelFor(0, kFields * 2 * blocks, 1, [&](int begin, int end) {
+        for (int item = begin; item < end; ++item) {
+            float* plane = &m_scratch[static_cast<size_t>(item / blocks) * m_count];
+            const int by = (item % blocks) * kTransposeBlock;
+            // Tiles on and right of the diagonal in this block row; each pair is swapped once
+            for (int bx = by; bx < n; bx += kTransposeBlock) {
+                for (int y = by; y < by + kTransposeBlock; ++y) {
+                    for (int x = (bx == by ? y + 1 : bx); x < bx + kTransposeBlock; ++x) {
+                        std::swap(plane[static_cast<size_t>(y) * n + x], plane[static_cast<size_t>(x) * n + y]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void OceanSpectrum::pack(OceanFrame& out) const {
+    const int n = m_size;
+    const float* h = &m_scratch[0];
+    const float* dx = &m_scratch[m_count];
+    const float* dz = &m_scratch[2 * m_count];
+    const float* sx = &m_scratch[3 * m_count];
+    const float* sz = &m_scratch[4 * m_count];
+    const float* jxx = &m_scratch[5 * m_count];
+    const float* jzz = &m_scratch[6 * m_count];
+    const float* jxz = &m_scratch[7 * m_count];
+    ThreadPool::shared().parallelFor(0, n, 32, [&](int z0, int z1) {
+        for (size_t i = static_cast<size_t>(z0) * n; i < static_cast<size_t>(z1) * n; ++i) {
+            const float jacobian = (1.0f + jxx[i]) * (1.0f + jzz[i]) - jxz[i] * jxz[i];
+            out.displacement[i] = glm::packHalf4x16(glm::vec4(dx[i], h[i], dz[i], jacobian));
+            out.slopes[i] = glm::packHalf2x16(glm::vec2(sx[i], sz[i]));
+        }
+    });
+}
+
+void OceanSpectrum::evaluate(float time, OceanFrame& out) {
+    out.size = m_size;
+    out.time = time;
+    out.displacement.resize(m_count);
+    out.slopes.resize(m_count);
+    // Spectrum rows are kz and columns kx: transform down the columns (kz -> z), transpose,
+    // transform again (kx -> x) and transpose back to row-major z, x
+    buildSpectrum(time);
+    inverseFftColumns();
+    transpose();
+    inverseFftColumns();
+    transpose();
+    pack(out);
+}
+
+glm::vec3 OceanFrame::sample(float u, float v) const {
+    if (size <= 0 || displacement.empty()) return glm::vec3(0.0f);
+    const float tx = u * static_cast<float>(size) - 0.5f;
+    const float tz = v * static_cast<float>(size) - 0.5f;
+    const float x0 = std::floor(tx), z0 = std::floor(tz);
+    const float fx = tx - x0, fz = tz - z0;
+    // size is a power of two, so masking wraps negative coordinates too
+    const int mask = size - 1;
+    const int ix = static_cast<int>(x0) & mask, iz = static_cast<int>(z0) & mask;
+    const int ix1 = (ix + 1) & mask, iz1 = (iz + 1) & mask;
+    auto texel = [&](int x, int z) {
+        const uint64_t bits = displacement[static_cast<size_t>(z) * size + x];
+        return glm::vec3(unpackHalf(static_cast<uint16_t>(bits)), unpackHalf(static_cast<uint16_t>(bits >> 16)),
+                         unpackHalf(static_cast<uint16_t>(bits >> 32)));
+    };
+    const glm::vec3 top = glm::mix(texel(ix, iz), texel(ix1, iz), fx);
+    const glm::vec3 bottom = glm::mix(texel(ix, iz1), texel(ix1, iz1), fx);
+    return glm::mix(top, bottom, fz);
+}
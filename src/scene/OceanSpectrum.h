@@ -0,0 +1,79 @@
+#pragma once
+// Tessendorf-style ocean detail. A Phillips or JONSWAP wave spectrum is sampled once into
+// random complex amplitudes h0(k); evaluate() advances them to any time with the deep-water
+// dispersion relation and returns to the spatial domain with inverse 2D FFTs. The result is a
+// tile that repeats every patchSize world units: choppy displacement plus the surface Jacobian
+// (below 1 where the surface compresses, negative where it folds; used for foam) and height
+// slopes for normals, packed as half floats ready for RGBA16F / RG16F textures. Ocean
+// (scene/Ocean.h) runs the evaluations on the thread pool and streams them to the GPU.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+enum class OceanSpectrumModel { Phillips, Jonswap };
+
+struct OceanSettings {
+    int resolution = 128;                   // FFT size per side: a power of two in [64, 512]
+    float updateRate = 30.0f;               // spectrum evaluations per second (<= 0: every frame)
+    float patchSize = 64.0f;                // world units covered by one repeat of the tile
+    OceanSpectrumModel spectrum = OceanSpectrumModel::Jonswap;
+    float windSpeed = 8.0f;                 // m/s, 10 m above the surface
+    glm::vec2 windDirection{1.0f, 0.35f};   // XZ, normalized internally
+    float fetch = 40000.0f;                 // JONSWAP: distance the wind has blown over open water (m)
+    float peakEnhancement = 3.3f;           // JONSWAP gamma
+    float minWavelength = 0.3f;             // shorter waves are damped away (m)
+    float amplitude = 1.0f;                 // height scale on top of the physical spectrum
+    float choppiness = 1.1f;                // horizontal displacement factor (lambda)
+    uint32_t seed = 1337;
+};
+
+// One evaluated tile, row-major: texel (x, z) at index z * size + x
+struct OceanFrame {
+    int size = 0;
+    float time = 0.0f;
+    std::vector<uint64_t> displacement;  // half4: x offset, height, z offset, Jacobian
+    std::vector<uint32_t> slopes;        // half2: dh/dx, dh/dz
+
+    // (x offset, height, z offset) at tile coordinate (u, v), filtered like GL_LINEAR + GL_REPEAT
+    glm::vec3 sample(float u, float v) const;
+};
+
+class OceanSpectrum {
+public:
+    explicit OceanSpectrum(const OceanSettings& settings);
+
+    // Nearest power of two inside [64, 512]
+    static int clampResolution(int resolution);
+
+    // settings().resolution is the clamped FFT size actually used
+    const OceanSettings& settings() const { return m_settings; }
+    int size() const { return m_size; }
+
+    // Surface at `time` seconds. Spreads its passes over the shared thread pool (safe from a pool
+    // job). Uses scratch owned by the spectrum, so run one evaluation at a time per instance.
+    void evaluate(float time, OceanFrame& out);
+
+private:
+    // One complex field as split real / imaginary planes
+    struct Field {
+        float* re;
+        float* im;
+    };
+
+    void buildSpectrum(float time);
+    void inverseFftColumns();
+    void transpose();
+    void pack(OceanFrame& out) const;
+    Field field(int f) { return {&m_scratch[static_cast<size_t>(2 * f) * m_count], &m_scratch[static_cast<size_t>(2 * f + 1) * m_count]}; }
+
+    OceanSettings m_settings;
+    int m_size = 0;
+    size_t m_count = 0;
+    std::vector<float> m_h0Re, m_h0Im;  // initial amplitudes, FFT index order
+    std::vector<float> m_omega;         // dispersion per wave vector
+    std::vector<float> m_k;             // wave number per FFT index along one axis (rad / world unit)
+    std::vector<int> m_bitReverse;
+    std::vector<float> m_twiddleRe, m_twiddleIm;  // exp(+2 pi i j / size), j < size / 2
+    std::vector<float> m_scratch;       // kFields complex fields
+};
@@ -0,0 +1,123 @@
+#include "ShoreDistanceField.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "TerrainSampler.h"
+#include "../util/ThreadPool.h"
+
+namespace {
+constexpr int kLinesPerTask = 16;
+constexpr float kFar = 1e20f;  // squared distance for "no feature on this line yet"
+
+// 1D squared Euclidean distance transform of f (n samples) into d: d[q] = min_p (q-p)^2 + f[p].
+// v / z are scratch of n and n + 1 entries.
+void distanceTransform1D(const float* f, int n, float* d, int* v, float* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -std::numeric_limits<float>::infinity();
+    z[1] = std::numeric_limits<float>::infinity();
+    auto intersect = [&](int q, int p) {
+        return ((f[q] + float(q) * q) - (f[p] + float(p) * p)) / (2.0f * (q - p));
+    };
+    for (int q = 1; q < n; ++q) {
+        // z[0] is -inf, so this stops at k == 0 at the latest
+        float s = intersect(q, v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = intersect(q, v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = std::numeric_limits<float>::infinity();
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < float(q)) ++k;
+        const float dq = float(q - v[k]);
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+
+// Squared texel distance from every texel to the nearest one whose water flag equals feature
+std::vector<float> squaredDistanceTo(const std::vector<unsigned char>& water, int res, unsigned char feature) {
+    std::vector<float> grid(static_cast<size_t>(res) * res);
+    ThreadPool& pool = ThreadPool::shared();
+    pool.parallelFor(0, res, kLinesPerTask, [&](int begin, int end) {
+        std::vector<float> f(res), d(res), zs(res + 1);
+        std::vector<int> v(res);
+        for (int row = begin; row < end; ++row) {
+            const size_t base = static_cast<size_t>(row) * res;
+            for (int x = 0; x < res; ++x) f[x] = water[base + x] == feature ? 0.0f : kFar;
+            distanceTransform1D(f.data(), res, d.data(), v.data(), zs.data());
+            std::copy(d.begin(), d.end(), grid.begin() + base);
+        }
+    });
+    pool.parallelFor(0, res, kLinesPerTask, [&](int begin, int end) {
+        std::vector<float> f(res), d(res), zs(res + 1);
+        std::vector<int> v(res);
+        for (int col = begin; col < end; ++col) {
+            for (int z = 0; z < res; ++z) f[z] = grid[static_cast<size_t>(z) * res + col];
+            distanceTransform1D(f.data(), res, d.data(), v.data(), zs.data());
+            for (int z = 0; z < res; ++z) grid[static_cast<size_t>(z) * res + col] = d[z];
+        }
+    });
+    return grid;
+}
+}
+
+ShoreDistanceField::ShoreDistanceField(std::shared_ptr<const TerrainSampler> terrain, float waterLevel)
+    : m_terrain(std::move(terrain)), m_waterLevel(waterLevel) {
+    if (!m_terrain || !m_terrain->valid()) return;
+    auto startTime = std::chrono::steady_clock::now();
+    const int res = m_terrain->resolution();
+    const std::vector<float>& heights = m_terrain->normalizedHeights();
+    const float heightScale = m_terrain->heightScale();
+    m_resolution = res;
+    m_half = m_terrain->worldSize() * 0.5f;
+    m_invStep = m_terrain->texelsPerUnit();
+
+    const size_t count = static_cast<size_t>(res) * res;
+    std::vector<unsigned char> water(count);
+    for (size_t i = 0; i < count; ++i) water[i] = heights[i] * heightScale < waterLevel ? 1 : 0;
+    const std::vector<float> toLand = squaredDistanceTo(water, res, 0);
+    const std::vector<float> toWater = squaredDistanceTo(water, res, 1);
+
+    // The shoreline runs between a water and a land texel, half a texel from either one
+    const float step = 1.0f / m_invStep;
+    const float farthest = m_terrain->worldSize() * 1.5f;  // map without land or without water
+    m_texels.resize(count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        const float texels = water[i] ? std::sqrt(toLand[i]) : std::sqrt(toWater[i]);
+        const float dist = std::min((texels - 0.5f) * step, farthest);
+        m_texels[i * 2] = water[i] ? dist : -dist;
+        m_texels[i * 2 + 1] = waterLevel - heights[i] * heightScale;
+    }
+
+    auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "[ShoreDistanceField] " << res << "x" << res << " baked in " << elapsedMs << " ms" << std::endl;
+}
+
+float ShoreDistanceField::distance(float x, float z) const {
+    if (!valid()) return 0.0f;
+    const float maxTexel = static_cast<float>(m_resolution - 1);
+    const float tx = std::clamp((x + m_half) * m_invStep, 0.0f, maxTexel);
+    const float tz = std::clamp((z + m_half) * m_invStep, 0.0f, maxTexel);
+    const int ix = std::min(static_cast<int>(tx), m_resolution - 2);
+    const int iz = std::min(static_cast<int>(tz), m_resolution - 2);
+    const float fx = tx - ix, fz = tz - iz;
+    const float* row = &m_texels[(static_cast<size_t>(iz) * m_resolution + ix) * 2];
+    const float* next = row + static_cast<size_t>(m_resolution) * 2;
+    const float top = row[0] + (row[2] - row[0]) * fx;
+    const float bottom = next[0] + (next[2] - next[0]) * fx;
+    return top + (bottom - top) * fz;
+}
+
+float ShoreDistanceField::depth(float x, float z) const {
+    if (!valid()) return 0.0f;
+    return m_waterLevel - m_terrain->height(x, z);
+}
@@ -0,0 +1,39 @@
+#pragma once
+// Signed horizontal distance to the shoreline, baked from a TerrainSampler snapshot and a
+// water level with an exact Euclidean distance transform (two separable passes of the
+// Felzenszwalb-Huttenlocher lower-envelope algorithm, rows and then columns spread over the
+// ThreadPool). One texel per heightmap texel; like the snapshot it is immutable, so any
+// thread may query it. texels() is laid out for a GL_RG texture covering the terrain.
+#include <memory>
+#include <vector>
+
+class TerrainSampler;
+
+class ShoreDistanceField {
+public:
+    ShoreDistanceField(std::shared_ptr<const TerrainSampler> terrain, float waterLevel);
+
+    bool valid() const { return m_resolution >= 2; }
+    int resolution() const { return m_resolution; }
+    float waterLevel() const { return m_waterLevel; }
+    // The snapshot the field was built from; rebuild when the terrain hands out a new one
+    const std::shared_ptr<const TerrainSampler>& terrain() const { return m_terrain; }
+
+    // World units, bilinear, clamped to the map edge: positive over water, negative on land,
+    // zero along the shoreline.
+    float distance(float x, float z) const;
+    // Still-water depth (water level minus terrain height); negative on land
+    float depth(float x, float z) const;
+    bool inWater(float x, float z) const { return distance(x, z) > 0.0f; }
+
+    // Interleaved (distance, depth) per texel, row-major, world units
+    const std::vector<float>& texels() const { return m_texels; }
+
+private:
+    std::shared_ptr<const TerrainSampler> m_terrain;
+    std::vector<float> m_texels;
+    int m_resolution = 0;
+    float m_waterLevel = 0.0f;
+    float m_half = 0.0f;
+    float m_invStep = 0.0f;
+};
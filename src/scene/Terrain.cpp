@@ -2,142 +2,121 @@
 #include <cmath>
 #include <iostream>
 #include <algorithm>
-#include "../util/FastNoiseLiteWrapper.h"
+#include <chrono>
+#include <climits>
+#include "TerrainGenerator.h"
+#include "../util/Noise.h"
+#include "../util/ThreadPool.h"
 
 Terrain::Terrain() {}
 
 Terrain::~Terrain() {
-    delete m_mesh;
     if (m_heightMapTex) glDeleteTextures(1, &m_heightMapTex);
+    if (m_normalMapTex) glDeleteTextures(1, &m_normalMapTex);
+    if (m_splatTex) glDeleteTextures(1, &m_splatTex);
 }
 
 void Terrain::generate(int widthQuads, float worldSize) {
     m_worldSize = worldSize;
-    m_resolution = widthQuads + 1; // Vertex count matches texture pixels roughly
+    m_resolution = widthQuads + 1; // One heightmap texel per grid point
 
-    buildMesh(widthQuads, worldSize);
+    m_streaming = false;
+    m_pager.shutdown();
+    m_microNoiseX.clear();
+    if (m_normalMapTex) { glDeleteTextures(1, &m_normalMapTex); m_normalMapTex = 0; }
     generateHeightMap(m_resolution);
-    // After heightmap is generated, compute normals and update mesh normals
-    updateMeshNormalsFromHeightmap();
+    // After heightmap is generated, compute the normal texture
+    recomputeNormals();
+    m_quadtree.init(m_heightData, m_resolution, m_worldSize);
 }
 
-void Terrain::recomputeNormals() {
-    updateMeshNormalsFromHeightmap();
+bool Terrain::generateFromBake(int widthQuads, float worldSize, TerrainBake bake) {
+    const int resolution = widthQuads + 1;
+    const size_t count = static_cast<size_t>(resolution) * resolution;
+    if (bake.heights.size() != count || bake.microNoiseX.size() != count || bake.microNoiseZ.size() != count) return false;
+
+    m_worldSize = worldSize;
+    m_resolution = resolution;
+    m_streaming = false;
+    m_pager.shutdown();
+    if (m_normalMapTex) { glDeleteTextures(1, &m_normalMapTex); m_normalMapTex = 0; }
+    m_heightData = std::move(bake.heights);
+    m_heightResolution = resolution;
+    m_sampler.reset();
+    m_microNoiseX = std::move(bake.microNoiseX);
+    m_microNoiseZ = std::move(bake.microNoiseZ);
+    m_microNoiseFrequency = bake.microFrequency;
+    uploadHeightMap();
+    recomputeNormals();  // regenerates micro noise only if the baked frequency is stale
+    m_quadtree.init(m_heightData, m_resolution, m_worldSize);
+    return true;
 }
 
-void Terrain::buildMesh(int widthQuads, float worldSize) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
+TerrainBake Terrain::bake() {
+    TerrainBake out;
+    if (m_streaming || m_heightData.empty()) return out;
+    ensureMicroNoise();
+    out.heights = m_heightData;
+    out.microNoiseX = m_microNoiseX;
+    out.microNoiseZ = m_microNoiseZ;
+    out.microFrequency = m_microNoiseFrequency;
+    return out;
+}
 
-    float step = worldSize / (float)widthQuads;
-    float offset = worldSize / 2.0f;
+void Terrain::generateStreaming(int widthQuads, float worldSize, const TerrainPagerSettings& settings, int overviewStep) {
+    m_worldSize = worldSize;
+    m_resolution = widthQuads + 1;
+    m_streaming = true;
+    if (m_normalMapTex) { glDeleteTextures(1, &m_normalMapTex); m_normalMapTex = 0; }
+
+    overviewStep = std::max(1, overviewStep);
+    generateHeightMap(std::max(2, widthQuads / overviewStep + 1));
+    m_quadtree.init(m_heightData, m_heightResolution, m_worldSize, TerrainLodSettings(), m_resolution);
+    m_pager.init(m_resolution, m_worldSize, settings);
+    // Overview bounds are only approximate, so grow node bounds as real pages arrive.
+    const int resolution = m_resolution;
+    m_pager.setPageCallback([this, resolution](int x0, int z0, int side, const float* heights) {
+        m_quadtree.expandBounds(heights, side, x0, z0, side, side, resolution);
+    });
+}
 
-    // Generate vertices
-    for (int z = 0; z <= widthQuads; ++z) {
-        for (int x = 0; x <= widthQuads; ++x) {
-            Vertex v;
-            // Flat grid on XZ plane, centered
-            v.position = glm::vec3(x * step - offset, 0.0f, z * step - offset);
-            v.normal = glm::vec3(0.0f, 1.0f, 0.0f); // Displaced in shader
-            v.uv = glm::vec2((float)x / widthQuads, (float)z / widthQuads);
-            vertices.push_back(v);
-        }
-    }
+void Terrain::update(const glm::vec3& eye) {
+    if (m_streaming) m_pager.update(eye);
+}
 
-    // Generate indices
-    for (int z = 0; z < widthQuads; ++z) {
-        for (int x = 0; x < widthQuads; ++x) {
-            int topLeft = z * (widthQuads + 1) + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * (widthQuads + 1) + x;
-            int bottomRight = bottomLeft + 1;
-
-            // Triangle 1: TL -> TR -> BL
-            indices.push_back(topLeft);
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-
-            // Triangle 2: TR -> BR -> BL
-            indices.push_back(topRight);
-            indices.push_back(bottomRight);
-            indices.push_back(bottomLeft);
-        }
-    }
+void Terrain::recomputeNormals() {
+    updateNormals(0, 0, m_resolution - 1, m_resolution - 1);
+}
 
-    if (m_mesh) delete m_mesh;
-    m_mesh = new Mesh();
-    m_mesh->setData(vertices, indices);
+namespace {
+// Rows are generated in tiles on the shared thread pool.
+constexpr int kHeightRowsPerTask = 4;
+// Normal rows are cheap (no noise once cached), so they are handed out in bigger tiles.
+constexpr int kNormalRowsPerTask = 16;
 }
 
 void Terrain::generateHeightMap(int resolution) {
+    auto startTime = std::chrono::steady_clock::now();
     m_heightData.resize(resolution * resolution);
-    FastNoiseLiteWrapper noise;
-    noise.setSeed(42); // Fixed seed for reproducibility
-
-    float worldScale = m_worldSize; // Map texture coords to world space
-
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            float u = (float)x / (resolution - 1);
-            float v = (float)z / (resolution - 1);
-
-            // Map to world coordinates
-            float wx = u * worldScale - worldScale / 2.0f;
-            float wz = v * worldScale - worldScale / 2.0f;
-
-            // Multi-octave fractal noise for natural terrain variation
-            float h = 0.0f;
-            
-            // Base terrain noise - slightly stronger rolling hills
-            float amplitude = 0.020f;  // increased for stronger base
-            float frequency = 0.28f;    // slightly higher frequency for more variation
-            for (int octave = 0; octave < 2; ++octave) {  // Only 2 octaves
-                h += noise.getFractalNoise(wx * frequency, wz * frequency) * amplitude;
-                amplitude *= 0.5f;      // Faster falloff
-                frequency *= 1.5f;      // Slower frequency increase
-            }
-            
-            // Add large-scale rolling hills (main terrain shape)
-            float hills = noise.getFractalNoise(wx * 0.12f, wz * 0.12f) * 0.07f;  // slightly stronger
-            h += hills;
-
-            // Valley system - very shallow depression
-            float valleyCenter = 0.0f;
-            float valleyWidth = worldScale * 0.4f;  // Wider valley
-            float distToValley = std::abs(wz - valleyCenter);
-            float valleyDepth = std::exp(-distToValley * distToValley / (2.0f * valleyWidth * valleyWidth)) * 0.06f;  // Much shallower
-            // Add very subtle erosion variation
-            float erosion = noise.getFractalNoise(wx * 0.5f, wz * 0.2f) * 0.008f;
-            h -= (valleyDepth + erosion);
-
-            // Plateau with gentle edge
-            float plateauEdge = glm::smoothstep(-worldScale * 0.5f, worldScale * 0.1f, wx);
-            float plateauNoise = noise.getFractalNoise(wx * 0.6f, wz * 0.6f) * 0.012f;
-            float sideElevation = (plateauEdge + plateauNoise) * 0.20f;
-            h += sideElevation;
-
-            // Gentle hills instead of mountains
-            float hill1 = std::exp(-((wx + worldScale * 0.3f)*(wx + worldScale * 0.3f) + wz*wz) / 
-                (2.0f * (worldScale * 0.25f)*(worldScale * 0.25f))) * 0.10f;  // Gentle hill
-            float hill2 = std::exp(-((wx - worldScale * 0.25f)*(wx - worldScale * 0.25f) + (wz + worldScale * 0.2f)*(wz + worldScale * 0.2f)) / 
-                (2.0f * (worldScale * 0.30f)*(worldScale * 0.30f))) * 0.08f;  // Gentle hill
-            h += hill1 + hill2;
-            
-            // Very subtle surface detail (like small rocks/terrain texture)
-            float detail = noise.getFractalNoise(wx * 2.0f, wz * 2.0f) * 0.006f;  // slightly stronger
-            h += detail;
-
-            // Add patchy variation to create different biomes/textured areas
-            float patchMask = noise.getFractalNoise(wx * 0.07f, wz * 0.07f) * 0.5f + 0.5f;
-            h += patchMask * 0.02f; // small patch height variation
-
-            // Clamp to 0-1 range
-            h = std::max(0.0f, std::min(1.0f, h));
-
-            m_heightData[z * resolution + x] = h;
-        }
-    }
+    m_heightResolution = resolution;
+    m_sampler.reset();
+    const TerrainHeightGenerator generator(resolution, m_worldSize);
+    auto generateRows = [&](int zBegin, int zEnd) {
+        generator.fill(0, zBegin, resolution, zEnd - zBegin, &m_heightData[static_cast<size_t>(zBegin) * resolution], resolution);
+    };
+
+    ThreadPool& pool = ThreadPool::shared();
+    pool.parallelFor(0, resolution, kHeightRowsPerTask, generateRows);
+
+    auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "[Terrain] Heightmap " << resolution << "x" << resolution << " generated in "
+              << elapsedMs << " ms on " << pool.concurrency() << " threads ("
+              << FractalNoise::simdLevelName(FractalNoise::simdLevel()) << " noise)" << std::endl;
+    uploadHeightMap();
+}
 
+void Terrain::uploadHeightMap() {
+    const int resolution = m_heightResolution;
     if (m_heightMapTex) glDeleteTextures(1, &m_heightMapTex);
     glGenTextures(1, &m_heightMapTex);
     glBindTexture(GL_TEXTURE_2D, m_heightMapTex);
@@ -146,6 +125,65 @@ void Terrain::generateHeightMap(int resolution) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (m_splatEnabled) bakeSplatMap(0, 0, INT_MAX, INT_MAX);
+}
+
+void Terrain::setSplatSettings(const TerrainSplatSettings& settings) {
+    m_splatSettings = settings;
+    m_splatSettings.oversample = std::max(1, settings.oversample);
+    m_splatEnabled = true;
+    if (!m_heightData.empty()) bakeSplatMap(0, 0, INT_MAX, INT_MAX);
+}
+
+void Terrain::bakeSplatMap(int x0, int z0, int x1, int z1) {
+    const int side = m_heightResolution * m_splatSettings.oversample;
+    const bool full = x0 <= 0 && z0 <= 0 && x1 >= side - 1 && z1 >= side - 1;
+    if (!full && (side != m_splatResolution || !m_splatTex)) return;  // nothing baked yet to patch
+
+    auto startTime = std::chrono::steady_clock::now();
+    m_splatResolution = side;
+    m_splatData.resize(static_cast<size_t>(side) * side * 4);
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, side - 1);
+    z1 = std::min(z1, side - 1);
+    if (x1 < x0 || z1 < z0) return;
+    bakeTerrainSplat(m_heightData, m_heightResolution, side, m_splatSettings, x0, z0, x1, z1, m_splatData.data());
+
+    if (full) {
+        if (m_splatTex) glDeleteTextures(1, &m_splatTex);
+        glGenTextures(1, &m_splatTex);
+        glBindTexture(GL_TEXTURE_2D, m_splatTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_splatData.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        std::cout << "[Terrain] Splat map " << side << "x" << side << " baked in " << elapsedMs << " ms" << std::endl;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, m_splatTex);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, side);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, z0, x1 - x0 + 1, z1 - z0 + 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                        &m_splatData[(static_cast<size_t>(z0) * side + x0) * 4]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+}
+
+std::shared_ptr<const TerrainSampler> Terrain::sampler() const {
+    if (!m_sampler) {
+        m_sampler = std::make_shared<const TerrainSampler>(m_heightData, m_heightResolution, m_worldSize, recommendedHeightScale());
+    }
+    return m_sampler;
+}
+
+std::shared_ptr<const TerrainRaycaster> Terrain::raycaster() const {
+    std::shared_ptr<const TerrainSampler> current = sampler();
+    if (!m_raycaster || m_raycaster->sampler() != current) {
+        m_raycaster = std::make_shared<const TerrainRaycaster>(current);
+    }
+    return m_raycaster;
 }
 
 float Terrain::getHeight(float x, float z) const {
@@ -156,86 +194,165 @@ float Terrain::getHeight(float x, float z) const {
 
     if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f) return 0.0f;
 
-    int ix = (int)(u * (m_resolution - 1));
-    int iz = (int)(v * (m_resolution - 1));
+    float normalized = 0.0f;
+    if (m_streaming && m_pager.sampleHeight(x, z, normalized)) return normalized * recommendedHeightScale();
+
+    int ix = (int)(u * (m_heightResolution - 1));
+    int iz = (int)(v * (m_heightResolution - 1));
     
     // Clamp
-    ix = std::max(0, std::min(ix, m_resolution - 1));
-    iz = std::max(0, std::min(iz, m_resolution - 1));
+    ix = std::max(0, std::min(ix, m_heightResolution - 1));
+    iz = std::max(0, std::min(iz, m_heightResolution - 1));
 
-    float normalized = m_heightData[iz * m_resolution + ix];
+    normalized = m_heightData[iz * m_heightResolution + ix];
     return normalized * recommendedHeightScale();
 }
 
-// Compute normals from the heightmap and update the mesh vertex normals in-place.
-// This keeps the mesh positions as a flat grid (so shader displacement still works),
-// but uses accurate CPU-computed normals for lighting.
-void Terrain::updateMeshNormalsFromHeightmap() {
-    if (!m_mesh) return;
-    FastNoiseLiteWrapper noise;
-    noise.setSeed(42);
+// Micro-detail noise depends only on the grid and m_microFrequency, so it is evaluated once per
+// frequency and reused by every normal update (amplitude just scales it).
+void Terrain::ensureMicroNoise() {
+    const size_t count = static_cast<size_t>(m_resolution) * m_resolution;
+    if (m_microNoiseX.size() == count && m_microNoiseFrequency == m_microFrequency) return;
 
-    int widthQuads = m_resolution - 1;
-    std::vector<Vertex> vertices;
-    std::vector<unsigned> indices;
-    vertices.reserve(m_resolution * m_resolution);
-    indices.reserve(widthQuads * widthQuads * 6);
+    float step = m_worldSize / (float)(m_resolution - 1);
+    float offset = m_worldSize / 2.0f;
+    std::vector<float> microXs(m_resolution), microZs(m_resolution);
+    std::vector<float> microXOffs(m_resolution), microZOffs(m_resolution);
+    for (int i = 0; i < m_resolution; ++i) {
+        float p = i * step - offset;
+        microXs[i] = p * m_microFrequency;
+        microZs[i] = p * m_microFrequency;
+        microXOffs[i] = p * m_microFrequency + 12.3f;
+        microZOffs[i] = p * m_microFrequency + 9.8f;
+    }
+    m_microNoiseX.resize(count);
+    m_microNoiseZ.resize(count);
+    const FractalNoise noise(42);
+    ThreadPool::shared().parallelFor(0, m_resolution, kNormalRowsPerTask, [&](int zBegin, int zEnd) {
+        const NoiseGrid rows{m_resolution, zEnd - zBegin};
+        const size_t first = static_cast<size_t>(zBegin) * m_resolution;
+        noise.fill(rows, microXs.data(), microZs.data() + zBegin, m_microNoiseX.data() + first);
+        noise.fill(rows, microXOffs.data(), microZOffs.data() + zBegin, m_microNoiseZ.data() + first);
+    });
+    m_microNoiseFrequency = m_microFrequency;
+}
+
+// Compute normals from the heightmap into the normal texture (one texel per heightmap texel).
+// Terrain patches are flat grids displaced in the shader, so they read lighting normals from
+// here instead of carrying them per vertex. Only texels inside [x0,x1]x[z0,z1] are recomputed
+// and uploaded.
+void Terrain::updateNormals(int x0, int z0, int x1, int z1) {
+    if (m_heightData.empty() || m_streaming) return;
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, m_resolution - 1);
+    z1 = std::min(z1, m_resolution - 1);
+    if (x1 < x0 || z1 < z0) return;
+    ensureMicroNoise();
+
+    const int width = x1 - x0 + 1;
+    const int height = z1 - z0 + 1;
+    std::vector<glm::vec3> normals(static_cast<size_t>(width) * height);
 
+    int widthQuads = m_resolution - 1;
     float step = m_worldSize / (float)widthQuads;
-    float offset = m_worldSize / 2.0f;
 
     // Height scale used by shader - read recommended value from Terrain
     float heightScaleForNormals = recommendedHeightScale();
 
-    for (int z = 0; z <= widthQuads; ++z) {
-        for (int x = 0; x <= widthQuads; ++x) {
-            int idx = z * (widthQuads + 1) + x;
-            Vertex v;
-            // flat XZ positions (shader will displace them using the heightmap)
-            v.position = glm::vec3(x * step - offset, 0.0f, z * step - offset);
-            v.uv = glm::vec2((float)x / widthQuads, (float)z / widthQuads);
-
-            // Compute central-difference slope in height (world units)
-            float hC = m_heightData[idx] * heightScaleForNormals;
-            float hL = (x > 0) ? m_heightData[idx - 1] * heightScaleForNormals : hC;
-            float hR = (x < m_resolution - 1) ? m_heightData[idx + 1] * heightScaleForNormals : hC;
-            float hD = (z > 0) ? m_heightData[idx - (m_resolution)] * heightScaleForNormals : hC;
-            float hU = (z < m_resolution - 1) ? m_heightData[idx + (m_resolution)] * heightScaleForNormals : hC;
-
-            float dx = (hR - hL) / (2.0f * step);
-            float dz = (hU - hD) / (2.0f * step);
-
-            // Add micro-detail to normals using small-scale noise (configurable amplitude/frequency)
-            float microX = noise.getFractalNoise(v.position.x * m_microFrequency, v.position.z * m_microFrequency) * m_microAmplitude;
-            float microZ = noise.getFractalNoise(v.position.x * m_microFrequency + 12.3f, v.position.z * m_microFrequency + 9.8f) * m_microAmplitude;
-
-            glm::vec3 n = glm::normalize(glm::vec3(-dx + microX, 1.0f, -dz + microZ));
-            v.normal = n;
-            v.tangent = glm::vec3(1.0f, 0.0f, 0.0f);
-
-            vertices.push_back(v);
-        }
-    }
+    ThreadPool::shared().parallelFor(z0, z1 + 1, kNormalRowsPerTask, [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                int idx = z * (widthQuads + 1) + x;
 
-    // Rebuild index list (same as buildMesh)
-    for (int z = 0; z < widthQuads; ++z) {
-        for (int x = 0; x < widthQuads; ++x) {
-            int topLeft = z * (widthQuads + 1) + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * (widthQuads + 1) + x;
-            int bottomRight = bottomLeft + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-            indices.push_back(bottomRight);
-            indices.push_back(bottomLeft);
+                // Compute central-difference slope in height (world units)
+                float hC = m_heightData[idx] * heightScaleForNormals;
+                float hL = (x > 0) ? m_heightData[idx - 1] * heightScaleForNormals : hC;
+                float hR = (x < m_resolution - 1) ? m_heightData[idx + 1] * heightScaleForNormals : hC;
+                float hD = (z > 0) ? m_heightData[idx - (m_resolution)] * heightScaleForNormals : hC;
+                float hU = (z < m_resolution - 1) ? m_heightData[idx + (m_resolution)] * heightScaleForNormals : hC;
+
+                float dx = (hR - hL) / (2.0f * step);
+                float dz = (hU - hD) / (2.0f * step);
+
+                // Add micro-detail to normals using small-scale noise (configurable amplitude/frequency)
+                float microX = m_microNoiseX[idx] * m_microAmplitude;
+                float microZ = m_microNoiseZ[idx] * m_microAmplitude;
+
+                normals[static_cast<size_t>(z - z0) * width + (x - x0)] = glm::normalize(glm::vec3(-dx + microX, 1.0f, -dz + microZ));
+            }
         }
+    });
+
+    if (!m_normalMapTex) {
+        glGenTextures(1, &m_normalMapTex);
+        glBindTexture(GL_TEXTURE_2D, m_normalMapTex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB16F, m_resolution, m_resolution);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
-
-    // Update the mesh VBO with new normals (positions remain flat so shader displacement still applies)
-    m_mesh->setData(vertices, indices);
+    glBindTexture(GL_TEXTURE_2D, m_normalMapTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x0, z0, width, height, GL_RGB, GL_FLOAT, normals.data());
 }
 
+void Terrain::setHeightRegion(int x0, int z0, int width, int height, const float* heights) {
+    if (m_heightData.empty() || m_streaming) return;
+    // Clip to the map, keeping the source offset in step
+    const int srcStride = width;
+    int cx0 = std::max(x0, 0), cz0 = std::max(z0, 0);
+    int cx1 = std::min(x0 + width, m_resolution) - 1;
+    int cz1 = std::min(z0 + height, m_resolution) - 1;
+    if (cx1 < cx0 || cz1 < cz0) return;
+    const int w = cx1 - cx0 + 1;
+    const int h = cz1 - cz0 + 1;
+
+    for (int z = cz0; z <= cz1; ++z) {
+        const float* src = heights + static_cast<size_t>(z - z0) * srcStride + (cx0 - x0);
+        std::copy(src, src + w, &m_heightData[static_cast<size_t>(z) * m_resolution + cx0]);
+    }
+    m_sampler.reset();  // queries already holding the old snapshot keep seeing pre-edit heights
+    glBindTexture(GL_TEXTURE_2D, m_heightMapTex);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_resolution);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cx0, cz0, w, h, GL_RED, GL_FLOAT, &m_heightData[static_cast<size_t>(cz0) * m_resolution + cx0]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Central differences reach one texel out, so the ring around the edit changes too
+    updateNormals(cx0 - 1, cz0 - 1, cx1 + 1, cz1 + 1);
+    m_quadtree.updateBounds(m_heightData, cx0, cz0, cx1, cz1);
+    if (m_splatEnabled) {
+        // Splat texel centres filter heights up to one texel away from the edited ones
+        const float scale = static_cast<float>(m_splatSettings.oversample);
+        bakeSplatMap(static_cast<int>(std::floor((cx0 - 0.5f) * scale - 0.5f)),
+                     static_cast<int>(std::floor((cz0 - 0.5f) * scale - 0.5f)),
+                     static_cast<int>(std::ceil((cx1 + 1.5f) * scale - 0.5f)),
+                     static_cast<int>(std::ceil((cz1 + 1.5f) * scale - 0.5f)));
+    }
+}
 
+void Terrain::applyHeightBrush(float worldX, float worldZ, float radius, float delta) {
+    if (m_heightData.empty() || m_streaming || radius <= 0.0f) return;
+    const float texelSize = m_worldSize / (float)(m_resolution - 1);
+    const float offset = m_worldSize / 2.0f;
+    int x0 = std::max(0, (int)std::floor((worldX - radius + offset) / texelSize));
+    int z0 = std::max(0, (int)std::floor((worldZ - radius + offset) / texelSize));
+    int x1 = std::min(m_resolution - 1, (int)std::ceil((worldX + radius + offset) / texelSize));
+    int z1 = std::min(m_resolution - 1, (int)std::ceil((worldZ + radius + offset) / texelSize));
+    if (x1 < x0 || z1 < z0) return;
+
+    const int width = x1 - x0 + 1;
+    const int height = z1 - z0 + 1;
+    std::vector<float> patch(static_cast<size_t>(width) * height);
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            float dist = glm::length(glm::vec2(x * texelSize - offset - worldX, z * texelSize - offset - worldZ));
+            // Smooth falloff to zero at the brush edge
+            float weight = 1.0f - glm::smoothstep(0.0f, radius, dist);
+            float h = m_heightData[static_cast<size_t>(z) * m_resolution + x] + delta * weight;
+            patch[static_cast<size_t>(z - z0) * width + (x - x0)] = std::max(0.0f, std::min(1.0f, h));
+        }
+    }
+    setHeightRegion(x0, z0, width, height, patch.data());
+}
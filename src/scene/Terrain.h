@@ -1,32 +1,72 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "../render/Mesh.h"
+#include "TerrainQuadtree.h"
+#include "TerrainPager.h"
+#include "TerrainSampler.h"
+#include "TerrainRaycast.h"
+#include "TerrainSplat.h"
+
+// Procedural output of Terrain::generate that is worth persisting (see WorldCache): the height
+// lattice and the micro-detail noise grids sampled at microFrequency.
+struct TerrainBake {
+    std::vector<float> heights;
+    std::vector<float> microNoiseX;
+    std::vector<float> microNoiseZ;
+    float microFrequency = 0.0f;
+};
 
 class Terrain {
 public:
     Terrain();
     ~Terrain();
  
-    // Generate a flat grid mesh and a heightmap texture
-    // widthQuads: number of quads along X
+    // Generate the heightmap and normal textures and the LOD quadtree drawn over them
+    // widthQuads: number of heightmap texels along X minus one
     // worldSize: total size in world units
     void generate(int widthQuads, float worldSize);
+    // Same result as generate() from previously baked data, without running any noise.
+    // Returns false (and leaves the terrain untouched) if the bake does not fit widthQuads.
+    bool generateFromBake(int widthQuads, float worldSize, TerrainBake bake);
+    // Copy of the procedural data behind the current eagerly generated terrain
+    TerrainBake bake();
+    // Streaming variant: only a coarse overview (one texel per overviewStep) is generated up
+    // front and serves as heightTexture(); full-resolution pages stream in around the position
+    // passed to update(). Normals are then derived from heights in the vertex shader.
+    void generateStreaming(int widthQuads, float worldSize, const TerrainPagerSettings& settings, int overviewStep = 8);
+    // Per frame: advances page streaming (no-op for eagerly generated terrain)
+    void update(const glm::vec3& eye);
+    bool streaming() const { return m_streaming; }
+    TerrainPager& pager() { return m_pager; }
 
-    Mesh* mesh() const { return m_mesh; }
+    TerrainQuadtree& quadtree() { return m_quadtree; }
     GLuint heightTexture() const { return m_heightMapTex; }
+    GLuint normalTexture() const { return m_normalMapTex; }
+    // RGBA8 biome weights (see TerrainSplat.h), 0 until setSplatSettings() is called. Rebaked
+    // whenever the heights are regenerated, and over the edited rectangle by setHeightRegion().
+    GLuint splatTexture() const { return m_splatTex; }
+    void setSplatSettings(const TerrainSplatSettings& settings);
+    // CPU copy of splatTexture(), splatResolution() texels square, for inspection or export
+    const std::vector<unsigned char>& splatData() const { return m_splatData; }
+    int splatResolution() const { return m_splatResolution; }
     int widthResolution() const { return m_resolution; }
     int lengthResolution() const { return m_resolution; }
 
-    // Helper to get height on CPU (normalized 0..1 value from texture data)
+    // Helper to get height on CPU (world units; streamed pages first, then the overview)
     float getHeight(float x, float z) const;
     // Recommended vertical scale (in world units) to use when displacing vertices in the shader
     float recommendedHeightScale() const { return m_worldSize * m_heightScaleMultiplier; }
     // Configure vertical exaggeration multiplier (default 0.26f)
-    void setHeightScaleMultiplier(float m) { m_heightScaleMultiplier = m; }
+    void setHeightScaleMultiplier(float m) { m_heightScaleMultiplier = m; m_sampler.reset(); }
     float heightScaleMultiplier() const { return m_heightScaleMultiplier; }
     float worldSize() const { return m_worldSize; }
+    // Immutable copy of the current heights (the overview when streaming) for bilinear, normal
+    // and batch queries from any thread. Built on first use after each edit; main thread only.
+    std::shared_ptr<const TerrainSampler> sampler() const;
+    // Ray / line-of-sight queries over the same snapshot; rebuilt together with sampler()
+    std::shared_ptr<const TerrainRaycaster> raycaster() const;
     // Micro-detail parameters (affect normals / small bumps)
     void setMicroAmplitude(float a) { m_microAmplitude = a; }
     void setMicroFrequency(float f) { m_microFrequency = f; }
@@ -34,18 +74,44 @@ public:
     float microFrequency() const { return m_microFrequency; }
     // Recompute normals from heightmap (call after changing micro-detail or height-scale)
     void recomputeNormals();
+    // Recompute and upload normals for texels [x0,x1]x[z0,z1] only
+    void updateNormals(int x0, int z0, int x1, int z1);
+
+    // Height editing (eagerly generated terrain only). Writes a width x height block of
+    // normalized heights at texel (x0, z0), then re-uploads just that rectangle of the height
+    // and normal textures and refreshes the affected LOD bounds.
+    void setHeightRegion(int x0, int z0, int width, int height, const float* heights);
+    // Raise (delta > 0) or lower the terrain around a world XZ point with a smooth falloff
+    void applyHeightBrush(float worldX, float worldZ, float radius, float delta);
 
 private:
-    void buildMesh(int widthQuads, float worldSize);
     void generateHeightMap(int resolution);
-    void updateMeshNormalsFromHeightmap();
+    void uploadHeightMap();
+    // Rebakes splat texels [x0, x1] x [z0, z1] and uploads them; the full map (re)allocates the texture
+    void bakeSplatMap(int x0, int z0, int x1, int z1);
+    void ensureMicroNoise();
 
-    Mesh* m_mesh = nullptr;
+    TerrainQuadtree m_quadtree;
+    TerrainPager m_pager;
+    bool m_streaming = false;
     GLuint m_heightMapTex = 0;
+    GLuint m_normalMapTex = 0;
+    GLuint m_splatTex = 0;
+    bool m_splatEnabled = false;
+    TerrainSplatSettings m_splatSettings;
+    std::vector<unsigned char> m_splatData;
+    int m_splatResolution = 0;
     int m_resolution = 256; 
-    std::vector<float> m_heightData;
+    std::vector<float> m_heightData; // full map, or the coarse overview when streaming
+    mutable std::shared_ptr<const TerrainSampler> m_sampler;  // reset whenever heights or scale change
+    mutable std::shared_ptr<const TerrainRaycaster> m_raycaster;
+    int m_heightResolution = 256;    // side of m_heightData
     float m_worldSize = 100.0f;
     float m_heightScaleMultiplier = 0.26f;
     float m_microAmplitude = 0.035f;
     float m_microFrequency = 0.15f;
+    // Cached micro-detail noise grids and the frequency they were evaluated at
+    std::vector<float> m_microNoiseX;
+    std::vector<float> m_microNoiseZ;
+    float m_microNoiseFrequency = 0.0f;
 };
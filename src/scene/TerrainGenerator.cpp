@@ -0,0 +1,102 @@
+#include "TerrainGenerator.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace {
+// Every noise layer of a row is evaluated with one batched FractalNoise::fill call, and the
+// layers are then combined with exactly the float operations of the original per-texel loop,
+// so the result is bit-identical regardless of SIMD level or how the map is split up.
+struct HeightNoiseLayer {
+    float freqX;
+    float freqZ;
+};
+// Order matters: it is the order the layers are accumulated in below.
+constexpr HeightNoiseLayer kHeightLayers[] = {
+    {0.28f, 0.28f},               // base octave 0
+    {0.28f * 1.5f, 0.28f * 1.5f}, // base octave 1
+    {0.12f, 0.12f},               // rolling hills
+    {0.5f, 0.2f},                 // erosion
+    {0.6f, 0.6f},                 // plateau noise
+    {2.0f, 2.0f},                 // surface detail
+    {0.07f, 0.07f},               // biome patches
+};
+constexpr int kHeightLayerCount = sizeof(kHeightLayers) / sizeof(kHeightLayers[0]);
+}
+
+TerrainHeightGenerator::TerrainHeightGenerator(int resolution, float worldSize)
+    : m_resolution(resolution), m_worldSize(worldSize) {}
+
+void TerrainHeightGenerator::fill(int x0, int z0, int width, int height, float* out, int stride) const {
+    if (width <= 0 || height <= 0) return;
+    const int resolution = m_resolution;
+    const float worldScale = m_worldSize; // Map texture coords to world space
+
+    // Terms that depend on only one axis are shared by a whole column or row.
+    std::vector<float> colPlateauEdge(width);
+    std::vector<float> colHill1X(width);
+    std::vector<float> colHill2X(width);
+    std::vector<float> layerXs(static_cast<size_t>(kHeightLayerCount) * width);
+    for (int col = 0; col < width; ++col) {
+        float u = (float)(x0 + col) / (resolution - 1);
+        float wx = u * worldScale - worldScale / 2.0f;
+        for (int l = 0; l < kHeightLayerCount; ++l) layerXs[static_cast<size_t>(l) * width + col] = wx * kHeightLayers[l].freqX;
+        colPlateauEdge[col] = glm::smoothstep(-worldScale * 0.5f, worldScale * 0.1f, wx);
+        colHill1X[col] = (wx + worldScale * 0.3f) * (wx + worldScale * 0.3f);
+        colHill2X[col] = (wx - worldScale * 0.25f) * (wx - worldScale * 0.25f);
+    }
+    const float valleyWidth = worldScale * 0.4f;  // Wider valley
+    const float hill1Denom = 2.0f * (worldScale * 0.25f) * (worldScale * 0.25f);
+    const float hill2Denom = 2.0f * (worldScale * 0.30f) * (worldScale * 0.30f);
+
+    std::vector<float> layerRows(static_cast<size_t>(kHeightLayerCount) * width);
+    const NoiseGrid rowGrid{width, 1};
+    for (int row = 0; row < height; ++row) {
+        float v = (float)(z0 + row) / (resolution - 1);
+        float wz = v * worldScale - worldScale / 2.0f;
+        for (int l = 0; l < kHeightLayerCount; ++l) {
+            float layerZ = wz * kHeightLayers[l].freqZ;
+            m_noise.fill(rowGrid, &layerXs[static_cast<size_t>(l) * width], &layerZ, &layerRows[static_cast<size_t>(l) * width]);
+        }
+        const float* base0 = &layerRows[0 * width];
+        const float* base1 = &layerRows[1 * width];
+        const float* hills = &layerRows[2 * width];
+        const float* erosion = &layerRows[3 * width];
+        const float* plateau = &layerRows[4 * width];
+        const float* detail = &layerRows[5 * width];
+        const float* patches = &layerRows[6 * width];
+
+        // Valley system - very shallow depression (row constant)
+        float valleyCenter = 0.0f;
+        float distToValley = std::abs(wz - valleyCenter);
+        float valleyDepth = std::exp(-distToValley * distToValley / (2.0f * valleyWidth * valleyWidth)) * 0.06f;  // Much shallower
+        float hill1Z = wz * wz;
+        float hill2Z = (wz + worldScale * 0.2f) * (wz + worldScale * 0.2f);
+
+        float* dst = out + static_cast<size_t>(row) * stride;
+        for (int x = 0; x < width; ++x) {
+            // Base terrain noise - 2 octaves of slightly stronger rolling hills
+            float h = 0.0f;
+            h += base0[x] * 0.020f;
+            h += base1[x] * (0.020f * 0.5f);
+            // Large-scale rolling hills (main terrain shape)
+            h += hills[x] * 0.07f;
+            // Valley plus very subtle erosion variation
+            h -= (valleyDepth + erosion[x] * 0.008f);
+            // Plateau with gentle edge
+            h += (colPlateauEdge[x] + plateau[x] * 0.012f) * 0.20f;
+            // Gentle hills instead of mountains
+            float hill1 = std::exp(-(colHill1X[x] + hill1Z) / hill1Denom) * 0.10f;
+            float hill2 = std::exp(-(colHill2X[x] + hill2Z) / hill2Denom) * 0.08f;
+            h += hill1 + hill2;
+            // Very subtle surface detail (like small rocks/terrain texture)
+            h += detail[x] * 0.006f;
+            // Patchy variation to create different biomes/textured areas
+            float patchMask = patches[x] * 0.5f + 0.5f;
+            h += patchMask * 0.02f;
+            // Clamp to 0-1 range
+            dst[x] = std::max(0.0f, std::min(1.0f, h));
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "../util/Noise.h"
+
+// Procedural height lattice: texel (x, z) of a resolution x resolution grid spanning worldSize,
+// centered on the origin, as normalized 0..1 heights. Every texel depends only on its own
+// coordinates, so any rectangle can be filled independently and from any thread; whole-map
+// generation and streamed pages share this one code path and agree bit for bit.
+class TerrainHeightGenerator {
+public:
+    TerrainHeightGenerator(int resolution, float worldSize);
+
+    // out[row * stride + col] = height of texel (x0 + col, z0 + row).
+    void fill(int x0, int z0, int width, int height, float* out, int stride) const;
+
+    int resolution() const { return m_resolution; }
+    float worldSize() const { return m_worldSize; }
+
+private:
+    FractalNoise m_noise{42}; // Fixed seed for reproducibility
+    int m_resolution;
+    float m_worldSize;
+};
@@ -0,0 +1,270 @@
+// scene/TerrainPager.cpp
+#include "TerrainPager.h"
+#include "TerrainGenerator.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "render/Shader.h"
+#include "util/ThreadPool.h"
+
+namespace {
+constexpr int kPageAbsent = -1;
+constexpr int kPageInFlight = -2;
+}
+
+TerrainPager::~TerrainPager() {
+    shutdown();
+}
+
+bool TerrainPager::init(int resolution, float worldSize, const TerrainPagerSettings& settings) {
+    shutdown();
+    if(resolution < 2 || settings.pageQuads < 1 || settings.residentPages < 1) return false;
+    m_settings = settings;
+    m_resolution = resolution;
+    m_worldSize = worldSize;
+    m_generator = std::make_shared<const TerrainHeightGenerator>(resolution, worldSize);
+    m_pagesPerSide = (resolution - 1 + settings.pageQuads - 1) / settings.pageQuads;
+    m_frame = 0;
+
+    const size_t pageCount = static_cast<size_t>(m_pagesPerSide) * m_pagesPerSide;
+    const size_t pageTexels = static_cast<size_t>(pageSide()) * pageSide();
+    m_pageSlot.assign(pageCount, kPageAbsent);
+    m_slotPage.assign(settings.residentPages, kPageAbsent);
+    m_slotLastUse.assign(settings.residentPages, 0);
+    m_slotHeights.assign(pageTexels * settings.residentPages, 0.0f);
+    m_residentCount = 0;
+
+    if(!m_settings.pageDirectory.empty()){
+        std::error_code ec;
+        std::filesystem::create_directories(m_settings.pageDirectory, ec);
+        if(ec){
+            std::cerr << "[TerrainPager] Cannot create page directory " << m_settings.pageDirectory
+                      << ": " << ec.message() << std::endl;
+            m_settings.pageDirectory.clear();
+        }
+    }
+
+    glGenTextures(1, &m_pageArrayTex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pageArrayTex);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32F, pageSide(), pageSide(), settings.residentPages);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    std::vector<GLshort> table(pageCount, static_cast<GLshort>(kPageAbsent));
+    glGenTextures(1, &m_pageTableTex);
+    glBindTexture(GL_TEXTURE_2D, m_pageTableTex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16I, m_pagesPerSide, m_pagesPerSide);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_pagesPerSide, m_pagesPerSide, GL_RED_INTEGER, GL_SHORT, table.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const float pageWorld = m_worldSize / (resolution - 1) * settings.pageQuads;
+    const int pagesAcross = static_cast<int>(std::ceil(2.0f * settings.streamRadius / pageWorld)) + 1;
+    if(pagesAcross * pagesAcross > settings.residentPages){
+        std::cerr << "[TerrainPager] Warning: stream radius needs up to " << pagesAcross * pagesAcross
+                  << " pages but only " << settings.residentPages << " may be resident" << std::endl;
+    }
+    std::cout << "[TerrainPager] " << m_pagesPerSide << "x" << m_pagesPerSide << " pages of " << pageSide() << "x"
+              << pageSide() << " texels, " << settings.residentPages << " resident" << std::endl;
+    return true;
+}
+
+std::string TerrainPager::pagePath(int px, int pz) const {
+    // Everything the page contents depend on is part of the name, so stale pages are never read.
+    return m_settings.pageDirectory + "/height_r" + std::to_string(m_resolution) + "_w" +
+           std::to_string(static_cast<int>(std::lround(m_worldSize * 100.0f))) + "_p" +
+           std::to_string(m_settings.pageQuads) + "_" + std::to_string(px) + "_" + std::to_string(pz) + ".bin";
+}
+
+void TerrainPager::update(const glm::vec3& eye) {
+    if(!m_pageArrayTex) return;
+    ++m_frame;
+
+    // Collect finished jobs.
+    for(size_t i = 0; i < m_pending.size();){
+        if(m_pending[i]->done.wait_for(std::chrono::seconds(0)) == std::future_status::ready){
+            m_ready.push_back(std::move(m_pending[i]));
+            m_pending[i] = std::move(m_pending.back());
+            m_pending.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    // Touch resident pages in range and gather missing ones, nearest first.
+    const float texelSize = m_worldSize / (m_resolution - 1);
+    const float pageWorld = texelSize * m_settings.pageQuads;
+    const float half = m_worldSize * 0.5f;
+    const float radius = m_settings.streamRadius;
+    auto pageRange = [&](float lo, float hi, int& first, int& last) {
+        first = std::max(0, static_cast<int>(std::floor((lo + half) / pageWorld)));
+        last = std::min(m_pagesPerSide - 1, static_cast<int>(std::floor((hi + half) / pageWorld)));
+    };
+    int px0, px1, pz0, pz1;
+    pageRange(eye.x - radius, eye.x + radius, px0, px1);
+    pageRange(eye.z - radius, eye.z + radius, pz0, pz1);
+    std::vector<std::pair<float, int>> missing;
+    for(int pz = pz0; pz <= pz1; ++pz){
+        for(int px = px0; px <= px1; ++px){
+            glm::vec2 pmin(px * pageWorld - half, pz * pageWorld - half);
+            glm::vec2 closest = glm::clamp(glm::vec2(eye.x, eye.z), pmin, pmin + pageWorld);
+            float dist = glm::length(closest - glm::vec2(eye.x, eye.z));
+            if(dist > radius) continue;
+            int page = pz * m_pagesPerSide + px;
+            int slot = m_pageSlot[page];
+            if(slot >= 0) m_slotLastUse[slot] = m_frame;
+            else if(slot == kPageAbsent) missing.emplace_back(dist, page);
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+
+    // Queue generation jobs.
+    ThreadPool& pool = ThreadPool::shared();
+    for(const auto& entry : missing){
+        if(static_cast<int>(m_pending.size() + m_ready.size()) >= m_settings.maxPendingPages) break;
+        const int page = entry.second;
+        auto job = std::make_unique<PageJob>();
+        job->page = page;
+        PageJob* jobPtr = job.get();
+        const int px = page % m_pagesPerSide;
+        const int pz = page / m_pagesPerSide;
+        const std::string path = m_settings.pageDirectory.empty() ? std::string() : pagePath(px, pz);
+        const int side = pageSide();
+        const int pageQuads = m_settings.pageQuads;
+        auto generator = m_generator;
+        m_pageSlot[page] = kPageInFlight;
+        job->done = pool.submit([jobPtr, generator, path, px, pz, side, pageQuads]{
+            const size_t count = static_cast<size_t>(side) * side;
+            jobPtr->heights.resize(count);
+            if(!path.empty()){
+                std::ifstream in(path, std::ios::binary | std::ios::ate);
+                if(in && static_cast<size_t>(in.tellg()) == count * sizeof(float)){
+                    in.seekg(0);
+                    if(in.read(reinterpret_cast<char*>(jobPtr->heights.data()), count * sizeof(float))) return;
+                }
+            }
+            generator->fill(px * pageQuads, pz * pageQuads, side, side, jobPtr->heights.data(), side);
+            if(!path.empty()){
+                // Write aside and rename so a crash never leaves a truncated page behind.
+                const std::string tmpPath = path + ".tmp";
+                std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+                if(out.write(reinterpret_cast<const char*>(jobPtr->heights.data()), count * sizeof(float))){
+                    out.close();
+                    std::error_code ec;
+                    std::filesystem::rename(tmpPath, path, ec);
+                }
+            }
+        });
+        m_pending.push_back(std::move(job));
+    }
+
+    // Upload a few finished pages, evicting the least recently used page not needed this frame.
+    int uploads = 0;
+    while(!m_ready.empty() && uploads < m_settings.uploadsPerFrame){
+        std::unique_ptr<PageJob> job = std::move(m_ready.front());
+        m_ready.erase(m_ready.begin());
+        int slot = -1;
+        for(int s = 0; s < m_settings.residentPages; ++s){
+            if(m_slotPage[s] == kPageAbsent){ slot = s; break; }
+            if(m_slotLastUse[s] < m_frame && (slot < 0 || m_slotLastUse[s] < m_slotLastUse[slot])) slot = s;
+        }
+        if(slot < 0){
+            // Budget is smaller than the stream radius needs; drop the page and ask again later.
+            m_pageSlot[job->page] = kPageAbsent;
+            continue;
+        }
+        if(m_slotPage[slot] != kPageAbsent){
+            m_pageSlot[m_slotPage[slot]] = kPageAbsent;
+            writeTableEntry(m_slotPage[slot], kPageAbsent);
+            --m_residentCount;
+        }
+        m_slotPage[slot] = job->page;
+        m_slotLastUse[slot] = m_frame;
+        m_pageSlot[job->page] = slot;
+        ++m_residentCount;
+        uploadPage(job->page, job->heights);
+        ++uploads;
+    }
+}
+
+void TerrainPager::uploadPage(int page, const std::vector<float>& heights) {
+    const int slot = m_pageSlot[page];
+    const size_t pageTexels = static_cast<size_t>(pageSide()) * pageSide();
+    std::copy(heights.begin(), heights.end(), m_slotHeights.begin() + pageTexels * slot);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pageArrayTex);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot, pageSide(), pageSide(), 1, GL_RED, GL_FLOAT, heights.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    writeTableEntry(page, slot);
+    if(m_onPageUploaded){
+        const int px = page % m_pagesPerSide;
+        const int pz = page / m_pagesPerSide;
+        m_onPageUploaded(px * m_settings.pageQuads, pz * m_settings.pageQuads, pageSide(), heights.data());
+    }
+}
+
+void TerrainPager::writeTableEntry(int page, int layer) {
+    GLshort value = static_cast<GLshort>(layer);
+    glBindTexture(GL_TEXTURE_2D, m_pageTableTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, page % m_pagesPerSide, page / m_pagesPerSide, 1, 1, GL_RED_INTEGER, GL_SHORT, &value);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TerrainPager::sampleHeight(float x, float z, float& outHeight) const {
+    if(m_pagesPerSide == 0) return false;
+    float offset = m_worldSize / 2.0f;
+    float u = (x + offset) / m_worldSize;
+    float v = (z + offset) / m_worldSize;
+    if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f) return false;
+    int ix = std::clamp((int)(u * (m_resolution - 1)), 0, m_resolution - 1);
+    int iz = std::clamp((int)(v * (m_resolution - 1)), 0, m_resolution - 1);
+    int px = std::min(ix / m_settings.pageQuads, m_pagesPerSide - 1);
+    int pz = std::min(iz / m_settings.pageQuads, m_pagesPerSide - 1);
+    int slot = m_pageSlot[static_cast<size_t>(pz) * m_pagesPerSide + px];
+    if(slot < 0) return false;
+    const size_t pageTexels = static_cast<size_t>(pageSide()) * pageSide();
+    const int lx = ix - px * m_settings.pageQuads;
+    const int lz = iz - pz * m_settings.pageQuads;
+    outHeight = m_slotHeights[pageTexels * slot + static_cast<size_t>(lz) * pageSide() + lx];
+    return true;
+}
+
+void TerrainPager::bind(Shader& shader, int arrayUnit, int tableUnit) const {
+    glActiveTexture(GL_TEXTURE0 + arrayUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pageArrayTex);
+    shader.setInt("uHeightPages", arrayUnit);
+    glActiveTexture(GL_TEXTURE0 + tableUnit);
+    glBindTexture(GL_TEXTURE_2D, m_pageTableTex);
+    shader.setInt("uPageTable", tableUnit);
+    shader.setFloat("uPageQuads", static_cast<float>(m_settings.pageQuads));
+    shader.setFloat("uHeightTexels", static_cast<float>(m_resolution - 1));
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void TerrainPager::shutdown() {
+    for(auto& job : m_pending){
+        if(job->done.valid()) job->done.wait();
+    }
+    m_pending.clear();
+    m_ready.clear();
+    if(m_pageArrayTex) glDeleteTextures(1, &m_pageArrayTex);
+    if(m_pageTableTex) glDeleteTextures(1, &m_pageTableTex);
+    m_pageArrayTex = m_pageTableTex = 0;
+    m_pageSlot.clear();
+    m_slotPage.clear();
+    m_slotLastUse.clear();
+    m_slotHeights.clear();
+    m_residentCount = 0;
+    m_pagesPerSide = 0;
+}
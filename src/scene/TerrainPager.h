@@ -0,0 +1,87 @@
+// scene/TerrainPager.h
+// Streams full-resolution terrain height pages around the camera. Pages are generated (or read
+// back from a page directory) on the shared thread pool, uploaded a few per frame into one layer
+// each of a texture array, and evicted least-recently-used once the residency budget is full.
+// A small integer page table maps page coordinates to array layers (-1 = not resident) so the
+// terrain vertex shader can fall back to the coarse overview heightmap where nothing is loaded.
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Shader;
+class TerrainHeightGenerator;
+
+struct TerrainPagerSettings {
+    int pageQuads = 64;           // texels per page side minus one; neighbours share their border texels
+    int residentPages = 64;       // texture array layers, also the CPU page budget
+    float streamRadius = 200.0f;  // pages overlapping this XZ radius around the camera are kept resident
+    int uploadsPerFrame = 4;
+    int maxPendingPages = 8;      // generation jobs in flight
+    std::string pageDirectory;    // when set, generated pages are saved here and loaded on later runs
+};
+
+class TerrainPager {
+public:
+    // Invoked on the main thread after a page is uploaded: texel origin in the full-resolution
+    // lattice, side length in texels and the page heights (side * side, row-major).
+    using PageCallback = std::function<void(int x0, int z0, int side, const float* heights)>;
+
+    TerrainPager() = default;
+    ~TerrainPager();
+    TerrainPager(const TerrainPager&) = delete;
+    TerrainPager& operator=(const TerrainPager&) = delete;
+
+    // resolution / worldSize describe the full-resolution lattice (see TerrainHeightGenerator).
+    bool init(int resolution, float worldSize, const TerrainPagerSettings& settings = TerrainPagerSettings());
+    void setPageCallback(PageCallback callback) { m_onPageUploaded = std::move(callback); }
+
+    // Main thread, once per frame: request missing pages near eye, upload finished ones.
+    void update(const glm::vec3& eye);
+
+    // Nearest-texel normalized height (same addressing as Terrain::getHeight), if resident.
+    bool sampleHeight(float x, float z, float& outHeight) const;
+
+    // Binds the page array and page table and uploads the TERRAIN_PAGED uniforms.
+    void bind(Shader& shader, int arrayUnit, int tableUnit) const;
+
+    int pagesPerSide() const { return m_pagesPerSide; }
+    int residentCount() const { return m_residentCount; }
+    int pendingCount() const { return static_cast<int>(m_pending.size()); }
+
+    void shutdown();
+
+private:
+    struct PageJob {
+        int page = -1;
+        std::vector<float> heights;
+        std::future<void> done;
+    };
+
+    int pageSide() const { return m_settings.pageQuads + 1; }
+    std::string pagePath(int px, int pz) const;
+    void uploadPage(int page, const std::vector<float>& heights);
+    void writeTableEntry(int page, int layer);
+
+    TerrainPagerSettings m_settings;
+    std::shared_ptr<const TerrainHeightGenerator> m_generator;
+    int m_resolution = 0;
+    float m_worldSize = 0.0f;
+    int m_pagesPerSide = 0;
+    unsigned long long m_frame = 0;
+
+    std::vector<int> m_pageSlot;                 // per page: array layer, -1 absent, -2 in flight
+    std::vector<int> m_slotPage;                 // per layer: page or -1
+    std::vector<unsigned long long> m_slotLastUse;
+    std::vector<float> m_slotHeights;            // CPU copies of resident pages, layer-major
+    int m_residentCount = 0;
+    std::vector<std::unique_ptr<PageJob>> m_pending;
+    std::vector<std::unique_ptr<PageJob>> m_ready;
+
+    unsigned int m_pageArrayTex = 0;
+    unsigned int m_pageTableTex = 0;
+    PageCallback m_onPageUploaded;
+};
@@ -0,0 +1,335 @@
+// scene/TerrainQuadtree.cpp
+#include "TerrainQuadtree.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "render/GridMeshCache.h"
+#include "render/Shader.h"
+
+namespace {
+constexpr int kMaxLodLevels = 8; // matches uLodMorph[] below
+
+const char* kTerrainLodGlsl = R"GLSL(
+// No per-vertex stream: the patch grid position comes from gl_VertexID (row-major grid).
+layout(location=1) in vec4 aNode;    // xy = node min corner (world XZ), z = node size, w = LOD level
+uniform float uTerrainWorldSize;
+uniform float uPatchQuads;
+uniform vec3 uLodEye;
+uniform vec2 uLodMorph[8];           // per level: morph start distance, 1 / (end - start)
+vec2 terrainUV(vec2 xz){ return (xz + 0.5 * uTerrainWorldSize) / uTerrainWorldSize; }
+#ifdef TERRAIN_PAGED
+// Streamed pages (TerrainPager); uHeightMap is the coarse overview used where none is resident.
+uniform sampler2DArray uHeightPages;
+uniform isampler2D uPageTable;
+uniform float uPageQuads;            // page side in texels minus one
+uniform float uHeightTexels;         // full-resolution lattice side minus one
+float terrainHeight01(vec2 uv){
+    vec2 t = clamp(uv, 0.0, 1.0) * uHeightTexels;
+    ivec2 page = min(ivec2(t / uPageQuads), textureSize(uPageTable, 0) - 1);
+    int layer = texelFetch(uPageTable, page, 0).r;
+    if(layer < 0) return texture(uHeightMap, uv).r;
+    vec2 local = (t - vec2(page) * uPageQuads + 0.5) / (uPageQuads + 1.0);
+    return texture(uHeightPages, vec3(local, float(layer))).r;
+}
+vec3 terrainLodNormal(vec2 uv){
+    float du = 1.0 / uHeightTexels;
+    float step = uTerrainWorldSize * du;
+    float dx = (terrainHeight01(uv + vec2(du, 0.0)) - terrainHeight01(uv - vec2(du, 0.0))) * uHeightScale / (2.0 * step);
+    float dz = (terrainHeight01(uv + vec2(0.0, du)) - terrainHeight01(uv - vec2(0.0, du))) * uHeightScale / (2.0 * step);
+    return normalize(vec3(-dx, 1.0, -dz));
+}
+#else
+uniform sampler2D uNormalMap;
+float terrainHeight01(vec2 uv){ return texture(uHeightMap, uv).r; }
+vec3 terrainLodNormal(vec2 uv){ return normalize(texture(uNormalMap, uv).xyz); }
+#endif
+vec3 terrainLodPosition(out vec2 uv){
+    int side = int(uPatchQuads + 0.5) + 1;
+    ivec2 grid = ivec2(gl_VertexID % side, gl_VertexID / side);
+    vec2 gridPos = vec2(grid) / uPatchQuads;   // patch-local, 0..1
+    vec2 xz = aNode.xy + gridPos * aNode.z;
+    int level = int(aNode.w + 0.5);
+    float h = terrainHeight01(terrainUV(xz)) * uHeightScale;
+    float dist = distance(uLodEye, vec3(xz.x, h, xz.y));
+    float morph = clamp((dist - uLodMorph[level].x) * uLodMorph[level].y, 0.0, 1.0);
+    // Slide odd grid vertices onto the even ones, i.e. onto the next coarser level's grid.
+    vec2 odd = vec2(grid & 1) / uPatchQuads;
+    xz -= odd * aNode.z * morph;
+    uv = terrainUV(xz);
+    return vec3(xz.x, terrainHeight01(uv) * uHeightScale, xz.y);
+}
+)GLSL";
+
+bool sphereIntersectsAABB(const glm::vec3& center, float radius, const glm::vec3& bmin, const glm::vec3& bmax) {
+    glm::vec3 closest = glm::clamp(center, bmin, bmax);
+    glm::vec3 d = closest - center;
+    return glm::dot(d, d) <= radius * radius;
+}
+} // namespace
+
+int TerrainQuadtree::Selection::patchCount() const {
+    size_t count = full.size();
+    for(const auto& q : quadrant) count += q.size();
+    return static_cast<int>(count);
+}
+
+TerrainQuadtree::~TerrainQuadtree() {
+    shutdown();
+}
+
+const char* TerrainQuadtree::glslVertexCommon() {
+    return kTerrainLodGlsl;
+}
+
+bool TerrainQuadtree::init(const std::vector<float>& heights, int resolution, float worldSize,
+                           const TerrainLodSettings& settings, int lodResolution) {
+    shutdown();
+    if(resolution < 2 || heights.size() < static_cast<size_t>(resolution) * resolution) return false;
+    m_settings = settings;
+    int patchQuads = 2;
+    while(patchQuads < m_settings.patchQuads && patchQuads < 128) patchQuads *= 2;
+    m_settings.patchQuads = patchQuads;
+    m_worldSize = worldSize;
+    m_resolution = resolution;
+
+    // Leaves get about one patch quad per heightmap texel.
+    if(lodResolution < 2) lodResolution = resolution;
+    int leavesPerSide = 1;
+    m_levelCount = 1;
+    while(leavesPerSide * patchQuads < lodResolution - 1 && m_levelCount < kMaxLodLevels){
+        leavesPerSide *= 2;
+        ++m_levelCount;
+    }
+
+    m_ranges.resize(m_levelCount);
+    float range = nodeSize(0) * m_settings.leafRangeScale;
+    for(int level = 0; level < m_levelCount; ++level){
+        m_ranges[level] = range;
+        range *= 2.0f;
+    }
+
+    m_heightBounds.assign(m_levelCount, {});
+    for(int level = 0; level < m_levelCount; ++level){
+        m_heightBounds[level].assign(static_cast<size_t>(nodesPerSide(level)) * nodesPerSide(level), glm::vec2(0.0f));
+    }
+    updateBounds(heights, 0, 0, resolution - 1, resolution - 1);
+
+    // Shared patch: (patchQuads+1)^2 grid vertices drawn with the shared restart-strip index
+    // buffer, which is ordered quadrant by quadrant so a single quadrant is a contiguous quarter.
+    // Vertices have no attributes of their own; the shader derives them from gl_VertexID, so
+    // the only per-vertex fetch is the 16-bit index.
+    m_grid = &GridMeshCache::shared().strips(patchQuads);
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_instanceVBO);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_grid->buffer);
+    m_instanceCapacity = 256;
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::cout << "[TerrainLod] " << m_levelCount << " LOD levels, " << leavesPerSide << "x" << leavesPerSide
+              << " leaf nodes, " << patchQuads << "x" << patchQuads << " quads per patch" << std::endl;
+    return true;
+}
+
+void TerrainQuadtree::updateBounds(const std::vector<float>& heights, int x0, int z0, int x1, int z1) {
+    if(m_levelCount == 0) return;
+    const int leaves = nodesPerSide(0);
+    const float texelsPerLeaf = static_cast<float>(m_resolution - 1) / leaves;
+    auto leafIndex = [&](int texel) {
+        return std::clamp(static_cast<int>(std::floor(texel / texelsPerLeaf)), 0, leaves - 1);
+    };
+    // Leaves also cover one texel beyond their edges: linear filtering reaches that far.
+    int lx0 = leafIndex(x0 - 1), lx1 = leafIndex(x1 + 1);
+    int lz0 = leafIndex(z0 - 1), lz1 = leafIndex(z1 + 1);
+    for(int nz = lz0; nz <= lz1; ++nz){
+        int tz0 = std::max(0, static_cast<int>(std::floor(nz * texelsPerLeaf)) - 1);
+        int tz1 = std::min(m_resolution - 1, static_cast<int>(std::ceil((nz + 1) * texelsPerLeaf)) + 1);
+        for(int nx = lx0; nx <= lx1; ++nx){
+            int tx0 = std::max(0, static_cast<int>(std::floor(nx * texelsPerLeaf)) - 1);
+            int tx1 = std::min(m_resolution - 1, static_cast<int>(std::ceil((nx + 1) * texelsPerLeaf)) + 1);
+            glm::vec2 bounds(1e30f, -1e30f);
+            for(int tz = tz0; tz <= tz1; ++tz){
+                const float* row = &heights[static_cast<size_t>(tz) * m_resolution];
+                for(int tx = tx0; tx <= tx1; ++tx){
+                    bounds.x = std::min(bounds.x, row[tx]);
+                    bounds.y = std::max(bounds.y, row[tx]);
+                }
+            }
+            m_heightBounds[0][static_cast<size_t>(nz) * leaves + nx] = bounds;
+        }
+    }
+    propagateBounds(lx0, lz0, lx1, lz1);
+}
+
+void TerrainQuadtree::expandBounds(const float* heights, int stride, int x0, int z0, int width, int height,
+                                   int latticeResolution) {
+    if(m_levelCount == 0 || width <= 0 || height <= 0) return;
+    const int leaves = nodesPerSide(0);
+    const float texelsPerLeaf = static_cast<float>(latticeResolution - 1) / leaves;
+    auto leafIndex = [&](int texel) {
+        return std::clamp(static_cast<int>(std::floor(texel / texelsPerLeaf)), 0, leaves - 1);
+    };
+    int lx0 = leafIndex(x0 - 1), lx1 = leafIndex(x0 + width);
+    int lz0 = leafIndex(z0 - 1), lz1 = leafIndex(z0 + height);
+    for(int nz = lz0; nz <= lz1; ++nz){
+        int tz0 = std::max(z0, static_cast<int>(std::floor(nz * texelsPerLeaf)) - 1);
+        int tz1 = std::min(z0 + height - 1, static_cast<int>(std::ceil((nz + 1) * texelsPerLeaf)) + 1);
+        for(int nx = lx0; nx <= lx1; ++nx){
+            int tx0 = std::max(x0, static_cast<int>(std::floor(nx * texelsPerLeaf)) - 1);
+            int tx1 = std::min(x0 + width - 1, static_cast<int>(std::ceil((nx + 1) * texelsPerLeaf)) + 1);
+            glm::vec2& bounds = m_heightBounds[0][static_cast<size_t>(nz) * leaves + nx];
+            for(int tz = tz0; tz <= tz1; ++tz){
+                const float* row = heights + static_cast<size_t>(tz - z0) * stride - x0;
+                for(int tx = tx0; tx <= tx1; ++tx){
+                    bounds.x = std::min(bounds.x, row[tx]);
+                    bounds.y = std::max(bounds.y, row[tx]);
+                }
+            }
+        }
+    }
+    propagateBounds(lx0, lz0, lx1, lz1);
+}
+
+// Recompute the ancestors of leaves [lx0,lx1]x[lz0,lz1] from their children.
+void TerrainQuadtree::propagateBounds(int lx0, int lz0, int lx1, int lz1) {
+    for(int level = 1; level < m_levelCount; ++level){
+        lx0 >>= 1; lx1 >>= 1; lz0 >>= 1; lz1 >>= 1;
+        const int side = nodesPerSide(level);
+        const int childSide = nodesPerSide(level - 1);
+        const std::vector<glm::vec2>& children = m_heightBounds[level - 1];
+        for(int nz = lz0; nz <= lz1; ++nz){
+            for(int nx = lx0; nx <= lx1; ++nx){
+                glm::vec2 bounds(1e30f, -1e30f);
+                for(int q = 0; q < 4; ++q){
+                    const glm::vec2& c = children[static_cast<size_t>(nz * 2 + (q >> 1)) * childSide + nx * 2 + (q & 1)];
+                    bounds.x = std::min(bounds.x, c.x);
+                    bounds.y = std::max(bounds.y, c.y);
+                }
+                m_heightBounds[level][static_cast<size_t>(nz) * side + nx] = bounds;
+            }
+        }
+    }
+}
+
+void TerrainQuadtree::nodeBounds(int level, int nx, int nz, float heightScale, glm::vec3& bmin, glm::vec3& bmax) const {
+    const float size = nodeSize(level);
+    const float half = m_worldSize * 0.5f;
+    const glm::vec2& h = m_heightBounds[level][static_cast<size_t>(nz) * nodesPerSide(level) + nx];
+    bmin = glm::vec3(nx * size - half, h.x * heightScale, nz * size - half);
+    bmax = glm::vec3(bmin.x + size, h.y * heightScale, bmin.z + size);
+}
+
+void TerrainQuadtree::select(const glm::vec3& lodEye, const Frustum& frustum, float heightScale, Selection& out) const {
+    out.clear();
+    if(m_levelCount == 0) return;
+    selectNode(m_levelCount - 1, 0, 0, lodEye, frustum, heightScale, out);
+}
+
+TerrainQuadtree::NodeResult TerrainQuadtree::selectNode(int level, int nx, int nz, const glm::vec3& eye,
+                                                        const Frustum& frustum, float heightScale, Selection& out) const {
+    glm::vec3 bmin, bmax;
+    nodeBounds(level, nx, nz, heightScale, bmin, bmax);
+    // The root has no parent to fall back on, so it is always in range.
+    if(level < m_levelCount - 1 && !sphereIntersectsAABB(eye, m_ranges[level], bmin, bmax)) return NodeResult::OutOfRange;
+    if(!frustum.intersectsAABB(bmin, bmax)) return NodeResult::Culled;
+
+    const glm::vec4 node(bmin.x, bmin.z, nodeSize(level), static_cast<float>(level));
+    if(level == 0 || !sphereIntersectsAABB(eye, m_ranges[level - 1], bmin, bmax)){
+        out.full.push_back(node);
+        return NodeResult::Selected;
+    }
+
+    // Children the finer level does not cover are drawn here as quarters of this node.
+    bool drawQuadrant[4] = {false, false, false, false};
+    int quadrantCount = 0;
+    for(int q = 0; q < 4; ++q){
+        const int cx = nx * 2 + (q & 1);
+        const int cz = nz * 2 + (q >> 1);
+        if(selectNode(level - 1, cx, cz, eye, frustum, heightScale, out) != NodeResult::OutOfRange) continue;
+        glm::vec3 cmin, cmax;
+        nodeBounds(level - 1, cx, cz, heightScale, cmin, cmax);
+        if(!frustum.intersectsAABB(cmin, cmax)) continue;
+        drawQuadrant[q] = true;
+        ++quadrantCount;
+    }
+    if(quadrantCount == 4){
+        out.full.push_back(node);
+    } else {
+        for(int q = 0; q < 4; ++q){
+            if(drawQuadrant[q]) out.quadrant[q].push_back(node);
+        }
+    }
+    return NodeResult::Selected;
+}
+
+void TerrainQuadtree::setUniforms(Shader& shader, const glm::vec3& lodEye, float heightScale) const {
+    shader.setFloat("uHeightScale", heightScale);
+    shader.setFloat("uTerrainWorldSize", m_worldSize);
+    shader.setFloat("uPatchQuads", static_cast<float>(m_settings.patchQuads));
+    shader.setVec3("uLodEye", lodEye);
+    for(int level = 0; level < m_levelCount; ++level){
+        // Morph over the outer part of [range(level-1), range(level)]; the top level has
+        // nothing coarser to morph into.
+        glm::vec2 morph(1e30f, 1.0f);
+        if(level < m_levelCount - 1){
+            float prev = level > 0 ? m_ranges[level - 1] : 0.0f;
+            float end = m_ranges[level];
+            float start = prev + (end - prev) * m_settings.morphStartRatio;
+            morph = glm::vec2(start, 1.0f / std::max(end - start, 1e-4f));
+        }
+        shader.setVec2("uLodMorph[" + std::to_string(level) + "]", morph);
+    }
+}
+
+void TerrainQuadtree::draw(const Selection& selection) {
+    if(!m_vao) return;
+    const int total = selection.patchCount();
+    if(total == 0) return;
+
+    m_instanceScratch.clear();
+    m_instanceScratch.insert(m_instanceScratch.end(), selection.full.begin(), selection.full.end());
+    for(const auto& q : selection.quadrant) m_instanceScratch.insert(m_instanceScratch.end(), q.begin(), q.end());
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if(m_instanceScratch.size() > m_instanceCapacity){
+        m_instanceCapacity = std::max(m_instanceScratch.size(), m_instanceCapacity * 2);
+    }
+    // Orphan first: the shadow and main passes both upload a selection each frame.
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_instanceScratch.size() * sizeof(glm::vec4), m_instanceScratch.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(m_vao);
+    glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    GLuint baseInstance = 0;
+    if(!selection.full.empty()){
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLE_STRIP, m_grid->count, m_grid->indexType, (void*)0,
+                                            static_cast<GLsizei>(selection.full.size()), baseInstance);
+        baseInstance += static_cast<GLuint>(selection.full.size());
+    }
+    for(int q = 0; q < 4; ++q){
+        if(selection.quadrant[q].empty()) continue;
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLE_STRIP, m_grid->quadrantCount, m_grid->indexType,
+                                            m_grid->quadrantOffset(q),
+                                            static_cast<GLsizei>(selection.quadrant[q].size()), baseInstance);
+        baseInstance += static_cast<GLuint>(selection.quadrant[q].size());
+    }
+    glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    glBindVertexArray(0);
+}
+
+void TerrainQuadtree::shutdown() {
+    if(m_instanceVBO) glDeleteBuffers(1, &m_instanceVBO);
+    if(m_vao) glDeleteVertexArrays(1, &m_vao);
+    m_instanceVBO = m_vao = 0;
+    m_grid = nullptr;  // owned by GridMeshCache
+    m_instanceCapacity = 0;
+}
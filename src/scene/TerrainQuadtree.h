@@ -0,0 +1,91 @@
+// scene/TerrainQuadtree.h
+// CDLOD terrain (Strugar, "Continuous Distance-Dependent Level of Detail"): a quadtree over
+// the heightmap whose selected nodes are all drawn with one shared patch grid. Each LOD level
+// owns a distance range twice the size of the one below it; inside the outer part of its range
+// a patch morphs its odd vertices onto the next coarser grid, so levels meet without cracks.
+// Heights still come from the terrain heightmap texture in the vertex shader.
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "render/Frustum.h"
+
+class Shader;
+struct GridIndexBuffer;
+
+struct TerrainLodSettings {
+    int patchQuads = 32;          // quads per patch side (power of two)
+    float leafRangeScale = 2.5f;  // LOD 0 range in multiples of a leaf node's size
+    float morphStartRatio = 0.7f; // morphing starts at this fraction of a level's range band
+};
+
+class TerrainQuadtree {
+public:
+    // Selected patches: xy = world XZ of the node's min corner, z = node size, w = LOD level.
+    // full holds whole nodes; quadrant[q] holds nodes of which only child q is drawn at this
+    // level (the other children were selected at a finer level or culled).
+    struct Selection {
+        std::vector<glm::vec4> full;
+        std::vector<glm::vec4> quadrant[4];
+        void clear() { full.clear(); for(auto& q : quadrant) q.clear(); }
+        int patchCount() const;
+    };
+
+    TerrainQuadtree() = default;
+    ~TerrainQuadtree();
+    TerrainQuadtree(const TerrainQuadtree&) = delete;
+    TerrainQuadtree& operator=(const TerrainQuadtree&) = delete;
+
+    // heights: normalized resolution x resolution heightmap spanning worldSize, centered on the origin.
+    // lodResolution sets the finest patch density (one quad per texel); it defaults to resolution
+    // and is larger when heights is only a coarse overview of streamed data.
+    bool init(const std::vector<float>& heights, int resolution, float worldSize,
+              const TerrainLodSettings& settings = TerrainLodSettings(), int lodResolution = 0);
+    // Refresh node height bounds after heights changed inside [x0,x1]x[z0,z1] (texel coordinates).
+    void updateBounds(const std::vector<float>& heights, int x0, int z0, int x1, int z1);
+    // Grow node height bounds to include a rectangle of a latticeResolution-sized lattice spanning
+    // the same world: heights[row * stride + col] is texel (x0 + col, z0 + row). Used for pages
+    // streamed in on top of the overview.
+    void expandBounds(const float* heights, int stride, int x0, int z0, int width, int height, int latticeResolution);
+
+    // lodEye drives the LOD choice and should be the main camera even for shadow passes, so
+    // every pass sees identical geometry; the frustum only culls.
+    void select(const glm::vec3& lodEye, const Frustum& frustum, float heightScale, Selection& out) const;
+
+    // Uploads the uniforms read by glslVertexCommon().
+    void setUniforms(Shader& shader, const glm::vec3& lodEye, float heightScale) const;
+    void draw(const Selection& selection);
+
+    int lodLevelCount() const { return m_levelCount; }
+    int patchQuads() const { return m_settings.patchQuads; }
+    int trianglesPerPatch() const { return m_settings.patchQuads * m_settings.patchQuads * 2; }
+
+    // GLSL fragment defining the patch vertex inputs (locations 0 and 1),
+    // vec3 terrainLodPosition(out vec2 uv), which returns the morphed, displaced world position,
+    // and vec3 terrainLodNormal(vec2 uv). The including shader must declare uHeightMap and
+    // uHeightScale before it, and #define TERRAIN_PAGED to read heights from a TerrainPager.
+    static const char* glslVertexCommon();
+
+    void shutdown();
+
+private:
+    enum class NodeResult { OutOfRange, Culled, Selected };
+    NodeResult selectNode(int level, int nx, int nz, const glm::vec3& eye, const Frustum& frustum,
+                          float heightScale, Selection& out) const;
+    void propagateBounds(int lx0, int lz0, int lx1, int lz1);
+    void nodeBounds(int level, int nx, int nz, float heightScale, glm::vec3& bmin, glm::vec3& bmax) const;
+    float nodeSize(int level) const { return m_worldSize / static_cast<float>(1 << (m_levelCount - 1 - level)); }
+    int nodesPerSide(int level) const { return 1 << (m_levelCount - 1 - level); }
+
+    TerrainLodSettings m_settings;
+    float m_worldSize = 0.0f;
+    int m_resolution = 0;
+    int m_levelCount = 0;
+    std::vector<float> m_ranges;                     // per level, world units
+    std::vector<std::vector<glm::vec2>> m_heightBounds; // per level, per node: normalized min/max
+
+    unsigned int m_vao = 0;
+    const GridIndexBuffer* m_grid = nullptr;  // shared patch indices (GridMeshCache)
+    unsigned int m_instanceVBO = 0;
+    size_t m_instanceCapacity = 0;
+    std::vector<glm::vec4> m_instanceScratch;
+};
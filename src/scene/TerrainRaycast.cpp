@@ -0,0 +1,219 @@
+#include "TerrainRaycast.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "TerrainSampler.h"
+#include "../util/ThreadPool.h"
+
+namespace {
+// Rays are traced in texel space: x/z in heightmap texels, y in normalized height. The map is
+// linear, so the ray parameter t (and therefore hit distances) is the same as in world space.
+constexpr float kEdgePad = 1e-4f;  // texels; keeps rays running along a cell edge from slipping between cells
+constexpr int kMaxLevels = 32;
+constexpr int kBatchGrain = 64;  // rays per pool chunk; smaller batches stay on the caller
+
+inline bool clipBox(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& bmin, const glm::vec3& bmax,
+                    float& t0, float& t1) {
+    for (int axis = 0; axis < 3; ++axis) {
+        float ta = (bmin[axis] - origin[axis]) * invDir[axis];
+        float tb = (bmax[axis] - origin[axis]) * invDir[axis];
+        if (ta > tb) std::swap(ta, tb);
+        // NaN (ray lying in a slab plane) leaves the interval unchanged
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+}
+
+TerrainRaycaster::TerrainRaycaster(std::shared_ptr<const TerrainSampler> sampler)
+    : m_sampler(std::move(sampler)) {
+    if (!m_sampler || !m_sampler->valid()) return;
+    const int res = m_sampler->resolution();
+    const std::vector<float>& h = m_sampler->normalizedHeights();
+    m_cells = res - 1;
+
+    // Level 0: per-cell range of the four corner texels, which bounds the bilinear patch exactly
+    std::vector<Range> cells(static_cast<size_t>(m_cells) * m_cells);
+    for (int z = 0; z < m_cells; ++z) {
+        const float* row = &h[static_cast<size_t>(z) * res];
+        const float* next = row + res;
+        for (int x = 0; x < m_cells; ++x) {
+            float lo = std::min(std::min(row[x], row[x + 1]), std::min(next[x], next[x + 1]));
+            float hi = std::max(std::max(row[x], row[x + 1]), std::max(next[x], next[x + 1]));
+            cells[static_cast<size_t>(z) * m_cells + x] = {lo, hi};
+        }
+    }
+    m_levelSide.push_back(m_cells);
+    m_levels.push_back(std::move(cells));
+
+    // Each coarser level merges 2x2 nodes (odd sides keep a partial last node) up to one root
+    while (m_levelSide.back() > 1 && static_cast<int>(m_levels.size()) < kMaxLevels) {
+        const int childSide = m_levelSide.back();
+        const int side = (childSide + 1) / 2;
+        const std::vector<Range>& child = m_levels.back();
+        std::vector<Range> level(static_cast<size_t>(side) * side);
+        for (int z = 0; z < side; ++z) {
+            for (int x = 0; x < side; ++x) {
+                Range r{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()};
+                for (int cz = 2 * z; cz < std::min(2 * z + 2, childSide); ++cz) {
+                    for (int cx = 2 * x; cx < std::min(2 * x + 2, childSide); ++cx) {
+                        const Range& c = child[static_cast<size_t>(cz) * childSide + cx];
+                        r.lo = std::min(r.lo, c.lo);
+                        r.hi = std::max(r.hi, c.hi);
+                    }
+                }
+                level[static_cast<size_t>(z) * side + x] = r;
+            }
+        }
+        m_levelSide.push_back(side);
+        m_levels.push_back(std::move(level));
+    }
+}
+
+bool TerrainRaycaster::intersectCell(int cx, int cz, const glm::vec3& origin, const glm::vec3& dir,
+                                     float t0, float t1, float& tHit) const {
+    const int res = m_sampler->resolution();
+    const float* row = &m_sampler->normalizedHeights()[static_cast<size_t>(cz) * res + cx];
+    const float h00 = row[0], h10 = row[1], h01 = row[res], h11 = row[res + 1];
+    // Bilinear patch h(fx, fz) = A + B fx + C fz + D fx fz, with the ray re-based at its cell
+    // entry point so fx / fz stay within [0, 1] and the quadratic below is well conditioned.
+    const float A = h00, B = h10 - h00, C = h01 - h00, D = h00 - h10 - h01 + h11;
+    const float px = glm::clamp(origin.x + dir.x * t0 - (float)cx, 0.0f, 1.0f);
+    const float pz = glm::clamp(origin.z + dir.z * t0 - (float)cz, 0.0f, 1.0f);
+    const float py = origin.y + dir.y * t0;
+
+    // f(s) = ray height - surface height = c0 + c1 s + c2 s^2, s = t - t0
+    const float c0 = py - (A + B * px + C * pz + D * px * pz);
+    const float c1 = dir.y - (B * dir.x + C * dir.z + D * (px * dir.z + pz * dir.x));
+    const float c2 = -D * dir.x * dir.z;
+    if (c0 <= 0.0f) {
+        tHit = t0;
+        return true;
+    }
+    const float len = t1 - t0;
+    float s = std::numeric_limits<float>::max();
+    if (std::abs(c2) < 1e-12f) {
+        if (c1 < 0.0f) s = -c0 / c1;
+    } else {
+        float disc = c1 * c1 - 4.0f * c2 * c0;
+        if (disc >= 0.0f) {
+            // Numerically stable root pair
+            float q = -0.5f * (c1 + std::copysign(std::sqrt(disc), c1));
+            float r1 = q / c2;
+            float r2 = (q != 0.0f) ? c0 / q : r1;
+            if (r1 > r2) std::swap(r1, r2);
+            s = (r1 >= 0.0f) ? r1 : r2;
+            if (s < 0.0f) s = std::numeric_limits<float>::max();
+        }
+    }
+    if (s <= len) {
+        tHit = t0 + s;
+        return true;
+    }
+    // Rounding can lose a grazing root right at the exit edge
+    if (c0 + (c1 + c2 * len) * len <= 0.0f) {
+        tHit = t1;
+        return true;
+    }
+    return false;
+}
+
+bool TerrainRaycaster::castTexelSpace(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& tHit) const {
+    const glm::vec3 invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    // Children are visited near-to-far: the ray is monotone in x and z, so the child on its
+    // entry side in both axes comes first and the first leaf hit is the nearest one.
+    const int flipX = dir.x < 0.0f ? 1 : 0;
+    const int flipZ = dir.z < 0.0f ? 1 : 0;
+
+    struct Node {
+        int level, x, z;
+    };
+    Node stack[4 * kMaxLevels];
+    int top = 0;
+    stack[top++] = {static_cast<int>(m_levels.size()) - 1, 0, 0};
+    while (top > 0) {
+        const Node n = stack[--top];
+        const int span = 1 << n.level;
+        const float x0 = static_cast<float>(n.x * span) - kEdgePad;
+        const float z0 = static_cast<float>(n.z * span) - kEdgePad;
+        const float x1 = static_cast<float>(std::min((n.x + 1) * span, m_cells)) + kEdgePad;
+        const float z1 = static_cast<float>(std::min((n.z + 1) * span, m_cells)) + kEdgePad;
+        const Range& r = m_levels[n.level][static_cast<size_t>(n.z) * m_levelSide[n.level] + n.x];
+
+        // Max culls nodes the ray passes entirely above. Min gives an early accept: if the ray
+        // is below it across the whole node, the nearest such node is where it goes under.
+        float ta = 0.0f, tb = tMax;
+        const float below = std::numeric_limits<float>::lowest();
+        if (!clipBox(origin, invDir, glm::vec3(x0, below, z0), glm::vec3(x1, r.hi, z1), ta, tb)) continue;
+        if (origin.y + dir.y * ta < r.lo && origin.y + dir.y * tb < r.lo) {
+            tHit = ta;
+            return true;
+        }
+        if (n.level == 0) {
+            if (intersectCell(n.x, n.z, origin, dir, ta, tb, tHit)) return true;
+            continue;
+        }
+
+        const int childSide = m_levelSide[n.level - 1];
+        // Push far-to-near so the nearest child is popped first
+        for (int k = 3; k >= 0; --k) {
+            const int cx = 2 * n.x + ((k & 1) ^ flipX);
+            const int cz = 2 * n.z + (((k >> 1) & 1) ^ flipZ);
+            if (cx < childSide && cz < childSide) stack[top++] = {n.level - 1, cx, cz};
+        }
+    }
+    return false;
+}
+
+bool TerrainRaycaster::raycast(const TerrainRay& ray, TerrainRayHit& hit) const {
+    hit = TerrainRayHit();
+    if (m_levels.empty() || m_sampler->heightScale() <= 0.0f || ray.maxDistance < 0.0f) return false;
+    const TerrainSampler& s = *m_sampler;
+    const float half = s.worldSize() * 0.5f;
+    const float texels = s.texelsPerUnit();
+
+    float t = 0.0f;
+    bool found = false;
+    if (std::abs(ray.origin.x) <= half && std::abs(ray.origin.z) <= half
+        && ray.origin.y <= s.height(ray.origin.x, ray.origin.z)) {
+        found = true;  // starts under the surface
+    } else {
+        const glm::vec3 origin((ray.origin.x + half) * texels, ray.origin.y / s.heightScale(), (ray.origin.z + half) * texels);
+        const glm::vec3 dir(ray.direction.x * texels, ray.direction.y / s.heightScale(), ray.direction.z * texels);
+        found = castTexelSpace(origin, dir, ray.maxDistance, t);
+    }
+    if (!found) return false;
+    hit.hit = true;
+    hit.distance = t;
+    hit.position = ray.origin + ray.direction * t;
+    hit.position.y = s.height(hit.position.x, hit.position.z);
+    hit.normal = s.normal(hit.position.x, hit.position.z);
+    return true;
+}
+
+bool TerrainRaycaster::segmentBlocked(const glm::vec3& a, const glm::vec3& b) const {
+    // The segment is the ray a + (b - a) t for t in [0, 1]
+    TerrainRay ray;
+    ray.origin = a;
+    ray.direction = b - a;
+    ray.maxDistance = 1.0f;
+    TerrainRayHit hit;
+    return raycast(ray, hit);
+}
+
+void TerrainRaycaster::raycastBatch(std::span<const TerrainRay> rays, std::span<TerrainRayHit> hits) const {
+    const size_t count = std::min(rays.size(), hits.size());
+    ThreadPool& pool = ThreadPool::shared();
+    if (count <= static_cast<size_t>(kBatchGrain) || pool.concurrency() < 2) {
+        for (size_t i = 0; i < count; ++i) raycast(rays[i], hits[i]);
+        return;
+    }
+    pool.parallelFor(0, static_cast<int>(count), kBatchGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) raycast(rays[i], hits[i]);
+    });
+}
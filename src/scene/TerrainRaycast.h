@@ -0,0 +1,59 @@
+#pragma once
+// Ray / segment queries against the bilinear terrain surface of a TerrainSampler snapshot.
+// A min/max pyramid over the heightmap cells lets a ray skip every quadtree node it passes
+// above (or below) without touching texels; only the leaf cells it can actually cross are
+// solved exactly. Like the snapshot it is built from, a raycaster never changes after
+// construction, so any number of threads may query it at once.
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+class TerrainSampler;
+
+struct TerrainRay {
+    glm::vec3 origin{0.0f};
+    glm::vec3 direction{0.0f, -1.0f, 0.0f};  // need not be normalized; distances are in its units
+    float maxDistance = 1000.0f;
+};
+
+struct TerrainRayHit {
+    bool hit = false;
+    float distance = 0.0f;  // along TerrainRay::direction
+    glm::vec3 position{0.0f};
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+};
+
+class TerrainRaycaster {
+public:
+    explicit TerrainRaycaster(std::shared_ptr<const TerrainSampler> sampler);
+
+    const std::shared_ptr<const TerrainSampler>& sampler() const { return m_sampler; }
+
+    // First crossing of the surface from above, within [0, maxDistance]. A ray starting below
+    // the surface hits at distance 0.
+    bool raycast(const TerrainRay& ray, TerrainRayHit& hit) const;
+    // True when the terrain cuts the straight line from a to b (line of sight between them);
+    // a point under the surface is always blocked
+    bool segmentBlocked(const glm::vec3& a, const glm::vec3& b) const;
+    // raycast() for every ray into the hit at the same index, for the first
+    // min(rays.size(), hits.size()) rays. Large batches are spread over ThreadPool::shared();
+    // results are those of raycast() either way.
+    void raycastBatch(std::span<const TerrainRay> rays, std::span<TerrainRayHit> hits) const;
+
+private:
+    struct Range {
+        float lo;
+        float hi;
+    };
+
+    bool castTexelSpace(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& tHit) const;
+    bool intersectCell(int cx, int cz, const glm::vec3& origin, const glm::vec3& dir,
+                       float t0, float t1, float& tHit) const;
+
+    std::shared_ptr<const TerrainSampler> m_sampler;
+    int m_cells = 0;                       // heightmap cells per side (resolution - 1)
+    std::vector<int> m_levelSide;          // nodes per side at each pyramid level, level 0 = cells
+    std::vector<std::vector<Range>> m_levels;
+};
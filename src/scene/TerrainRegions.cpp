@@ -0,0 +1,118 @@
+#include "TerrainRegions.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "../util/ThreadPool.h"
+
+namespace {
+constexpr int kClassifyGrain = 1024;
+}
+
+int TerrainRegionIndex::Axis::slot(float v) const {
+    // NaN compares false against everything and lands in slot 0, which no region covers
+    const int i = static_cast<int>(std::upper_bound(bounds.begin(), bounds.end(), v) - bounds.begin());
+    if (i > 0 && bounds[i - 1] == v) return 2 * (i - 1) + 1;
+    return 2 * i;
+}
+
+bool TerrainRegionIndex::Axis::covers(int slot, float lo, float hi) const {
+    const int i = slot / 2;
+    if (slot & 1) return lo <= bounds[i] && bounds[i] <= hi;
+    // Open interval (bounds[i-1], bounds[i]): lo and hi are bounds, so it is all in or all out.
+    // The unbounded end slots are never covered.
+    if (i == 0 || i == static_cast<int>(bounds.size())) return false;
+    return lo <= bounds[i - 1] && bounds[i] <= hi;
+}
+
+void TerrainRegionIndex::clear() {
+    m_regions.clear();
+    m_ids.clear();
+    m_x = m_z = m_y = Axis();
+    m_table.clear();
+}
+
+RegionId TerrainRegionIndex::add(const TerrainRegion& region) {
+    if (m_ids.count(region.name)) {
+        std::cerr << "[TerrainRegions] Duplicate region name '" << region.name << "' ignored" << std::endl;
+        return kNone;
+    }
+    if (m_regions.size() >= kNone) {
+        std::cerr << "[TerrainRegions] Too many regions; '" << region.name << "' ignored" << std::endl;
+        return kNone;
+    }
+    const RegionId id = static_cast<RegionId>(m_regions.size());
+    m_regions.push_back(region);
+    m_ids.emplace(region.name, id);
+    return id;
+}
+
+void TerrainRegionIndex::build() {
+    auto collect = [](Axis& axis, std::vector<float> values) {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        axis.bounds = std::move(values);
+    };
+    std::vector<float> xs, zs, ys;
+    for (const TerrainRegion& r : m_regions) {
+        xs.push_back(r.minXZ.x);
+        xs.push_back(r.maxXZ.x);
+        zs.push_back(r.minXZ.y);
+        zs.push_back(r.maxXZ.y);
+        ys.push_back(r.minY);
+        ys.push_back(r.maxY);
+    }
+    collect(m_x, std::move(xs));
+    collect(m_z, std::move(zs));
+    collect(m_y, std::move(ys));
+
+    const int nx = m_x.slotCount(), nz = m_z.slotCount(), ny = m_y.slotCount();
+    m_table.assign(static_cast<size_t>(nx) * nz * ny, kNone);
+    for (int sx = 0; sx < nx; ++sx) {
+        for (int sz = 0; sz < nz; ++sz) {
+            for (int sy = 0; sy < ny; ++sy) {
+                // Latest added region wins, matching the old reverse linear scan
+                for (int i = static_cast<int>(m_regions.size()) - 1; i >= 0; --i) {
+                    const TerrainRegion& r = m_regions[i];
+                    if (m_x.covers(sx, r.minXZ.x, r.maxXZ.x) && m_z.covers(sz, r.minXZ.y, r.maxXZ.y)
+                        && m_y.covers(sy, r.minY, r.maxY)) {
+                        m_table[(static_cast<size_t>(sx) * nz + sz) * ny + sy] = static_cast<RegionId>(i);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+RegionId TerrainRegionIndex::at(const glm::vec3& pos) const {
+    if (m_table.empty()) return kNone;
+    const size_t sx = static_cast<size_t>(m_x.slot(pos.x));
+    const size_t sz = static_cast<size_t>(m_z.slot(pos.z));
+    const size_t sy = static_cast<size_t>(m_y.slot(pos.y));
+    return m_table[(sx * m_z.slotCount() + sz) * m_y.slotCount() + sy];
+}
+
+void TerrainRegionIndex::classify(const glm::vec3* positions, RegionId* out, size_t count) const {
+    if (count <= static_cast<size_t>(kClassifyGrain)) {
+        for (size_t i = 0; i < count; ++i) out[i] = at(positions[i]);
+        return;
+    }
+    ThreadPool::shared().parallelFor(0, static_cast<int>(count), kClassifyGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) out[i] = at(positions[i]);
+    });
+}
+
+RegionId TerrainRegionIndex::find(const std::string& name) const {
+    auto it = m_ids.find(name);
+    return it != m_ids.end() ? it->second : kNone;
+}
+
+const std::string& TerrainRegionIndex::name(RegionId id) const {
+    static const std::string unknown = "unknown";
+    return id < m_regions.size() ? m_regions[id].name : unknown;
+}
+
+const TerrainRegion* TerrainRegionIndex::region(RegionId id) const {
+    return id < m_regions.size() ? &m_regions[id] : nullptr;
+}
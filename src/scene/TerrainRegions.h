@@ -0,0 +1,63 @@
+#pragma once
+// Named, axis-aligned terrain regions (beach, grassland, spawn area, ...) compiled into an
+// interval index for per-frame classification. Names are interned: every region gets a
+// compact RegionId when added, and queries return ids rather than strings.
+//
+// build() splits each axis at the distinct region bounds. Every bound is its own slot and so
+// is every open interval between two bounds, which keeps the inclusive box test exact; the
+// winning region for each (x, z, y) slot is precomputed, so a lookup is three short binary
+// searches and one table read. The table grows with the product of distinct bounds per axis,
+// which is meant for tens of regions, not thousands.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct TerrainRegion {
+    std::string name;
+    glm::vec2 minXZ;  // Minimum X,Z bounds
+    glm::vec2 maxXZ;  // Maximum X,Z bounds
+    float minY;       // Minimum Y (height)
+    float maxY;       // Maximum Y (height)
+    std::string description;
+};
+
+using RegionId = uint16_t;
+
+class TerrainRegionIndex {
+public:
+    static constexpr RegionId kNone = 0xFFFF;
+
+    void clear();
+    // Regions added later take priority where they overlap earlier ones. Returns kNone (and
+    // adds nothing) for a name that is already taken. Call build() after the last add().
+    RegionId add(const TerrainRegion& region);
+    void build();
+
+    // Innermost region containing pos (bounds inclusive), or kNone
+    RegionId at(const glm::vec3& pos) const;
+    // at() for many positions; large batches are split across the shared ThreadPool
+    void classify(const glm::vec3* positions, RegionId* out, size_t count) const;
+
+    RegionId find(const std::string& name) const;
+    const std::string& name(RegionId id) const;  // "unknown" for kNone
+    const TerrainRegion* region(RegionId id) const;
+    const std::vector<TerrainRegion>& regions() const { return m_regions; }
+    size_t size() const { return m_regions.size(); }
+
+private:
+    // Sorted distinct bounds; slot 2i is the open interval below bounds[i], slot 2i+1 is bounds[i]
+    struct Axis {
+        std::vector<float> bounds;
+        int slotCount() const { return static_cast<int>(bounds.size()) * 2 + 1; }
+        int slot(float v) const;
+        bool covers(int slot, float lo, float hi) const;
+    };
+
+    std::vector<TerrainRegion> m_regions;
+    std::unordered_map<std::string, RegionId> m_ids;
+    Axis m_x, m_z, m_y;
+    std::vector<RegionId> m_table;  // [x slot][z slot][y slot]
+};
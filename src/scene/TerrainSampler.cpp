@@ -1,16 +1,181 @@
 #include "TerrainSampler.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "Terrain.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TERRAIN_SAMPLER_SSE2 1
+#endif
+
 namespace {
 Terrain* g_activeTerrain = nullptr;
 }
 
+TerrainSampler::TerrainSampler(std::vector<float> heights, int resolution, float worldSize, float heightScale)
+    : m_heights(std::move(heights)), m_resolution(resolution), m_worldSize(worldSize), m_heightScale(heightScale) {
+    if (m_resolution < 2 || m_heights.size() < static_cast<size_t>(m_resolution) * m_resolution) {
+        m_heights.clear();
+        m_resolution = 0;
+        return;
+    }
+    m_half = m_worldSize / 2.0f;
+    m_invStep = (m_resolution - 1) / m_worldSize;
+}
+
+float TerrainSampler::heightNearest(float x, float z) const {
+    if (!valid()) return 0.0f;
+    // Same addressing as Terrain::getHeight
+    float u = (x + m_half) / m_worldSize;
+    float v = (z + m_half) / m_worldSize;
+    if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f) return 0.0f;
+    int ix = std::min((int)(u * (m_resolution - 1)), m_resolution - 1);
+    int iz = std::min((int)(v * (m_resolution - 1)), m_resolution - 1);
+    return m_heights[static_cast<size_t>(iz) * m_resolution + ix] * m_heightScale;
+}
+
+namespace {
+// Bilinear cell lookup shared by the scalar and batch paths. The batch path computes the same
+// t / index / fraction values four lanes at a time, so both agree bit for bit.
+struct Cell {
+    float h00, h10, h01, h11;
+    float fx, fz;
+};
+
+inline bool lookupCell(const std::vector<float>& heights, int resolution, float half, float invStep,
+                       float x, float z, Cell& c) {
+    float tx = (x + half) * invStep;
+    float tz = (z + half) * invStep;
+    const float maxT = static_cast<float>(resolution - 1);
+    if (!(tx >= 0.0f && tx <= maxT && tz >= 0.0f && tz <= maxT)) return false;
+    int ix = std::min((int)tx, resolution - 2);
+    int iz = std::min((int)tz, resolution - 2);
+    c.fx = tx - (float)ix;
+    c.fz = tz - (float)iz;
+    const float* row = &heights[static_cast<size_t>(iz) * resolution + ix];
+    c.h00 = row[0];
+    c.h10 = row[1];
+    c.h01 = row[resolution];
+    c.h11 = row[resolution + 1];
+    return true;
+}
+
+inline float blendHeight(const Cell& c) {
+    float top = c.h00 + (c.h10 - c.h00) * c.fx;
+    float bottom = c.h01 + (c.h11 - c.h01) * c.fx;
+    return top + (bottom - top) * c.fz;
+}
+
+// d/dx and d/dz of blendHeight in texel units
+inline glm::vec2 blendGradient(const Cell& c) {
+    float ddx = (c.h10 - c.h00) + ((c.h11 - c.h01) - (c.h10 - c.h00)) * c.fz;
+    float ddz = (c.h01 - c.h00) + ((c.h11 - c.h10) - (c.h01 - c.h00)) * c.fx;
+    return glm::vec2(ddx, ddz);
+}
+}
+
+float TerrainSampler::height(float x, float z) const {
+    Cell c;
+    if (!valid() || !lookupCell(m_heights, m_resolution, m_half, m_invStep, x, z, c)) return 0.0f;
+    return blendHeight(c) * m_heightScale;
+}
+
+float TerrainSampler::heightAndGradient(float x, float z, glm::vec2& gradient) const {
+    Cell c;
+    if (!valid() || !lookupCell(m_heights, m_resolution, m_half, m_invStep, x, z, c)) {
+        gradient = glm::vec2(0.0f);
+        return 0.0f;
+    }
+    gradient = blendGradient(c) * (m_heightScale * m_invStep);
+    return blendHeight(c) * m_heightScale;
+}
+
+glm::vec3 TerrainSampler::normal(float x, float z) const {
+    glm::vec2 g;
+    heightAndGradient(x, z, g);
+    return glm::normalize(glm::vec3(-g.x, 1.0f, -g.y));
+}
+
+void TerrainSampler::heights(const float* xs, const float* zs, float* out, size_t count) const {
+    if (!valid()) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+    size_t i = 0;
+#ifdef TERRAIN_SAMPLER_SSE2
+    // Four points per step: texel coordinates, bounds mask and blend weights in SSE registers,
+    // the four corner fetches per point stay scalar (SSE2 has no gather).
+    const __m128 half = _mm_set1_ps(m_half);
+    const __m128 invStep = _mm_set1_ps(m_invStep);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxT = _mm_set1_ps(static_cast<float>(m_resolution - 1));
+    const __m128i maxCell = _mm_set1_epi32(m_resolution - 2);
+    const __m128 scale = _mm_set1_ps(m_heightScale);
+    const float* heights = m_heights.data();
+    for (; i + 4 <= count; i += 4) {
+        __m128 tx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(xs + i), half), invStep);
+        __m128 tz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(zs + i), half), invStep);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(tx, zero), _mm_cmple_ps(tx, maxT)),
+                                   _mm_and_ps(_mm_cmpge_ps(tz, zero), _mm_cmple_ps(tz, maxT)));
+        // Clamp outside lanes into range so their (discarded) fetches stay in bounds.
+        __m128 ctx = _mm_and_ps(inside, tx);
+        __m128 ctz = _mm_and_ps(inside, tz);
+        __m128i ix = _mm_cvttps_epi32(ctx);
+        __m128i iz = _mm_cvttps_epi32(ctz);
+        // min(i, res - 2) without SSE4.1 pminsd
+        __m128i overX = _mm_cmpgt_epi32(ix, maxCell);
+        __m128i overZ = _mm_cmpgt_epi32(iz, maxCell);
+        ix = _mm_or_si128(_mm_andnot_si128(overX, ix), _mm_and_si128(overX, maxCell));
+        iz = _mm_or_si128(_mm_andnot_si128(overZ, iz), _mm_and_si128(overZ, maxCell));
+        __m128 fx = _mm_sub_ps(ctx, _mm_cvtepi32_ps(ix));
+        __m128 fz = _mm_sub_ps(ctz, _mm_cvtepi32_ps(iz));
+
+        alignas(16) int ixs[4], izs[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+        _mm_store_si128(reinterpret_cast<__m128i*>(izs), iz);
+        alignas(16) float h00[4], h10[4], h01[4], h11[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const float* row = heights + static_cast<size_t>(izs[lane]) * m_resolution + ixs[lane];
+            h00[lane] = row[0];
+            h10[lane] = row[1];
+            h01[lane] = row[m_resolution];
+            h11[lane] = row[m_resolution + 1];
+        }
+        __m128 a = _mm_load_ps(h00), b = _mm_load_ps(h10), c = _mm_load_ps(h01), d = _mm_load_ps(h11);
+        __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fx));
+        __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), fx));
+        __m128 h = _mm_mul_ps(_mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fz)), scale);
+        _mm_storeu_ps(out + i, _mm_and_ps(inside, h));
+    }
+#endif
+    for (; i < count; ++i) out[i] = height(xs[i], zs[i]);
+}
+
+void TerrainSampler::heightsAndNormals(const float* xs, const float* zs, float* outHeights, glm::vec3* outNormals,
+                                       size_t count) const {
+    // Normals are consumed as vec3 and need a normalize each, so this stays a scalar loop; it
+    // still does one cell lookup per point for both outputs.
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec2 g;
+        outHeights[i] = heightAndGradient(xs[i], zs[i], g);
+        outNormals[i] = glm::normalize(glm::vec3(-g.x, 1.0f, -g.y));
+    }
+}
+
 void setActiveTerrain(Terrain* terrain){
     g_activeTerrain = terrain;
 }
 
 float getTerrainHeightAt(float worldX, float worldZ){
     if(!g_activeTerrain) return 0.0f;
-    return g_activeTerrain->getHeight(worldX, worldZ);
+    // Streamed terrain keeps full detail only in resident pages; the snapshot holds the overview.
+    if(g_activeTerrain->streaming()) return g_activeTerrain->getHeight(worldX, worldZ);
+    return g_activeTerrain->sampler()->height(worldX, worldZ);
+}
+
+std::shared_ptr<const TerrainSampler> activeTerrainSampler(){
+    if(!g_activeTerrain) return std::make_shared<const TerrainSampler>();
+    return g_activeTerrain->sampler();
 }
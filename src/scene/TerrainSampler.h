@@ -1,8 +1,54 @@
 #pragma once
 // Helper to expose a global terrain height query for gameplay systems. Game
 // sets the active terrain, then callers can invoke getTerrainHeightAt.
+//
+// TerrainSampler is an immutable snapshot of a heightmap for CPU queries: bilinear heights,
+// the analytic gradient / normal of that bilinear surface, and SIMD batch variants. Snapshots
+// are shared by pointer and never change, so worker threads can query them concurrently while
+// the main thread edits the live Terrain (which then hands out a new snapshot).
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
 
 class Terrain;
 
+class TerrainSampler {
+public:
+    TerrainSampler() = default;
+    // heights: normalized resolution x resolution lattice spanning worldSize, centered on the origin.
+    TerrainSampler(std::vector<float> heights, int resolution, float worldSize, float heightScale);
+
+    bool valid() const { return m_resolution >= 2; }
+    int resolution() const { return m_resolution; }
+    float worldSize() const { return m_worldSize; }
+    float heightScale() const { return m_heightScale; }
+    // Texel lattice access for structures built on top of a snapshot (e.g. TerrainRaycaster)
+    const std::vector<float>& normalizedHeights() const { return m_heights; }
+    float texelsPerUnit() const { return m_invStep; }
+
+    // All heights are in world units and 0 outside the map, like Terrain::getHeight.
+    float heightNearest(float x, float z) const;
+    float height(float x, float z) const;
+    // Height plus (dh/dx, dh/dz) of the bilinear surface at the same point.
+    float heightAndGradient(float x, float z, glm::vec2& gradient) const;
+    glm::vec3 normal(float x, float z) const;
+
+    // Batch forms; results are identical to the single-point calls.
+    void heights(const float* xs, const float* zs, float* out, size_t count) const;
+    void heightsAndNormals(const float* xs, const float* zs, float* outHeights, glm::vec3* outNormals, size_t count) const;
+
+private:
+    std::vector<float> m_heights;
+    int m_resolution = 0;
+    float m_worldSize = 0.0f;
+    float m_heightScale = 0.0f;
+    float m_half = 0.0f;
+    float m_invStep = 0.0f;  // texels per world unit
+};
+
 void setActiveTerrain(Terrain* terrain);
 float getTerrainHeightAt(float worldX, float worldZ);
+// Snapshot of the active terrain (empty sampler when none is set). Main thread only; pass the
+// returned pointer to workers.
+std::shared_ptr<const TerrainSampler> activeTerrainSampler();
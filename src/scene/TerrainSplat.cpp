@@ -0,0 +1,75 @@
+#include "TerrainSplat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "../util/ThreadPool.h"
+
+namespace {
+constexpr int kSplatRowsPerTask = 8;
+
+float smoothstep(float edge0, float edge1, float x) {
+    float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+unsigned char toUnorm8(float v) {
+    return static_cast<unsigned char>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+// GL_LINEAR + GL_CLAMP_TO_EDGE lookup at texel-space coordinate (tx, tz)
+float filteredHeight(const std::vector<float>& heights, int res, float tx, float tz) {
+    tx = std::clamp(tx, 0.0f, static_cast<float>(res - 1));
+    tz = std::clamp(tz, 0.0f, static_cast<float>(res - 1));
+    const int ix = std::min(static_cast<int>(tx), res - 2);
+    const int iz = std::min(static_cast<int>(tz), res - 2);
+    const float fx = tx - ix, fz = tz - iz;
+    const float* row = &heights[static_cast<size_t>(iz) * res + ix];
+    const float top = row[0] + (row[1] - row[0]) * fx;
+    const float bottom = row[res] + (row[res + 1] - row[res]) * fx;
+    return top + (bottom - top) * fz;
+}
+}
+
+void bakeTerrainSplat(const std::vector<float>& heights, int res, int side, const TerrainSplatSettings& s,
+                      int x0, int z0, int x1, int z1, unsigned char* rgba) {
+    if (res < 2 || side <= 0 || heights.size() < static_cast<size_t>(res) * res) return;
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, side - 1);
+    z1 = std::min(z1, side - 1);
+    if (x1 < x0 || z1 < z0) return;
+
+    const float texelScale = static_cast<float>(res) / static_cast<float>(side);
+    auto bakeRows = [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            const float tz = (z + 0.5f) * texelScale - 0.5f;
+            unsigned char* out = rgba + (static_cast<size_t>(z) * side + x0) * 4;
+            for (int x = x0; x <= x1; ++x, out += 4) {
+                const float h = filteredHeight(heights, res, (x + 0.5f) * texelScale - 0.5f, tz);
+                float fungus = 0.0f, sand = 0.0f, rock = 0.0f;
+                if (h <= s.fungusEnd) {
+                    fungus = 1.0f;
+                } else if (h <= s.sandStart) {
+                    sand = smoothstep(s.fungusEnd, s.sandStart, h);
+                    fungus = 1.0f - sand;
+                } else if (h <= s.sandEnd) {
+                    sand = 1.0f;
+                } else if (h <= s.rockStart) {
+                    rock = smoothstep(s.sandEnd, s.rockStart, h);
+                    sand = 1.0f - rock;
+                } else {
+                    rock = 1.0f;
+                }
+                const float tint = smoothstep(s.tintStart, s.tintEnd, h);
+                const float textured = s.textureWeight * (1.0f - tint);
+                out[0] = toUnorm8(fungus * textured);
+                out[1] = toUnorm8(sand * textured);
+                out[2] = toUnorm8(rock * textured);
+                out[3] = toUnorm8(tint);
+            }
+        }
+    };
+    ThreadPool::shared().parallelFor(z0, z1 + 1, kSplatRowsPerTask, bakeRows);
+}
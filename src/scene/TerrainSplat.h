@@ -0,0 +1,27 @@
+#pragma once
+// Biome weights for the terrain fragment shader, baked on the CPU into an RGBA8 splat map.
+// R, G and B are the fungus, sand-grass and rock texture weights, already scaled by the
+// texture influence; A is the high-altitude light-brown tint. Whatever weight is left
+// (1 - R - G - B - A) goes to the slope-shaded grass base, which stays per pixel because it
+// follows the detail-perturbed normal.
+#include <vector>
+
+struct TerrainSplatSettings {
+    int oversample = 2;  // splat texels per heightmap texel along each axis
+    // Normalized-height bands: fungus up to fungusEnd, blend to sand-grass by sandStart,
+    // sand-grass up to sandEnd, blend to rock by rockStart, rock above
+    float fungusEnd = 0.15f;
+    float sandStart = 0.30f;
+    float sandEnd = 0.60f;
+    float rockStart = 0.85f;
+    float textureWeight = 0.8f;  // biome textures vs. the grass base
+    float tintStart = 0.6f;      // light-brown tint fades in over [tintStart, tintEnd]
+    float tintEnd = 0.95f;
+};
+
+// Fills splat texels [x0, x1] x [z0, z1] of a side x side RGBA8 map (rgba holds the whole
+// map) from res x res normalized heights. Each texel uses the height GL's bilinear filter
+// returns at that texel's centre, so the map matches what sampling the height texture at
+// the same UV gave the shader. Rows are spread over the shared ThreadPool.
+void bakeTerrainSplat(const std::vector<float>& heights, int res, int side, const TerrainSplatSettings& settings,
+                      int x0, int z0, int x1, int z1, unsigned char* rgba);
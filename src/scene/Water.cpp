@@ -2,57 +2,104 @@
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include "../render/GridMeshCache.h"
+#include "../render/Shader.h"
+
+namespace {
+// Largest chunk edge in quads; 128 quads = 129^2 vertices, comfortably 16-bit
+constexpr int kMaxChunkQuads = 128;
+// Projected grid spans this much more than the screen in NDC, so wave displacement near the
+// screen edges never pulls the surface inside the view
+constexpr float kProjectorMargin = 1.15f;
+}
 
 Water::Water() {}
 
 Water::~Water() {
-    delete m_mesh;
+    release();
+}
+
+void Water::release() {
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+    m_vao = 0;
+    m_widthQuads = m_chunkQuads = m_chunksPerSide = 0;
+    m_grid = nullptr;  // owned by GridMeshCache
+    m_chunkCounts.clear();
+    m_chunkOffsets.clear();
+    m_chunkBaseVertices.clear();
 }
 
 void Water::generate(int widthQuads, float worldSize, float height) {
     buildMesh(widthQuads, worldSize, height);
+    m_projected = false;
+}
+
+void Water::generateProjected(int gridQuads, float worldSize, float height, float horizon, bool bounded) {
+    buildMesh(gridQuads, worldSize, height);
+    m_projected = true;
+    m_bounded = bounded;
+    m_horizon = horizon;
 }
 
 void Water::buildMesh(int widthQuads, float worldSize, float height) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-
-    float step = worldSize / (float)widthQuads;
-    float offset = worldSize / 2.0f;
-
-    // Generate vertices
-    for (int z = 0; z <= widthQuads; ++z) {
-        for (int x = 0; x <= widthQuads; ++x) {
-            Vertex v;
-            // Flat grid on XZ plane at height, centered
-            v.position = glm::vec3(x * step - offset, height, z * step - offset);
-            v.normal = glm::vec3(0.0f, 1.0f, 0.0f);
-            v.uv = glm::vec2((float)x / widthQuads, (float)z / widthQuads);
-            vertices.push_back(v);
-        }
+    release();
+    if (widthQuads <= 0) return;
+
+    // Fewest chunks that divide the plane evenly and stay within kMaxChunkQuads
+    int chunksPerSide = (widthQuads + kMaxChunkQuads - 1) / kMaxChunkQuads;
+    while (widthQuads % chunksPerSide != 0) ++chunksPerSide;
+    const int chunkQuads = widthQuads / chunksPerSide;
+    const int chunkSide = chunkQuads + 1;
+
+    m_widthQuads = widthQuads;
+    m_chunkQuads = chunkQuads;
+    m_chunksPerSide = chunksPerSide;
+    m_worldSize = worldSize;
+    m_height = height;
+
+    // Chunks are numbered row-major and own a contiguous block of chunkSide^2 vertex ids;
+    // neighbouring chunks repeat their shared edge, as a stored vertex buffer would.
+    const int chunkCount = chunksPerSide * chunksPerSide;
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        m_chunkBaseVertices.push_back(static_cast<GLint>(chunk * chunkSide * chunkSide));
     }
 
-    // Generate indices (same as terrain)
-    for (int z = 0; z < widthQuads; ++z) {
-        for (int x = 0; x < widthQuads; ++x) {
-            int topLeft = z * (widthQuads + 1) + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * (widthQuads + 1) + x;
-            int bottomRight = bottomLeft + 1;
-
-            // Triangle 1: TL -> TR -> BL
-            indices.push_back(topLeft);
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-
-            // Triangle 2: TR -> BR -> BL
-            indices.push_back(topRight);
-            indices.push_back(bottomRight);
-            indices.push_back(bottomLeft);
-        }
+    m_grid = &GridMeshCache::shared().strips(chunkQuads);
+    m_chunkCounts.assign(m_chunkBaseVertices.size(), m_grid->count);
+    m_chunkOffsets.assign(m_chunkBaseVertices.size(), nullptr);
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_grid->buffer);
+    glBindVertexArray(0);
+
+    std::cout << "[Water] " << chunksPerSide << "x" << chunksPerSide << " chunks of " << chunkQuads << "x"
+              << chunkQuads << " quads, " << chunkCount * chunkSide * chunkSide
+              << " vertices (attribute-less)" << std::endl;
+}
+
+void Water::setUniforms(Shader& shader, const glm::mat4& viewProj) const {
+    shader.setInt("uWaterQuads", m_widthQuads);
+    shader.setInt("uWaterChunkQuads", m_chunkQuads);
+    shader.setInt("uWaterChunksPerSide", m_chunksPerSide);
+    shader.setFloat("uWaterExtent", m_worldSize);
+    shader.setFloat("uWaterLevel", m_height);
+    shader.setBool("uWaterProjected", m_projected);
+    if (m_projected) {
+        shader.setMat4("uWaterInvViewProj", glm::inverse(viewProj));
+        shader.setFloat("uWaterHorizon", m_horizon);
+        shader.setFloat("uWaterMargin", kProjectorMargin);
+        shader.setBool("uWaterBounded", m_bounded);
     }
+}
 
-    if (m_mesh) delete m_mesh;
-    m_mesh = new Mesh();
-    m_mesh->setData(vertices, indices);
-}
\ No newline at end of file
+void Water::draw() const {
+    if (!m_vao || !m_grid) return;
+    glBindVertexArray(m_vao);
+    glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLE_STRIP, m_chunkCounts.data(), m_grid->indexType,
+                                  m_chunkOffsets.data(), static_cast<GLsizei>(m_chunkCounts.size()),
+                                  m_chunkBaseVertices.data());
+    glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    glBindVertexArray(0);
+}
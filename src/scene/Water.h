@@ -2,7 +2,9 @@
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "../render/Mesh.h"
+
+struct GridIndexBuffer;
+class Shader;
 
 class Water {
 public:
@@ -14,11 +16,41 @@ public:
     // worldSize: total size in world units
     // height: water level
     void generate(int widthQuads, float worldSize, float height);
+    // Camera-projected grid (LOD mode): a gridQuads x gridQuads grid spanning the screen is
+    // cast onto the water plane every frame, so vertex density follows screen-space need and
+    // the cost does not grow with the water area. Rays that miss the plane, or hit it beyond
+    // horizon, end at horizon distance. bounded clamps the surface to the worldSize square;
+    // otherwise it reaches the horizon and worldSize only sets the wave texture tiling.
+    void generateProjected(int gridQuads, float worldSize, float height, float horizon, bool bounded = true);
+    bool projected() const { return m_projected; }
+
+    // Grid layout for the attribute-less vertex shader: uWaterQuads, uWaterChunkQuads,
+    // uWaterChunksPerSide, uWaterExtent and uWaterLevel, plus the projector (uWaterProjected,
+    // uWaterInvViewProj, ...) in projected mode. Call with the water shader bound.
+    void setUniforms(Shader& shader, const glm::mat4& viewProj) const;
 
-    Mesh* mesh() const { return m_mesh; }
+    // Draws every chunk with the bound shader. There are no vertex attributes: each vertex
+    // is identified by gl_VertexID, which includes the chunk's base vertex.
+    void draw() const;
 
 private:
     void buildMesh(int widthQuads, float worldSize, float height);
+    void release();
 
-    Mesh* m_mesh = nullptr;
-};
\ No newline at end of file
+    // The plane is split into chunksPerSide^2 square chunks small enough for 16-bit indices;
+    // all chunks share one GridMeshCache strip buffer and differ only in their base vertex.
+    // The VAO holds nothing but that element buffer.
+    GLuint m_vao = 0;
+    int m_widthQuads = 0;
+    int m_chunkQuads = 0;
+    int m_chunksPerSide = 0;
+    float m_worldSize = 0.0f;
+    float m_height = 0.0f;
+    bool m_projected = false;
+    bool m_bounded = true;
+    float m_horizon = 0.0f;
+    const GridIndexBuffer* m_grid = nullptr;
+    std::vector<GLsizei> m_chunkCounts;
+    std::vector<const void*> m_chunkOffsets;
+    std::vector<GLint> m_chunkBaseVertices;
+};
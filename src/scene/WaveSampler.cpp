@@ -0,0 +1,276 @@
+#include "WaveSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+
+#include "OceanSpectrum.h"
+#include "ShoreDistanceField.h"
+#include "TerrainSampler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WAVE_SAMPLER_SSE2 1
+#endif
+
+namespace {
+float toHalf(float v) {
+    return glm::unpackHalf1x16(glm::packHalf1x16(v));
+}
+
+// GL_LINEAR + GL_REPEAT at texture coordinate (u, v)
+float sampleRepeat(const float* texels, int size, float u, float v) {
+    const float tx = u * static_cast<float>(size) - 0.5f;
+    const float tz = v * static_cast<float>(size) - 0.5f;
+    const float x0 = std::floor(tx), z0 = std::floor(tz);
+    const float fx = tx - x0, fz = tz - z0;
+    int ix = static_cast<int>(x0) % size, iz = static_cast<int>(z0) % size;
+    if (ix < 0) ix += size;
+    if (iz < 0) iz += size;
+    const int ix1 = ix + 1 == size ? 0 : ix + 1;
+    const int iz1 = iz + 1 == size ? 0 : iz + 1;
+    const float* row = texels + static_cast<size_t>(iz) * size;
+    const float* next = texels + static_cast<size_t>(iz1) * size;
+    const float top = row[ix] + (row[ix1] - row[ix]) * fx;
+    const float bottom = next[ix] + (next[ix1] - next[ix]) * fx;
+    return top + (bottom - top) * fz;
+}
+
+// GL_LINEAR + GL_CLAMP_TO_EDGE at texture coordinate (u, v)
+float sampleClamp(const float* texels, int res, float u, float v) {
+    const float maxT = static_cast<float>(res - 1);
+    const float tx = std::clamp(u * static_cast<float>(res) - 0.5f, 0.0f, maxT);
+    const float tz = std::clamp(v * static_cast<float>(res) - 0.5f, 0.0f, maxT);
+    const int ix = std::min(static_cast<int>(tx), res - 2);
+    const int iz = std::min(static_cast<int>(tz), res - 2);
+    const float fx = tx - static_cast<float>(ix), fz = tz - static_cast<float>(iz);
+    const float* row = texels + static_cast<size_t>(iz) * res + ix;
+    const float top = row[0] + (row[1] - row[0]) * fx;
+    const float bottom = row[res] + (row[res + 1] - row[res]) * fx;
+    return top + (bottom - top) * fz;
+}
+
+// GLSL smoothstep(0, 1, x)
+float smooth01(float x) {
+    const float t = std::clamp(x, 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+}
+
+WaveSampler::WaveSampler(const std::vector<float>& layer0, const std::vector<float>& layer1, int size,
+                         const WaveSettings& settings, float waterLevel, float extent)
+    : m_settings(settings), m_waterLevel(waterLevel) {
+    const size_t count = static_cast<size_t>(size) * size;
+    if (size < 2 || extent <= 0.0f || layer0.size() < count || layer1.size() < count) return;
+    auto layers = std::make_shared<Layers>();
+    layers->size = size;
+    layers->powerOfTwo = (size & (size - 1)) == 0;
+    layers->wave0.resize(count);
+    layers->wave1.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        layers->wave0[i] = toHalf(layer0[i]);
+        layers->wave1[i] = toHalf(layer1[i]);
+    }
+    m_layers = std::move(layers);
+    m_invExtent = 1.0f / extent;
+}
+
+std::shared_ptr<const WaveSampler> WaveSampler::withShore(std::shared_ptr<const ShoreDistanceField> shore) const {
+    auto sampler = std::make_shared<WaveSampler>(*this);
+    sampler->m_shore.reset();
+    if (shore && shore->valid()) {
+        auto data = std::make_shared<Shore>();
+        const std::vector<float>& texels = shore->texels();
+        data->res = shore->resolution();
+        // The field is lattice-aligned (see shoreFieldUV in the water shader): the terrain span covers
+        // the first to last texel centers, i.e. u = (x / world + 0.5) * (n - 1) / n + 0.5 / n
+        const float res = static_cast<float>(data->res);
+        data->invWorld = (res - 1.0f) / (res * shore->terrain()->worldSize());
+        data->distance.resize(texels.size() / 2);
+        for (size_t i = 0; i < data->distance.size(); ++i) data->distance[i] = toHalf(texels[i * 2]);
+        sampler->m_waterLevel = shore->waterLevel();  // the field is rebaked whenever the level moves
+        data->field = std::move(shore);
+        sampler->m_shore = std::move(data);
+    }
+    return sampler;
+}
+
+std::shared_ptr<const WaveSampler> WaveSampler::withOcean(std::shared_ptr<const OceanFrame> frame, float patchSize) const {
+    auto sampler = std::make_shared<WaveSampler>(*this);
+    const bool usable = frame && frame->size > 0 && patchSize > 0.0f;
+    sampler->m_ocean = usable ? std::move(frame) : nullptr;
+    sampler->m_oceanPatch = usable ? patchSize : 0.0f;
+    return sampler;
+}
+
+float WaveSampler::displacement(float x, float z, float time) const {
+    if (!m_layers) return 0.0f;
+    const WaveSettings& s = m_settings;
+    const Layers& l = *m_layers;
+    const float u = x * m_invExtent + 0.5f;
+    const float v = z * m_invExtent + 0.5f;
+    const glm::vec2 off0 = s.layer0Speed * time;
+    const glm::vec2 off1 = s.layer1Speed * time;
+    const float h0 = sampleRepeat(l.wave0.data(), l.size, u * s.layer0Tiling + off0.x, v * s.layer0Tiling + off0.y) * s.layer0Strength;
+    const float h1 = sampleRepeat(l.wave1.data(), l.size, u * s.layer1Tiling + off1.x, v * s.layer1Tiling + off1.y) * s.layer1Strength;
+    const float blend = smooth01((h0 - h1) * (s.blendSharpness * 0.5f) + 0.5f);
+    float height = (h0 + (h1 - h0) * blend) * s.gain;
+    float shoreScale = 1.0f;
+    if (m_shore) {
+        const Shore& sh = *m_shore;
+        const float shore = sampleClamp(sh.distance.data(), sh.res, x * sh.invWorld + 0.5f, z * sh.invWorld + 0.5f);
+        shoreScale = s.shoreMinScale + (1.0f - s.shoreMinScale) * smooth01(shore / s.shoreFade);
+        height *= shoreScale;
+    }
+    if (m_ocean) {
+        // pos += textureLod(uOceanDisplacement, xz / uOceanPatchSize).xyz * (uOceanStrength * shoreScale)
+        const float detail = m_ocean->sample(x / m_oceanPatch, z / m_oceanPatch).y;
+        height += detail * (s.oceanStrength * shoreScale);
+    }
+    return height;
+}
+
+#ifdef WAVE_SAMPLER_SSE2
+namespace {
+inline __m128 floorPs(__m128 x) {
+    // Truncate, then step down where truncation rounded a negative value up
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+inline __m128 smooth01Ps(__m128 x) {
+    __m128 t = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), t)));
+}
+
+// sampleRepeat() for four points of a power-of-two texture; fetches stay scalar (no gather)
+inline __m128 sampleRepeatPs(const float* texels, int size, __m128 u, __m128 v) {
+    const __m128 sizeF = _mm_set1_ps(static_cast<float>(size));
+    const __m128 halfTexel = _mm_set1_ps(0.5f);
+    const __m128 tx = _mm_sub_ps(_mm_mul_ps(u, sizeF), halfTexel);
+    const __m128 tz = _mm_sub_ps(_mm_mul_ps(v, sizeF), halfTexel);
+    const __m128 x0 = floorPs(tx), z0 = floorPs(tz);
+    const __m128 fx = _mm_sub_ps(tx, x0), fz = _mm_sub_ps(tz, z0);
+    const __m128i mask = _mm_set1_epi32(size - 1);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i ix = _mm_and_si128(_mm_cvttps_epi32(x0), mask);
+    const __m128i iz = _mm_and_si128(_mm_cvttps_epi32(z0), mask);
+    const __m128i ix1 = _mm_and_si128(_mm_add_epi32(ix, one), mask);
+    const __m128i iz1 = _mm_and_si128(_mm_add_epi32(iz, one), mask);
+    alignas(16) int x0s[4], x1s[4], z0s[4], z1s[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(x0s), ix);
+    _mm_store_si128(reinterpret_cast<__m128i*>(x1s), ix1);
+    _mm_store_si128(reinterpret_cast<__m128i*>(z0s), iz);
+    _mm_store_si128(reinterpret_cast<__m128i*>(z1s), iz1);
+    alignas(16) float a[4], b[4], c[4], d[4];
+    for (int lane = 0; lane < 4; ++lane) {
+        const float* row = texels + static_cast<size_t>(z0s[lane]) * size;
+        const float* next = texels + static_cast<size_t>(z1s[lane]) * size;
+        a[lane] = row[x0s[lane]];
+        b[lane] = row[x1s[lane]];
+        c[lane] = next[x0s[lane]];
+        d[lane] = next[x1s[lane]];
+    }
+    const __m128 va = _mm_load_ps(a), vb = _mm_load_ps(b), vc = _mm_load_ps(c), vd = _mm_load_ps(d);
+    const __m128 top = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), fx));
+    const __m128 bottom = _mm_add_ps(vc, _mm_mul_ps(_mm_sub_ps(vd, vc), fx));
+    return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fz));
+}
+
+// sampleClamp() for four points
+inline __m128 sampleClampPs(const float* texels, int res, __m128 u, __m128 v) {
+    const __m128 resF = _mm_set1_ps(static_cast<float>(res));
+    const __m128 halfTexel = _mm_set1_ps(0.5f);
+    const __m128 maxT = _mm_set1_ps(static_cast<float>(res - 1));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 tx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(u, resF), halfTexel), zero), maxT);
+    const __m128 tz = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(v, resF), halfTexel), zero), maxT);
+    const __m128i maxCell = _mm_set1_epi32(res - 2);
+    __m128i ix = _mm_cvttps_epi32(tx);
+    __m128i iz = _mm_cvttps_epi32(tz);
+    // min(i, res - 2) without SSE4.1 pminsd
+    const __m128i overX = _mm_cmpgt_epi32(ix, maxCell);
+    const __m128i overZ = _mm_cmpgt_epi32(iz, maxCell);
+    ix = _mm_or_si128(_mm_andnot_si128(overX, ix), _mm_and_si128(overX, maxCell));
+    iz = _mm_or_si128(_mm_andnot_si128(overZ, iz), _mm_and_si128(overZ, maxCell));
+    const __m128 fx = _mm_sub_ps(tx, _mm_cvtepi32_ps(ix));
+    const __m128 fz = _mm_sub_ps(tz, _mm_cvtepi32_ps(iz));
+    alignas(16) int ixs[4], izs[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+    _mm_store_si128(reinterpret_cast<__m128i*>(izs), iz);
+    alignas(16) float a[4], b[4], c[4], d[4];
+    for (int lane = 0; lane < 4; ++lane) {
+        const float* row = texels + static_cast<size_t>(izs[lane]) * res + ixs[lane];
+        a[lane] = row[0];
+        b[lane] = row[1];
+        c[lane] = row[res];
+        d[lane] = row[res + 1];
+    }
+    const __m128 va = _mm_load_ps(a), vb = _mm_load_ps(b), vc = _mm_load_ps(c), vd = _mm_load_ps(d);
+    const __m128 top = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), fx));
+    const __m128 bottom = _mm_add_ps(vc, _mm_mul_ps(_mm_sub_ps(vd, vc), fx));
+    return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fz));
+}
+}
+#endif
+
+void WaveSampler::heights(const float* xs, const float* zs, float time, float* out, size_t count) const {
+    if (!m_layers) {
+        std::fill(out, out + count, m_waterLevel);
+        return;
+    }
+    size_t i = 0;
+#ifdef WAVE_SAMPLER_SSE2
+    const Layers& l = *m_layers;
+    if (l.powerOfTwo) {
+        const WaveSettings& s = m_settings;
+        const glm::vec2 off0 = s.layer0Speed * time;
+        const glm::vec2 off1 = s.layer1Speed * time;
+        const __m128 invExtent = _mm_set1_ps(m_invExtent);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 tiling0 = _mm_set1_ps(s.layer0Tiling), tiling1 = _mm_set1_ps(s.layer1Tiling);
+        const __m128 off0u = _mm_set1_ps(off0.x), off0v = _mm_set1_ps(off0.y);
+        const __m128 off1u = _mm_set1_ps(off1.x), off1v = _mm_set1_ps(off1.y);
+        const __m128 strength0 = _mm_set1_ps(s.layer0Strength), strength1 = _mm_set1_ps(s.layer1Strength);
+        const __m128 halfSharpness = _mm_set1_ps(s.blendSharpness * 0.5f);
+        const __m128 gain = _mm_set1_ps(s.gain);
+        const __m128 level = _mm_set1_ps(m_waterLevel);
+        const Shore* shore = m_shore.get();
+        const __m128 shoreInvWorld = _mm_set1_ps(shore ? shore->invWorld : 0.0f);
+        const __m128 oceanStrength = _mm_set1_ps(s.oceanStrength);
+        const __m128 shoreMin = _mm_set1_ps(s.shoreMinScale);
+        const __m128 shoreRange = _mm_set1_ps(1.0f - s.shoreMinScale);
+        const __m128 shoreFade = _mm_set1_ps(s.shoreFade);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm_loadu_ps(xs + i), z = _mm_loadu_ps(zs + i);
+            const __m128 u = _mm_add_ps(_mm_mul_ps(x, invExtent), half);
+            const __m128 v = _mm_add_ps(_mm_mul_ps(z, invExtent), half);
+            const __m128 h0 = _mm_mul_ps(sampleRepeatPs(l.wave0.data(), l.size, _mm_add_ps(_mm_mul_ps(u, tiling0), off0u),
+                                                        _mm_add_ps(_mm_mul_ps(v, tiling0), off0v)), strength0);
+            const __m128 h1 = _mm_mul_ps(sampleRepeatPs(l.wave1.data(), l.size, _mm_add_ps(_mm_mul_ps(u, tiling1), off1u),
+                                                        _mm_add_ps(_mm_mul_ps(v, tiling1), off1v)), strength1);
+            const __m128 blend = smooth01Ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(h0, h1), halfSharpness), half));
+            __m128 height = _mm_mul_ps(_mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), blend)), gain);
+            __m128 shoreScale = _mm_set1_ps(1.0f);
+            if (shore) {
+                const __m128 dist = sampleClampPs(shore->distance.data(), shore->res,
+                                                  _mm_add_ps(_mm_mul_ps(x, shoreInvWorld), half),
+                                                  _mm_add_ps(_mm_mul_ps(z, shoreInvWorld), half));
+                const __m128 fade = smooth01Ps(_mm_div_ps(dist, shoreFade));
+                shoreScale = _mm_add_ps(shoreMin, _mm_mul_ps(shoreRange, fade));
+                height = _mm_mul_ps(height, shoreScale);
+            }
+            if (m_ocean) {
+                // The tile filter decodes half floats per texel; it stays scalar per lane
+                alignas(16) float detail[4];
+                for (int lane = 0; lane < 4; ++lane) {
+                    detail[lane] = m_ocean->sample(xs[i + lane] / m_oceanPatch, zs[i + lane] / m_oceanPatch).y;
+                }
+                height = _mm_add_ps(height, _mm_mul_ps(_mm_load_ps(detail), _mm_mul_ps(oceanStrength, shoreScale)));
+            }
+            _mm_storeu_ps(out + i, _mm_add_ps(level, height));
+        }
+    }
+#endif
+    for (; i < count; ++i) out[i] = height(xs[i], zs[i], time);
+}
@@ -0,0 +1,83 @@
+#pragma once
+// CPU evaluation of the water surface the water vertex shader draws: the two scrolling wave
+// height layers, their sharpened blend, the shoreline damping from ShoreDistanceField and the
+// FFT ocean detail (height channel of an OceanFrame, damped by the same shore scale).
+// Layer and shore data are quantized to half floats like the R16F / RG16F textures and
+// filtered the way GL_LINEAR does (repeat for waves, clamp for the shore), so results track
+// the GPU formula up to the texture unit's filtering precision. Samplers are immutable and
+// may be queried from any thread; gameplay uses them for buoyancy, wading and splash checks.
+//
+// The ocean term is the tile the shader has bound, so it ignores the time argument, and like
+// the shader it is read at the undisplaced point: the choppy horizontal offset is not inverted.
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+class ShoreDistanceField;
+struct OceanFrame;
+
+// Parameters shared by the water shader uniforms and WaveSampler
+struct WaveSettings {
+    glm::vec2 layer0Speed{0.025f, 0.018f};   // wave UV per second
+    glm::vec2 layer1Speed{-0.015f, 0.028f};  // cross-wave pattern
+    float layer0Tiling = 0.25f;              // wave texture repeats per water UV
+    float layer1Tiling = 0.45f;
+    float layer0Strength = 2.8f;             // world units at a texel value of 1
+    float layer1Strength = 2.2f;
+    float blendSharpness = 4.5f;             // ridge sharpness of the layer blend
+    float gain = 1.05f;
+    float shoreFade = 6.0f;                  // waves flatten over this distance from the shore
+    float shoreMinScale = 0.35f;             // ... down to this fraction at the shoreline
+    float oceanStrength = 1.0f;              // scale of the FFT ocean detail (uOceanStrength)
+};
+
+class WaveSampler {
+public:
+    WaveSampler() = default;
+    // layer0 / layer1: size x size wave height textures as generated (before half conversion).
+    // extent: water UV span in world units, centred on the origin.
+    WaveSampler(const std::vector<float>& layer0, const std::vector<float>& layer1, int size,
+                const WaveSettings& settings, float waterLevel, float extent);
+    // Same waves damped by a new shore field (null: no damping) at that field's water level;
+    // the layer data is shared
+    std::shared_ptr<const WaveSampler> withShore(std::shared_ptr<const ShoreDistanceField> shore) const;
+    // Same waves plus an ocean tile repeating every patchSize world units (null: no ocean);
+    // the layer and shore data are shared
+    std::shared_ptr<const WaveSampler> withOcean(std::shared_ptr<const OceanFrame> frame, float patchSize) const;
+
+    bool valid() const { return m_layers != nullptr; }
+    const WaveSettings& settings() const { return m_settings; }
+    float waterLevel() const { return m_waterLevel; }
+    const std::shared_ptr<const OceanFrame>& ocean() const { return m_ocean; }
+
+    // Displacement above the still water level at world (x, z) and shader time uTime
+    float displacement(float x, float z, float time) const;
+    // World-space surface height: waterLevel() + displacement()
+    float height(float x, float z, float time) const { return m_waterLevel + displacement(x, z, time); }
+    // Batch height(); SSE2 four points at a time, results identical to the scalar call
+    void heights(const float* xs, const float* zs, float time, float* out, size_t count) const;
+
+private:
+    struct Layers {
+        std::vector<float> wave0, wave1;  // half-quantized
+        int size = 0;
+        bool powerOfTwo = false;
+    };
+
+    // Shore distance channel (half-quantized) and its texture mapping
+    struct Shore {
+        std::shared_ptr<const ShoreDistanceField> field;
+        std::vector<float> distance;
+        int res = 0;
+        float invWorld = 0.0f;  // shore texture u = x * invWorld + 0.5 (see withShore)
+    };
+
+    std::shared_ptr<const Layers> m_layers;
+    WaveSettings m_settings;
+    float m_waterLevel = 0.0f;
+    float m_invExtent = 0.0f;
+    std::shared_ptr<const Shore> m_shore;  // null without a shore
+    std::shared_ptr<const OceanFrame> m_ocean;  // null without ocean detail
+    float m_oceanPatch = 0.0f;
+};
@@ -0,0 +1,250 @@
+#include "AabbTree.h"
+
+namespace {
+// A moving proxy's fat box reaches this many frames of its last displacement ahead
+constexpr float kDisplacementLookahead = 2.0f;
+// Refit in place while the leaf and its sibling still fit a box at most this much larger than
+// the two together; past that the pair is far apart and the leaf is re-inserted instead
+constexpr float kRefitSpread = 2.0f;
+}
+
+int AabbTree::allocateNode() {
+    if(m_freeList == kNull) {
+        m_nodes.emplace_back();
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+    const int node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+    m_nodes[node] = Node();
+    return node;
+}
+
+void AabbTree::freeNode(int node) {
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].child1 = m_nodes[node].child2 = kNull;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+int AabbTree::createProxy(const Aabb& box, int userData) {
+    const int proxy = allocateNode();
+    m_nodes[proxy].box = box.expanded(m_margin);
+    m_nodes[proxy].userData = userData;
+    m_nodes[proxy].height = 0;
+    insertLeaf(proxy);
+    ++m_proxyCount;
+    return proxy;
+}
+
+void AabbTree::destroyProxy(int proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --m_proxyCount;
+}
+
+bool AabbTree::moveProxy(int proxy, const Aabb& box, const glm::vec3& displacement) {
+    Node& leaf = m_nodes[proxy];
+    if(leaf.box.contains(box)) return false;
+
+    Aabb fat = box.expanded(m_margin);
+    const glm::vec3 ahead = displacement * kDisplacementLookahead;
+    for(int axis = 0; axis < 3; ++axis) {
+        if(ahead[axis] < 0.0f) fat.min[axis] += ahead[axis];
+        else fat.max[axis] += ahead[axis];
+    }
+    placeLeaf(proxy, fat);
+    return true;
+}
+
+void AabbTree::setFatAabb(int proxy, const Aabb& fat) {
+    if(!(m_nodes[proxy].box == fat)) placeLeaf(proxy, fat);
+}
+
+void AabbTree::placeLeaf(int leaf, const Aabb& fat) {
+    Node& node = m_nodes[leaf];
+    bool refit = node.parent == kNull;
+    if(!refit && fat.overlaps(node.box)) {
+        const Node& parent = m_nodes[node.parent];
+        const Aabb& sibling = m_nodes[parent.child1 == leaf ? parent.child2 : parent.child1].box;
+        refit = sibling.merged(fat).surfaceArea() <= kRefitSpread * (sibling.surfaceArea() + fat.surfaceArea());
+    }
+    if(refit) {
+        node.box = fat;
+        refitLeaf(leaf);
+    } else {
+        removeLeaf(leaf);
+        m_nodes[leaf].box = fat;
+        insertLeaf(leaf);
+    }
+}
+
+void AabbTree::refitLeaf(int leaf) {
+    int index = m_nodes[leaf].parent;
+    while(index != kNull) {
+        Node& node = m_nodes[index];
+        const Aabb merged = m_nodes[node.child1].box.merged(m_nodes[node.child2].box);
+        if(merged == node.box) break;  // nothing above changes either
+        node.box = merged;
+        index = node.parent;
+    }
+}
+
+void AabbTree::insertLeaf(int leaf) {
+    if(m_root == kNull) {
+        m_root = leaf;
+        m_nodes[leaf].parent = kNull;
+        return;
+    }
+
+    // Descend towards the cheapest sibling: creating a parent there costs its merged area, and
+    // every ancestor on the way grows by the area the leaf adds to it (inheritance cost).
+    const Aabb leafBox = m_nodes[leaf].box;
+    int index = m_root;
+    while(!m_nodes[index].isLeaf()) {
+        const Node& node = m_nodes[index];
+        const float area = node.box.surfaceArea();
+        const float combinedArea = node.box.merged(leafBox).surfaceArea();
+        const float cost = 2.0f * combinedArea;
+        const float inheritance = 2.0f * (combinedArea - area);
+        auto descendCost = [&](int child) {
+            const Node& c = m_nodes[child];
+            const float merged = c.box.merged(leafBox).surfaceArea();
+            return (c.isLeaf() ? merged : merged - c.box.surfaceArea()) + inheritance;
+        };
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+        if(cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int sibling = index;
+    const int oldParent = m_nodes[sibling].parent;
+    const int newParent = allocateNode();
+    Node& parent = m_nodes[newParent];
+    parent.parent = oldParent;
+    parent.box = leafBox.merged(m_nodes[sibling].box);
+    parent.height = m_nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+    if(oldParent == kNull) {
+        m_root = newParent;
+    } else if(m_nodes[oldParent].child1 == sibling) {
+        m_nodes[oldParent].child1 = newParent;
+    } else {
+        m_nodes[oldParent].child2 = newParent;
+    }
+
+    for(index = m_nodes[leaf].parent; index != kNull; index = m_nodes[index].parent) {
+        index = balance(index);
+        Node& node = m_nodes[index];
+        node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        node.box = m_nodes[node.child1].box.merged(m_nodes[node.child2].box);
+    }
+}
+
+void AabbTree::removeLeaf(int leaf) {
+    if(leaf == m_root) {
+        m_root = kNull;
+        return;
+    }
+    const int parent = m_nodes[leaf].parent;
+    const int grandParent = m_nodes[parent].parent;
+    const int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+    freeNode(parent);
+    m_nodes[sibling].parent = grandParent;
+    if(grandParent == kNull) {
+        m_root = sibling;
+        return;
+    }
+    if(m_nodes[grandParent].child1 == parent) m_nodes[grandParent].child1 = sibling;
+    else m_nodes[grandParent].child2 = sibling;
+    for(int index = grandParent; index != kNull; index = m_nodes[index].parent) {
+        index = balance(index);
+        Node& node = m_nodes[index];
+        node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        node.box = m_nodes[node.child1].box.merged(m_nodes[node.child2].box);
+    }
+}
+
+int AabbTree::balance(int iA) {
+    // Rotates the taller grandchild side up when A's subtrees differ in height by more than one.
+    // Returns the index now at A's position.
+    Node& A = m_nodes[iA];
+    if(A.isLeaf() || A.height < 2) return iA;
+    const int iB = A.child1, iC = A.child2;
+    Node& B = m_nodes[iB];
+    Node& C = m_nodes[iC];
+    const int diff = C.height - B.height;
+
+    auto replaceInParent = [&](int oldChild, int newChild, int parent) {
+        if(parent == kNull) m_root = newChild;
+        else if(m_nodes[parent].child1 == oldChild) m_nodes[parent].child1 = newChild;
+        else m_nodes[parent].child2 = newChild;
+    };
+
+    if(diff > 1) {
+        // C moves up; its shorter child goes to A
+        const int iF = C.child1, iG = C.child2;
+        Node& F = m_nodes[iF];
+        Node& G = m_nodes[iG];
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        replaceInParent(iA, iC, C.parent);
+        const bool keepF = F.height > G.height;
+        const int iMoved = keepF ? iG : iF;
+        Node& kept = keepF ? F : G;
+        Node& moved = keepF ? G : F;
+        C.child2 = keepF ? iF : iG;
+        A.child2 = iMoved;
+        moved.parent = iA;
+        A.box = B.box.merged(moved.box);
+        C.box = A.box.merged(kept.box);
+        A.height = 1 + std::max(B.height, moved.height);
+        C.height = 1 + std::max(A.height, kept.height);
+        return iC;
+    }
+    if(diff < -1) {
+        // B moves up; its shorter child goes to A
+        const int iD = B.child1, iE = B.child2;
+        Node& D = m_nodes[iD];
+        Node& E = m_nodes[iE];
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        replaceInParent(iA, iB, B.parent);
+        const bool keepD = D.height > E.height;
+        const int iMoved = keepD ? iE : iD;
+        Node& kept = keepD ? D : E;
+        Node& moved = keepD ? E : D;
+        B.child2 = keepD ? iD : iE;
+        A.child1 = iMoved;
+        moved.parent = iA;
+        A.box = C.box.merged(moved.box);
+        B.box = A.box.merged(kept.box);
+        A.height = 1 + std::max(C.height, moved.height);
+        B.height = 1 + std::max(A.height, kept.height);
+        return iB;
+    }
+    return iA;
+}
+
+void AabbTree::clear() {
+    m_nodes.clear();
+    m_root = kNull;
+    m_freeList = kNull;
+    m_proxyCount = 0;
+}
+
+float AabbTree::areaRatio() const {
+    if(m_root == kNull) return 0.0f;
+    const float rootArea = m_nodes[m_root].box.surfaceArea();
+    if(rootArea <= 0.0f) return 0.0f;
+    float total = 0.0f;
+    for(const Node& node : m_nodes) {
+        if(node.height > 0) total += node.box.surfaceArea();
+    }
+    return total / rootArea;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "CollisionGeometry.h"
+
+// Dynamic bounding volume hierarchy for the collision broadphase. Leaves hold "fat" boxes, the
+// tight box grown by a margin and stretched along the last displacement, so a body that moves a
+// little stays inside its leaf and costs nothing. A body that leaves its fat box is refitted in
+// place when it stays near its old box (ancestors are re-merged bottom-up and the walk stops at
+// the first one that does not change) and is removed and re-inserted when it has moved far.
+// Insertion descends by surface-area cost and AVL rotations keep the tree balanced.
+//
+// Proxy ids are node indices and stay valid until destroyProxy. Queries are const and keep their
+// traversal stack on the call stack, so any number of threads may query a tree nobody modifies.
+class AabbTree {
+public:
+    static constexpr int kNull = -1;
+
+    explicit AabbTree(float margin = 0.1f) : m_margin(margin) {}
+
+    int createProxy(const Aabb& box, int userData);
+    void destroyProxy(int proxy);
+    // Updates a proxy's tight box; displacement is the movement since the last update. Returns
+    // true when the fat box had to change.
+    bool moveProxy(int proxy, const Aabb& box, const glm::vec3& displacement);
+    // Replaces a proxy's fat box outright, e.g. to cover a body over a whole batch of moves and
+    // to put the box it had back afterwards
+    void setFatAabb(int proxy, const Aabb& fat);
+    void clear();
+
+    int userData(int proxy) const { return m_nodes[proxy].userData; }
+    const Aabb& fatAabb(int proxy) const { return m_nodes[proxy].box; }
+    int proxyCount() const { return m_proxyCount; }
+    int height() const { return m_root == kNull ? 0 : m_nodes[m_root].height; }
+    // Sum of internal node areas over the root area: lower is a tighter tree
+    float areaRatio() const;
+
+    // fn(proxy) for every proxy whose fat box overlaps `box`; fn returns false to stop early.
+    template <typename Fn>
+    void query(const Aabb& box, Fn&& fn) const;
+
+    // Moves `box` from its position along unit `dir` for up to tMax and calls
+    // fn(proxy, tMax) -> new tMax for every proxy it may touch, nearest boxes first. Returning
+    // a smaller value clips the sweep; return 0 after a hit at the start to stop early.
+    template <typename Fn>
+    void sweep(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const;
+
+    template <typename Fn>
+    void raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, Fn&& fn) const {
+        sweep(Aabb{origin, origin}, dir, tMax, std::forward<Fn>(fn));
+    }
+
+private:
+    // AVL balance keeps the height below 1.45 log2(n) + 2, far inside this for any proxy count
+    static constexpr int kStackSize = 256;
+
+    struct Node {
+        Aabb box;
+        int parent = kNull;  // next free node while on the free list
+        int child1 = kNull;
+        int child2 = kNull;
+        int height = 0;      // leaf = 0, free = -1
+        int userData = -1;
+        bool isLeaf() const { return child1 == kNull; }
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    void refitLeaf(int leaf);
+    // Gives a leaf a new fat box, refitting it in place or re-inserting it
+    void placeLeaf(int leaf, const Aabb& fat);
+    int balance(int a);
+    static float entryDistance(const glm::vec3& origin, const glm::vec3& invDir, const Aabb& box, float tMax);
+
+    std::vector<Node> m_nodes;
+    int m_root = kNull;
+    int m_freeList = kNull;
+    int m_proxyCount = 0;
+    float m_margin;
+};
+
+template <typename Fn>
+void AabbTree::query(const Aabb& box, Fn&& fn) const {
+    if(m_root == kNull) return;
+    int stack[kStackSize];
+    int top = 0;
+    stack[top++] = m_root;
+    while(top > 0) {
+        const int index = stack[--top];
+        const Node& node = m_nodes[index];
+        if(!node.box.overlaps(box)) continue;
+        if(node.isLeaf()) {
+            if(!fn(index)) return;
+        } else {
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+}
+
+inline float AabbTree::entryDistance(const glm::vec3& origin, const glm::vec3& invDir, const Aabb& box, float tMax) {
+    // Slab test; a NaN from a zero direction lying in a slab plane leaves the interval unchanged
+    float t0 = 0.0f, t1 = tMax;
+    for(int axis = 0; axis < 3; ++axis) {
+        float ta = (box.min[axis] - origin[axis]) * invDir[axis];
+        float tb = (box.max[axis] - origin[axis]) * invDir[axis];
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    return t0 <= t1 ? t0 : std::numeric_limits<float>::infinity();
+}
+
+template <typename Fn>
+void AabbTree::sweep(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const {
+    if(m_root == kNull || !(tMax >= 0.0f)) return;
+    // Sweeping the box against a node equals casting its centre against the node grown by its extents
+    const glm::vec3 origin = box.center();
+    const glm::vec3 half = box.halfExtents();
+    const glm::vec3 invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    auto grown = [&](const Aabb& b) { return Aabb{b.min - half, b.max + half}; };
+    struct Entry {
+        int node;
+        float t;
+    };
+    Entry stack[kStackSize];
+    int top = 0;
+    const float rootT = entryDistance(origin, invDir, grown(m_nodes[m_root].box), tMax);
+    if(rootT == std::numeric_limits<float>::infinity()) return;
+    stack[top++] = {m_root, rootT};
+    while(top > 0) {
+        const Entry entry = stack[--top];
+        if(entry.t > tMax) continue;  // clipped since it was pushed
+        const Node& node = m_nodes[entry.node];
+        if(node.isLeaf()) {
+            tMax = std::min(tMax, fn(entry.node, tMax));
+            continue;
+        }
+        float t1 = entryDistance(origin, invDir, grown(m_nodes[node.child1].box), tMax);
+        float t2 = entryDistance(origin, invDir, grown(m_nodes[node.child2].box), tMax);
+        int c1 = node.child1, c2 = node.child2;
+        if(t2 < t1) {
+            std::swap(t1, t2);
+            std::swap(c1, c2);
+        }
+        // Far child first so the near one is popped next
+        if(t2 <= tMax) stack[top++] = {c2, t2};
+        if(t1 <= tMax) stack[top++] = {c1, t1};
+    }
+}
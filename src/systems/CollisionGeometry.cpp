@@ -0,0 +1,433 @@
+#include "CollisionGeometry.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+constexpr float kEpsilon = 1e-12f;
+
+inline float lengthSq(const glm::vec3& v) {
+    return glm::dot(v, v);
+}
+
+// Calls fn(a, b) for the 12 edges of a box
+template <typename Fn>
+void forEachEdge(const Aabb& box, Fn&& fn) {
+    const glm::vec3 lo = box.min, hi = box.max;
+    for(int i = 0; i < 4; ++i) {
+        const float u = (i & 1) ? hi.y : lo.y, v = (i & 2) ? hi.z : lo.z;
+        fn(glm::vec3(lo.x, u, v), glm::vec3(hi.x, u, v));
+    }
+    for(int i = 0; i < 4; ++i) {
+        const float u = (i & 1) ? hi.x : lo.x, v = (i & 2) ? hi.z : lo.z;
+        fn(glm::vec3(u, lo.y, v), glm::vec3(u, hi.y, v));
+    }
+    for(int i = 0; i < 4; ++i) {
+        const float u = (i & 1) ? hi.x : lo.x, v = (i & 2) ? hi.y : lo.y;
+        fn(glm::vec3(u, v, lo.z), glm::vec3(u, v, hi.z));
+    }
+}
+
+// Box grown by `radius` along one axis only; with the 12 edge capsules these make up the rounded box
+inline Aabb faceSlab(const Aabb& box, int axis, float radius) {
+    Aabb slab = box;
+    slab.min[axis] -= radius;
+    slab.max[axis] += radius;
+    return slab;
+}
+}
+
+glm::vec3 closestPointOnSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b) {
+    const glm::vec3 ab = b - a;
+    const float len2 = lengthSq(ab);
+    if(len2 <= kEpsilon) return a;
+    return a + ab * std::clamp(glm::dot(p - a, ab) / len2, 0.0f, 1.0f);
+}
+
+glm::vec3 closestPointOnAabb(const glm::vec3& p, const Aabb& box) {
+    return glm::clamp(p, box.min, box.max);
+}
+
+float closestPointsSegmentSegment(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2,
+                                  glm::vec3& c1, glm::vec3& c2) {
+    // Ericson, Real-Time Collision Detection 5.1.9
+    const glm::vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+    const float a = lengthSq(d1), e = lengthSq(d2), f = glm::dot(d2, r);
+    float s = 0.0f, t = 0.0f;
+    if(a <= kEpsilon && e <= kEpsilon) {
+        // both degenerate to points
+    } else if(a <= kEpsilon) {
+        t = std::clamp(f / e, 0.0f, 1.0f);
+    } else {
+        const float c = glm::dot(d1, r);
+        if(e <= kEpsilon) {
+            s = std::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            const float b = glm::dot(d1, d2);
+            const float denom = a * e - b * b;
+            s = denom > kEpsilon ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if(t < 0.0f) {
+                t = 0.0f;
+                s = std::clamp(-c / a, 0.0f, 1.0f);
+            } else if(t > 1.0f) {
+                t = 1.0f;
+                s = std::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+    return lengthSq(c1 - c2);
+}
+
+float closestPointsSegmentAabb(const glm::vec3& a, const glm::vec3& b, const Aabb& box,
+                               glm::vec3& onSegment, glm::vec3& onBox) {
+    // The squared distance along the segment is convex and piecewise quadratic, split where the
+    // segment crosses a slab plane. Between crossings the axes outside their slab do not change,
+    // so each piece has a closed-form minimum; the smallest of those is the answer.
+    const glm::vec3 ab = b - a;
+    float knots[8] = {0.0f, 1.0f};
+    int count = 2;
+    for(int axis = 0; axis < 3; ++axis) {
+        if(ab[axis] == 0.0f) continue;
+        for(float bound : {box.min[axis], box.max[axis]}) {
+            const float s = (bound - a[axis]) / ab[axis];
+            if(!(s > 0.0f && s < 1.0f)) continue;
+            // Insert in order: knots[0] == 0 stops the shift, and at most six land between the ends
+            int i = count++;
+            while(knots[i - 1] > s) {
+                knots[i] = knots[i - 1];
+                --i;
+            }
+            knots[i] = s;
+        }
+    }
+    float best = std::numeric_limits<float>::infinity(), bestS = 0.0f;
+    for(int i = 0; i + 1 < count; ++i) {
+        const float s0 = knots[i], s1 = knots[i + 1];
+        const glm::vec3 mid = a + ab * ((s0 + s1) * 0.5f);
+        float num = 0.0f, den = 0.0f;
+        for(int axis = 0; axis < 3; ++axis) {
+            float bound;
+            if(mid[axis] < box.min[axis]) bound = box.min[axis];
+            else if(mid[axis] > box.max[axis]) bound = box.max[axis];
+            else continue;
+            num += ab[axis] * (bound - a[axis]);
+            den += ab[axis] * ab[axis];
+        }
+        const float s = den > 0.0f ? std::clamp(num / den, s0, s1) : s0;
+        const glm::vec3 p = a + ab * s;
+        const float dist2 = lengthSq(p - closestPointOnAabb(p, box));
+        if(dist2 < best) {
+            best = dist2;
+            bestS = s;
+        }
+    }
+    onSegment = a + ab * bestS;
+    onBox = closestPointOnAabb(onSegment, box);
+    return lengthSq(onSegment - onBox);
+}
+
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    // Ericson, Real-Time Collision Detection 5.1.5: find p's Voronoi region of the triangle
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if(d1 <= 0.0f && d2 <= 0.0f) return a;
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if(d3 >= 0.0f && d4 <= d3) return b;
+    const float vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if(d6 >= 0.0f && d5 <= d6) return c;
+    const float vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+    const float va = d3 * d6 - d5 * d4;
+    if(va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    const float denom = va + vb + vc;
+    if(std::abs(denom) <= kEpsilon) return closestPointOnSegment(p, a, b);  // degenerate triangle
+    return a + ab * (vb / denom) + ac * (vc / denom);
+}
+
+float closestPointsSegmentTriangle(const glm::vec3& p, const glm::vec3& q, const glm::vec3& a, const glm::vec3& b,
+                                   const glm::vec3& c, glm::vec3& onSegment, glm::vec3& onTriangle) {
+    const glm::vec3 pq = q - p;
+    const float len = std::sqrt(lengthSq(pq));
+    float t;
+    if(len > 0.0f && rayCastTriangle(p, pq / len, len, a, b, c, t)) {
+        onSegment = onTriangle = p + pq * (t / len);
+        return 0.0f;
+    }
+    // Apart, the closest pair has an end of the segment or an edge of the triangle in it
+    float best = std::numeric_limits<float>::infinity();
+    auto consider = [&](const glm::vec3& s, const glm::vec3& tri) {
+        const float dist2 = lengthSq(s - tri);
+        if(dist2 < best) {
+            best = dist2;
+            onSegment = s;
+            onTriangle = tri;
+        }
+    };
+    consider(p, closestPointOnTriangle(p, a, b, c));
+    consider(q, closestPointOnTriangle(q, a, b, c));
+    const glm::vec3 edges[3][2] = {{a, b}, {b, c}, {c, a}};
+    for(const auto& edge : edges) {
+        glm::vec3 s, e;
+        closestPointsSegmentSegment(p, q, edge[0], edge[1], s, e);
+        consider(s, e);
+    }
+    return best;
+}
+
+bool rayCastSphere(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& center, float radius, float& t) {
+    const glm::vec3 oc = origin - center;
+    const float c = lengthSq(oc) - radius * radius;
+    if(c <= 0.0f) {
+        t = 0.0f;
+        return true;
+    }
+    const float b = glm::dot(oc, dir);
+    if(b >= 0.0f) return false;  // outside and moving away
+    const float h = b * b - c;
+    if(h < 0.0f) return false;
+    const float hit = -b - std::sqrt(h);
+    if(hit > tMax) return false;
+    t = std::max(hit, 0.0f);
+    return true;
+}
+
+bool rayCastCapsule(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& a, const glm::vec3& b,
+                    float radius, float& t) {
+    if(lengthSq(origin - closestPointOnSegment(origin, a, b)) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    float best = tMax;
+    bool found = false;
+    // Cylinder wall between the caps
+    const glm::vec3 ba = b - a, oa = origin - a;
+    const float baba = lengthSq(ba);
+    const float bard = glm::dot(ba, dir), baoa = glm::dot(ba, oa);
+    const float qa = baba - bard * bard;
+    if(baba > kEpsilon && qa > kEpsilon * baba) {
+        const float qb = baba * glm::dot(dir, oa) - baoa * bard;
+        const float qc = baba * lengthSq(oa) - baoa * baoa - radius * radius * baba;
+        const float h = qb * qb - qa * qc;
+        if(h >= 0.0f) {
+            const float hit = (-qb - std::sqrt(h)) / qa;
+            const float y = baoa + hit * bard;
+            if(hit >= 0.0f && hit <= best && y > 0.0f && y < baba) {
+                best = hit;
+                found = true;
+            }
+        }
+    }
+    float cap;
+    if(rayCastSphere(origin, dir, best, a, radius, cap)) { best = cap; found = true; }
+    if(rayCastSphere(origin, dir, best, b, radius, cap)) { best = cap; found = true; }
+    if(found) t = best;
+    return found;
+}
+
+bool rayCastTriangle(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& a, const glm::vec3& b,
+                     const glm::vec3& c, float& t) {
+    // Moller-Trumbore, accepting either winding
+    const glm::vec3 e1 = b - a, e2 = c - a;
+    const glm::vec3 pvec = glm::cross(dir, e2);
+    const float det = glm::dot(e1, pvec);
+    if(det * det <= kEpsilon * lengthSq(e1) * lengthSq(e2)) return false;  // parallel or degenerate
+    const float invDet = 1.0f / det;
+    const glm::vec3 tvec = origin - a;
+    const float u = glm::dot(tvec, pvec) * invDet;
+    if(u < 0.0f || u > 1.0f) return false;
+    const glm::vec3 qvec = glm::cross(tvec, e1);
+    const float v = glm::dot(dir, qvec) * invDet;
+    if(v < 0.0f || u + v > 1.0f) return false;
+    const float hit = glm::dot(e2, qvec) * invDet;
+    if(hit < 0.0f || hit > tMax) return false;
+    t = hit;
+    return true;
+}
+
+bool rayCastAabb(const glm::vec3& origin, const glm::vec3& dir, float tMax, const Aabb& box, float& t) {
+    float t0 = 0.0f, t1 = tMax;
+    for(int axis = 0; axis < 3; ++axis) {
+        if(std::abs(dir[axis]) < kEpsilon) {
+            if(origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) return false;
+            continue;
+        }
+        const float inv = 1.0f / dir[axis];
+        float ta = (box.min[axis] - origin[axis]) * inv;
+        float tb = (box.max[axis] - origin[axis]) * inv;
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if(t0 > t1) return false;
+    }
+    t = t0;
+    return true;
+}
+
+bool rayCastRoundedAabb(const glm::vec3& origin, const glm::vec3& dir, float tMax, const Aabb& box, float radius, float& t) {
+    if(radius <= 0.0f) return rayCastAabb(origin, dir, tMax, box, t);
+    if(lengthSq(origin - closestPointOnAabb(origin, box)) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    float best = tMax, hit;
+    if(!rayCastAabb(origin, dir, best, box.expanded(radius), hit)) return false;
+    bool found = false;
+    for(int axis = 0; axis < 3; ++axis) {
+        if(rayCastAabb(origin, dir, best, faceSlab(box, axis, radius), hit)) { best = hit; found = true; }
+    }
+    forEachEdge(box, [&](const glm::vec3& a, const glm::vec3& b) {
+        if(rayCastCapsule(origin, dir, best, a, b, radius, hit)) { best = hit; found = true; }
+    });
+    if(found) t = best;
+    return found;
+}
+
+bool capsuleCastCapsule(const glm::vec3& a0, const glm::vec3& a1, float ra, const glm::vec3& dir, float tMax,
+                        const glm::vec3& b0, const glm::vec3& b1, float rb, float& t) {
+    const float radius = ra + rb;
+    glm::vec3 ca, cb;
+    if(closestPointsSegmentSegment(a0, a1, b0, b1, ca, cb) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    // A touches B once dir * t enters {q - p : p on A, q on B} grown by ra + rb: a parallelogram
+    // with rounded edges, i.e. four edge capsules plus the parallelogram thickened along its normal.
+    const glm::vec3 origin(0.0f);
+    const glm::vec3 v00 = b0 - a0, v10 = b1 - a0, v01 = b0 - a1, v11 = b1 - a1;
+    float best = tMax, hit;
+    bool found = false;
+    const glm::vec3 edges[4][2] = {{v00, v10}, {v01, v11}, {v00, v01}, {v10, v11}};
+    for(const auto& edge : edges) {
+        if(rayCastCapsule(origin, dir, best, edge[0], edge[1], radius, hit)) { best = hit; found = true; }
+    }
+    const glm::vec3 e1 = b1 - b0, e2 = a0 - a1;
+    glm::vec3 n = glm::cross(e1, e2);
+    const float nLen2 = lengthSq(n);
+    if(nLen2 > kEpsilon * lengthSq(e1) * lengthSq(e2)) n /= std::sqrt(nLen2);
+    const float nd = glm::dot(n, dir);
+    if(nLen2 > kEpsilon * lengthSq(e1) * lengthSq(e2) && std::abs(nd) > kEpsilon) {
+        // Face planes at +-radius along the normal; the ray can only enter through the one on its side
+        const float side = glm::dot(n, v00) <= 0.0f ? 1.0f : -1.0f;
+        const glm::vec3 offset = n * (side * radius);
+        const float face = glm::dot(n, v00 + offset) / nd;
+        if(face >= 0.0f && face <= best) {
+            // Parallelogram coordinates of the hit point
+            const glm::vec3 p = dir * face - offset - v00;
+            const float e11 = lengthSq(e1), e12 = glm::dot(e1, e2), e22 = lengthSq(e2);
+            const float p1 = glm::dot(p, e1), p2 = glm::dot(p, e2);
+            const float det = e11 * e22 - e12 * e12;
+            if(det > kEpsilon) {
+                const float s = (p1 * e22 - p2 * e12) / det;
+                const float u = (p2 * e11 - p1 * e12) / det;
+                if(s >= 0.0f && s <= 1.0f && u >= 0.0f && u <= 1.0f) {
+                    best = face;
+                    found = true;
+                }
+            }
+        }
+    }
+    if(found) t = best;
+    return found;
+}
+
+bool capsuleCastAabb(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                     const Aabb& box, float& t) {
+    glm::vec3 onSegment, onBox;
+    if(closestPointsSegmentAabb(a0, a1, box, onSegment, onBox) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    // Cull with the capsule's bounds swept against the box
+    const Aabb bounds{glm::min(a0, a1) - glm::vec3(radius), glm::max(a0, a1) + glm::vec3(radius)};
+    const glm::vec3 half = bounds.halfExtents();
+    float best = tMax, hit;
+    if(!rayCastAabb(bounds.center(), dir, best, Aabb{box.min - half, box.max + half}, hit)) return false;
+    // The capsule's first contact is an end cap on a face, or the capsule against a box edge
+    // (corners included): the segment's interior can only meet a flat face when an end does too.
+    bool found = false;
+    for(int axis = 0; axis < 3; ++axis) {
+        const Aabb slab = faceSlab(box, axis, radius);
+        if(rayCastAabb(a0, dir, best, slab, hit)) { best = hit; found = true; }
+        if(rayCastAabb(a1, dir, best, slab, hit)) { best = hit; found = true; }
+    }
+    forEachEdge(box, [&](const glm::vec3& e0, const glm::vec3& e1) {
+        if(capsuleCastCapsule(a0, a1, radius, dir, best, e0, e1, 0.0f, hit)) { best = hit; found = true; }
+    });
+    if(found) t = best;
+    return found;
+}
+
+bool capsuleCastTriangle(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                         const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t) {
+    glm::vec3 onSegment, onTriangle;
+    if(closestPointsSegmentTriangle(a0, a1, a, b, c, onSegment, onTriangle) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    // As with a box: the first contact is an end cap on the face, or the capsule against an edge
+    float best = tMax, hit;
+    bool found = false;
+    const glm::vec3 n = glm::cross(b - a, c - a);
+    const float nLen2 = lengthSq(n);
+    if(nLen2 > kEpsilon) {
+        const glm::vec3 unit = n / std::sqrt(nLen2);
+        for(const glm::vec3& end : {a0, a1}) {
+            // The end can only enter through the face copy on its own side, moving towards it
+            const glm::vec3 side = glm::dot(end - a, n) >= 0.0f ? unit : -unit;
+            const glm::vec3 offset = side * radius;
+            if(glm::dot(dir, side) < 0.0f && rayCastTriangle(end, dir, best, a + offset, b + offset, c + offset, hit)) {
+                best = hit;
+                found = true;
+            }
+        }
+    }
+    const glm::vec3 edges[3][2] = {{a, b}, {b, c}, {c, a}};
+    for(const auto& edge : edges) {
+        if(capsuleCastCapsule(a0, a1, radius, dir, best, edge[0], edge[1], 0.0f, hit)) { best = hit; found = true; }
+    }
+    if(found) t = best;
+    return found;
+}
+
+bool aabbCastTriangle(const Aabb& box, const glm::vec3& dir, float tMax,
+                      const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t) {
+    // Both shapes are convex polytopes, so they overlap exactly when their projections overlap on
+    // all 13 SAT axes. Under translation every projection moves linearly, so each axis allows
+    // one interval of t and the first contact is where the intersection of those begins.
+    const glm::vec3 center = box.center(), half = box.halfExtents();
+    const glm::vec3 edges[3] = {b - a, c - b, a - c};
+    glm::vec3 axes[13] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, glm::cross(edges[0], edges[1])};
+    for(int i = 0; i < 3; ++i) {
+        axes[4 + 3 * i] = {0.0f, -edges[i].z, edges[i].y};
+        axes[5 + 3 * i] = {edges[i].z, 0.0f, -edges[i].x};
+        axes[6 + 3 * i] = {-edges[i].y, edges[i].x, 0.0f};
+    }
+    float enter = 0.0f, exit = tMax;
+    for(const glm::vec3& axis : axes) {
+        if(lengthSq(axis) <= kEpsilon) continue;
+        const float mid = glm::dot(axis, center), e = glm::dot(glm::abs(axis), half);
+        const float ta = glm::dot(axis, a), tb = glm::dot(axis, b), tc = glm::dot(axis, c);
+        const float lo = std::min({ta, tb, tc}) - (mid + e);  // box offsets along the axis that overlap
+        const float hi = std::max({ta, tb, tc}) - (mid - e);
+        const float speed = glm::dot(axis, dir);
+        if(speed == 0.0f) {
+            if(lo > 0.0f || hi < 0.0f) return false;
+            continue;
+        }
+        float t0 = lo / speed, t1 = hi / speed;
+        if(t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if(enter > exit) return false;
+    }
+    t = enter;
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Geometric building blocks shared by the broadphase and CollisionSystem queries: axis-aligned
+// boxes, closest-point helpers and exact shape casts. Casts move a shape along a unit direction
+// and report the distance t in [0, tMax] at which it first touches the target, or t = 0 when the
+// two already overlap; they never report exits, so a cast starting inside a shape hits at 0.
+
+struct Aabb {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    static Aabb around(const glm::vec3& center, const glm::vec3& halfExtents) {
+        return {center - halfExtents, center + halfExtents};
+    }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 halfExtents() const { return (max - min) * 0.5f; }
+    // Cost metric for tree building (SAH)
+    float surfaceArea() const {
+        glm::vec3 e = max - min;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+    bool contains(const Aabb& other) const {
+        return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::lessThanEqual(other.max, max));
+    }
+    bool overlaps(const Aabb& other) const {
+        return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::lessThanEqual(other.min, max));
+    }
+    Aabb expanded(float margin) const { return {min - glm::vec3(margin), max + glm::vec3(margin)}; }
+    Aabb merged(const Aabb& other) const { return {glm::min(min, other.min), glm::max(max, other.max)}; }
+    bool operator==(const Aabb& other) const { return min == other.min && max == other.max; }
+};
+
+glm::vec3 closestPointOnSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b);
+glm::vec3 closestPointOnAabb(const glm::vec3& p, const Aabb& box);
+// Closest points between segments [p1, q1] and [p2, q2]; returns their squared distance
+float closestPointsSegmentSegment(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2,
+                                  glm::vec3& c1, glm::vec3& c2);
+// Closest points between segment [a, b] and a box; returns their squared distance
+float closestPointsSegmentAabb(const glm::vec3& a, const glm::vec3& b, const Aabb& box,
+                               glm::vec3& onSegment, glm::vec3& onBox);
+
+// Closest point on triangle abc to p
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+// Closest points between segment [p, q] and triangle abc; returns their squared distance (0 when
+// the segment passes through the triangle)
+float closestPointsSegmentTriangle(const glm::vec3& p, const glm::vec3& q, const glm::vec3& a, const glm::vec3& b,
+                                   const glm::vec3& c, glm::vec3& onSegment, glm::vec3& onTriangle);
+
+// Ray (unit dir) against solid shapes
+bool rayCastSphere(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& center, float radius, float& t);
+bool rayCastCapsule(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& a, const glm::vec3& b,
+                    float radius, float& t);
+// Triangles are two-sided
+bool rayCastTriangle(const glm::vec3& origin, const glm::vec3& dir, float tMax, const glm::vec3& a, const glm::vec3& b,
+                     const glm::vec3& c, float& t);
+bool rayCastAabb(const glm::vec3& origin, const glm::vec3& dir, float tMax, const Aabb& box, float& t);
+// Box with its edges and corners rounded by `radius`: what a sphere of that radius cast against the box sees
+bool rayCastRoundedAabb(const glm::vec3& origin, const glm::vec3& dir, float tMax, const Aabb& box, float radius, float& t);
+
+// Capsule [a0, a1] of radius ra moving along dir against a static capsule, box or triangle
+bool capsuleCastCapsule(const glm::vec3& a0, const glm::vec3& a1, float ra, const glm::vec3& dir, float tMax,
+                        const glm::vec3& b0, const glm::vec3& b1, float rb, float& t);
+bool capsuleCastAabb(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                     const Aabb& box, float& t);
+bool capsuleCastTriangle(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                         const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t);
+// Box moving along dir against a static triangle
+bool aabbCastTriangle(const Aabb& box, const glm::vec3& dir, float tMax,
+                      const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t);
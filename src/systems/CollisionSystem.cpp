@@ -1,111 +1,958 @@
 #include "CollisionSystem.h"
 #include <algorithm>
 #include <cmath>
+#include <numeric>
+#include "util/ThreadPool.h"
 
-size_t CollisionSystem::addBody(const CollisionBody& body) {
-    // Find empty slot or add new one
-    for(size_t i = 0; i < m_activeSlots.size(); ++i) {
-        if(!m_activeSlots[i]) {
-            m_bodies[i] = body;
-            m_activeSlots[i] = true;
-            return i;
-        }
+namespace {
+// resolveMovement: sweep-and-slide passes per call, and the gap it keeps to what it slid along
+constexpr int kMaxSlideIterations = 4;
+constexpr int kMaxDepenetrationIterations = 4;
+constexpr float kSkinWidth = 0.01f;
+// Casters are grown by this to read the contact at the time of impact
+constexpr float kContactSlop = 1e-3f;
+// How far past its move a body's sweep and slide can reach: the skin-wide gaps it keeps
+constexpr float kMoveReachMargin = 2.0f * (kMaxSlideIterations + kMaxDepenetrationIterations) * kSkinWidth;
+// Batch moves split into pool ranges of at least this many bodies (or islands)
+constexpr size_t kMovesPerRange = 16;
+
+// Generations run 1..4095 (the 12 bits above the slot) so no handle is ever zero
+uint16_t nextGeneration(uint16_t generation) {
+    constexpr uint32_t kMaxGeneration = UINT32_MAX >> CollisionHandle::kSlotBits;
+    return static_cast<uint16_t>(generation % kMaxGeneration + 1);
+}
+
+// Capsule core segment from the base up; a capsule shorter than 2 * radius degenerates to a sphere
+void capsuleSegment(const glm::vec3& base, float radius, float height, glm::vec3& a, glm::vec3& b) {
+    a = base + glm::vec3(0.0f, radius, 0.0f);
+    b = base + glm::vec3(0.0f, std::max(height - radius, radius), 0.0f);
+}
+
+Aabb bodyBounds(const CollisionBody& body) {
+    switch(body.shape) {
+    case CollisionShape::Sphere:
+        return Aabb::around(body.position, glm::vec3(body.radius));
+    case CollisionShape::Capsule: {
+        glm::vec3 a, b;
+        capsuleSegment(body.position, body.radius, body.height, a, b);
+        return {glm::min(a, b) - glm::vec3(body.radius), glm::max(a, b) + glm::vec3(body.radius)};
+    }
+    case CollisionShape::Mesh:
+        if(!body.mesh || body.mesh->empty()) return {body.position, body.position};
+        return {body.mesh->bounds().min + body.position, body.mesh->bounds().max + body.position};
+    case CollisionShape::Heightfield:
+        if(!body.heightfield || body.heightfield->empty()) return {body.position, body.position};
+        return {body.heightfield->bounds().min + body.position, body.heightfield->bounds().max + body.position};
+    case CollisionShape::Box:
+    default:
+        return Aabb::around(body.position, body.halfExtents);
+    }
+}
+
+// Core segment of a sphere (a single point) or capsule
+void coreSegment(const CollisionBody& body, glm::vec3& a, glm::vec3& b) {
+    if(body.shape == CollisionShape::Capsule) {
+        capsuleSegment(body.position, body.radius, body.height, a, b);
+    } else {
+        a = b = body.position;
+    }
+}
+
+bool isScenery(CollisionShape shape) {
+    return shape == CollisionShape::Mesh || shape == CollisionShape::Heightfield;
+}
+
+// Contact of a sphere, capsule or box with a mesh placed at `origin`, normal pushing the shape out
+bool meshContact(const CollisionBody& shape, const TriangleMesh* mesh, const glm::vec3& origin, Contact& contact) {
+    if(!mesh || isScenery(shape.shape)) return false;
+    bool touched;
+    if(shape.shape == CollisionShape::Box) {
+        const Aabb box = bodyBounds(shape);
+        touched = mesh->aabbContact(Aabb{box.min - origin, box.max - origin}, contact);
+    } else {
+        glm::vec3 a, b;
+        coreSegment(shape, a, b);
+        touched = mesh->capsuleContact(a - origin, b - origin, shape.radius, contact);
+    }
+    contact.point += origin;
+    return touched;
+}
+
+// The same against a heightfield placed at `origin`
+bool heightfieldContact(const CollisionBody& shape, const Heightfield* heightfield, const glm::vec3& origin,
+                        Contact& contact) {
+    if(!heightfield || isScenery(shape.shape)) return false;
+    bool touched;
+    if(shape.shape == CollisionShape::Box) {
+        const Aabb box = bodyBounds(shape);
+        touched = heightfield->aabbContact(Aabb{box.min - origin, box.max - origin}, contact);
+    } else {
+        glm::vec3 a, b;
+        coreSegment(shape, a, b);
+        touched = heightfield->capsuleContact(a - origin, b - origin, shape.radius, contact);
+    }
+    contact.point += origin;
+    return touched;
+}
+
+bool sceneryContact(const CollisionBody& shape, const CollisionBody& scenery, Contact& contact) {
+    return scenery.shape == CollisionShape::Mesh
+         ? meshContact(shape, scenery.mesh, scenery.position, contact)
+         : heightfieldContact(shape, scenery.heightfield, scenery.position, contact);
+}
+
+// Exact contact for any pair of shapes, normal pushing `a` out of `b`
+bool bodyContact(const CollisionBody& a, const CollisionBody& b, Contact& contact) {
+    if(isScenery(b.shape)) return sceneryContact(a, b, contact);
+    if(isScenery(a.shape)) {
+        if(!sceneryContact(b, a, contact)) return false;
+        // Flip to push the scenery out of b; the point moves onto b's surface
+        contact.point -= contact.normal * contact.depth;
+        contact.normal = -contact.normal;
+        return true;
+    }
+    glm::vec3 a0, a1, b0, b1;
+    if(a.shape == CollisionShape::Box) {
+        if(b.shape == CollisionShape::Box) return aabbAabbContact(bodyBounds(a), bodyBounds(b), contact);
+        coreSegment(b, b0, b1);
+        return aabbCapsuleContact(bodyBounds(a), b0, b1, b.radius, contact);
+    }
+    if(b.shape == CollisionShape::Box) {
+        if(a.shape == CollisionShape::Sphere) return sphereAabbContact(a.position, a.radius, bodyBounds(b), contact);
+        coreSegment(a, a0, a1);
+        return capsuleAabbContact(a0, a1, a.radius, bodyBounds(b), contact);
+    }
+    if(a.shape == CollisionShape::Sphere && b.shape == CollisionShape::Sphere) {
+        return sphereSphereContact(a.position, a.radius, b.position, b.radius, contact);
+    }
+    coreSegment(a, a0, a1);
+    coreSegment(b, b0, b1);
+    return capsuleCapsuleContact(a0, a1, a.radius, b0, b1, b.radius, contact);
+}
+
+}
+
+uint32_t CollisionSystem::slotOf(CollisionHandle body) const {
+    const uint32_t slot = body.slot();
+    if(!body || slot >= m_generations.size()) return kNoSlot;
+    if(m_generations[slot] != body.generation() || m_proxies[slot] == AabbTree::kNull) return kNoSlot;
+    return slot;
+}
+
+CollisionBody CollisionSystem::bodyAt(uint32_t slot) const {
+    CollisionBody body;
+    body.shape = m_shapes[slot];
+    body.position = m_positions[slot];
+    body.radius = m_radii[slot];
+    body.height = m_heights[slot];
+    body.halfExtents = m_halfExtents[slot];
+    body.mesh = m_meshes[slot];
+    body.heightfield = m_heightfields[slot];
+    body.isStatic = m_static[slot] != 0;
+    body.userData = m_userData[slot];
+    return body;
+}
+
+Aabb CollisionSystem::boundsOf(uint32_t slot) const {
+    if(m_shapes[slot] == CollisionShape::Box) return Aabb::around(m_positions[slot], m_halfExtents[slot]);
+    if(isScenery(m_shapes[slot])) return bodyBounds(bodyAt(slot));
+    glm::vec3 a, b;
+    segmentOf(slot, a, b);
+    const glm::vec3 r(m_radii[slot]);
+    return {glm::min(a, b) - r, glm::max(a, b) + r};
+}
+
+void CollisionSystem::segmentOf(uint32_t slot, glm::vec3& a, glm::vec3& b) const {
+    if(m_shapes[slot] == CollisionShape::Capsule) {
+        capsuleSegment(m_positions[slot], m_radii[slot], m_heights[slot], a, b);
+    } else {
+        a = b = m_positions[slot];
     }
-    m_bodies.push_back(body);
-    m_activeSlots.push_back(true);
-    return m_bodies.size() - 1;
 }
 
-void CollisionSystem::updateBodyPosition(size_t index, const glm::vec3& position) {
-    if(index < m_bodies.size() && m_activeSlots[index]) {
-        m_bodies[index].position = position;
+CollisionHandle CollisionSystem::addBody(const CollisionBody& body) {
+    uint32_t slot;
+    if(!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        if(m_generations.size() > CollisionHandle::kSlotMask) return {};
+        slot = static_cast<uint32_t>(m_generations.size());
+        m_shapes.emplace_back();
+        m_positions.emplace_back();
+        m_radii.emplace_back();
+        m_heights.emplace_back();
+        m_halfExtents.emplace_back();
+        m_meshes.emplace_back();
+        m_heightfields.emplace_back();
+        m_static.emplace_back();
+        m_userData.emplace_back();
+        m_moveIslands.emplace_back();
+        m_proxies.push_back(AabbTree::kNull);
+        m_generations.push_back(1);
+    }
+    m_shapes[slot] = body.shape;
+    m_positions[slot] = body.position;
+    m_radii[slot] = body.radius;
+    m_heights[slot] = body.height;
+    m_halfExtents[slot] = body.halfExtents;
+    m_meshes[slot] = body.shape == CollisionShape::Mesh ? body.mesh : nullptr;
+    m_heightfields[slot] = body.shape == CollisionShape::Heightfield ? body.heightfield : nullptr;
+    m_static[slot] = body.isStatic ? 1 : 0;
+    m_userData[slot] = body.userData;
+    if(body.shape == CollisionShape::Heightfield) {
+        m_proxies[slot] = kOutsideTree;
+        m_heightfieldSlots.insert(std::lower_bound(m_heightfieldSlots.begin(), m_heightfieldSlots.end(), slot), slot);
+    } else {
+        m_proxies[slot] = m_tree.createProxy(boundsOf(slot), static_cast<int>(slot));
     }
+    ++m_bodyCount;
+    return handleOf(slot);
 }
 
-glm::vec3 CollisionSystem::resolveMovement(size_t bodyIndex, const glm::vec3& from, const glm::vec3& to) {
-    if(bodyIndex >= m_bodies.size() || !m_activeSlots[bodyIndex]) {
+void CollisionSystem::updateBodyPosition(CollisionHandle body, const glm::vec3& position) {
+    const uint32_t slot = slotOf(body);
+    if(slot != kNoSlot) {
+        const glm::vec3 displacement = position - m_positions[slot];
+        m_positions[slot] = position;
+        if(m_proxies[slot] != kOutsideTree) m_tree.moveProxy(m_proxies[slot], boundsOf(slot), displacement);
+    }
+}
+
+glm::vec3 CollisionSystem::resolveMovement(CollisionHandle body, const glm::vec3& from, const glm::vec3& to) {
+    const uint32_t slot = slotOf(body);
+    if(slot == kNoSlot || isScenery(m_shapes[slot])) {
         return to;
     }
     
-    CollisionBody& movingBody = m_bodies[bodyIndex];
-    glm::vec3 movement = to - from;
-    float moveLength = glm::length(movement);
-    
-    if(moveLength < 1e-6f) {
+    if(glm::length(to - from) < 1e-6f) {
         return to;
     }
+    return sweepAndSlide(m_scratch, bodyAt(slot), from, to, slot, kAllShapes);
+}
+
+template <typename Fn>
+void CollisionSystem::forEachRange(size_t count, Fn&& fn) {
+    // The serial path runs fn in place: no wrapper, no pool batch, nothing allocated
+    ThreadPool& pool = m_pool ? *m_pool : ThreadPool::shared();
+    const size_t ranges = std::min<size_t>(pool.concurrency() * 4, count / kMovesPerRange);
+    if(pool.concurrency() < 2 || ranges <= 1) {
+        if(count > 0) fn(m_scratch, 0, count);
+        return;
+    }
+    if(m_laneScratch.size() < ranges) m_laneScratch.resize(ranges);
+    pool.parallelFor(0, static_cast<int>(ranges), 1, [&](int rangeBegin, int rangeEnd) {
+        for(int range = rangeBegin; range < rangeEnd; ++range) {
+            fn(m_laneScratch[range], count * range / ranges, count * (range + 1) / ranges);
+        }
+    });
+}
+
+void CollisionSystem::resolveMovements(std::span<BodyMove> moves) {
+    const size_t count = moves.size();
+    if(m_moveSlots.size() < count) {
+        m_moveSlots.resize(count);
+        m_moveFrom.resize(count);
+        m_moveReach.resize(count);
+        m_moveFatBoxes.resize(count);
+        m_islandParent.resize(count);
+        m_islandIndex.resize(count);
+    }
+    // Scenery is not swept and goes straight to its target, before anything else moves
+    m_moveOrder.clear();
+    for(size_t i = 0; i < count; ++i) {
+        BodyMove& move = moves[i];
+        const uint32_t slot = slotOf(move.body);
+        m_moveSlots[i] = kNoSlot;
+        move.position = move.target;
+        if(slot == kNoSlot) continue;
+        if(isScenery(m_shapes[slot])) {
+            updateBodyPosition(move.body, move.target);
+            continue;
+        }
+        m_moveSlots[i] = slot;
+        m_moveFrom[i] = m_positions[slot];
+        m_moveOrder.push_back(static_cast<uint32_t>(i));
+    }
+    // A move's reach covers where it starts, where it is pushed out to when it starts inside
+    // something, and from there the length of the move
+    forEachRange(m_moveOrder.size(), [&](QueryScratch& scratch, size_t begin, size_t end) {
+        for(size_t k = begin; k < end; ++k) {
+            const uint32_t i = m_moveOrder[k];
+            const uint32_t slot = m_moveSlots[i];
+            CollisionBody shape = bodyAt(slot);
+            shape.position = depenetrate(scratch, shape, m_moveFrom[i], slot);
+            const float distance = glm::length(moves[i].target - m_moveFrom[i]);
+            m_moveReach[i] = boundsOf(slot).merged(bodyBounds(shape)).expanded(distance + kMoveReachMargin);
+        }
+    });
+
+    // Islands: moves whose reaches overlap, found by sweeping the reaches sorted along x and
+    // joined by union-find with the earliest move as the root
+    auto find = [&](uint32_t i) {
+        while(m_islandParent[i] != i) {
+            m_islandParent[i] = m_islandParent[m_islandParent[i]];
+            i = m_islandParent[i];
+        }
+        return i;
+    };
+    for(uint32_t i : m_moveOrder) m_islandParent[i] = i;
+    std::sort(m_moveOrder.begin(), m_moveOrder.end(), [&](uint32_t a, uint32_t b) {
+        return m_moveReach[a].min.x < m_moveReach[b].min.x || (m_moveReach[a].min.x == m_moveReach[b].min.x && a < b);
+    });
+    for(size_t k = 0; k < m_moveOrder.size(); ++k) {
+        const uint32_t a = m_moveOrder[k];
+        const Aabb& reach = m_moveReach[a];
+        for(size_t j = k + 1; j < m_moveOrder.size() && m_moveReach[m_moveOrder[j]].min.x <= reach.max.x; ++j) {
+            const uint32_t b = m_moveOrder[j];
+            if(!reach.overlaps(m_moveReach[b])) continue;
+            const uint32_t rootA = find(a), rootB = find(b);
+            if(rootA != rootB) m_islandParent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+        }
+    }
+
+    // Islands in order of their first move, each listing its moves in span order
+    m_islandStart.assign(1, 0);
+    for(size_t i = 0; i < count; ++i) {
+        if(m_moveSlots[i] == kNoSlot) continue;
+        const uint32_t root = find(static_cast<uint32_t>(i));
+        if(root == i) {
+            m_islandIndex[i] = static_cast<uint32_t>(m_islandStart.size() - 1);
+            m_islandStart.push_back(0);
+        }
+        ++m_islandStart[m_islandIndex[root] + 1];
+    }
+    const size_t islandCount = m_islandStart.size() - 1;
+    std::partial_sum(m_islandStart.begin(), m_islandStart.end(), m_islandStart.begin());
+    m_islandMoves.resize(m_islandStart.back());
+    for(size_t i = 0; i < count; ++i) {
+        if(m_moveSlots[i] == kNoSlot) continue;
+        const uint32_t island = m_islandIndex[find(static_cast<uint32_t>(i))];
+        m_islandMoves[m_islandStart[island]++] = static_cast<uint32_t>(i);
+        m_moveIslands[m_moveSlots[i]] = island + 1;
+    }
+    // The fill advanced every start to the next island's
+    std::copy_backward(m_islandStart.begin(), m_islandStart.end() - 1, m_islandStart.end());
+    m_islandStart[0] = 0;
+
+    // Each mover's proxy covers its whole reach while the islands run, so it can be moved without
+    // touching the tree. No island reaches another, and a query that still meets another island's
+    // mover (the reach of a mover off the end of a sweep, say) skips it.
+    for(size_t i = 0; i < count; ++i) {
+        const uint32_t slot = m_moveSlots[i];
+        if(slot == kNoSlot) continue;
+        m_moveFatBoxes[i] = m_tree.fatAabb(m_proxies[slot]);
+        m_tree.setFatAabb(m_proxies[slot], m_moveReach[i]);
+    }
+    forEachRange(islandCount, [&](QueryScratch& scratch, size_t begin, size_t end) {
+        for(size_t island = begin; island < end; ++island) {
+            for(uint32_t k = m_islandStart[island]; k < m_islandStart[island + 1]; ++k) {
+                BodyMove& move = moves[m_islandMoves[k]];
+                const uint32_t slot = m_moveSlots[m_islandMoves[k]];
+                if(glm::length(move.target - m_positions[slot]) >= 1e-6f) {
+                    move.position = sweepAndSlide(scratch, bodyAt(slot), m_positions[slot], move.target, slot,
+                                                  kAllShapes, static_cast<uint32_t>(island + 1));
+                }
+                m_positions[slot] = move.position;
+            }
+        }
+    });
+    for(size_t i = 0; i < count; ++i) {
+        const uint32_t slot = m_moveSlots[i];
+        if(slot == kNoSlot) continue;
+        m_moveIslands[slot] = 0;
+        m_tree.setFatAabb(m_proxies[slot], m_moveFatBoxes[i]);
+        m_tree.moveProxy(m_proxies[slot], boundsOf(slot), m_positions[slot] - m_moveFrom[i]);
+    }
+}
+
+glm::vec3 CollisionSystem::sweepAndSlide(QueryScratch& scratch, const CollisionBody& shape, const glm::vec3& from,
+                                         const glm::vec3& to, uint32_t ignoreSlot, uint32_t shapes,
+                                         uint32_t island) {
+    // Sweep the body's shape along the move and stop short of the first hit, then spend the
+    // rest of the move sliding along what it hit. The whole path is swept, so no step length
+    // tunnels through a body.
+    CollisionBody probe = shape;
+    probe.position = depenetrate(scratch, probe, from, ignoreSlot, shapes, island);
+    glm::vec3 remaining = to - from;
+    glm::vec3 planes[kMaxSlideIterations];
+    int planeCount = 0;
     
-    glm::vec3 moveDir = movement / moveLength;
-    glm::vec3 resolvedPos = to;
-    
-    // Check collision with all other bodies
-    for(size_t i = 0; i < m_bodies.size(); ++i) {
-        if(i == bodyIndex || !m_activeSlots[i]) continue;
+    for(int iteration = 0; iteration < kMaxSlideIterations; ++iteration) {
+        const float distance = glm::length(remaining);
+        if(distance < 1e-6f) break;
+        const glm::vec3 dir = remaining / distance;
         
-        const CollisionBody& other = m_bodies[i];
+        CollisionHit hit;
+        if(!castShape(probe, dir, distance, hit, ignoreSlot, shapes, island)) {
+            probe.position += remaining;
+            break;
+        }
         
-        // Simple sphere-based collision for now (works for capsules too)
-        float combinedRadius = movingBody.radius + other.radius;
-        glm::vec3 toOther = other.position - resolvedPos;
-        float dist = glm::length(toOther);
+        const float travel = std::max(hit.distance - kSkinWidth, 0.0f);
+        probe.position += dir * travel;
+        // Keep a skin-wide gap along the normal too, or a grazing hit leaves the shape touching
+        const float gap = (hit.distance - travel) * -glm::dot(dir, hit.normal);
+        if(gap < kSkinWidth) probe.position += hit.normal * (kSkinWidth - gap);
         
-        if(dist < combinedRadius) {
-            // Collision detected - push out
-            if(dist > 1e-6f) {
-                glm::vec3 pushDir = toOther / dist;
-                float penetration = combinedRadius - dist;
-                resolvedPos -= pushDir * (penetration + 0.01f);
-                
-                // Slide along surface if moving
-                if(!other.isStatic) {
-                    resolvedPos = slideAlongSurface(movement, -pushDir);
+        // Slide along the surface; in a crease between two surfaces, along the crease
+        glm::vec3 slide = dir * (distance - travel);
+        if(glm::dot(slide, hit.normal) < 0.0f) slide = slideAlongSurface(slide, hit.normal);
+        for(int i = 0; i < planeCount; ++i) {
+            if(glm::dot(slide, planes[i]) >= 0.0f) continue;
+            const glm::vec3 crease = glm::cross(planes[i], hit.normal);
+            const float len2 = glm::dot(crease, crease);
+            slide = len2 > 1e-12f ? crease * (glm::dot(slide, crease) / len2) : glm::vec3(0.0f);
+        }
+        planes[planeCount++] = hit.normal;
+        // Boxed in by three or more surfaces
+        for(int i = 0; i < planeCount; ++i) {
+            if(glm::dot(slide, planes[i]) < -1e-6f) slide = glm::vec3(0.0f);
+        }
+        remaining = slide;
+    }
+    
+    return depenetrate(scratch, probe, probe.position, ignoreSlot, shapes, island);
+}
+
+glm::vec3 CollisionSystem::depenetrate(QueryScratch& scratch, const CollisionBody& shape, const glm::vec3& position,
+                                       uint32_t ignoreSlot, uint32_t shapes, uint32_t island) {
+    // Out of the deepest overlap first; each push can change the others, so re-query
+    CollisionBody probe = shape;
+    probe.position = position;
+    for(int iteration = 0; iteration < kMaxDepenetrationIterations; ++iteration) {
+        const size_t count = gatherContacts(scratch, probe, ignoreSlot, shapes, island);
+        const BodyContact* deepest = nullptr;
+        for(size_t i = 0; i < count; ++i) {
+            const BodyContact& c = scratch.found[i];
+            if(c.contact.depth > 0.0f && (!deepest || c.contact.depth > deepest->contact.depth)) deepest = &c;
+        }
+        if(!deepest) break;
+        probe.position += deepest->contact.normal * (deepest->contact.depth + kSkinWidth);
+    }
+    return probe.position;
+}
+
+void CollisionSystem::moveCharacters(std::span<CharacterMove> characters, float dt, const CharacterSettings& settings) {
+    const size_t count = characters.size();
+    if(m_walkEnds.size() < count) {
+        m_walkEnds.resize(count);
+        m_walkLifts.resize(count);
+        m_walkClear.resize(count);
+        m_sampleX.resize(count);
+        m_sampleZ.resize(count);
+        m_sampleHeights.resize(count);
+        m_sampleNormals.resize(count);
+        m_groundHeights.resize(count);
+        m_groundNormals.resize(count);
+    }
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    const float minGroundNormalY = std::cos(glm::radians(settings.maxSlopeDegrees));
+    const float maxSlopeRise = std::tan(glm::radians(settings.maxSlopeDegrees));
+    // Characters sweep against everything but heightfields, which they stand on instead
+    const uint32_t bodies = kAllShapes & ~shapeBit(CollisionShape::Heightfield);
+    auto characterSlot = [&](const CharacterMove& character) {
+        const uint32_t slot = slotOf(character.body);
+        if(slot == kNoSlot || isScenery(m_shapes[slot]) || m_shapes[slot] == CollisionShape::Box) return kNoSlot;
+        return slot;
+    };
+    auto verticalSpeed = [&](const CharacterMove& character) {
+        return character.grounded ? 0.0f : character.velocity.y - settings.gravity * dt;
+    };
+
+    // A grounded character is lifted by the step height (less under a ceiling) before it walks,
+    // so it passes over anything lower and settles back down onto it afterwards. A character with
+    // no body near it (`clear`) has nothing to cast against.
+    auto walk = [&](QueryScratch& scratch, uint32_t slot, const glm::vec3& from, const glm::vec3& step,
+                    bool grounded, bool clear, float& lift) {
+        CollisionBody shape = bodyAt(slot);
+        shape.position = from;
+        lift = 0.0f;
+        if(grounded && settings.stepHeight > 0.0f && (step.x != 0.0f || step.z != 0.0f)) {
+            CollisionHit hit;
+            lift = !clear && castShape(shape, up, settings.stepHeight, hit, slot, bodies)
+                 ? std::max(hit.distance - kSkinWidth, 0.0f) : settings.stepHeight;
+        }
+        const glm::vec3 start = from + up * lift;
+        return clear ? start + step : sweepAndSlide(scratch, shape, start, start + step, slot, bodies);
+    };
+    // Whether no body but the character's own is within reach of anything its move may cast: the
+    // walk, the step-up above it and the ground search below its end
+    auto isClear = [&](uint32_t slot, const glm::vec3& step) {
+        const float reach = glm::length(step) + 2.0f * settings.stepHeight + settings.snapDistance + 4.0f * kSkinWidth;
+        bool clear = true;
+        m_tree.query(boundsOf(slot).expanded(reach), [&](int proxy) {
+            const uint32_t other = static_cast<uint32_t>(m_tree.userData(proxy));
+            clear = other == slot || !(bodies & shapeBit(m_shapes[other]));
+            return clear;
+        });
+        return clear;
+    };
+
+    // Ground a character at `end` can stand on: the body below within reach, or the heightfield
+    // surface under its feet when that is higher (even above the feet, when it walked into a rise)
+    struct Ground {
+        bool found = false;
+        float y = 0.0f;    // where the feet come to rest
+        float top = 0.0f;  // height of the point they rest on, above y when they rest on an edge
+        glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    };
+    auto findGround = [&](uint32_t slot, const glm::vec3& end, float lift, bool grounded, bool clear,
+                          float terrainY, const glm::vec3& terrainNormal) {
+        const float reach = lift + (grounded ? settings.snapDistance : 0.0f) + 2.0f * kSkinWidth;
+        Ground ground;
+        CollisionBody shape = bodyAt(slot);
+        shape.position = end;
+        CollisionHit hit;
+        if(!clear && castShape(shape, -up, reach, hit, slot, bodies)) {
+            ground = {true, end.y - hit.distance + kSkinWidth, std::max(hit.point.y, end.y - hit.distance), hit.normal};
+            // Feet resting on an edge (a step being climbed) get the edge's rounded normal; what
+            // they stand on is the face beyond it, under a short ray just past the contact
+            const glm::vec3 out(hit.point.x - end.x, 0.0f, hit.point.z - end.z);
+            const float outLength = glm::length(out);
+            if(outLength > kContactSlop) {
+                CollisionBody ray;
+                ray.shape = CollisionShape::Sphere;
+                ray.radius = 0.0f;
+                ray.position = hit.point + out * (kSkinWidth / outLength) + up * kSkinWidth;
+                CollisionHit face;
+                if(castShape(ray, -up, 2.0f * kSkinWidth, face, slot, bodies)) ground.normal = face.normal;
+            }
+        }
+        if(terrainY != Heightfield::kNoHeight && terrainY >= end.y - reach && (!ground.found || terrainY > ground.y)) {
+            ground = {true, terrainY, terrainY, terrainNormal};
+        }
+        return ground;
+    };
+
+    // Walk everyone, then sample the heightfields under the whole batch at once. Until the bodies
+    // are moved at the end every character only reads shared state, so both per-character passes
+    // run on the pool.
+    forEachRange(count, [&](QueryScratch& scratch, size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            const uint32_t slot = characterSlot(characters[i]);
+            m_walkEnds[i] = glm::vec3(0.0f);
+            if(slot == kNoSlot) continue;
+            const CharacterMove& character = characters[i];
+            const glm::vec3 step = glm::vec3(character.velocity.x, verticalSpeed(character), character.velocity.z) * dt;
+            m_walkClear[i] = isClear(slot, step);
+            m_walkEnds[i] = walk(scratch, slot, m_positions[slot], step, character.grounded, m_walkClear[i],
+                                 m_walkLifts[i]);
+        }
+    });
+    std::fill_n(m_groundHeights.begin(), count, Heightfield::kNoHeight);
+    std::fill_n(m_groundNormals.begin(), count, up);
+    for(uint32_t slot : m_heightfieldSlots) {
+        const Heightfield* heightfield = m_heightfields[slot];
+        if(!heightfield) continue;
+        const glm::vec3& origin = m_positions[slot];
+        for(size_t i = 0; i < count; ++i) {
+            m_sampleX[i] = m_walkEnds[i].x - origin.x;
+            m_sampleZ[i] = m_walkEnds[i].z - origin.z;
+        }
+        heightfield->heights(m_sampleX.data(), m_sampleZ.data(), m_sampleHeights.data(), m_sampleNormals.data(), count);
+        for(size_t i = 0; i < count; ++i) {
+            if(m_sampleHeights[i] == Heightfield::kNoHeight || m_sampleHeights[i] + origin.y <= m_groundHeights[i]) continue;
+            m_groundHeights[i] = m_sampleHeights[i] + origin.y;
+            m_groundNormals[i] = m_sampleNormals[i];
+        }
+    }
+
+    forEachRange(count, [&](QueryScratch& scratch, size_t begin, size_t rangeEnd) {
+        for(size_t i = begin; i < rangeEnd; ++i) {
+            CharacterMove& character = characters[i];
+            const uint32_t slot = characterSlot(character);
+            if(slot == kNoSlot) continue;
+            const glm::vec3 from = m_positions[slot];
+            float vy = verticalSpeed(character);
+            glm::vec3 step = glm::vec3(character.velocity.x, vy, character.velocity.z) * dt;
+            glm::vec3 end = m_walkEnds[i];
+            float lift = m_walkLifts[i];
+            const bool clear = m_walkClear[i] != 0;
+            float terrainY = m_groundHeights[i];
+            glm::vec3 terrainNormal = m_groundNormals[i];
+            Ground ground;
+            // Ground too steep to walk up (or along, for a grounded character), or a rise steeper than
+            // that over the distance walked (a heightfield cliff crossed in one step), is walked into
+            // without stepping up, so the walk slides along its side; failing that the walk turns
+            // along its contour, and failing that the character stays where it was
+            bool stepUp = character.grounded;
+            for(int attempt = 0;; ++attempt) {
+                ground = findGround(slot, end, lift, character.grounded, clear, terrainY, terrainNormal);
+                // Measured to the point stood on, or the rounded feet would ride up over any edge
+                const float climb = ground.top - from.y;
+                const float maxRise = settings.stepHeight + glm::length(glm::vec2(end.x - from.x, end.z - from.z)) * maxSlopeRise;
+                const bool steep = ground.normal.y < minGroundNormalY;
+                const bool blocked = ground.found && (climb > kSkinWidth ? steep || climb > maxRise
+                                                                         : steep && character.grounded && climb > -kSkinWidth);
+                if(!blocked || attempt == 3) break;
+                const glm::vec2 away(ground.normal.x, ground.normal.z);
+                const float awayLength2 = glm::dot(away, away);
+                const float into = glm::dot(glm::vec2(step.x, step.z), away);
+                if(stepUp && lift > 0.0f) {
+                    stepUp = false;
+                } else if(attempt <= 1 && into < 0.0f && awayLength2 > 1e-12f) {
+                    step.x -= away.x * into / awayLength2;
+                    step.z -= away.y * into / awayLength2;
+                } else {
+                    step.x = step.z = 0.0f;
+                }
+                end = walk(scratch, slot, from, step, stepUp, clear, lift);
+                terrainY = heightfieldGround(end.x, end.z, terrainNormal);
+            }
+
+            glm::vec3 position = end;
+            if(ground.found) {
+                const float fell = ground.y - end.y;
+                position.y = ground.y;
+                if(ground.normal.y >= minGroundNormalY) {
+                    character.grounded = true;
+                    character.groundNormal = ground.normal;
+                    vy = 0.0f;
+                } else {
+                    // Too steep to stand on: what the slope stopped of this step's fall carries on down it
+                    character.grounded = false;
+                    character.groundNormal = up;
+                    if(fell > 0.0f) {
+                        const glm::vec3 downhill = glm::vec3(ground.normal.x, 0.0f, ground.normal.z) * (fell * ground.normal.y);
+                        CollisionBody shape = bodyAt(slot);
+                        position = sweepAndSlide(scratch, shape, position, position + downhill, slot, bodies);
+                        glm::vec3 normal;
+                        position.y = std::max(position.y, heightfieldGround(position.x, position.z, normal));
+                    }
+                }
+            } else {
+                // Walked off an edge: drop back to walking height and start falling
+                if(character.grounded) {
+                    position.y -= lift;
+                    vy = 0.0f;
                 }
+                character.grounded = false;
+                character.groundNormal = up;
             }
+            character.velocity.y = vy;
+            character.position = position;
+            m_walkEnds[i] = position;
         }
+    });
+
+    for(size_t i = 0; i < count; ++i) {
+        if(characterSlot(characters[i]) != kNoSlot) updateBodyPosition(characters[i].body, m_walkEnds[i]);
     }
-    
-    return resolvedPos;
 }
 
-std::vector<size_t> CollisionSystem::queryRadius(const glm::vec3& center, float radius) {
-    std::vector<size_t> results;
-    for(size_t i = 0; i < m_bodies.size(); ++i) {
-        if(!m_activeSlots[i]) continue;
-        
-        float dist = glm::length(m_bodies[i].position - center);
-        if(dist <= radius + m_bodies[i].radius) {
-            results.push_back(i);
+float CollisionSystem::heightfieldGround(float x, float z, glm::vec3& normal) const {
+    float ground = Heightfield::kNoHeight;
+    normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    for(uint32_t slot : m_heightfieldSlots) {
+        float h;
+        glm::vec3 n;
+        const glm::vec3& origin = m_positions[slot];
+        if(m_heightfields[slot] && m_heightfields[slot]->height(x - origin.x, z - origin.z, h, n) && h + origin.y > ground) {
+            ground = h + origin.y;
+            normal = n;
         }
     }
-    return results;
+    return ground;
+}
+
+size_t CollisionSystem::queryRadius(const glm::vec3& center, float radius, std::span<CollisionHandle> out) {
+    CollisionBody sphere;
+    sphere.shape = CollisionShape::Sphere;
+    sphere.position = center;
+    sphere.radius = radius;
+    const size_t count = gatherContacts(m_scratch, sphere, kNoSlot);
+    const size_t written = std::min(count, out.size());
+    for(size_t i = 0; i < written; ++i) out[i] = m_scratch.found[i].body;
+    return count;
 }
 
-void CollisionSystem::removeBody(size_t index) {
-    if(index < m_activeSlots.size()) {
-        m_activeSlots[index] = false;
+size_t CollisionSystem::queryAabb(const glm::vec3& min, const glm::vec3& max, std::span<CollisionHandle> out) {
+    m_foundSlots.clear();
+    const Aabb box{glm::min(min, max), glm::max(min, max)};
+    m_tree.query(box, [&](int proxy) {
+        const uint32_t slot = static_cast<uint32_t>(m_tree.userData(proxy));
+        const float r = m_radii[slot];
+        bool overlaps = false;
+        if(m_shapes[slot] == CollisionShape::Box) {
+            overlaps = boundsOf(slot).overlaps(box);
+        } else if(m_shapes[slot] == CollisionShape::Mesh) {
+            const glm::vec3& origin = m_positions[slot];
+            overlaps = m_meshes[slot] && m_meshes[slot]->overlaps(Aabb{box.min - origin, box.max - origin});
+        } else if(m_shapes[slot] == CollisionShape::Sphere) {
+            const glm::vec3 d = m_positions[slot] - closestPointOnAabb(m_positions[slot], box);
+            overlaps = glm::dot(d, d) <= r * r;
+        } else {
+            glm::vec3 a, b, onSegment, onBox;
+            segmentOf(slot, a, b);
+            overlaps = closestPointsSegmentAabb(a, b, box, onSegment, onBox) <= r * r;
+        }
+        if(overlaps) m_foundSlots.push_back(slot);
+        return true;
+    });
+    for(uint32_t slot : m_heightfieldSlots) {
+        const glm::vec3& origin = m_positions[slot];
+        if(m_heightfields[slot] && m_heightfields[slot]->overlaps(Aabb{box.min - origin, box.max - origin})) {
+            m_foundSlots.push_back(slot);
+        }
     }
+    std::sort(m_foundSlots.begin(), m_foundSlots.end());
+    const size_t written = std::min(m_foundSlots.size(), out.size());
+    for(size_t i = 0; i < written; ++i) out[i] = handleOf(m_foundSlots[i]);
+    return m_foundSlots.size();
 }
 
-void CollisionSystem::clear() {
-    m_bodies.clear();
-    m_activeSlots.clear();
+size_t CollisionSystem::queryContacts(const CollisionBody& shape, std::span<BodyContact> out, CollisionHandle ignore) {
+    const size_t count = gatherContacts(m_scratch, shape, slotOf(ignore));
+    std::copy_n(m_scratch.found.begin(), std::min(count, out.size()), out.begin());
+    return count;
 }
 
-CollisionBody* CollisionSystem::getBody(size_t index) {
-    if(index < m_bodies.size() && m_activeSlots[index]) {
-        return &m_bodies[index];
+size_t CollisionSystem::gatherContacts(QueryScratch& scratch, const CollisionBody& shape, uint32_t ignoreSlot,
+                                      uint32_t shapes, uint32_t island) const {
+    scratch.found.clear();
+    scratch.capsuleBatch.clear();
+    scratch.boxBatch.clear();
+    scratch.capsuleSlots.clear();
+    scratch.boxSlots.clear();
+    scratch.scenerySlots.clear();
+    if(isScenery(shape.shape)) return 0;
+    const Aabb bounds = bodyBounds(shape);
+    auto collect = [&](uint32_t slot) {
+        if(slot == ignoreSlot || !(shapes & shapeBit(m_shapes[slot]))) return;
+        if(isScenery(m_shapes[slot])) {
+            scratch.scenerySlots.push_back(slot);
+        } else if(m_shapes[slot] == CollisionShape::Box) {
+            scratch.boxBatch.push(boundsOf(slot));
+            scratch.boxSlots.push_back(slot);
+        } else {
+            glm::vec3 a, b;
+            segmentOf(slot, a, b);
+            scratch.capsuleBatch.push(a, b, m_radii[slot]);
+            scratch.capsuleSlots.push_back(slot);
+        }
+    };
+    m_tree.query(bounds, [&](int proxy) {
+        const uint32_t slot = static_cast<uint32_t>(m_tree.userData(proxy));
+        if(m_moveIslands[slot] == island || !m_moveIslands[slot]) collect(slot);
+        return true;
+    });
+    if(shapes & shapeBit(CollisionShape::Heightfield)) {
+        for(uint32_t slot : m_heightfieldSlots) {
+            if(slot != ignoreSlot && boundsOf(slot).overlaps(bounds)) scratch.scenerySlots.push_back(slot);
+        }
+    }
+
+    const size_t capacity = std::max(scratch.capsuleBatch.size(), scratch.boxBatch.size());
+    if(scratch.hits.size() < capacity) {
+        scratch.hits.resize(capacity);
+        scratch.contacts.resize(capacity);
+    }
+    uint32_t* hits = scratch.hits.data();
+    Contact* contacts = scratch.contacts.data();
+    auto emit = [&](size_t count, const std::vector<uint32_t>& slots) {
+        for(size_t k = 0; k < count; ++k) scratch.found.push_back({handleOf(slots[hits[k]]), contacts[k]});
+    };
+    if(shape.shape == CollisionShape::Box) {
+        emit(aabbCapsuleContacts(bounds, scratch.capsuleBatch, hits, contacts), scratch.capsuleSlots);
+        emit(aabbAabbContacts(bounds, scratch.boxBatch, hits, contacts), scratch.boxSlots);
+    } else {
+        glm::vec3 a, b;
+        coreSegment(shape, a, b);
+        emit(capsuleCapsuleContacts(a, b, shape.radius, scratch.capsuleBatch, hits, contacts), scratch.capsuleSlots);
+        emit(capsuleAabbContacts(a, b, shape.radius, scratch.boxBatch, hits, contacts), scratch.boxSlots);
+    }
+    // Meshes and heightfields are few and large; each runs its own triangle search
+    for(uint32_t slot : scratch.scenerySlots) {
+        Contact contact;
+        if(sceneryContact(shape, bodyAt(slot), contact)) scratch.found.push_back({handleOf(slot), contact});
+    }
+    std::sort(scratch.found.begin(), scratch.found.end(),
+              [](const BodyContact& x, const BodyContact& y) { return x.body.slot() < y.body.slot(); });
+    return scratch.found.size();
+}
+
+bool CollisionSystem::contact(CollisionHandle a, CollisionHandle b, Contact& out) const {
+    const uint32_t slotA = slotOf(a), slotB = slotOf(b);
+    if(slotA == kNoSlot || slotB == kNoSlot || slotA == slotB) return false;
+    return bodyContact(bodyAt(slotA), bodyAt(slotB), out);
+}
+
+bool CollisionSystem::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                              CollisionHit& hit, CollisionHandle ignore) const {
+    return sphereCast(origin, 0.0f, direction, maxDistance, hit, ignore);
+}
+
+bool CollisionSystem::sphereCast(const glm::vec3& center, float radius, const glm::vec3& direction, float maxDistance,
+                                 CollisionHit& hit, CollisionHandle ignore) const {
+    CollisionBody sphere;
+    sphere.shape = CollisionShape::Sphere;
+    sphere.position = center;
+    sphere.radius = radius;
+    return castShape(sphere, direction, maxDistance, hit, slotOf(ignore));
+}
+
+bool CollisionSystem::capsuleCast(const glm::vec3& base, float radius, float height, const glm::vec3& direction,
+                                  float maxDistance, CollisionHit& hit, CollisionHandle ignore) const {
+    CollisionBody capsule;
+    capsule.shape = CollisionShape::Capsule;
+    capsule.position = base;
+    capsule.radius = radius;
+    capsule.height = height;
+    return castShape(capsule, direction, maxDistance, hit, slotOf(ignore));
+}
+
+bool CollisionSystem::boxCast(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& direction,
+                              float maxDistance, CollisionHit& hit, CollisionHandle ignore) const {
+    CollisionBody box;
+    box.shape = CollisionShape::Box;
+    box.position = center;
+    box.halfExtents = halfExtents;
+    return castShape(box, direction, maxDistance, hit, slotOf(ignore));
+}
+
+bool CollisionSystem::sweepBody(CollisionHandle body, const glm::vec3& from, const glm::vec3& to, CollisionHit& hit) const {
+    hit = CollisionHit();
+    const uint32_t slot = slotOf(body);
+    if(slot == kNoSlot) return false;
+    CollisionBody probe = bodyAt(slot);
+    probe.position = from;
+    return castShape(probe, to - from, glm::length(to - from), hit, slot);
+}
+
+bool CollisionSystem::castShape(const CollisionBody& shape, const glm::vec3& direction, float maxDistance,
+                                CollisionHit& hit, uint32_t ignoreSlot, uint32_t shapes,
+                                uint32_t island) const {
+    hit = CollisionHit();
+    const float len = glm::length(direction);
+    if(len < 1e-6f || !(maxDistance >= 0.0f) || isScenery(shape.shape)) return false;
+    const glm::vec3 dir = direction / len;
+    const Aabb bounds = bodyBounds(shape);
+    glm::vec3 a, b;
+    if(shape.shape != CollisionShape::Box) coreSegment(shape, a, b);
+    const bool point = shape.shape == CollisionShape::Sphere;
+    uint32_t hitSlot = kNoSlot;
+
+    // Casts against one body; returns the new reach of the cast
+    auto castAgainst = [&](uint32_t slot, float tMax) {
+        if(slot == ignoreSlot || !(shapes & shapeBit(m_shapes[slot]))) return tMax;
+        float t = 0.0f;
+        bool touched = false;
+        if(m_shapes[slot] == CollisionShape::Mesh) {
+            const TriangleMesh* mesh = m_meshes[slot];
+            const glm::vec3& origin = m_positions[slot];
+            if(mesh) {
+                touched = shape.shape == CollisionShape::Box
+                        ? mesh->aabbCast(Aabb{bounds.min - origin, bounds.max - origin}, dir, tMax, t)
+                        : mesh->capsuleCast(a - origin, b - origin, shape.radius, dir, tMax, t);
+            }
+        } else if(m_shapes[slot] == CollisionShape::Heightfield) {
+            const Heightfield* heightfield = m_heightfields[slot];
+            const glm::vec3& origin = m_positions[slot];
+            if(heightfield) {
+                touched = shape.shape == CollisionShape::Box
+                        ? heightfield->aabbCast(Aabb{bounds.min - origin, bounds.max - origin}, dir, tMax, t)
+                        : heightfield->capsuleCast(a - origin, b - origin, shape.radius, dir, tMax, t);
+            }
+        } else if(m_shapes[slot] == CollisionShape::Box) {
+            const Aabb target = boundsOf(slot);
+            if(shape.shape == CollisionShape::Box) {
+                const glm::vec3 half = bounds.halfExtents();
+                touched = rayCastAabb(bounds.center(), dir, tMax, Aabb{target.min - half, target.max + half}, t);
+            } else {
+                touched = point ? rayCastRoundedAabb(a, dir, tMax, target, shape.radius, t)
+                                : capsuleCastAabb(a, b, shape.radius, dir, tMax, target, t);
+            }
+        } else {
+            glm::vec3 c0, c1;
+            segmentOf(slot, c0, c1);
+            const float radius = m_radii[slot];
+            if(shape.shape == CollisionShape::Box) {
+                // A box moving along dir meets a body when the body moving along -dir meets the box
+                touched = c0 == c1 ? rayCastRoundedAabb(c0, -dir, tMax, bounds, radius, t)
+                                   : capsuleCastAabb(c0, c1, radius, -dir, tMax, bounds, t);
+            } else if(point) {
+                touched = c0 == c1 ? rayCastSphere(a, dir, tMax, c0, radius + shape.radius, t)
+                                   : rayCastCapsule(a, dir, tMax, c0, c1, radius + shape.radius, t);
+            } else {
+                touched = capsuleCastCapsule(a, b, shape.radius, dir, tMax, c0, c1, radius, t);
+            }
+        }
+        // Ties go to the lower slot so the result does not depend on the tree's shape
+        if(!touched || (hit.hit && (t > hit.distance || (t == hit.distance && slot > hitSlot)))) return tMax;
+        hit.hit = true;
+        hitSlot = slot;
+        hit.distance = t;
+        return t;
+    };
+    // Heightfields first: a hit on one shortens the sweep through the tree
+    float reach = maxDistance;
+    for(uint32_t slot : m_heightfieldSlots) reach = castAgainst(slot, reach);
+    m_tree.sweep(bounds, dir, reach, [&](int proxy, float tMax) {
+        const uint32_t slot = static_cast<uint32_t>(m_tree.userData(proxy));
+        return m_moveIslands[slot] == island || !m_moveIslands[slot] ? castAgainst(slot, tMax) : tMax;
+    });
+    if(!hit.hit) return false;
+    hit.body = handleOf(hitSlot);
+
+    // The shapes touch at the time of impact; a caster backed off a little and grown a little more
+    // overlaps the body there, and its contact gives the normal from the closest features (or the
+    // way out, when it started inside). Backing off keeps those features apart, which matters
+    // for meshes: a surface has no inside to tell which way out is.
+    CollisionBody probe = shape;
+    probe.position += dir * (hit.distance - kContactSlop);
+    probe.radius += 2.0f * kContactSlop;
+    probe.halfExtents += glm::vec3(2.0f * kContactSlop);
+    Contact contact;
+    if(bodyContact(probe, bodyAt(hitSlot), contact)) {
+        hit.normal = contact.normal;
+        hit.point = contact.point;
+    } else {
+        hit.normal = -dir;
+        hit.point = probe.position;
+    }
+    return true;
+}
+
+void CollisionSystem::removeBody(CollisionHandle body) {
+    const uint32_t slot = slotOf(body);
+    if(slot == kNoSlot) return;
+    if(m_proxies[slot] != kOutsideTree) m_tree.destroyProxy(m_proxies[slot]);
+    m_proxies[slot] = AabbTree::kNull;
+    m_userData[slot] = nullptr;
+    m_meshes[slot] = nullptr;
+    if(m_shapes[slot] == CollisionShape::Heightfield) {
+        m_heightfieldSlots.erase(std::lower_bound(m_heightfieldSlots.begin(), m_heightfieldSlots.end(), slot));
+        m_heightfields[slot] = nullptr;
     }
-    return nullptr;
+    m_generations[slot] = nextGeneration(m_generations[slot]);
+    m_freeSlots.push_back(slot);
+    --m_bodyCount;
 }
 
-bool CollisionSystem::sphereVsSphere(const glm::vec3& pos1, float r1, const glm::vec3& pos2, float r2) {
-    float dist = glm::length(pos1 - pos2);
-    return dist < (r1 + r2);
+void CollisionSystem::clear() {
+    // Slots and generations stay, so handles from before the clear never match a later body
+    m_freeSlots.clear();
+    for(uint32_t slot = static_cast<uint32_t>(m_generations.size()); slot-- > 0;) {
+        if(m_proxies[slot] != AabbTree::kNull) {
+            m_proxies[slot] = AabbTree::kNull;
+            m_userData[slot] = nullptr;
+            m_meshes[slot] = nullptr;
+            m_heightfields[slot] = nullptr;
+            m_generations[slot] = nextGeneration(m_generations[slot]);
+        }
+        m_freeSlots.push_back(slot);
+    }
+    m_heightfieldSlots.clear();
+    m_bodyCount = 0;
+    m_tree.clear();
 }
 
-bool CollisionSystem::capsuleVsCapsule(const CollisionBody& a, const CollisionBody& b) {
-    // Simplified: treat as sphere at center for now
-    return sphereVsSphere(a.position, a.radius, b.position, b.radius);
+bool CollisionSystem::getBody(CollisionHandle body, CollisionBody& out) const {
+    const uint32_t slot = slotOf(body);
+    if(slot == kNoSlot) return false;
+    out = bodyAt(slot);
+    return true;
 }
 
 glm::vec3 CollisionSystem::slideAlongSurface(const glm::vec3& velocity, const glm::vec3& normal) {
@@ -1,57 +1,286 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <vector>
+#include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
+#include "AabbTree.h"
+#include "Heightfield.h"
+#include "Narrowphase.h"
+#include "TriangleMesh.h"
+
+class ThreadPool;
 
 // Simple collision shapes for character and future 3D objects
 enum class CollisionShape {
     Sphere,
     Capsule,
-    Box
+    Box,
+    Mesh,
+    Heightfield
 };
 
+// Capsules stand on `position` (their base) and run up `height`; boxes are axis-aligned; mesh and
+// heightfield bodies place their TriangleMesh / Heightfield with its origin at `position`
 struct CollisionBody {
     CollisionShape shape = CollisionShape::Capsule;
     glm::vec3 position{0.0f};
     float radius = 0.5f;      // For sphere/capsule
     float height = 1.0f;      // For capsule
     glm::vec3 halfExtents{0.5f}; // For box
+    const TriangleMesh* mesh = nullptr;  // For mesh; not owned, must outlive the body
+    const Heightfield* heightfield = nullptr;  // For heightfield; not owned, must outlive the body
     bool isStatic = false;
     void* userData = nullptr;  // Back-reference to game object
 };
 
-// Simple collision detection and response
+// Body handle: a 20-bit storage slot and a 12-bit generation that changes whenever the slot's
+// body is removed, so a handle kept past removeBody matches nothing instead of whichever body
+// reuses the slot. The default (zero) handle is never a body.
+struct CollisionHandle {
+    static constexpr uint32_t kSlotBits = 20;
+    static constexpr uint32_t kSlotMask = (1u << kSlotBits) - 1;
+
+    uint32_t value = 0;
+
+    uint32_t slot() const { return value & kSlotMask; }
+    uint32_t generation() const { return value >> kSlotBits; }
+    explicit operator bool() const { return value != 0; }
+    bool operator==(const CollisionHandle&) const = default;
+};
+
+// Result of a ray or shape cast: the first body touched along the direction
+struct CollisionHit {
+    bool hit = false;
+    CollisionHandle body;
+    float distance = 0.0f;   // travelled before contact; 0 when the shape starts overlapping
+    glm::vec3 point{0.0f};   // contact point on the body's surface
+    glm::vec3 normal{0.0f};  // surface normal at the contact, facing the caster
+};
+
+struct BodyContact {
+    CollisionHandle body;
+    Contact contact;  // normal pushes the query shape out of the body
+};
+
+// Walking rules shared by a batch of characters (see CollisionSystem::moveCharacters)
+struct CharacterSettings {
+    float stepHeight = 0.35f;       // ledges and rises up to this tall are walked onto
+    float maxSlopeDegrees = 50.0f;  // steeper ground cannot be walked up and does not hold a character
+    float snapDistance = 0.3f;      // ground dropping away by up to this per move is followed down
+    float gravity = 20.0f;
+};
+
+// A kinematic character: a capsule or sphere body whose position is its base (the feet)
+struct CharacterMove {
+    CollisionHandle body;
+    glm::vec3 velocity{0.0f};  // x/z: desired walking velocity; y: vertical speed, updated by the move
+    bool grounded = false;     // updated by the move
+    glm::vec3 groundNormal{0.0f, 1.0f, 0.0f};  // out: ground under the feet, straight up while airborne
+    glm::vec3 position{0.0f};  // out: the body's position after the move
+};
+
+// A body moved by CollisionSystem::resolveMovements
+struct BodyMove {
+    CollisionHandle body;
+    glm::vec3 target{0.0f};    // where the body is headed from where it stands
+    glm::vec3 position{0.0f};  // out: where it ended up
+};
+
+// Simple collision detection and response. Bodies live in a dynamic AABB tree, so queries and
+// casts only test bodies whose bounds they reach; heightfields are kept beside it.
+//
+// Body data is stored structure-of-arrays by slot, and freed slots are reused from a free list.
+// Queries write into caller-provided spans and work in scratch buffers that only grow, so
+// once those have reached their working size a frame of collision work allocates nothing.
 class CollisionSystem {
 public:
-    // Register a collision body (returns index)
-    size_t addBody(const CollisionBody& body);
-    
-    // Update body position
-    void updateBodyPosition(size_t index, const glm::vec3& position);
-    
+    // Register a collision body. Returns a null handle once all 2^20 slots are in use.
+    CollisionHandle addBody(const CollisionBody& body);
+
+    // Update body position; also the only way to move a body the queries will see
+    void updateBodyPosition(CollisionHandle body, const glm::vec3& position);
+
     // Check if moving from 'from' to 'to' would collide
-    // Returns adjusted position (slides along obstacles)
-    glm::vec3 resolveMovement(size_t bodyIndex, const glm::vec3& from, const glm::vec3& to);
-    
+    // Returns adjusted position (slides along obstacles). The body's shape is swept along the
+    // whole move, so any step length is safe, and the slide is capped at a few passes.
+    // Mesh and heightfield bodies are scenery and are not moved.
+    glm::vec3 resolveMovement(CollisionHandle body, const glm::vec3& from, const glm::vec3& to);
+
+    // resolveMovement for a batch: each body is moved toward its target and left where it ended
+    // up, as by calling resolveMovement then updateBodyPosition for every move in span order (to
+    // rounding, where bodies start inside each other). Moves whose reach (the body's bounds grown
+    // by its move) overlaps are joined into islands; islands cannot touch each other, so they are
+    // resolved in parallel on the system's ThreadPool while each island runs its moves in span
+    // order. Results do not depend on the thread count. Mesh and heightfield bodies go straight
+    // to their targets before anything else moves. A body may appear at most once.
+    void resolveMovements(std::span<BodyMove> moves);
+
+    // One step of dt for a batch of characters: each steps up onto ledges up to stepHeight,
+    // slides along the bodies it walks into, cannot climb ground steeper than maxSlope, and
+    // follows the ground down (or falls under gravity once it leaves it). Characters stand on
+    // heightfields rather than colliding with them; the ground under the whole batch is sampled
+    // with one Heightfield::heights call per heightfield. Characters see each other where they
+    // stood before the batch, so they are walked in parallel on the system's ThreadPool and their
+    // bodies are only moved at the end, in span order.
+    void moveCharacters(std::span<CharacterMove> characters, float dt, const CharacterSettings& settings = {});
+
+    // Pool the batch moves run on; nullptr (the default) is ThreadPool::shared(). The pool must
+    // outlive the system or be reset first.
+    void setThreadPool(ThreadPool* pool) { m_pool = pool; }
+
+    // Overlap queries write up to out.size() matches in slot order and return how many bodies
+    // matched, which is more than out.size() when the span was too small.
+
     // Query all bodies within radius of point
-    std::vector<size_t> queryRadius(const glm::vec3& center, float radius);
-    
-    // Remove a body
-    void removeBody(size_t index);
-    
-    // Clear all bodies
+    size_t queryRadius(const glm::vec3& center, float radius, std::span<CollisionHandle> out);
+
+    // Query all bodies overlapping an axis-aligned box
+    size_t queryAabb(const glm::vec3& min, const glm::vec3& max, std::span<CollisionHandle> out);
+
+    // Every body overlapping `shape` (placed and sized like a body) with its contact.
+    // Broadphase candidates go through the batch narrowphase; meshes and heightfields report
+    // their deepest contact. A mesh or heightfield query shape matches nothing.
+    size_t queryContacts(const CollisionBody& shape, std::span<BodyContact> out, CollisionHandle ignore = {});
+
+    // Contact between two registered bodies, normal pushing `a` out of `b`; meshes and heightfields
+    // never touch each other
+    bool contact(CollisionHandle a, CollisionHandle b, Contact& out) const;
+
+    // First body hit by a ray / moving sphere / moving capsule / moving box along `direction`
+    // within maxDistance; `ignore` is skipped (typically the caster's own body)
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                 CollisionHit& hit, CollisionHandle ignore = {}) const;
+    bool sphereCast(const glm::vec3& center, float radius, const glm::vec3& direction, float maxDistance,
+                    CollisionHit& hit, CollisionHandle ignore = {}) const;
+    bool capsuleCast(const glm::vec3& base, float radius, float height, const glm::vec3& direction,
+                     float maxDistance, CollisionHit& hit, CollisionHandle ignore = {}) const;
+    bool boxCast(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& direction,
+                 float maxDistance, CollisionHit& hit, CollisionHandle ignore = {}) const;
+
+    // Time of impact of a body's shape moved from `from` to `to`: the first body it would hit,
+    // with hit.distance measured along the move
+    bool sweepBody(CollisionHandle body, const glm::vec3& from, const glm::vec3& to, CollisionHit& hit) const;
+
+    // Remove a body; its handle (and every copy of it) goes stale
+    void removeBody(CollisionHandle body);
+
+    // Clear all bodies; every handle goes stale
     void clear();
-    
-    // Get body by index
-    CollisionBody* getBody(size_t index);
+
+    // Whether the handle still names a registered body
+    bool isValid(CollisionHandle body) const { return slotOf(body) != kNoSlot; }
+
+    // Copy of a body's description; false for a stale handle. To move a body use
+    // updateBodyPosition; to reshape it, remove and re-add it.
+    bool getBody(CollisionHandle body, CollisionBody& out) const;
+
+    size_t bodyCount() const { return m_bodyCount; }
+    const AabbTree& broadphase() const { return m_tree; }
 
 private:
-    std::vector<CollisionBody> m_bodies;
-    std::vector<bool> m_activeSlots;
-    
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+    static constexpr int kOutsideTree = -2;  // m_proxies entry of a heightfield body
+    // Masks of CollisionShape values a query considers
+    static constexpr uint32_t shapeBit(CollisionShape shape) { return 1u << static_cast<uint32_t>(shape); }
+    static constexpr uint32_t kAllShapes = ~0u;
+
+    // Body storage by slot
+    std::vector<CollisionShape> m_shapes;
+    std::vector<glm::vec3> m_positions;
+    std::vector<float> m_radii;
+    std::vector<float> m_heights;
+    std::vector<glm::vec3> m_halfExtents;
+    std::vector<const TriangleMesh*> m_meshes;
+    std::vector<const Heightfield*> m_heightfields;
+    std::vector<uint8_t> m_static;
+    std::vector<void*> m_userData;
+    std::vector<int> m_proxies;            // broadphase proxy or kOutsideTree; AabbTree::kNull while the slot is free
+    std::vector<uint16_t> m_generations;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_bodyCount = 0;
+    AabbTree m_tree;
+    // Every heightfield body, ascending. Heightfields span the world, and one in the tree would
+    // sit in the box of every node above it, so they stay out of it (their proxy is kOutsideTree)
+    // and every query tests them directly.
+    std::vector<uint32_t> m_heightfieldSlots;
+
+    // Query scratch: candidates split by kind and packed for the batch tests, and the results.
+    // Serial queries use m_scratch; each pool lane of a batch move has its own.
+    struct QueryScratch {
+        CapsuleBatch capsuleBatch;      // spheres and capsules
+        AabbBatch boxBatch;
+        std::vector<uint32_t> capsuleSlots;
+        std::vector<uint32_t> boxSlots;
+        std::vector<uint32_t> scenerySlots;   // meshes and heightfields
+        std::vector<uint32_t> hits;
+        std::vector<Contact> contacts;
+        std::vector<BodyContact> found;
+    };
+    QueryScratch m_scratch;
+    std::vector<QueryScratch> m_laneScratch;
+    ThreadPool* m_pool = nullptr;
+    std::vector<uint32_t> m_foundSlots;
+    // By slot, 1 + the island of a body being moved by resolveMovements (0 when it is not). The
+    // tree holds such a body by its whole reach, and queries skip it unless it is in their island.
+    std::vector<uint32_t> m_moveIslands;
+    // resolveMovements scratch, by move: slot, start, reach and broadphase fat box of each mover,
+    // the movers sorted by reach for the pair sweep, union-find parents, and the islands as
+    // ranges of moves in span order
+    std::vector<uint32_t> m_moveSlots;
+    std::vector<glm::vec3> m_moveFrom;
+    std::vector<Aabb> m_moveReach;
+    std::vector<Aabb> m_moveFatBoxes;
+    std::vector<uint32_t> m_moveOrder;
+    std::vector<uint32_t> m_islandParent;
+    std::vector<uint32_t> m_islandIndex;
+    std::vector<uint32_t> m_islandStart;
+    std::vector<uint32_t> m_islandMoves;
+    // moveCharacters scratch: where each character's walk ended, whether it had bodies near it,
+    // and the ground sampled there
+    std::vector<glm::vec3> m_walkEnds;
+    std::vector<float> m_walkLifts;
+    std::vector<uint8_t> m_walkClear;
+    std::vector<float> m_sampleX;
+    std::vector<float> m_sampleZ;
+    std::vector<float> m_sampleHeights;
+    std::vector<glm::vec3> m_sampleNormals;
+    std::vector<float> m_groundHeights;
+    std::vector<glm::vec3> m_groundNormals;
+
+    uint32_t slotOf(CollisionHandle body) const;
+    CollisionHandle handleOf(uint32_t slot) const {
+        return {(static_cast<uint32_t>(m_generations[slot]) << CollisionHandle::kSlotBits) | slot};
+    }
+    CollisionBody bodyAt(uint32_t slot) const;
+    Aabb boundsOf(uint32_t slot) const;
+    // Core segment of a sphere (a single point) or capsule slot
+    void segmentOf(uint32_t slot, glm::vec3& a, glm::vec3& b) const;
+
     // Collision detection helpers
-    bool sphereVsSphere(const glm::vec3& pos1, float r1, const glm::vec3& pos2, float r2);
-    bool capsuleVsCapsule(const CollisionBody& a, const CollisionBody& b);
     glm::vec3 slideAlongSurface(const glm::vec3& velocity, const glm::vec3& normal);
+    // The queries below test bodies of a shape in `shapes` only and, of the bodies being moved by
+    // resolveMovements, only those of `island` (as numbered in m_moveIslands).
+    // Fills scratch.found with every body overlapping `shape`, in slot order; returns the count
+    size_t gatherContacts(QueryScratch& scratch, const CollisionBody& shape, uint32_t ignoreSlot,
+                          uint32_t shapes = kAllShapes, uint32_t island = 0) const;
+    // First body hit by `shape` (placed and sized like a body) moving along direction
+    bool castShape(const CollisionBody& shape, const glm::vec3& direction, float maxDistance,
+                   CollisionHit& hit, uint32_t ignoreSlot, uint32_t shapes = kAllShapes,
+                   uint32_t island = 0) const;
+    // `shape` moved from `position` out of everything it overlaps (a few passes at most)
+    glm::vec3 depenetrate(QueryScratch& scratch, const CollisionBody& shape, const glm::vec3& position,
+                          uint32_t ignoreSlot, uint32_t shapes = kAllShapes, uint32_t island = 0);
+    // resolveMovement's sweep and slide
+    glm::vec3 sweepAndSlide(QueryScratch& scratch, const CollisionBody& shape, const glm::vec3& from,
+                            const glm::vec3& to, uint32_t ignoreSlot, uint32_t shapes,
+                            uint32_t island = 0);
+    // fn(scratch, begin, end) over ranges covering [0, count): on the caller alone, with
+    // m_scratch, for small counts or a single-lane pool, otherwise on the system's ThreadPool
+    // with one scratch per range
+    template <typename Fn>
+    void forEachRange(size_t count, Fn&& fn);
+    // Highest heightfield surface at x/z (Heightfield::kNoHeight when there is none)
+    float heightfieldGround(float x, float z, glm::vec3& normal) const;
 };
@@ -0,0 +1,266 @@
+#include "Heightfield.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEIGHTFIELD_SSE2 1
+#endif
+
+void Heightfield::assign(std::vector<float> heights, int resolution, float worldSize) {
+    if(resolution < 2 || !(worldSize > 0.0f) || heights.size() < static_cast<size_t>(resolution) * resolution) {
+        clear();
+        return;
+    }
+    m_heights = std::move(heights);
+    m_heights.resize(static_cast<size_t>(resolution) * resolution);
+    m_resolution = resolution;
+    m_worldSize = worldSize;
+    m_half = worldSize * 0.5f;
+    m_step = worldSize / (resolution - 1);
+    m_invStep = (resolution - 1) / worldSize;
+    const auto range = std::minmax_element(m_heights.begin(), m_heights.end());
+    m_bounds = {glm::vec3(-m_half, *range.first - kSolidDepth, -m_half), glm::vec3(m_half, *range.second, m_half)};
+}
+
+void Heightfield::clear() {
+    m_heights.clear();
+    m_resolution = 0;
+    m_worldSize = m_half = m_step = m_invStep = 0.0f;
+    m_bounds = Aabb();
+}
+
+bool Heightfield::height(float x, float z, float& h, glm::vec3& normal) const {
+    const float tx = (x + m_half) * m_invStep;
+    const float tz = (z + m_half) * m_invStep;
+    const float maxT = static_cast<float>(m_resolution - 1);
+    if(empty() || !(tx >= 0.0f && tx <= maxT && tz >= 0.0f && tz <= maxT)) {
+        h = kNoHeight;
+        normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        return false;
+    }
+    const int ix = std::min(static_cast<int>(tx), m_resolution - 2);
+    const int iz = std::min(static_cast<int>(tz), m_resolution - 2);
+    const float fx = tx - static_cast<float>(ix);
+    const float fz = tz - static_cast<float>(iz);
+    const float h00 = sample(ix, iz), h10 = sample(ix + 1, iz);
+    const float h01 = sample(ix, iz + 1), h11 = sample(ix + 1, iz + 1);
+    // Slopes of the triangle under the point: (x + 1, z) side of the diagonal or (x, z + 1) side
+    const float dx = fx >= fz ? h10 - h00 : h11 - h01;
+    const float dz = fx >= fz ? h11 - h10 : h01 - h00;
+    h = h00 + dx * fx + dz * fz;
+    const float gx = dx * m_invStep;
+    const float gz = dz * m_invStep;
+    const float invLength = 1.0f / std::sqrt(gx * gx + gz * gz + 1.0f);
+    normal = glm::vec3(-(gx * invLength), invLength, -(gz * invLength));
+    return true;
+}
+
+void Heightfield::heights(const float* xs, const float* zs, float* outHeights, glm::vec3* outNormals,
+                          size_t count) const {
+    size_t i = 0;
+#ifdef HEIGHTFIELD_SSE2
+    // Same steps as height(), four points per step; the corner fetches stay scalar (SSE2 has no
+    // gather) and the branches become masks
+    if(!empty()) {
+        const __m128 half = _mm_set1_ps(m_half);
+        const __m128 invStep = _mm_set1_ps(m_invStep);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        const __m128 noHeight = _mm_set1_ps(kNoHeight);
+        const __m128 maxT = _mm_set1_ps(static_cast<float>(m_resolution - 1));
+        const __m128i maxCell = _mm_set1_epi32(m_resolution - 2);
+        auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+        for(; i + 4 <= count; i += 4) {
+            __m128 tx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(xs + i), half), invStep);
+            __m128 tz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(zs + i), half), invStep);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(tx, zero), _mm_cmple_ps(tx, maxT)),
+                                       _mm_and_ps(_mm_cmpge_ps(tz, zero), _mm_cmple_ps(tz, maxT)));
+            // Outside lanes are clamped into range so their (discarded) fetches stay in bounds
+            tx = _mm_and_ps(inside, tx);
+            tz = _mm_and_ps(inside, tz);
+            __m128i ix = _mm_cvttps_epi32(tx);
+            __m128i iz = _mm_cvttps_epi32(tz);
+            __m128i overX = _mm_cmpgt_epi32(ix, maxCell);
+            __m128i overZ = _mm_cmpgt_epi32(iz, maxCell);
+            ix = _mm_or_si128(_mm_andnot_si128(overX, ix), _mm_and_si128(overX, maxCell));
+            iz = _mm_or_si128(_mm_andnot_si128(overZ, iz), _mm_and_si128(overZ, maxCell));
+            const __m128 fx = _mm_sub_ps(tx, _mm_cvtepi32_ps(ix));
+            const __m128 fz = _mm_sub_ps(tz, _mm_cvtepi32_ps(iz));
+
+            alignas(16) int ixs[4], izs[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+            _mm_store_si128(reinterpret_cast<__m128i*>(izs), iz);
+            alignas(16) float h00[4], h10[4], h01[4], h11[4];
+            for(int lane = 0; lane < 4; ++lane) {
+                h00[lane] = sample(ixs[lane], izs[lane]);
+                h10[lane] = sample(ixs[lane] + 1, izs[lane]);
+                h01[lane] = sample(ixs[lane], izs[lane] + 1);
+                h11[lane] = sample(ixs[lane] + 1, izs[lane] + 1);
+            }
+            const __m128 a = _mm_load_ps(h00), b = _mm_load_ps(h10), c = _mm_load_ps(h01), d = _mm_load_ps(h11);
+            const __m128 lower = _mm_cmpge_ps(fx, fz);
+            const __m128 dx = select(lower, _mm_sub_ps(b, a), _mm_sub_ps(d, c));
+            const __m128 dz = select(lower, _mm_sub_ps(d, b), _mm_sub_ps(c, a));
+            const __m128 h = _mm_add_ps(_mm_add_ps(a, _mm_mul_ps(dx, fx)), _mm_mul_ps(dz, fz));
+            const __m128 gx = _mm_mul_ps(dx, invStep);
+            const __m128 gz = _mm_mul_ps(dz, invStep);
+            const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gz, gz)), one)));
+            _mm_storeu_ps(outHeights + i, select(inside, h, noHeight));
+
+            alignas(16) float nx[4], ny[4], nz[4];
+            _mm_store_ps(nx, _mm_and_ps(inside, _mm_xor_ps(_mm_mul_ps(gx, invLength), signBit)));
+            _mm_store_ps(ny, select(inside, invLength, one));
+            _mm_store_ps(nz, _mm_and_ps(inside, _mm_xor_ps(_mm_mul_ps(gz, invLength), signBit)));
+            for(int lane = 0; lane < 4; ++lane) outNormals[i + lane] = glm::vec3(nx[lane], ny[lane], nz[lane]);
+        }
+    }
+#endif
+    for(; i < count; ++i) height(xs[i], zs[i], outHeights[i], outNormals[i]);
+}
+
+template <typename Fn>
+void Heightfield::forEachTriangle(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const {
+    if(empty()) return;
+    const glm::vec3 travel = dir * tMax;
+    const Aabb swept = box.merged(Aabb{box.min + travel, box.max + travel});
+    if(!swept.overlaps(m_bounds)) return;
+    const int lastCell = m_resolution - 2;
+    auto cellOf = [&](float v) {
+        return std::clamp(static_cast<int>(std::floor((v + m_half) * m_invStep)), 0, lastCell);
+    };
+    // Row by row, only the cells the box passes over while it overlaps that row, so a long
+    // diagonal cast visits a band of cells rather than its whole bounding rectangle
+    const float margin = m_step * 1e-3f;
+    const int iz1 = cellOf(swept.max.z);
+    for(int iz = cellOf(swept.min.z); iz <= iz1; ++iz) {
+        const float z0 = iz * m_step - m_half - margin;
+        const float z1 = z0 + m_step + 2.0f * margin;
+        float tLo = 0.0f, tHi = tMax;
+        if(dir.z > 0.0f) {
+            tLo = std::max(tLo, (z0 - box.max.z) / dir.z);
+            tHi = std::min(tHi, (z1 - box.min.z) / dir.z);
+        } else if(dir.z < 0.0f) {
+            tLo = std::max(tLo, (z1 - box.min.z) / dir.z);
+            tHi = std::min(tHi, (z0 - box.max.z) / dir.z);
+        }
+        if(tLo > tHi) continue;
+        const float xLo = std::min(box.min.x + dir.x * tLo, box.min.x + dir.x * tHi);
+        const float xHi = std::max(box.max.x + dir.x * tLo, box.max.x + dir.x * tHi);
+        const float yLo = std::min(box.min.y + dir.y * tLo, box.min.y + dir.y * tHi);
+        const int ix1 = cellOf(xHi);
+        for(int ix = cellOf(xLo); ix <= ix1; ++ix) {
+            const glm::vec3 p00 = point(ix, iz), p10 = point(ix + 1, iz);
+            const glm::vec3 p01 = point(ix, iz + 1), p11 = point(ix + 1, iz + 1);
+            if(std::max(std::max(p00.y, p10.y), std::max(p01.y, p11.y)) < yLo) continue;
+            if(!fn(p00, p10, p11) || !fn(p00, p11, p01)) return;
+        }
+    }
+}
+
+bool Heightfield::buriedContact(const glm::vec3& center, float radius, const glm::vec3& halfExtents,
+                                Contact& contact) const {
+    float h;
+    glm::vec3 n;
+    if(!height(center.x, center.z, h, n) || center.y >= h) return false;
+    // Distance from the center up to the face plane, plus the shape's extent along the normal
+    const float below = (h - center.y) * n.y;
+    contact.normal = n;
+    contact.depth = below + radius + glm::dot(glm::abs(n), halfExtents);
+    contact.point = center + n * below;
+    return true;
+}
+
+bool Heightfield::capsuleContact(const glm::vec3& a0, const glm::vec3& a1, float radius, Contact& contact) const {
+    bool found = false;
+    for(const glm::vec3& end : {a0, a1}) {
+        Contact c;
+        if(buriedContact(end, radius, glm::vec3(0.0f), c) && (!found || c.depth > contact.depth)) {
+            contact = c;
+            found = true;
+        }
+    }
+    if(found) return true;
+    // The core is above the surface, so the two-sided triangle contacts all point up out of it
+    const Aabb box{glm::min(a0, a1) - glm::vec3(radius), glm::max(a0, a1) + glm::vec3(radius)};
+    forEachTriangle(box, glm::vec3(0.0f), 0.0f, [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        Contact candidate;
+        if(capsuleTriangleContact(a0, a1, radius, a, b, c, candidate) && (!found || candidate.depth > contact.depth)) {
+            contact = candidate;
+            found = true;
+        }
+        return true;
+    });
+    return found;
+}
+
+bool Heightfield::aabbContact(const Aabb& box, Contact& contact) const {
+    if(buriedContact(box.center(), 0.0f, box.halfExtents(), contact)) return true;
+    bool found = false;
+    forEachTriangle(box, glm::vec3(0.0f), 0.0f, [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        Contact candidate;
+        if(aabbTriangleContact(box, a, b, c, candidate) && (!found || candidate.depth > contact.depth)) {
+            contact = candidate;
+            found = true;
+        }
+        return true;
+    });
+    return found;
+}
+
+bool Heightfield::overlaps(const Aabb& box) const {
+    // Wholly below the surface, or crossed by it
+    Contact contact;
+    if(buriedContact(box.center(), 0.0f, box.halfExtents(), contact)) return true;
+    bool found = false;
+    forEachTriangle(box, glm::vec3(0.0f), 0.0f, [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        found = aabbTriangleContact(box, a, b, c, contact);
+        return !found;
+    });
+    return found;
+}
+
+bool Heightfield::capsuleCast(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                              float& t) const {
+    Contact contact;
+    if(buriedContact(a0, radius, glm::vec3(0.0f), contact) || buriedContact(a1, radius, glm::vec3(0.0f), contact)) {
+        t = 0.0f;
+        return true;
+    }
+    bool hit = false;
+    float best = tMax;
+    const Aabb box{glm::min(a0, a1) - glm::vec3(radius), glm::max(a0, a1) + glm::vec3(radius)};
+    forEachTriangle(box, dir, tMax, [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        float candidate;
+        if(capsuleCastTriangle(a0, a1, radius, dir, best, a, b, c, candidate)) {
+            hit = true;
+            best = candidate;
+        }
+        return best > 0.0f;
+    });
+    if(hit) t = best;
+    return hit;
+}
+
+bool Heightfield::aabbCast(const Aabb& box, const glm::vec3& dir, float tMax, float& t) const {
+    Contact contact;
+    if(buriedContact(box.center(), 0.0f, box.halfExtents(), contact)) {
+        t = 0.0f;
+        return true;
+    }
+    bool hit = false;
+    float best = tMax;
+    forEachTriangle(box, dir, tMax, [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        float candidate;
+        if(aabbCastTriangle(box, dir, best, a, b, c, candidate)) {
+            hit = true;
+            best = candidate;
+        }
+        return best > 0.0f;
+    });
+    if(hit) t = best;
+    return hit;
+}
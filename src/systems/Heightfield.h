@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "CollisionGeometry.h"
+#include "Narrowphase.h"
+
+// Regular height lattice for collision, e.g. the terrain. Every cell is split into two triangles
+// along the diagonal from its (x, z) corner to its (x + 1, z + 1) corner, as the terrain grid mesh
+// is, and unlike a TriangleMesh the ground is solid: a shape below the surface is pushed up out
+// of it, never down through it.
+//
+// Queries only visit the cells under the shape (or under its path for casts), so their cost does
+// not depend on the lattice size. They are const and allocate nothing, so any number of threads
+// may query a heightfield at once.
+class Heightfield {
+public:
+    // Height reported for points off the lattice
+    static constexpr float kNoHeight = -std::numeric_limits<float>::max();
+
+    // heights: resolution x resolution samples in world units, row by row along x, spanning
+    // worldSize on x and z and centered on the origin (the TerrainSampler layout)
+    void assign(std::vector<float> heights, int resolution, float worldSize);
+    void clear();
+
+    bool empty() const { return m_resolution < 2; }
+    int resolution() const { return m_resolution; }
+    float worldSize() const { return m_worldSize; }
+    // Covers the lattice, from kSolidDepth below its lowest sample up to its highest
+    const Aabb& bounds() const { return m_bounds; }
+
+    // Surface height and upward normal at x/z; false (kNoHeight, straight up) off the lattice
+    bool height(float x, float z, float& h, glm::vec3& normal) const;
+    // Batch form, four points at a time with SSE2; results are identical to height()
+    void heights(const float* xs, const float* zs, float* outHeights, glm::vec3* outNormals, size_t count) const;
+
+    // Deepest contact of a capsule [a0, a1] (a sphere when a0 == a1) or a box with the ground,
+    // normal pushing the shape out
+    bool capsuleContact(const glm::vec3& a0, const glm::vec3& a1, float radius, Contact& contact) const;
+    bool aabbContact(const Aabb& box, Contact& contact) const;
+    bool overlaps(const Aabb& box) const;
+    // First touch of a capsule or box moving along unit dir, 0 when it starts touching
+    bool capsuleCast(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                     float& t) const;
+    bool aabbCast(const Aabb& box, const glm::vec3& dir, float tMax, float& t) const;
+
+private:
+    // Bounds reach this far below the lowest sample, so shapes sunk beneath the surface still
+    // overlap them and are pushed back up
+    static constexpr float kSolidDepth = 16.0f;
+
+    float sample(int ix, int iz) const { return m_heights[static_cast<size_t>(iz) * m_resolution + ix]; }
+    glm::vec3 point(int ix, int iz) const {
+        return {ix * m_step - m_half, sample(ix, iz), iz * m_step - m_half};
+    }
+    // fn(a, b, c) for both triangles of every cell under `box` swept along dir over [0, tMax]
+    // whose highest corner reaches the swept box; fn returns false to stop early
+    template <typename Fn>
+    void forEachTriangle(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const;
+    // Contact of a sphere or box centered below the surface with the plane of the face above its
+    // center; false when the center is above the surface (or off the lattice)
+    bool buriedContact(const glm::vec3& center, float radius, const glm::vec3& halfExtents, Contact& contact) const;
+
+    std::vector<float> m_heights;
+    int m_resolution = 0;
+    float m_worldSize = 0.0f;
+    float m_half = 0.0f;
+    float m_step = 0.0f;
+    float m_invStep = 0.0f;  // cells per world unit
+    Aabb m_bounds;
+};
@@ -67,6 +67,16 @@ bool MonsterAI::detectsPlayer(const glm::vec3& playerPos, float detectionRadius)
     return distSq < (detectionRadius * detectionRadius);
 }
 
+bool MonsterAI::detectsPlayer(const glm::vec3& playerPos, float detectionRadius,
+                              const std::function<bool(const glm::vec3&, const glm::vec3&)>& lineBlocked) const{
+    if(!detectsPlayer(playerPos, detectionRadius)) return false;
+    if(!lineBlocked) return true;
+    // Eye and chest height, so a ridge between the two hides the player
+    const glm::vec3 eyeOffset(0.0f, 1.6f, 0.0f);
+    const glm::vec3 targetOffset(0.0f, 1.0f, 0.0f);
+    return !lineBlocked(m_position + eyeOffset, playerPos + targetOffset);
+}
+
 void MonsterAI::reset(){
     m_currentWaypoint = 0;
     m_waitTimer = 0.0f;
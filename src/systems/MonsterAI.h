@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -21,6 +22,10 @@ public:
     
     // Check if player is caught (within detection radius)
     bool detectsPlayer(const glm::vec3& playerPos, float detectionRadius = 10.0f) const;
+    // Same, but the player must also be in sight: lineBlocked(eye, target) reports occlusion
+    // (e.g. TerrainRaycaster::segmentBlocked) so hills hide the player
+    bool detectsPlayer(const glm::vec3& playerPos, float detectionRadius,
+                       const std::function<bool(const glm::vec3&, const glm::vec3&)>& lineBlocked) const;
     
     void reset();
 
@@ -0,0 +1,595 @@
+#include "Narrowphase.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NARROWPHASE_SSE2 1
+#endif
+
+namespace {
+constexpr float kEpsilon = 1e-12f;
+// Closest features nearer than this give no usable direction; the tests switch to SAT
+constexpr float kContactEpsilon = 1e-6f;
+// Preference for a triangle's face normal over its edge axes in SAT fallbacks
+constexpr float kFaceBias = 1e-4f;
+
+inline float lengthSq(const glm::vec3& v) {
+    return glm::dot(v, v);
+}
+
+// Some unit vector perpendicular to a non-zero v
+glm::vec3 perpendicular(const glm::vec3& v) {
+    const glm::vec3 a = glm::abs(v);
+    const glm::vec3 axis = a.x <= a.y && a.x <= a.z ? glm::vec3(1.0f, 0.0f, 0.0f)
+                         : a.y <= a.z              ? glm::vec3(0.0f, 1.0f, 0.0f)
+                                                   : glm::vec3(0.0f, 0.0f, 1.0f);
+    return glm::normalize(glm::cross(v, axis));
+}
+
+// Separation direction for capsule cores that touch: across both segments when they cross,
+// otherwise sideways from B's segment towards A's centre
+glm::vec3 crossingNormal(const glm::vec3& a0, const glm::vec3& a1, const glm::vec3& b0, const glm::vec3& b1) {
+    const glm::vec3 d1 = a1 - a0, d2 = b1 - b0;
+    const glm::vec3 offset = (a0 + a1 - b0 - b1) * 0.5f;
+    glm::vec3 n = glm::cross(d1, d2);
+    const float n2 = lengthSq(n);
+    if(n2 > kEpsilon * lengthSq(d1) * lengthSq(d2) && n2 > 0.0f) {
+        n /= std::sqrt(n2);
+    } else {
+        const glm::vec3 axis = lengthSq(d2) > kEpsilon ? d2 : d1;
+        if(lengthSq(axis) <= kEpsilon) return glm::vec3(0.0f, 1.0f, 0.0f);  // two coincident spheres
+        const glm::vec3 side = offset - axis * (glm::dot(offset, axis) / lengthSq(axis));
+        n = lengthSq(side) > kEpsilon ? glm::normalize(side) : perpendicular(axis);
+    }
+    return glm::dot(n, offset) < 0.0f ? -n : n;
+}
+
+// Minimum translation of a capsule whose segment reaches into the box. The separating axes of
+// a segment and a box are the box normals and the segment crossed with each box edge.
+void segmentAabbSat(const glm::vec3& a0, const glm::vec3& a1, float radius, const Aabb& box, Contact& contact) {
+    const glm::vec3 d = a1 - a0;
+    const glm::vec3 center = box.center(), half = box.halfExtents();
+    const glm::vec3 axes[6] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+                               {0.0f, -d.z, d.y}, {d.z, 0.0f, -d.x}, {-d.y, d.x, 0.0f}};
+    float best = std::numeric_limits<float>::infinity();
+    for(glm::vec3 n : axes) {
+        const float n2 = lengthSq(n);
+        if(n2 <= kEpsilon * lengthSq(d)) continue;
+        n /= std::sqrt(n2);
+        const float p0 = glm::dot(n, a0), p1 = glm::dot(n, a1);
+        const float c = glm::dot(n, center), e = glm::dot(glm::abs(n), half);
+        const float up = c + e - (std::min(p0, p1) - radius);
+        const float down = std::max(p0, p1) + radius - (c - e);
+        if(up < best) { best = up; contact.normal = n; }
+        if(down < best) { best = down; contact.normal = -n; }
+    }
+    contact.depth = best;
+}
+
+// Same for a capsule whose segment passes through a triangle: the axes are the triangle normal,
+// the in-plane edge normals and the segment crossed with each edge
+void segmentTriangleSat(const glm::vec3& a0, const glm::vec3& a1, float radius,
+                        const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Contact& contact) {
+    const glm::vec3 d = a1 - a0;
+    const glm::vec3 edges[3] = {b - a, c - b, a - c};
+    const glm::vec3 n = glm::cross(edges[0], edges[1]);
+    glm::vec3 axes[7] = {n};
+    for(int i = 0; i < 3; ++i) {
+        axes[1 + i] = glm::cross(n, edges[i]);
+        axes[4 + i] = glm::cross(d, edges[i]);
+    }
+    float best = std::numeric_limits<float>::infinity();
+    contact.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    for(int i = 0; i < 7; ++i) {
+        glm::vec3 axis = axes[i];
+        const float len2 = lengthSq(axis);
+        if(len2 <= kEpsilon) continue;
+        axis /= std::sqrt(len2);
+        const float p0 = glm::dot(axis, a0), p1 = glm::dot(axis, a1);
+        const float ta = glm::dot(axis, a), tb = glm::dot(axis, b), tc = glm::dot(axis, c);
+        // Other axes must clearly beat the face normal, which wins ties at a vertex or edge
+        const float bias = i == 0 ? 0.0f : kFaceBias;
+        const float up = std::max({ta, tb, tc}) - (std::min(p0, p1) - radius) + bias;
+        const float down = std::max(p0, p1) + radius - std::min({ta, tb, tc}) + bias;
+        if(up < best) { best = up; contact.normal = axis; }
+        if(down < best) { best = down; contact.normal = -axis; }
+    }
+    const float p0 = glm::dot(contact.normal, a0), p1 = glm::dot(contact.normal, a1);
+    contact.depth = std::max({glm::dot(contact.normal, a), glm::dot(contact.normal, b), glm::dot(contact.normal, c)})
+                  - (std::min(p0, p1) - radius);
+}
+
+// Box against triangle over the 13 SAT axes (box normals, triangle normal, box axes crossed with
+// the edges). Returns the smallest overlap, negative when an axis separates them, and sets
+// `normal` to the direction that pushes the box out along that axis.
+float aabbTriangleSat(const Aabb& box, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, glm::vec3& normal) {
+    const glm::vec3 center = box.center(), half = box.halfExtents();
+    const glm::vec3 edges[3] = {b - a, c - b, a - c};
+    glm::vec3 axes[13] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, glm::cross(edges[0], edges[1])};
+    for(int i = 0; i < 3; ++i) {
+        axes[4 + 3 * i] = {0.0f, -edges[i].z, edges[i].y};
+        axes[5 + 3 * i] = {edges[i].z, 0.0f, -edges[i].x};
+        axes[6 + 3 * i] = {-edges[i].y, edges[i].x, 0.0f};
+    }
+    float best = std::numeric_limits<float>::infinity();
+    normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    for(glm::vec3 axis : axes) {
+        const float len2 = lengthSq(axis);
+        if(len2 <= kEpsilon) continue;
+        axis /= std::sqrt(len2);
+        const float mid = glm::dot(axis, center), e = glm::dot(glm::abs(axis), half);
+        const float ta = glm::dot(axis, a), tb = glm::dot(axis, b), tc = glm::dot(axis, c);
+        const float up = std::max({ta, tb, tc}) - (mid - e);
+        const float down = mid + e - std::min({ta, tb, tc});
+        if(up < best) { best = up; normal = axis; }
+        if(down < best) { best = down; normal = -axis; }
+    }
+    return best;
+}
+}
+
+bool sphereSphereContact(const glm::vec3& c1, float r1, const glm::vec3& c2, float r2, Contact& contact) {
+    const glm::vec3 d = c1 - c2;
+    const float r = r1 + r2;
+    const float dist2 = lengthSq(d);
+    if(dist2 > r * r) return false;
+    const float dist = std::sqrt(dist2);
+    contact.normal = dist > kContactEpsilon ? d / dist : glm::vec3(0.0f, 1.0f, 0.0f);
+    contact.depth = r - dist;
+    contact.point = c2 + contact.normal * r2;
+    return true;
+}
+
+bool sphereAabbContact(const glm::vec3& center, float radius, const Aabb& box, Contact& contact) {
+    const glm::vec3 onBox = closestPointOnAabb(center, box);
+    const glm::vec3 d = center - onBox;
+    const float dist2 = lengthSq(d);
+    if(dist2 > radius * radius) return false;
+    const float dist = std::sqrt(dist2);
+    if(dist > kContactEpsilon) {
+        contact.normal = d / dist;
+        contact.depth = radius - dist;
+    } else {
+        segmentAabbSat(center, center, radius, box, contact);
+    }
+    contact.point = onBox;
+    return true;
+}
+
+bool capsuleCapsuleContact(const glm::vec3& a0, const glm::vec3& a1, float ra,
+                           const glm::vec3& b0, const glm::vec3& b1, float rb, Contact& contact) {
+    const float r = ra + rb;
+    glm::vec3 c1, c2;
+    const float dist2 = closestPointsSegmentSegment(a0, a1, b0, b1, c1, c2);
+    if(dist2 > r * r) return false;
+    const float dist = std::sqrt(dist2);
+    contact.normal = dist > kContactEpsilon ? (c1 - c2) / dist : crossingNormal(a0, a1, b0, b1);
+    contact.depth = r - dist;
+    contact.point = c2 + contact.normal * rb;
+    return true;
+}
+
+bool capsuleAabbContact(const glm::vec3& a0, const glm::vec3& a1, float radius, const Aabb& box, Contact& contact) {
+    glm::vec3 onSegment, onBox;
+    const float dist2 = closestPointsSegmentAabb(a0, a1, box, onSegment, onBox);
+    if(dist2 > radius * radius) return false;
+    const float dist = std::sqrt(dist2);
+    if(dist > kContactEpsilon) {
+        contact.normal = (onSegment - onBox) / dist;
+        contact.depth = radius - dist;
+    } else {
+        segmentAabbSat(a0, a1, radius, box, contact);
+    }
+    contact.point = onBox;
+    return true;
+}
+
+bool aabbCapsuleContact(const Aabb& box, const glm::vec3& b0, const glm::vec3& b1, float radius, Contact& contact) {
+    glm::vec3 onSegment, onBox;
+    const float dist2 = closestPointsSegmentAabb(b0, b1, box, onSegment, onBox);
+    if(dist2 > radius * radius) return false;
+    const float dist = std::sqrt(dist2);
+    if(dist > kContactEpsilon) {
+        contact.normal = (onBox - onSegment) / dist;
+        contact.depth = radius - dist;
+        contact.point = onSegment + contact.normal * radius;
+    } else {
+        segmentAabbSat(b0, b1, radius, box, contact);
+        contact.normal = -contact.normal;
+        contact.point = onSegment;
+    }
+    return true;
+}
+
+bool aabbAabbContact(const Aabb& a, const Aabb& b, Contact& contact) {
+    if(!a.overlaps(b)) return false;
+    const glm::vec3 lo = glm::max(a.min, b.min), hi = glm::min(a.max, b.max);
+    float best = std::numeric_limits<float>::infinity();
+    int bestAxis = 0;
+    float sign = 1.0f;
+    for(int axis = 0; axis < 3; ++axis) {
+        const float up = b.max[axis] - a.min[axis];
+        const float down = a.max[axis] - b.min[axis];
+        if(up < best) { best = up; bestAxis = axis; sign = 1.0f; }
+        if(down < best) { best = down; bestAxis = axis; sign = -1.0f; }
+    }
+    contact.normal = glm::vec3(0.0f);
+    contact.normal[bestAxis] = sign;
+    contact.depth = best;
+    // Middle of the overlap, on the face of b that a is pushed out of
+    contact.point = (lo + hi) * 0.5f;
+    contact.point[bestAxis] = sign > 0.0f ? b.max[bestAxis] : b.min[bestAxis];
+    return true;
+}
+
+bool capsuleTriangleContact(const glm::vec3& a0, const glm::vec3& a1, float radius,
+                            const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Contact& contact) {
+    glm::vec3 onSegment, onTriangle;
+    const float dist2 = closestPointsSegmentTriangle(a0, a1, a, b, c, onSegment, onTriangle);
+    if(dist2 > radius * radius) return false;
+    const float dist = std::sqrt(dist2);
+    if(dist > kContactEpsilon) {
+        contact.normal = (onSegment - onTriangle) / dist;
+        contact.depth = radius - dist;
+    } else {
+        segmentTriangleSat(a0, a1, radius, a, b, c, contact);
+    }
+    contact.point = onTriangle;
+    return true;
+}
+
+bool aabbTriangleContact(const Aabb& box, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Contact& contact) {
+    glm::vec3 normal;
+    const float depth = aabbTriangleSat(box, a, b, c, normal);
+    if(depth < 0.0f) return false;
+    contact.normal = normal;
+    contact.depth = depth;
+    contact.point = closestPointOnTriangle(box.center(), a, b, c);
+    return true;
+}
+
+void CapsuleBatch::clear() {
+    ax.clear(); ay.clear(); az.clear();
+    bx.clear(); by.clear(); bz.clear();
+    radius.clear();
+}
+
+void CapsuleBatch::push(const glm::vec3& a, const glm::vec3& b, float r) {
+    ax.push_back(a.x); ay.push_back(a.y); az.push_back(a.z);
+    bx.push_back(b.x); by.push_back(b.y); bz.push_back(b.z);
+    radius.push_back(r);
+}
+
+void AabbBatch::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void AabbBatch::push(const Aabb& box) {
+    minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+    maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+}
+
+namespace {
+glm::vec3 capsuleA(const CapsuleBatch& batch, size_t i) {
+    return {batch.ax[i], batch.ay[i], batch.az[i]};
+}
+
+glm::vec3 capsuleB(const CapsuleBatch& batch, size_t i) {
+    return {batch.bx[i], batch.by[i], batch.bz[i]};
+}
+
+Aabb batchBox(const AabbBatch& batch, size_t i) {
+    return {{batch.minX[i], batch.minY[i], batch.minZ[i]}, {batch.maxX[i], batch.maxY[i], batch.maxZ[i]}};
+}
+}
+
+#ifdef NARROWPHASE_SSE2
+namespace {
+// Four vectors, one per lane
+struct Vec3x4 {
+    __m128 c[3];
+};
+
+inline Vec3x4 splat(const glm::vec3& v) {
+    return {{_mm_set1_ps(v.x), _mm_set1_ps(v.y), _mm_set1_ps(v.z)}};
+}
+
+inline Vec3x4 load(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z, size_t i) {
+    return {{_mm_loadu_ps(x.data() + i), _mm_loadu_ps(y.data() + i), _mm_loadu_ps(z.data() + i)}};
+}
+
+inline Vec3x4 sub(const Vec3x4& a, const Vec3x4& b) {
+    return {{_mm_sub_ps(a.c[0], b.c[0]), _mm_sub_ps(a.c[1], b.c[1]), _mm_sub_ps(a.c[2], b.c[2])}};
+}
+
+inline Vec3x4 mul(const Vec3x4& v, __m128 s) {
+    return {{_mm_mul_ps(v.c[0], s), _mm_mul_ps(v.c[1], s), _mm_mul_ps(v.c[2], s)}};
+}
+
+// a + b * s
+inline Vec3x4 madd(const Vec3x4& a, const Vec3x4& b, __m128 s) {
+    return {{_mm_add_ps(a.c[0], _mm_mul_ps(b.c[0], s)), _mm_add_ps(a.c[1], _mm_mul_ps(b.c[1], s)),
+             _mm_add_ps(a.c[2], _mm_mul_ps(b.c[2], s))}};
+}
+
+inline __m128 dot(const Vec3x4& a, const Vec3x4& b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.c[0], b.c[0]), _mm_mul_ps(a.c[1], b.c[1])), _mm_mul_ps(a.c[2], b.c[2]));
+}
+
+// min(max(v, lo), hi); a NaN v comes out as lo
+inline __m128 clampPs(__m128 v, __m128 lo, __m128 hi) {
+    return _mm_min_ps(_mm_max_ps(v, lo), hi);
+}
+
+inline __m128 selectPs(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline Vec3x4 clampBox(const Vec3x4& p, const Vec3x4& lo, const Vec3x4& hi) {
+    return {{clampPs(p.c[0], lo.c[0], hi.c[0]), clampPs(p.c[1], lo.c[1], hi.c[1]), clampPs(p.c[2], lo.c[2], hi.c[2])}};
+}
+
+struct Lanes {
+    alignas(16) float x[4], y[4], z[4];
+    glm::vec3 operator[](int lane) const { return {x[lane], y[lane], z[lane]}; }
+};
+
+inline void store(const Vec3x4& v, Lanes& out) {
+    _mm_store_ps(out.x, v.c[0]);
+    _mm_store_ps(out.y, v.c[1]);
+    _mm_store_ps(out.z, v.c[2]);
+}
+
+// closestPointsSegmentSegment() for a fixed first segment [p1, p1 + d1] against four
+inline __m128 closestSegmentSegment(const Vec3x4& p1, const Vec3x4& d1, float d1Len2, const Vec3x4& p2,
+                                    const Vec3x4& d2, Vec3x4& c1, Vec3x4& c2) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), eps = _mm_set1_ps(kEpsilon);
+    const Vec3x4 r = sub(p1, p2);
+    const __m128 e = dot(d2, d2), f = dot(d2, r);
+    const __m128 hasLength = _mm_cmpgt_ps(e, eps);
+    __m128 s, t;
+    if(d1Len2 <= kEpsilon) {
+        s = zero;
+        t = _mm_and_ps(hasLength, clampPs(_mm_div_ps(f, e), zero, one));
+    } else {
+        const __m128 a = _mm_set1_ps(d1Len2);
+        const __m128 c = dot(d1, r), b = dot(d1, d2);
+        const __m128 denom = _mm_sub_ps(_mm_mul_ps(a, e), _mm_mul_ps(b, b));
+        s = _mm_and_ps(_mm_cmpgt_ps(denom, eps),
+                       clampPs(_mm_div_ps(_mm_sub_ps(_mm_mul_ps(b, f), _mm_mul_ps(c, e)), denom), zero, one));
+        const __m128 tn = _mm_div_ps(_mm_add_ps(_mm_mul_ps(b, s), f), e);
+        const __m128 sLow = clampPs(_mm_div_ps(_mm_sub_ps(zero, c), a), zero, one);
+        const __m128 sHigh = clampPs(_mm_div_ps(_mm_sub_ps(b, c), a), zero, one);
+        s = selectPs(_mm_cmplt_ps(tn, zero), sLow, selectPs(_mm_cmpgt_ps(tn, one), sHigh, s));
+        t = clampPs(tn, zero, one);
+        // A point-like second segment: closest point of the first one to it
+        s = selectPs(hasLength, s, sLow);
+        t = _mm_and_ps(hasLength, t);
+    }
+    c1 = madd(p1, d1, s);
+    c2 = madd(p2, d2, t);
+    const Vec3x4 diff = sub(c1, c2);
+    return dot(diff, diff);
+}
+
+inline void compareExchange(__m128& a, __m128& b) {
+    const __m128 lo = _mm_min_ps(a, b);
+    b = _mm_max_ps(a, b);
+    a = lo;
+}
+
+// closestPointsSegmentAabb() for four segment/box pairs: the same piecewise minimisation, with
+// all six slab crossings kept (clamped to [0, 1]) so every lane walks seven intervals
+inline __m128 closestSegmentAabb(const Vec3x4& a, const Vec3x4& ab, const Vec3x4& lo, const Vec3x4& hi,
+                                 Vec3x4& onSegment, Vec3x4& onBox) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+    __m128 knots[6];
+    for(int axis = 0; axis < 3; ++axis) {
+        knots[axis * 2] = clampPs(_mm_div_ps(_mm_sub_ps(lo.c[axis], a.c[axis]), ab.c[axis]), zero, one);
+        knots[axis * 2 + 1] = clampPs(_mm_div_ps(_mm_sub_ps(hi.c[axis], a.c[axis]), ab.c[axis]), zero, one);
+    }
+    // Six-input sorting network
+    compareExchange(knots[0], knots[5]); compareExchange(knots[1], knots[3]); compareExchange(knots[2], knots[4]);
+    compareExchange(knots[1], knots[2]); compareExchange(knots[3], knots[4]);
+    compareExchange(knots[0], knots[3]); compareExchange(knots[2], knots[5]);
+    compareExchange(knots[0], knots[1]); compareExchange(knots[2], knots[3]); compareExchange(knots[4], knots[5]);
+    compareExchange(knots[1], knots[2]); compareExchange(knots[3], knots[4]);
+
+    __m128 best = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 bestS = zero;
+    __m128 s0 = zero;
+    for(int i = 0; i <= 6; ++i) {
+        const __m128 s1 = i < 6 ? knots[i] : one;
+        const __m128 mid = _mm_mul_ps(_mm_add_ps(s0, s1), half);
+        __m128 num = zero, den = zero;
+        for(int axis = 0; axis < 3; ++axis) {
+            const __m128 p = _mm_add_ps(a.c[axis], _mm_mul_ps(ab.c[axis], mid));
+            const __m128 below = _mm_cmplt_ps(p, lo.c[axis]);
+            const __m128 active = _mm_or_ps(below, _mm_cmpgt_ps(p, hi.c[axis]));
+            const __m128 bound = selectPs(below, lo.c[axis], hi.c[axis]);
+            num = _mm_add_ps(num, _mm_and_ps(active, _mm_mul_ps(ab.c[axis], _mm_sub_ps(bound, a.c[axis]))));
+            den = _mm_add_ps(den, _mm_and_ps(active, _mm_mul_ps(ab.c[axis], ab.c[axis])));
+        }
+        const __m128 s = selectPs(_mm_cmpgt_ps(den, zero), clampPs(_mm_div_ps(num, den), s0, s1), s0);
+        const Vec3x4 p = madd(a, ab, s);
+        const Vec3x4 d = sub(p, clampBox(p, lo, hi));
+        const __m128 dist2 = dot(d, d);
+        const __m128 better = _mm_cmplt_ps(dist2, best);
+        best = selectPs(better, dist2, best);
+        bestS = selectPs(better, s, bestS);
+        s0 = s1;
+    }
+    onSegment = madd(a, ab, bestS);
+    onBox = clampBox(onSegment, lo, hi);
+    const Vec3x4 d = sub(onSegment, onBox);
+    return dot(d, d);
+}
+}
+#endif
+
+size_t capsuleCapsuleContacts(const glm::vec3& a0, const glm::vec3& a1, float radius, const CapsuleBatch& batch,
+                              uint32_t* hits, Contact* contacts) {
+    const size_t n = batch.size();
+    size_t count = 0, i = 0;
+#ifdef NARROWPHASE_SSE2
+    const Vec3x4 p1 = splat(a0), d1 = splat(a1 - a0);
+    const float d1Len2 = lengthSq(a1 - a0);
+    const __m128 ra = _mm_set1_ps(radius);
+    for(; i + 4 <= n; i += 4) {
+        const Vec3x4 p2 = load(batch.ax, batch.ay, batch.az, i);
+        const Vec3x4 d2 = sub(load(batch.bx, batch.by, batch.bz, i), p2);
+        const __m128 rb = _mm_loadu_ps(batch.radius.data() + i);
+        Vec3x4 c1, c2;
+        const __m128 dist2 = closestSegmentSegment(p1, d1, d1Len2, p2, d2, c1, c2);
+        const __m128 r = _mm_add_ps(ra, rb);
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, _mm_mul_ps(r, r)));
+        if(!mask) continue;
+        const __m128 dist = _mm_sqrt_ps(dist2);
+        const Vec3x4 normal = mul(sub(c1, c2), _mm_div_ps(_mm_set1_ps(1.0f), dist));
+        Lanes normals, points;
+        store(normal, normals);
+        store(madd(c2, normal, rb), points);
+        alignas(16) float dists[4], depths[4];
+        _mm_store_ps(dists, dist);
+        _mm_store_ps(depths, _mm_sub_ps(r, dist));
+        for(int lane = 0; lane < 4; ++lane) {
+            if(!(mask & (1 << lane))) continue;
+            const size_t index = i + lane;
+            Contact& contact = contacts[count];
+            if(dists[lane] > kContactEpsilon) {
+                contact.normal = normals[lane];
+                contact.point = points[lane];
+                contact.depth = depths[lane];
+            } else {
+                capsuleCapsuleContact(a0, a1, radius, capsuleA(batch, index), capsuleB(batch, index),
+                                      batch.radius[index], contact);
+            }
+            hits[count++] = static_cast<uint32_t>(index);
+        }
+    }
+#endif
+    for(; i < n; ++i) {
+        if(capsuleCapsuleContact(a0, a1, radius, capsuleA(batch, i), capsuleB(batch, i), batch.radius[i], contacts[count])) {
+            hits[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+size_t capsuleAabbContacts(const glm::vec3& a0, const glm::vec3& a1, float radius, const AabbBatch& batch,
+                           uint32_t* hits, Contact* contacts) {
+    const size_t n = batch.size();
+    size_t count = 0, i = 0;
+#ifdef NARROWPHASE_SSE2
+    const Vec3x4 a = splat(a0), ab = splat(a1 - a0);
+    const __m128 r = _mm_set1_ps(radius);
+    const __m128 r2 = _mm_mul_ps(r, r);
+    for(; i + 4 <= n; i += 4) {
+        const Vec3x4 lo = load(batch.minX, batch.minY, batch.minZ, i);
+        const Vec3x4 hi = load(batch.maxX, batch.maxY, batch.maxZ, i);
+        Vec3x4 onSegment, onBox;
+        const __m128 dist2 = closestSegmentAabb(a, ab, lo, hi, onSegment, onBox);
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, r2));
+        if(!mask) continue;
+        const __m128 dist = _mm_sqrt_ps(dist2);
+        Lanes normals, points;
+        store(mul(sub(onSegment, onBox), _mm_div_ps(_mm_set1_ps(1.0f), dist)), normals);
+        store(onBox, points);
+        alignas(16) float dists[4], depths[4];
+        _mm_store_ps(dists, dist);
+        _mm_store_ps(depths, _mm_sub_ps(r, dist));
+        for(int lane = 0; lane < 4; ++lane) {
+            if(!(mask & (1 << lane))) continue;
+            const size_t index = i + lane;
+            Contact& contact = contacts[count];
+            if(dists[lane] > kContactEpsilon) {
+                contact.normal = normals[lane];
+                contact.point = points[lane];
+                contact.depth = depths[lane];
+            } else {
+                capsuleAabbContact(a0, a1, radius, batchBox(batch, index), contact);
+            }
+            hits[count++] = static_cast<uint32_t>(index);
+        }
+    }
+#endif
+    for(; i < n; ++i) {
+        if(capsuleAabbContact(a0, a1, radius, batchBox(batch, i), contacts[count])) hits[count++] = static_cast<uint32_t>(i);
+    }
+    return count;
+}
+
+size_t aabbCapsuleContacts(const Aabb& box, const CapsuleBatch& batch, uint32_t* hits, Contact* contacts) {
+    const size_t n = batch.size();
+    size_t count = 0, i = 0;
+#ifdef NARROWPHASE_SSE2
+    const Vec3x4 lo = splat(box.min), hi = splat(box.max);
+    for(; i + 4 <= n; i += 4) {
+        const Vec3x4 a = load(batch.ax, batch.ay, batch.az, i);
+        const Vec3x4 ab = sub(load(batch.bx, batch.by, batch.bz, i), a);
+        const __m128 r = _mm_loadu_ps(batch.radius.data() + i);
+        Vec3x4 onSegment, onBox;
+        const __m128 dist2 = closestSegmentAabb(a, ab, lo, hi, onSegment, onBox);
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, _mm_mul_ps(r, r)));
+        if(!mask) continue;
+        const __m128 dist = _mm_sqrt_ps(dist2);
+        const Vec3x4 normal = mul(sub(onBox, onSegment), _mm_div_ps(_mm_set1_ps(1.0f), dist));
+        Lanes normals, points;
+        store(normal, normals);
+        store(madd(onSegment, normal, r), points);
+        alignas(16) float dists[4], depths[4];
+        _mm_store_ps(dists, dist);
+        _mm_store_ps(depths, _mm_sub_ps(r, dist));
+        for(int lane = 0; lane < 4; ++lane) {
+            if(!(mask & (1 << lane))) continue;
+            const size_t index = i + lane;
+            Contact& contact = contacts[count];
+            if(dists[lane] > kContactEpsilon) {
+                contact.normal = normals[lane];
+                contact.point = points[lane];
+                contact.depth = depths[lane];
+            } else {
+                aabbCapsuleContact(box, capsuleA(batch, index), capsuleB(batch, index), batch.radius[index], contact);
+            }
+            hits[count++] = static_cast<uint32_t>(index);
+        }
+    }
+#endif
+    for(; i < n; ++i) {
+        if(aabbCapsuleContact(box, capsuleA(batch, i), capsuleB(batch, i), batch.radius[i], contacts[count])) {
+            hits[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+size_t aabbAabbContacts(const Aabb& box, const AabbBatch& batch, uint32_t* hits, Contact* contacts) {
+    const size_t n = batch.size();
+    size_t count = 0, i = 0;
+#ifdef NARROWPHASE_SSE2
+    // Rejection is the bulk of the work; the few overlapping pairs take the scalar contact
+    const Vec3x4 lo = splat(box.min), hi = splat(box.max);
+    for(; i + 4 <= n; i += 4) {
+        const Vec3x4 otherLo = load(batch.minX, batch.minY, batch.minZ, i);
+        const Vec3x4 otherHi = load(batch.maxX, batch.maxY, batch.maxZ, i);
+        __m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int axis = 0; axis < 3; ++axis) {
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(lo.c[axis], otherHi.c[axis]));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(otherLo.c[axis], hi.c[axis]));
+        }
+        const int mask = _mm_movemask_ps(overlap);
+        for(int lane = 0; lane < 4; ++lane) {
+            if(!(mask & (1 << lane))) continue;
+            aabbAabbContact(box, batchBox(batch, i + lane), contacts[count]);
+            hits[count++] = static_cast<uint32_t>(i + lane);
+        }
+    }
+#endif
+    for(; i < n; ++i) {
+        if(aabbAabbContact(box, batchBox(batch, i), contacts[count])) hits[count++] = static_cast<uint32_t>(i);
+    }
+    return count;
+}
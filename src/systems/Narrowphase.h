@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CollisionGeometry.h"
+
+// Overlap tests that also say how to separate the shapes: moving the first shape by
+// normal * depth leaves the two just touching. `point` lies where they touch, on the second
+// shape's surface for shallow contacts. Touching shapes (depth 0) count as overlapping.
+// Spheres are capsules whose segment is a single point; boxes are axis-aligned.
+struct Contact {
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    glm::vec3 point{0.0f};
+    float depth = 0.0f;
+};
+
+bool sphereSphereContact(const glm::vec3& c1, float r1, const glm::vec3& c2, float r2, Contact& contact);
+bool sphereAabbContact(const glm::vec3& center, float radius, const Aabb& box, Contact& contact);
+bool capsuleCapsuleContact(const glm::vec3& a0, const glm::vec3& a1, float ra,
+                           const glm::vec3& b0, const glm::vec3& b1, float rb, Contact& contact);
+bool capsuleAabbContact(const glm::vec3& a0, const glm::vec3& a1, float radius, const Aabb& box, Contact& contact);
+bool aabbCapsuleContact(const Aabb& box, const glm::vec3& b0, const glm::vec3& b1, float radius, Contact& contact);
+// SAT over the three face axes, which is every candidate axis for two axis-aligned boxes
+bool aabbAabbContact(const Aabb& a, const Aabb& b, Contact& contact);
+
+// Triangles are two-sided; `point` lies on the triangle
+bool capsuleTriangleContact(const glm::vec3& a0, const glm::vec3& a1, float radius,
+                            const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Contact& contact);
+bool aabbTriangleContact(const Aabb& box, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, Contact& contact);
+
+// Candidate lists packed structure-of-arrays for the batch tests below
+struct CapsuleBatch {
+    std::vector<float> ax, ay, az, bx, by, bz, radius;
+
+    size_t size() const { return radius.size(); }
+    void clear();
+    void push(const glm::vec3& a, const glm::vec3& b, float r);
+};
+
+struct AabbBatch {
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    size_t size() const { return minX.size(); }
+    void clear();
+    void push(const Aabb& box);
+};
+
+// One shape against every candidate of a batch, SSE2 four candidates at a time. Writes the
+// position of each overlapping candidate to `hits` and its contact (as the pair test with the
+// query shape first would) to `contacts`, both with room for batch.size(), and returns how many.
+size_t capsuleCapsuleContacts(const glm::vec3& a0, const glm::vec3& a1, float radius, const CapsuleBatch& batch,
+                              uint32_t* hits, Contact* contacts);
+size_t capsuleAabbContacts(const glm::vec3& a0, const glm::vec3& a1, float radius, const AabbBatch& batch,
+                           uint32_t* hits, Contact* contacts);
+size_t aabbCapsuleContacts(const Aabb& box, const CapsuleBatch& batch, uint32_t* hits, Contact* contacts);
+size_t aabbAabbContacts(const Aabb& box, const AabbBatch& batch, uint32_t* hits, Contact* contacts);
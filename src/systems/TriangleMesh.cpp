@@ -0,0 +1,417 @@
+#include "TriangleMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace {
+// Binned SAH build: candidate planes per axis, leaf size limit and the cost of visiting a node
+// relative to testing one triangle
+constexpr int kSahBins = 12;
+constexpr uint32_t kMaxLeafTriangles = 4;
+constexpr float kTraversalCost = 1.0f;
+
+struct BuildTriangle {
+    Aabb bounds;
+    glm::vec3 centroid;
+};
+
+Aabb emptyBounds() {
+    return {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+}
+
+class Builder {
+public:
+    Builder(const std::vector<BuildTriangle>& triangles, std::vector<uint32_t>& order, std::vector<TriangleMesh::Node>& nodes,
+            int maxSahDepth)
+        : m_triangles(triangles), m_order(order), m_nodes(nodes), m_maxSahDepth(maxSahDepth) {}
+
+    void build(uint32_t begin, uint32_t end, int depth) {
+        const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        Aabb bounds = emptyBounds(), centroids = emptyBounds();
+        for(uint32_t i = begin; i < end; ++i) {
+            const BuildTriangle& tri = m_triangles[m_order[i]];
+            bounds = bounds.merged(tri.bounds);
+            centroids = centroids.merged(Aabb{tri.centroid, tri.centroid});
+        }
+        m_nodes[index].min = bounds.min;
+        m_nodes[index].max = bounds.max;
+
+        const uint32_t count = end - begin;
+        const uint32_t mid = count <= 1 ? end : split(begin, end, depth, bounds, centroids);
+        if(mid == end) {
+            m_nodes[index].offset = begin;
+            m_nodes[index].count = count;
+            return;
+        }
+        build(begin, mid, depth + 1);
+        m_nodes[index].offset = static_cast<uint32_t>(m_nodes.size());
+        build(mid, end, depth + 1);
+    }
+
+private:
+    // Partitions [begin, end) and returns where the second child starts, or end for a leaf
+    uint32_t split(uint32_t begin, uint32_t end, int depth, const Aabb& bounds, const Aabb& centroids) {
+        const uint32_t count = end - begin;
+        const glm::vec3 extent = centroids.max - centroids.min;
+        const int longest = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+        if(extent[longest] <= 0.0f) {
+            // Coincident centroids: no plane separates them, so only split to respect the leaf size
+            return count <= kMaxLeafTriangles ? end : begin + count / 2;
+        }
+        if(depth >= m_maxSahDepth) return medianSplit(begin, end, longest);
+
+        // Cost of splitting after each bin on each axis: traversal plus the triangles on each side
+        // weighted by the chance (relative area) that a query reaching this node reaches that side
+        struct Bin {
+            Aabb bounds = emptyBounds();
+            uint32_t count = 0;
+        };
+        float bestCost = std::numeric_limits<float>::infinity();
+        int bestAxis = -1, bestSplit = 0;
+        for(int axis = 0; axis < 3; ++axis) {
+            if(extent[axis] <= 0.0f) continue;
+            Bin bins[kSahBins];
+            const float scale = kSahBins / extent[axis];
+            for(uint32_t i = begin; i < end; ++i) {
+                const BuildTriangle& tri = m_triangles[m_order[i]];
+                Bin& bin = bins[binOf(tri.centroid[axis], centroids.min[axis], scale)];
+                bin.bounds = bin.bounds.merged(tri.bounds);
+                ++bin.count;
+            }
+            float rightArea[kSahBins];
+            uint32_t rightCount[kSahBins];
+            Aabb right = emptyBounds();
+            uint32_t rightTotal = 0;
+            for(int i = kSahBins - 1; i > 0; --i) {
+                right = right.merged(bins[i].bounds);
+                rightTotal += bins[i].count;
+                rightArea[i] = right.surfaceArea();
+                rightCount[i] = rightTotal;
+            }
+            Aabb left = emptyBounds();
+            uint32_t leftTotal = 0;
+            for(int i = 0; i + 1 < kSahBins; ++i) {
+                left = left.merged(bins[i].bounds);
+                leftTotal += bins[i].count;
+                if(leftTotal == 0 || rightCount[i + 1] == 0) continue;
+                const float cost = leftTotal * left.surfaceArea() + rightCount[i + 1] * rightArea[i + 1];
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+        const float area = bounds.surfaceArea();
+        bestCost = area > 0.0f ? kTraversalCost + bestCost / area : std::numeric_limits<float>::infinity();
+        if(bestAxis < 0) return medianSplit(begin, end, longest);
+        if(count <= kMaxLeafTriangles && bestCost >= static_cast<float>(count)) return end;
+
+        const float scale = kSahBins / extent[bestAxis];
+        const float origin = centroids.min[bestAxis];
+        const auto first = m_order.begin() + begin, last = m_order.begin() + end;
+        const auto mid = std::partition(first, last, [&](uint32_t tri) {
+            return binOf(m_triangles[tri].centroid[bestAxis], origin, scale) <= bestSplit;
+        });
+        return begin + static_cast<uint32_t>(mid - first);
+    }
+
+    uint32_t medianSplit(uint32_t begin, uint32_t end, int axis) {
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end, [&](uint32_t a, uint32_t b) {
+            return m_triangles[a].centroid[axis] < m_triangles[b].centroid[axis];
+        });
+        return mid;
+    }
+
+    static int binOf(float value, float origin, float scale) {
+        return std::min(static_cast<int>((value - origin) * scale), kSahBins - 1);
+    }
+
+    const std::vector<BuildTriangle>& m_triangles;
+    std::vector<uint32_t>& m_order;
+    std::vector<TriangleMesh::Node>& m_nodes;
+    int m_maxSahDepth;
+};
+
+Aabb nodeBounds(const TriangleMesh::Node& node) {
+    return {node.min, node.max};
+}
+
+// Slab test as in AabbTree; infinity when the ray misses within tMax
+float entryDistance(const glm::vec3& origin, const glm::vec3& invDir, const Aabb& box, float tMax) {
+    float t0 = 0.0f, t1 = tMax;
+    for(int axis = 0; axis < 3; ++axis) {
+        float ta = (box.min[axis] - origin[axis]) * invDir[axis];
+        float tb = (box.max[axis] - origin[axis]) * invDir[axis];
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    return t0 <= t1 ? t0 : std::numeric_limits<float>::infinity();
+}
+
+Aabb capsuleBounds(const glm::vec3& a0, const glm::vec3& a1, float radius) {
+    return {glm::min(a0, a1) - glm::vec3(radius), glm::max(a0, a1) + glm::vec3(radius)};
+}
+}
+
+void TriangleMesh::build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                         const glm::mat4& transform) {
+    clear();
+    m_vertices.reserve(positions.size());
+    for(const glm::vec3& p : positions) m_vertices.push_back(glm::vec3(transform * glm::vec4(p, 1.0f)));
+
+    std::vector<BuildTriangle> triangles;
+    std::vector<uint32_t> source;  // first index of each kept triangle
+    triangles.reserve(indices.size() / 3);
+    source.reserve(indices.size() / 3);
+    for(size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if(indices[i] >= m_vertices.size() || indices[i + 1] >= m_vertices.size() || indices[i + 2] >= m_vertices.size()) continue;
+        const glm::vec3& a = m_vertices[indices[i]];
+        const glm::vec3& b = m_vertices[indices[i + 1]];
+        const glm::vec3& c = m_vertices[indices[i + 2]];
+        triangles.push_back({{glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))}, (a + b + c) / 3.0f});
+        source.push_back(static_cast<uint32_t>(i));
+    }
+    if(triangles.empty()) {
+        clear();
+        return;
+    }
+
+    std::vector<uint32_t> order(triangles.size());
+    std::iota(order.begin(), order.end(), 0u);
+    m_nodes.reserve(2 * triangles.size());
+    Builder(triangles, order, m_nodes, kMaxSahDepth).build(0, static_cast<uint32_t>(triangles.size()), 0);
+    m_nodes.shrink_to_fit();
+
+    m_indices.resize(order.size() * 3);
+    for(size_t i = 0; i < order.size(); ++i) {
+        std::copy_n(indices.begin() + source[order[i]], 3, m_indices.begin() + i * 3);
+    }
+    m_bounds = nodeBounds(m_nodes[0]);
+}
+
+bool TriangleMesh::assign(std::vector<glm::vec3> vertices, std::vector<uint32_t> indices, std::vector<Node> nodes) {
+    clear();
+    if(indices.size() % 3 != 0 || nodes.empty() != indices.empty()) return false;
+    for(uint32_t index : indices) {
+        if(index >= vertices.size()) return false;
+    }
+    // Every node's subtree must be the contiguous run of nodes that follows it, and the leaves,
+    // in that order, must cover the triangles exactly once
+    const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    uint32_t nextTriangle = 0;
+    struct Pending {
+        uint32_t node;
+        uint32_t end;  // where this subtree must stop
+        int depth;
+    };
+    Pending stack[kStackSize];
+    int top = 0;
+    uint32_t expected = 0;  // nodes are visited in storage order
+    if(nodeCount > 0) stack[top++] = {0, nodeCount, 0};
+    while(top > 0) {
+        const Pending p = stack[--top];
+        if(p.node != expected++ || p.node >= p.end || p.depth >= kStackSize - 1) return false;
+        const Node& node = nodes[p.node];
+        if(node.isLeaf()) {
+            if(node.offset != nextTriangle || node.count > triangleCount - nextTriangle) return false;
+            nextTriangle += node.count;
+            if(p.node + 1 != p.end) return false;
+        } else {
+            if(node.offset <= p.node + 1 || node.offset >= p.end) return false;
+            stack[top++] = {node.offset, p.end, p.depth + 1};
+            stack[top++] = {p.node + 1, node.offset, p.depth + 1};
+        }
+    }
+    if(expected != nodeCount || nextTriangle != triangleCount) return false;
+
+    m_vertices = std::move(vertices);
+    m_indices = std::move(indices);
+    m_nodes = std::move(nodes);
+    if(!m_nodes.empty()) m_bounds = nodeBounds(m_nodes[0]);
+    return true;
+}
+
+void TriangleMesh::clear() {
+    m_vertices.clear();
+    m_indices.clear();
+    m_nodes.clear();
+    m_bounds = Aabb();
+}
+
+int TriangleMesh::depth() const {
+    if(m_nodes.empty()) return 0;
+    std::pair<uint32_t, int> stack[kStackSize];
+    int top = 0, deepest = 0;
+    stack[top++] = {0, 1};
+    while(top > 0) {
+        const auto [index, level] = stack[--top];
+        deepest = std::max(deepest, level);
+        const Node& node = m_nodes[index];
+        if(node.isLeaf()) continue;
+        stack[top++] = {index + 1, level + 1};
+        stack[top++] = {node.offset, level + 1};
+    }
+    return deepest;
+}
+
+template <typename Fn>
+void TriangleMesh::query(const Aabb& box, Fn&& fn) const {
+    if(m_nodes.empty()) return;
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        const uint32_t index = stack[--top];
+        const Node& node = m_nodes[index];
+        if(!nodeBounds(node).overlaps(box)) continue;
+        if(node.isLeaf()) {
+            for(uint32_t tri = node.offset; tri < node.offset + node.count; ++tri) {
+                if(!fn(tri)) return;
+            }
+        } else {
+            stack[top++] = node.offset;
+            stack[top++] = index + 1;
+        }
+    }
+}
+
+template <typename Fn>
+void TriangleMesh::sweep(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const {
+    if(m_nodes.empty() || !(tMax >= 0.0f)) return;
+    const glm::vec3 origin = box.center();
+    const glm::vec3 half = box.halfExtents();
+    const glm::vec3 invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    auto enter = [&](uint32_t index, float limit) {
+        const Node& node = m_nodes[index];
+        return entryDistance(origin, invDir, Aabb{node.min - half, node.max + half}, limit);
+    };
+    struct Entry {
+        uint32_t node;
+        float t;
+    };
+    Entry stack[kStackSize];
+    int top = 0;
+    const float rootT = enter(0, tMax);
+    if(rootT == std::numeric_limits<float>::infinity()) return;
+    stack[top++] = {0, rootT};
+    while(top > 0) {
+        const Entry entry = stack[--top];
+        if(entry.t > tMax) continue;  // clipped since it was pushed
+        const Node& node = m_nodes[entry.node];
+        if(node.isLeaf()) {
+            for(uint32_t tri = node.offset; tri < node.offset + node.count; ++tri) {
+                tMax = std::min(tMax, fn(tri, tMax));
+            }
+            continue;
+        }
+        uint32_t c1 = entry.node + 1, c2 = node.offset;
+        float t1 = enter(c1, tMax), t2 = enter(c2, tMax);
+        if(t2 < t1) {
+            std::swap(t1, t2);
+            std::swap(c1, c2);
+        }
+        // Far child first so the near one is popped next
+        if(t2 <= tMax) stack[top++] = {c2, t2};
+        if(t1 <= tMax) stack[top++] = {c1, t1};
+    }
+}
+
+bool TriangleMesh::raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& t, glm::vec3& normal) const {
+    bool found = false;
+    uint32_t nearest = 0;
+    sweep(Aabb{origin, origin}, dir, tMax, [&](uint32_t tri, float limit) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        float hit;
+        if(!rayCastTriangle(origin, dir, limit, a, b, c, hit)) return limit;
+        found = true;
+        nearest = tri;
+        t = hit;
+        return hit;
+    });
+    if(found) {
+        glm::vec3 a, b, c;
+        triangle(nearest, a, b, c);
+        normal = glm::normalize(glm::cross(b - a, c - a));
+        if(glm::dot(normal, dir) > 0.0f) normal = -normal;
+    }
+    return found;
+}
+
+bool TriangleMesh::capsuleContact(const glm::vec3& a0, const glm::vec3& a1, float radius, Contact& contact) const {
+    bool found = false;
+    query(capsuleBounds(a0, a1, radius), [&](uint32_t tri) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        Contact candidate;
+        if(capsuleTriangleContact(a0, a1, radius, a, b, c, candidate) && (!found || candidate.depth > contact.depth)) {
+            contact = candidate;
+            found = true;
+        }
+        return true;
+    });
+    return found;
+}
+
+bool TriangleMesh::aabbContact(const Aabb& box, Contact& contact) const {
+    bool found = false;
+    query(box, [&](uint32_t tri) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        Contact candidate;
+        if(aabbTriangleContact(box, a, b, c, candidate) && (!found || candidate.depth > contact.depth)) {
+            contact = candidate;
+            found = true;
+        }
+        return true;
+    });
+    return found;
+}
+
+bool TriangleMesh::overlaps(const Aabb& box) const {
+    bool found = false;
+    query(box, [&](uint32_t tri) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        float t;
+        found = aabbCastTriangle(box, glm::vec3(1.0f, 0.0f, 0.0f), 0.0f, a, b, c, t);
+        return !found;
+    });
+    return found;
+}
+
+bool TriangleMesh::capsuleCast(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                               float& t) const {
+    bool found = false;
+    sweep(capsuleBounds(a0, a1, radius), dir, tMax, [&](uint32_t tri, float limit) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        float hit;
+        if(!capsuleCastTriangle(a0, a1, radius, dir, limit, a, b, c, hit)) return limit;
+        found = true;
+        t = hit;
+        return hit;
+    });
+    return found;
+}
+
+bool TriangleMesh::aabbCast(const Aabb& box, const glm::vec3& dir, float tMax, float& t) const {
+    bool found = false;
+    sweep(box, dir, tMax, [&](uint32_t tri, float limit) {
+        glm::vec3 a, b, c;
+        triangle(tri, a, b, c);
+        float hit;
+        if(!aabbCastTriangle(box, dir, limit, a, b, c, hit)) return limit;
+        found = true;
+        t = hit;
+        return hit;
+    });
+    return found;
+}
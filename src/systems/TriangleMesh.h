@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CollisionGeometry.h"
+#include "Narrowphase.h"
+
+// Static triangle soup for collision, e.g. a building loaded from a model. Triangles are
+// two-sided and have no inside: a shape wholly within a closed mesh touches nothing.
+//
+// A bounding volume hierarchy over the triangles is built once with a binned surface-area
+// heuristic and stored flat in depth-first order: 32-byte nodes whose first child follows them,
+// and a triangle index list reordered so every leaf owns one contiguous run. The three arrays
+// are plain data, so a built mesh can be saved (see WorldCache) and restored with assign().
+//
+// Queries are const and keep their traversal stack on the call stack, so any number of threads
+// may query a mesh at once.
+class TriangleMesh {
+public:
+    struct Node {
+        glm::vec3 min{0.0f};
+        uint32_t offset = 0;  // leaf: first triangle; interior: second child (the first is next)
+        glm::vec3 max{0.0f};
+        uint32_t count = 0;   // triangles in a leaf, 0 for interior nodes
+        bool isLeaf() const { return count != 0; }
+    };
+    static_assert(sizeof(Node) == 32, "nodes are part of the cached format");
+
+    // Builds from a triangle list; positions are transformed into the space the queries use
+    void build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+               const glm::mat4& transform = glm::mat4(1.0f));
+    // Adopts arrays saved from vertices(), indices() and nodes(). Returns false (and leaves the
+    // mesh empty) when they do not describe a valid hierarchy.
+    bool assign(std::vector<glm::vec3> vertices, std::vector<uint32_t> indices, std::vector<Node> nodes);
+    void clear();
+
+    bool empty() const { return m_nodes.empty(); }
+    size_t triangleCount() const { return m_indices.size() / 3; }
+    const Aabb& bounds() const { return m_bounds; }
+    const std::vector<glm::vec3>& vertices() const { return m_vertices; }
+    const std::vector<uint32_t>& indices() const { return m_indices; }
+    const std::vector<Node>& nodes() const { return m_nodes; }
+    int depth() const;
+
+    // Nearest triangle along a ray (unit dir) within tMax; normal faces the ray's origin
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& t, glm::vec3& normal) const;
+    // Deepest contact of a capsule [a0, a1] (a sphere when a0 == a1) or a box with any triangle,
+    // normal pushing the shape out
+    bool capsuleContact(const glm::vec3& a0, const glm::vec3& a1, float radius, Contact& contact) const;
+    bool aabbContact(const Aabb& box, Contact& contact) const;
+    bool overlaps(const Aabb& box) const;
+    // First touch of a capsule or box moving along unit dir, 0 when it starts touching
+    bool capsuleCast(const glm::vec3& a0, const glm::vec3& a1, float radius, const glm::vec3& dir, float tMax,
+                     float& t) const;
+    bool aabbCast(const Aabb& box, const glm::vec3& dir, float tMax, float& t) const;
+
+private:
+    // Builds switch to median splits past this depth, which bounds the total depth below it
+    static constexpr int kMaxSahDepth = 64;
+    static constexpr int kStackSize = kMaxSahDepth + 40;
+
+    void triangle(uint32_t first, glm::vec3& a, glm::vec3& b, glm::vec3& c) const {
+        a = m_vertices[m_indices[first * 3]];
+        b = m_vertices[m_indices[first * 3 + 1]];
+        c = m_vertices[m_indices[first * 3 + 2]];
+    }
+
+    // fn(triangle) for every triangle whose leaf overlaps `box`; fn returns false to stop early
+    template <typename Fn>
+    void query(const Aabb& box, Fn&& fn) const;
+    // Nearest leaves first along a swept box, as AabbTree::sweep; fn(triangle, tMax) -> new tMax
+    template <typename Fn>
+    void sweep(const Aabb& box, const glm::vec3& dir, float tMax, Fn&& fn) const;
+
+    std::vector<glm::vec3> m_vertices;
+    std::vector<uint32_t> m_indices;  // three per triangle, in leaf order
+    std::vector<Node> m_nodes;
+    Aabb m_bounds;
+};
@@ -0,0 +1,158 @@
+#include "Noise.h"
+#include "NoiseSimd.h"
+#include <atomic>
+#include <glm/glm.hpp>
+#include <glm/gtc/noise.hpp>
+#if defined(NOISE_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Scalar path: the glm reference itself.
+void perlinScalar(const float* xs, const float* zs, float* out, size_t count) {
+    for(size_t i = 0; i < count; ++i) out[i] = glm::perlin(glm::vec2(xs[i], zs[i]));
+}
+
+void simplexScalar(const float* xs, const float* zs, float* out, size_t count) {
+    for(size_t i = 0; i < count; ++i) out[i] = glm::simplex(glm::vec2(xs[i], zs[i]));
+}
+
+float fractalScalar(float seed, float x, float z) {
+    // Macro structure (low freq simplex)
+    float macro = glm::simplex(glm::vec2(x * 0.0032f + seed, z * 0.0032f + seed));
+    // Domain warp for meso layer
+    glm::vec2 warp(
+        glm::perlin(glm::vec2(x * 0.02f + 17.0f, z * 0.02f + 3.1f)),
+        glm::perlin(glm::vec2(x * 0.02f - 6.4f, z * 0.02f + 11.7f))
+    );
+    float meso = glm::perlin(glm::vec2(x * 0.01f, z * 0.01f) + warp * 15.0f);
+    // Micro detail (higher freq fractal sum)
+    float micro = 0.0f;
+    float amp = 1.0f;
+    float freq = 0.08f;
+    for(int i = 0; i < 4; ++i){
+        micro += amp * glm::perlin(glm::vec2(x * freq, z * freq));
+        amp *= 0.5f;
+        freq *= 2.0f;
+    }
+    return macro * 0.55f + meso * 0.35f + micro * 0.10f; // Weighted blend
+}
+
+void fractalBatchScalar(float seed, const float* xs, const float* zs, float* out, size_t count) {
+    for(size_t i = 0; i < count; ++i) out[i] = fractalScalar(seed, xs[i], zs[i]);
+}
+
+void fractalRowScalar(float seed, const float* xs, float z, float* out, size_t count) {
+    for(size_t i = 0; i < count; ++i) out[i] = fractalScalar(seed, xs[i], z);
+}
+
+struct NoiseKernels {
+    void (*perlin)(const float*, const float*, float*, size_t);
+    void (*simplex)(const float*, const float*, float*, size_t);
+    void (*fractal)(float, const float*, const float*, float*, size_t);
+    void (*fractalRow)(float, const float*, float, float*, size_t);
+};
+
+constexpr NoiseKernels kScalarKernels{perlinScalar, simplexScalar, fractalBatchScalar, fractalRowScalar};
+#if defined(NOISE_SIMD_X86)
+constexpr NoiseKernels kSse41Kernels{noise_kernels::sse41::perlin, noise_kernels::sse41::simplex,
+                                     noise_kernels::sse41::fractal, noise_kernels::sse41::fractalRow};
+constexpr NoiseKernels kAvx2Kernels{noise_kernels::avx2::perlin, noise_kernels::avx2::simplex,
+                                    noise_kernels::avx2::fractal, noise_kernels::avx2::fractalRow};
+#endif
+
+NoiseSimdLevel detectCpuLevel() {
+#if defined(NOISE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return NoiseSimdLevel::AVX2;
+    if(__builtin_cpu_supports("sse4.1")) return NoiseSimdLevel::SSE41;
+#elif defined(NOISE_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    if(maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6){
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if(avx2) return NoiseSimdLevel::AVX2;
+    if(sse41) return NoiseSimdLevel::SSE41;
+#endif
+    return NoiseSimdLevel::Scalar;
+}
+
+std::atomic<int> g_activeLevel{-1};
+
+NoiseSimdLevel activeLevel() {
+    int level = g_activeLevel.load(std::memory_order_relaxed);
+    if(level < 0){
+        level = static_cast<int>(FractalNoise::detectedSimdLevel());
+        g_activeLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<NoiseSimdLevel>(level);
+}
+
+const NoiseKernels& kernels() {
+#if defined(NOISE_SIMD_X86)
+    switch(activeLevel()){
+        case NoiseSimdLevel::AVX2: return kAvx2Kernels;
+        case NoiseSimdLevel::SSE41: return kSse41Kernels;
+        default: break;
+    }
+#endif
+    return kScalarKernels;
+}
+
+} // namespace
+
+float FractalNoise::sample(float x, float z) const {
+    return fractalScalar(static_cast<float>(m_seed), x, z);
+}
+
+void FractalNoise::sample(const float* xs, const float* zs, float* out, size_t count) const {
+    kernels().fractal(static_cast<float>(m_seed), xs, zs, out, count);
+}
+
+void FractalNoise::fill(const NoiseGrid& grid, const float* xs, const float* zs, float* out) const {
+    if(grid.countX <= 0 || grid.countZ <= 0) return;
+    const NoiseKernels& k = kernels();
+    const float seed = static_cast<float>(m_seed);
+    for(int row = 0; row < grid.countZ; ++row){
+        k.fractalRow(seed, xs, zs[row], out + static_cast<size_t>(row) * grid.countX, static_cast<size_t>(grid.countX));
+    }
+}
+
+void FractalNoise::perlin(const float* xs, const float* zs, float* out, size_t count) {
+    kernels().perlin(xs, zs, out, count);
+}
+
+void FractalNoise::simplex(const float* xs, const float* zs, float* out, size_t count) {
+    kernels().simplex(xs, zs, out, count);
+}
+
+NoiseSimdLevel FractalNoise::simdLevel() {
+    return activeLevel();
+}
+
+NoiseSimdLevel FractalNoise::detectedSimdLevel() {
+    static const NoiseSimdLevel level = detectCpuLevel();
+    return level;
+}
+
+void FractalNoise::setSimdLevel(NoiseSimdLevel level) {
+    if(static_cast<int>(level) > static_cast<int>(detectedSimdLevel())) level = detectedSimdLevel();
+    g_activeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* FractalNoise::simdLevelName(NoiseSimdLevel level) {
+    switch(level){
+        case NoiseSimdLevel::AVX2: return "AVX2";
+        case NoiseSimdLevel::SSE41: return "SSE4.1";
+        default: return "scalar";
+    }
+}
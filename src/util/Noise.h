@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+
+// Batched 2D gradient noise.
+// Every kernel reproduces glm::perlin(vec2) / glm::simplex(vec2) operation for operation
+// (no FMA contraction, same evaluation order), so SSE4.1 / AVX2 / scalar paths return
+// bit-identical results and terrain generated on any machine matches the glm reference.
+
+enum class NoiseSimdLevel { Scalar, SSE41, AVX2 };
+
+// Separable sample grid: fill() writes out[row * countX + col] = f(xs[col], zs[row]).
+struct NoiseGrid {
+    int countX = 0;
+    int countZ = 0;
+};
+
+class FractalNoise {
+public:
+    explicit FractalNoise(int seed = 1337) : m_seed(seed) {}
+    // The seed offsets the macro layer's domain; the permutation polynomial itself is fixed
+    // so results stay comparable to the glm reference.
+    void setSeed(int seed) { m_seed = seed; }
+    int seed() const { return m_seed; }
+
+    // Simplex macro layer + domain-warped Perlin meso layer + 4-octave Perlin micro layer.
+    float sample(float x, float z) const;
+    void sample(const float* xs, const float* zs, float* out, size_t count) const;
+    void fill(const NoiseGrid& grid, const float* xs, const float* zs, float* out) const;
+
+    // Raw batched primitives (out[i] = glm::perlin / glm::simplex of (xs[i], zs[i])).
+    static void perlin(const float* xs, const float* zs, float* out, size_t count);
+    static void simplex(const float* xs, const float* zs, float* out, size_t count);
+
+    // Kernel selection. The best level supported by the CPU is picked on first use;
+    // setSimdLevel clamps to that, and exists to compare kernels against each other.
+    static NoiseSimdLevel simdLevel();
+    static NoiseSimdLevel detectedSimdLevel();
+    static void setSimdLevel(NoiseSimdLevel level);
+    static const char* simdLevelName(NoiseSimdLevel level);
+
+private:
+    int m_seed = 1337;
+};
@@ -0,0 +1,36 @@
+// util/NoiseAvx2.cpp
+// 8-lane noise kernels. Built with AVX2 enabled but deliberately without FMA, so products
+// and sums round exactly like the scalar glm reference; only reached through FractalNoise's
+// CPU dispatch.
+#include "NoiseSimd.h"
+
+#if defined(NOISE_SIMD_X86)
+#include <immintrin.h>
+
+namespace {
+
+struct F { __m256 v; };
+constexpr int kLanes = 8;
+
+inline F splat(float f) { return {_mm256_set1_ps(f)}; }
+inline F load(const float* p) { return {_mm256_loadu_ps(p)}; }
+inline void store(float* p, F a) { _mm256_storeu_ps(p, a.v); }
+inline F operator+(F a, F b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline F operator-(F a, F b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline F operator*(F a, F b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline F operator/(F a, F b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline F floorv(F a) { return {_mm256_floor_ps(a.v)}; }
+inline F absv(F a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+// maxps(a, b) = a > b ? a : b, which matches glm::max(b, a) including -0 and NaN handling.
+inline F maxv(F a, F b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline F selectGreater(F a, F b, F ifTrue, F ifFalse) {
+    return {_mm256_blendv_ps(ifFalse.v, ifTrue.v, _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ))};
+}
+
+} // namespace
+
+#define NOISE_KERNEL_NAMESPACE avx2
+#include "NoiseKernel.inl"
+#undef NOISE_KERNEL_NAMESPACE
+
+#endif
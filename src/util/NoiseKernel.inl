@@ -0,0 +1,201 @@
+// util/NoiseKernel.inl
+// Lane-parallel ports of glm::perlin(vec2) and glm::simplex(vec2), shared by the SSE4.1 and
+// AVX2 translation units. The including file provides, in an anonymous namespace:
+//   struct F;  constexpr int kLanes;  F splat(float);  F load(const float*);  void store(float*, F);
+//   F operator+ - * / (F, F);  F floorv(F);  F absv(F);  F maxv(F, F);
+//   F selectGreater(F a, F b, F ifTrue, F ifFalse)   // a > b ? ifTrue : ifFalse
+// and defines NOISE_KERNEL_NAMESPACE. Each expression mirrors the glm source term by term;
+// do not "simplify" (reassociating or fusing changes the rounding). glm builds its constants
+// as T(double literal), hence the static_casts instead of float literals.
+
+namespace noise_kernels {
+namespace NOISE_KERNEL_NAMESPACE {
+namespace {
+
+// glm::detail::mod289 / permute
+inline F mod289(F x) {
+    return x - floorv(x * splat(1.0f / 289.0f)) * splat(289.0f);
+}
+inline F permute(F x) {
+    return mod289(((x * splat(34.0f)) + splat(1.0f)) * x);
+}
+// glm::fract
+inline F fract(F x) {
+    return x - floorv(x);
+}
+// glm::mod(x, 289)
+inline F mod289Div(F x) {
+    return x - splat(289.0f) * floorv(x / splat(289.0f));
+}
+
+inline F perlinLane(F px, F py) {
+    // Pi = floor(P.xyxy) + (0,0,1,1); Pf = fract(P.xyxy) - (0,0,1,1)
+    F fx0 = floorv(px);
+    F fy0 = floorv(py);
+    F pix = fx0 + splat(0.0f);
+    F piy = fy0 + splat(0.0f);
+    F piz = fx0 + splat(1.0f);
+    F piw = fy0 + splat(1.0f);
+    F pfx = fract(px) - splat(0.0f);
+    F pfy = fract(py) - splat(0.0f);
+    F pfz = fract(px) - splat(1.0f);
+    F pfw = fract(py) - splat(1.0f);
+    pix = mod289Div(pix);
+    piy = mod289Div(piy);
+    piz = mod289Div(piz);
+    piw = mod289Div(piw);
+
+    // Corners: 00 = (x,y), 10 = (z,y), 01 = (x,w), 11 = (z,w)
+    F i00 = permute(permute(pix) + piy);
+    F i10 = permute(permute(piz) + piy);
+    F i01 = permute(permute(pix) + piw);
+    F i11 = permute(permute(piz) + piw);
+
+    auto gradient = [](F i, F& gx, F& gy) {
+        gx = splat(2.0f) * fract(i / splat(41.0f)) - splat(1.0f);
+        gy = absv(gx) - splat(0.5f);
+        F tx = floorv(gx + splat(0.5f));
+        gx = gx - tx;
+        F norm = splat(static_cast<float>(1.79284291400159)) - splat(static_cast<float>(0.85373472095314)) * (gx * gx + gy * gy);
+        gx = gx * norm;
+        gy = gy * norm;
+    };
+    F g00x, g00y, g10x, g10y, g01x, g01y, g11x, g11y;
+    gradient(i00, g00x, g00y);
+    gradient(i10, g10x, g10y);
+    gradient(i01, g01x, g01y);
+    gradient(i11, g11x, g11y);
+
+    F n00 = g00x * pfx + g00y * pfy;
+    F n10 = g10x * pfz + g10y * pfy;
+    F n01 = g01x * pfx + g01y * pfw;
+    F n11 = g11x * pfz + g11y * pfw;
+
+    // fade(t) = (t*t*t) * (t*(t*6-15)+10)
+    F fadeX = (pfx * pfx * pfx) * (pfx * (pfx * splat(6.0f) - splat(15.0f)) + splat(10.0f));
+    F fadeY = (pfy * pfy * pfy) * (pfy * (pfy * splat(6.0f) - splat(15.0f)) + splat(10.0f));
+    // mix(x, y, a) = x * (1 - a) + y * a
+    F oneMinusFx = splat(1.0f) - fadeX;
+    F nx0 = n00 * oneMinusFx + n10 * fadeX;
+    F nx1 = n01 * oneMinusFx + n11 * fadeX;
+    F nxy = nx0 * (splat(1.0f) - fadeY) + nx1 * fadeY;
+    return splat(static_cast<float>(2.3)) * nxy;
+}
+
+inline F simplexLane(F vx, F vy) {
+    const F cx = splat(static_cast<float>(0.211324865405187));
+    const F cy = splat(static_cast<float>(0.366025403784439));
+    const F cz = splat(static_cast<float>(-0.577350269189626));
+    const F cw = splat(static_cast<float>(0.024390243902439));
+
+    // First corner
+    F d = vx * cy + vy * cy;
+    F ix = floorv(vx + d);
+    F iy = floorv(vy + d);
+    F di = ix * cx + iy * cx;
+    F x0x = vx - ix + di;
+    F x0y = vy - iy + di;
+
+    // Other corners: i1 = x0.x > x0.y ? (1,0) : (0,1)
+    F i1x = selectGreater(x0x, x0y, splat(1.0f), splat(0.0f));
+    F i1y = selectGreater(x0x, x0y, splat(0.0f), splat(1.0f));
+    F x12x = (x0x + cx) - i1x;
+    F x12y = (x0y + cx) - i1y;
+    F x12z = x0x + cz;
+    F x12w = x0y + cz;
+
+    // Permutations
+    ix = mod289Div(ix);
+    iy = mod289Div(iy);
+    F p0 = permute((permute(iy + splat(0.0f)) + ix) + splat(0.0f));
+    F p1 = permute((permute(iy + i1y) + ix) + i1x);
+    F p2 = permute((permute(iy + splat(1.0f)) + ix) + splat(1.0f));
+
+    F m0 = maxv(splat(0.0f), splat(0.5f) - (x0x * x0x + x0y * x0y));
+    F m1 = maxv(splat(0.0f), splat(0.5f) - (x12x * x12x + x12y * x12y));
+    F m2 = maxv(splat(0.0f), splat(0.5f) - (x12z * x12z + x12w * x12w));
+    m0 = m0 * m0; m1 = m1 * m1; m2 = m2 * m2;
+    m0 = m0 * m0; m1 = m1 * m1; m2 = m2 * m2;
+
+    auto gradient = [&](F p, F& m, F& a0, F& h) {
+        F x = splat(2.0f) * fract(p * cw) - splat(1.0f);
+        h = absv(x) - splat(0.5f);
+        F ox = floorv(x + splat(0.5f));
+        a0 = x - ox;
+        m = m * (splat(static_cast<float>(1.79284291400159)) - splat(static_cast<float>(0.85373472095314)) * (a0 * a0 + h * h));
+    };
+    F a00, h0, a01, h1, a02, h2;
+    gradient(p0, m0, a00, h0);
+    gradient(p1, m1, a01, h1);
+    gradient(p2, m2, a02, h2);
+
+    F g0 = a00 * x0x + h0 * x0y;
+    F g1 = a01 * x12x + h1 * x12y;
+    F g2 = a02 * x12z + h2 * x12w;
+    return splat(130.0f) * ((m0 * g0 + m1 * g1) + m2 * g2);
+}
+
+// Same layering as FractalNoise::sample.
+inline F fractalLane(F seed, F x, F z) {
+    F macro = simplexLane(x * splat(0.0032f) + seed, z * splat(0.0032f) + seed);
+    F warpX = perlinLane(x * splat(0.02f) + splat(17.0f), z * splat(0.02f) + splat(3.1f));
+    F warpY = perlinLane(x * splat(0.02f) - splat(6.4f), z * splat(0.02f) + splat(11.7f));
+    F meso = perlinLane(x * splat(0.01f) + warpX * splat(15.0f), z * splat(0.01f) + warpY * splat(15.0f));
+    F micro = splat(0.0f);
+    float amp = 1.0f;
+    float freq = 0.08f;
+    for (int i = 0; i < 4; ++i) {
+        micro = micro + splat(amp) * perlinLane(x * splat(freq), z * splat(freq));
+        amp *= 0.5f;
+        freq *= 2.0f;
+    }
+    return macro * splat(0.55f) + meso * splat(0.35f) + micro * splat(0.10f);
+}
+
+// Runs fn over full lanes, then pads the tail so every lane count goes through the kernel.
+template <typename Fn>
+inline void forEachBlock(const float* xs, const float* zs, float* out, size_t count, Fn fn) {
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        store(out + i, fn(load(xs + i), load(zs + i)));
+    }
+    if (i < count) {
+        float bx[kLanes] = {}, bz[kLanes] = {}, bo[kLanes];
+        for (size_t k = 0; i + k < count; ++k) { bx[k] = xs[i + k]; bz[k] = zs[i + k]; }
+        store(bo, fn(load(bx), load(bz)));
+        for (size_t k = 0; i + k < count; ++k) out[i + k] = bo[k];
+    }
+}
+
+} // namespace
+
+void perlin(const float* xs, const float* zs, float* out, size_t count) {
+    forEachBlock(xs, zs, out, count, [](F x, F z) { return perlinLane(x, z); });
+}
+
+void simplex(const float* xs, const float* zs, float* out, size_t count) {
+    forEachBlock(xs, zs, out, count, [](F x, F z) { return simplexLane(x, z); });
+}
+
+void fractal(float seed, const float* xs, const float* zs, float* out, size_t count) {
+    const F s = splat(seed);
+    forEachBlock(xs, zs, out, count, [s](F x, F z) { return fractalLane(s, x, z); });
+}
+
+void fractalRow(float seed, const float* xs, float z, float* out, size_t count) {
+    const F s = splat(seed);
+    const F zv = splat(z);
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        store(out + i, fractalLane(s, load(xs + i), zv));
+    }
+    if (i < count) {
+        float bx[kLanes] = {}, bo[kLanes];
+        for (size_t k = 0; i + k < count; ++k) bx[k] = xs[i + k];
+        store(bo, fractalLane(s, load(bx), zv));
+        for (size_t k = 0; i + k < count; ++k) out[i + k] = bo[k];
+    }
+}
+
+} // namespace NOISE_KERNEL_NAMESPACE
+} // namespace noise_kernels
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+
+// Internal entry points of the per-ISA noise kernels (util/NoiseSse41.cpp, util/NoiseAvx2.cpp).
+// Those translation units are compiled with their own instruction-set flags, so only
+// FractalNoise's dispatcher may call into them, and only after checking CPU support.
+// NOISE_SIMD_X86 is defined by the build on x86 targets where the kernels are compiled.
+
+#define NOISE_DECLARE_KERNELS(ns)                                                                  \
+    namespace ns {                                                                                 \
+    void perlin(const float* xs, const float* zs, float* out, size_t count);                       \
+    void simplex(const float* xs, const float* zs, float* out, size_t count);                      \
+    void fractal(float seed, const float* xs, const float* zs, float* out, size_t count);          \
+    void fractalRow(float seed, const float* xs, float z, float* out, size_t count);               \
+    }
+
+namespace noise_kernels {
+#if defined(NOISE_SIMD_X86)
+NOISE_DECLARE_KERNELS(sse41)
+NOISE_DECLARE_KERNELS(avx2)
+#endif
+}
+
+#undef NOISE_DECLARE_KERNELS
@@ -0,0 +1,35 @@
+// util/NoiseSse41.cpp
+// 4-lane noise kernels. Built with SSE4.1 enabled (roundps gives an exact floor);
+// only reached through FractalNoise's CPU dispatch.
+#include "NoiseSimd.h"
+
+#if defined(NOISE_SIMD_X86)
+#include <smmintrin.h>
+
+namespace {
+
+struct F { __m128 v; };
+constexpr int kLanes = 4;
+
+inline F splat(float f) { return {_mm_set1_ps(f)}; }
+inline F load(const float* p) { return {_mm_loadu_ps(p)}; }
+inline void store(float* p, F a) { _mm_storeu_ps(p, a.v); }
+inline F operator+(F a, F b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F operator-(F a, F b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline F operator*(F a, F b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F operator/(F a, F b) { return {_mm_div_ps(a.v, b.v)}; }
+inline F floorv(F a) { return {_mm_floor_ps(a.v)}; }
+inline F absv(F a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+// maxps(a, b) = a > b ? a : b, which matches glm::max(b, a) including -0 and NaN handling.
+inline F maxv(F a, F b) { return {_mm_max_ps(a.v, b.v)}; }
+inline F selectGreater(F a, F b, F ifTrue, F ifFalse) {
+    return {_mm_blendv_ps(ifFalse.v, ifTrue.v, _mm_cmpgt_ps(a.v, b.v))};
+}
+
+} // namespace
+
+#define NOISE_KERNEL_NAMESPACE sse41
+#include "NoiseKernel.inl"
+#undef NOISE_KERNEL_NAMESPACE
+
+#endif
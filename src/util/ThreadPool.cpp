@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if(threadCount == 0){
+        unsigned hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 0;
+    }
+    m_workers.reserve(threadCount);
+    for(unsigned i = 0; i < threadCount; ++i){
+        m_workers.emplace_back([this]{ workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    for(std::thread& t : m_workers){
+        if(t.joinable()) t.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for(;;){
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]{ return m_stopping || !m_jobs.empty(); });
+            if(m_stopping && m_jobs.empty()) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> job) {
+    auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+    std::future<void> result = task->get_future();
+    if(m_workers.empty()){
+        (*task)();
+        return result;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.emplace_back([task]{ (*task)(); });
+    }
+    m_cv.notify_one();
+    return result;
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if(end <= begin) return;
+    grain = std::max(1, grain);
+    const int chunkCount = (end - begin + grain - 1) / grain;
+    if(chunkCount == 1 || m_workers.empty()){
+        for(int i = begin; i < end; i += grain) fn(i, std::min(end, i + grain));
+        return;
+    }
+
+    // Helpers may still be dequeued after this call returns (once all chunks are claimed),
+    // so everything they touch lives in a shared block rather than on this stack frame.
+    struct Batch {
+        std::function<void(int, int)> fn;
+        int begin, end, grain, chunkCount;
+        std::atomic<int> nextChunk{0};
+        std::atomic<int> doneChunks{0};
+        std::mutex doneMutex;
+        std::condition_variable doneCv;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->fn = fn;
+    batch->begin = begin;
+    batch->end = end;
+    batch->grain = grain;
+    batch->chunkCount = chunkCount;
+
+    auto drain = [](Batch& b){
+        for(;;){
+            int chunk = b.nextChunk.fetch_add(1);
+            if(chunk >= b.chunkCount) return;
+            int first = b.begin + chunk * b.grain;
+            b.fn(first, std::min(b.end, first + b.grain));
+            if(b.doneChunks.fetch_add(1) + 1 == b.chunkCount){
+                std::lock_guard<std::mutex> lock(b.doneMutex);
+                b.doneCv.notify_all();
+            }
+        }
+    };
+
+    const int helpers = std::min(static_cast<int>(m_workers.size()), chunkCount - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(int i = 0; i < helpers; ++i){
+            m_jobs.emplace_back([batch, drain]{ drain(*batch); });
+        }
+    }
+    m_cv.notify_all();
+
+    drain(*batch);
+    std::unique_lock<std::mutex> lock(batch->doneMutex);
+    batch->doneCv.wait(lock, [&]{ return batch->doneChunks.load() == batch->chunkCount; });
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
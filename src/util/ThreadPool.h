@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size worker pool shared by CPU-heavy generation code (terrain, textures, physics).
+// parallelFor blocks until every chunk has run; the calling thread works on chunks too, so it
+// is safe to call from inside another pool task.
+class ThreadPool {
+public:
+    // threadCount == 0 picks hardware_concurrency() - 1 workers (the caller is the extra lane).
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that execute parallelFor chunks, including the caller.
+    unsigned concurrency() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // Run fn(chunkBegin, chunkEnd) over [begin, end) in chunks of at most `grain` items.
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+    // Queue a fire-and-forget job (background baking, streaming). The future reports completion.
+    std::future<void> submit(std::function<void()> job);
+
+    // Process-wide pool, created on first use.
+    static ThreadPool& shared();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+};
@@ -0,0 +1,176 @@
+#include "WorldCache.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+constexpr char kMagic[8] = {'W', 'O', 'R', 'L', 'D', 'C', 'A', 'C'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr uint64_t kSectionAlignment = 64;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t key;
+    uint64_t fileSize;
+    uint64_t tableChecksum;
+    unsigned char reserved[24];
+};
+static_assert(sizeof(FileHeader) == 64, "header is part of the on-disk format");
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t elementSize;
+    uint64_t offset;  // from the start of the file, kSectionAlignment aligned
+    uint64_t size;
+    uint64_t checksum;
+};
+static_assert(sizeof(SectionEntry) == 32, "section entries are part of the on-disk format");
+
+// FNV-1a folded over 8-byte words: a cheap integrity check that keeps validation of a few
+// megabytes in the low milliseconds.
+uint64_t checksum(const unsigned char* data, size_t size) {
+    uint64_t h = kFnvOffset;
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8){
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * kFnvPrime;
+    }
+    for(; i < size; ++i) h = (h ^ data[i]) * kFnvPrime;
+    return h;
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+}
+
+WorldCache::KeyBuilder& WorldCache::KeyBuilder::add(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; ++i) m_hash = (m_hash ^ bytes[i]) * kFnvPrime;
+    return *this;
+}
+
+void WorldCache::putBytes(uint32_t id, uint32_t elementSize, const void* data, size_t size) {
+    auto it = std::find_if(m_sections.begin(), m_sections.end(), [id](const Section& s){ return s.id == id; });
+    if(it == m_sections.end()){
+        m_sections.emplace_back();
+        it = m_sections.end() - 1;
+    }
+    it->id = id;
+    it->elementSize = elementSize;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    it->bytes.assign(bytes, bytes + size);
+}
+
+const WorldCache::Section* WorldCache::find(uint32_t id) const {
+    for(const Section& s : m_sections){
+        if(s.id == id) return &s;
+    }
+    return nullptr;
+}
+
+bool WorldCache::load(const std::string& path) {
+    m_sections.clear();
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if(!in) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    std::vector<unsigned char> file(fileSize);
+    in.seekg(0);
+    if(fileSize < sizeof(FileHeader) || !in.read(reinterpret_cast<char*>(file.data()), fileSize)){
+        std::cerr << "[WorldCache] " << path << " is truncated" << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion){
+        std::cerr << "[WorldCache] " << path << " has an unknown format" << std::endl;
+        return false;
+    }
+    if(header.key != m_key){
+        std::cout << "[WorldCache] " << path << " was built with other generator settings; rebuilding" << std::endl;
+        return false;
+    }
+    const uint64_t tableSize = static_cast<uint64_t>(header.sectionCount) * sizeof(SectionEntry);
+    if(header.fileSize != fileSize || sizeof(FileHeader) + tableSize > fileSize
+       || checksum(file.data() + sizeof(FileHeader), tableSize) != header.tableChecksum){
+        std::cerr << "[WorldCache] " << path << " is corrupt (header)" << std::endl;
+        return false;
+    }
+
+    std::vector<Section> sections(header.sectionCount);
+    for(uint32_t i = 0; i < header.sectionCount; ++i){
+        SectionEntry entry;
+        std::memcpy(&entry, file.data() + sizeof(FileHeader) + i * sizeof(SectionEntry), sizeof(entry));
+        if(entry.offset % kSectionAlignment != 0 || entry.offset > fileSize || entry.size > fileSize - entry.offset
+           || checksum(file.data() + entry.offset, entry.size) != entry.checksum){
+            std::cerr << "[WorldCache] " << path << " is corrupt (section " << i << ")" << std::endl;
+            return false;
+        }
+        sections[i].id = entry.id;
+        sections[i].elementSize = entry.elementSize;
+        sections[i].bytes.assign(file.begin() + entry.offset, file.begin() + entry.offset + entry.size);
+    }
+    m_sections = std::move(sections);
+    return true;
+}
+
+bool WorldCache::save(const std::string& path) const {
+    std::filesystem::path target(path);
+    std::error_code ec;
+    if(target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.sectionCount = static_cast<uint32_t>(m_sections.size());
+    header.key = m_key;
+
+    std::vector<SectionEntry> table(m_sections.size());
+    uint64_t offset = alignUp(sizeof(FileHeader) + table.size() * sizeof(SectionEntry));
+    for(size_t i = 0; i < m_sections.size(); ++i){
+        const Section& s = m_sections[i];
+        table[i] = {s.id, s.elementSize, offset, s.bytes.size(), checksum(s.bytes.data(), s.bytes.size())};
+        offset = alignUp(offset + s.bytes.size());
+    }
+    header.fileSize = offset;
+    header.tableChecksum = checksum(reinterpret_cast<const unsigned char*>(table.data()), table.size() * sizeof(SectionEntry));
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if(!out){
+            std::cerr << "[WorldCache] Cannot write " << tmpPath << std::endl;
+            return false;
+        }
+        static const char padding[kSectionAlignment] = {};
+        uint64_t written = 0;
+        auto write = [&](const void* data, uint64_t size){
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written += size;
+        };
+        write(&header, sizeof(header));
+        write(table.data(), table.size() * sizeof(SectionEntry));
+        for(size_t i = 0; i < m_sections.size(); ++i){
+            write(padding, table[i].offset - written);
+            write(m_sections[i].bytes.data(), m_sections[i].bytes.size());
+        }
+        write(padding, header.fileSize - written);
+        if(!out){
+            std::cerr << "[WorldCache] Failed writing " << tmpPath << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if(ec){
+        std::cerr << "[WorldCache] Cannot replace " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
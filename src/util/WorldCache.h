@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Persistent store for deterministic procedural outputs (heightmaps, textures, placements).
+// The file is a fixed header, a section table and 64-byte aligned raw arrays in native
+// (little-endian) layout. load() reads the file into memory and copies each verified section
+// into its own buffer; get() then copies the raw bytes out without any parsing. It is
+// bound to a key, a hash of every generator parameter: a mismatching key, size or section
+// checksum rejects the whole file and the caller regenerates and saves a new one.
+class WorldCache {
+public:
+    // Incremental FNV-1a over generator parameters
+    class KeyBuilder {
+    public:
+        KeyBuilder& add(const void* data, size_t size);
+        template <typename T>
+        KeyBuilder& add(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "hash plain values only");
+            return add(&value, sizeof(T));
+        }
+        KeyBuilder& add(const std::string& text) { return add(text.data(), text.size()); }
+        uint64_t key() const { return m_hash; }
+
+    private:
+        uint64_t m_hash = 14695981039346656037ull;
+    };
+
+    explicit WorldCache(uint64_t key = 0) : m_key(key) {}
+
+    uint64_t key() const { return m_key; }
+    bool empty() const { return m_sections.empty(); }
+
+    // Reads and validates a cache file; on any mismatch the cache stays empty and false is returned.
+    bool load(const std::string& path);
+    // Writes to path + ".tmp" and renames, so readers never see a half-written file.
+    bool save(const std::string& path) const;
+
+    // Four-character section ids, e.g. WorldCache::sectionId("HGHT")
+    static constexpr uint32_t sectionId(const char (&tag)[5]) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(tag[0]))
+            | static_cast<uint32_t>(static_cast<unsigned char>(tag[1])) << 8
+            | static_cast<uint32_t>(static_cast<unsigned char>(tag[2])) << 16
+            | static_cast<uint32_t>(static_cast<unsigned char>(tag[3])) << 24;
+    }
+
+    template <typename T>
+    void put(uint32_t id, const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "sections hold plain arrays");
+        putBytes(id, sizeof(T), values.data(), values.size() * sizeof(T));
+    }
+    // False when the section is missing or was stored with a different element size.
+    template <typename T>
+    bool get(uint32_t id, std::vector<T>& out) const {
+        static_assert(std::is_trivially_copyable<T>::value, "sections hold plain arrays");
+        const Section* s = find(id);
+        if(!s || s->elementSize != sizeof(T) || s->bytes.size() % sizeof(T) != 0) return false;
+        out.resize(s->bytes.size() / sizeof(T));
+        if(!s->bytes.empty()) std::memcpy(out.data(), s->bytes.data(), s->bytes.size());
+        return true;
+    }
+
+private:
+    struct Section {
+        uint32_t id = 0;
+        uint32_t elementSize = 0;
+        std::vector<unsigned char> bytes;
+    };
+
+    void putBytes(uint32_t id, uint32_t elementSize, const void* data, size_t size);
+    const Section* find(uint32_t id) const;
+
+    uint64_t m_key = 0;
+    std::vector<Section> m_sections;
+};
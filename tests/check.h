@@ -0,0 +1,26 @@
+#pragma once
+#include <iostream>
+
+// Check helpers shared by the engine tests: a failed check is reported and counted, and main
+// returns testResult() so ctest sees the failure.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline bool check(bool ok, const char* what) {
+    if(!ok) {
+        std::cout << "  FAILED: " << what << std::endl;
+        ++checkFailures();
+    }
+    return ok;
+}
+
+inline int testResult(const char* name) {
+    if(checkFailures() == 0) {
+        std::cout << "[" << name << "] passed" << std::endl;
+        return 0;
+    }
+    std::cout << "[" << name << "] " << checkFailures() << " check(s) failed" << std::endl;
+    return 1;
+}
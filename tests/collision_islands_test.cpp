@@ -0,0 +1,230 @@
+// CollisionSystem::resolveMovements must move bodies as resolveMovement then updateBodyPosition
+// do in span order, to rounding where bodies start inside each other, and its results must not
+// depend on the thread count: a one-worker pool and a many-worker pool give the same bits.
+// Once warm, a frame of collision work that runs on the caller must allocate nothing.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "check.h"
+#include "systems/CollisionSystem.h"
+#include "systems/Heightfield.h"
+#include "util/ThreadPool.h"
+
+// Every allocation in the process, counted so a warm frame can be checked to make none
+std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+// Bodies that start inside each other are pushed apart in float by either path, not always to the
+// same bits; the drift seen is under 1e-6 after three steps
+constexpr float kMaxSequentialDrift = 1e-5f;  // world units
+constexpr int kSteps = 3;
+constexpr int kWarmupFrames = 40;
+constexpr int kWarmFrames = 50;
+
+struct Scene {
+    CollisionSystem system;
+    std::vector<CollisionHandle> movers;
+    std::vector<glm::vec3> targets;
+};
+
+// Static boxes and a crowd of spheres, capsules and boxes, each headed up to 1.5 units away.
+// The density is high enough that most movers share an island with a few others.
+void build(Scene& scene, int moverCount, int staticCount, uint32_t seed) {
+    const float half = std::sqrt(static_cast<float>(moverCount + staticCount)) * 1.2f;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(-half, half), size(0.2f, 0.6f), step(-1.5f, 1.5f);
+    for(int i = 0; i < staticCount; ++i) {
+        CollisionBody body;
+        body.shape = CollisionShape::Box;
+        body.isStatic = true;
+        body.position = glm::vec3(coord(rng), 0.5f, coord(rng));
+        body.halfExtents = glm::vec3(size(rng), size(rng), size(rng));
+        scene.system.addBody(body);
+    }
+    for(int i = 0; i < moverCount; ++i) {
+        CollisionBody body;
+        const int kind = i % 3;
+        body.shape = kind == 0 ? CollisionShape::Sphere : kind == 1 ? CollisionShape::Capsule : CollisionShape::Box;
+        body.position = glm::vec3(coord(rng), 0.2f, coord(rng));
+        body.radius = size(rng);
+        body.height = 1.8f;
+        body.halfExtents = glm::vec3(size(rng));
+        scene.movers.push_back(scene.system.addBody(body));
+        scene.targets.push_back(body.position + glm::vec3(step(rng), 0.0f, step(rng)));
+    }
+}
+
+glm::vec3 positionOf(const CollisionSystem& system, CollisionHandle handle) {
+    CollisionBody body;
+    system.getBody(handle, body);
+    return body.position;
+}
+
+void testScene(int moverCount, int staticCount, uint32_t seed, ThreadPool& onePool, ThreadPool& widePool) {
+    Scene sequential, narrow, wide;
+    build(sequential, moverCount, staticCount, seed);
+    build(narrow, moverCount, staticCount, seed);
+    build(wide, moverCount, staticCount, seed);
+    narrow.system.setThreadPool(&onePool);
+    wide.system.setThreadPool(&widePool);
+
+    std::vector<BodyMove> narrowMoves(moverCount), wideMoves(moverCount);
+    float maxDrift = 0.0f;
+    size_t poolMismatches = 0, reportMismatches = 0;
+    for(int step = 0; step < kSteps; ++step) {
+        const glm::vec3 offset(0.3f * step, 0.0f, -0.2f * step);
+        for(int i = 0; i < moverCount; ++i) {
+            const glm::vec3 target = sequential.targets[i] + offset;
+            const glm::vec3 from = positionOf(sequential.system, sequential.movers[i]);
+            sequential.system.updateBodyPosition(sequential.movers[i],
+                                                 sequential.system.resolveMovement(sequential.movers[i], from, target));
+            narrowMoves[i] = {narrow.movers[i], target};
+            wideMoves[i] = {wide.movers[i], target};
+        }
+        narrow.system.resolveMovements(narrowMoves);
+        wide.system.resolveMovements(wideMoves);
+
+        for(int i = 0; i < moverCount; ++i) {
+            const glm::vec3 expected = positionOf(sequential.system, sequential.movers[i]);
+            const glm::vec3 narrowPosition = positionOf(narrow.system, narrow.movers[i]);
+            const glm::vec3 widePosition = positionOf(wide.system, wide.movers[i]);
+            maxDrift = std::max(maxDrift, glm::length(narrowPosition - expected));
+            poolMismatches += narrowPosition != widePosition;
+            reportMismatches += narrowMoves[i].position != narrowPosition || wideMoves[i].position != widePosition;
+        }
+    }
+
+    // The tree must come out of the batch holding every body where it ended up
+    const glm::vec3 bound(1e4f);
+    std::vector<CollisionHandle> expectedFound(moverCount + staticCount), narrowFound(moverCount + staticCount);
+    const size_t expectedCount = sequential.system.queryAabb(-bound, bound, expectedFound);
+    const size_t narrowCount = narrow.system.queryAabb(-bound, bound, narrowFound);
+
+    std::cout << "  " << moverCount << " movers, " << staticCount << " static, seed " << seed
+              << ": max drift from sequential " << maxDrift << ", pool mismatches " << poolMismatches << std::endl;
+    check(maxDrift <= kMaxSequentialDrift, "resolveMovements follows sequential resolveMovement");
+    check(poolMismatches == 0, "resolveMovements gives the same result on 1 and many workers");
+    check(reportMismatches == 0, "BodyMove::position is where the body was left");
+    check(expectedCount == narrowCount &&
+              std::equal(expectedFound.begin(), expectedFound.begin() + expectedCount, narrowFound.begin()),
+          "queries see the moved bodies");
+}
+
+// Characters on rolling ground among static boxes, as Game::update moves the player each frame.
+// Frames that fit on the caller (one character, a handful of moves, every frame on a single-lane
+// pool) must not allocate once the scratch buffers have grown.
+void testWarmFrames() {
+    constexpr int kCharacters = 200, kBoxes = 50, kGroundRes = 65;
+    constexpr float kGroundSize = 64.0f;
+    std::vector<float> heights(static_cast<size_t>(kGroundRes) * kGroundRes);
+    for(int z = 0; z < kGroundRes; ++z) {
+        for(int x = 0; x < kGroundRes; ++x) heights[static_cast<size_t>(z) * kGroundRes + x] = std::sin(x * 0.3f) * std::cos(z * 0.2f);
+    }
+    Heightfield ground;
+    ground.assign(std::move(heights), kGroundRes, kGroundSize);
+
+    CollisionSystem system;
+    CollisionBody groundBody;
+    groundBody.shape = CollisionShape::Heightfield;
+    groundBody.heightfield = &ground;
+    groundBody.isStatic = true;
+    system.addBody(groundBody);
+    std::mt19937 rng(5u);
+    std::uniform_real_distribution<float> coord(-0.4f * kGroundSize, 0.4f * kGroundSize), angle(0.0f, 6.2831853f);
+    for(int i = 0; i < kBoxes; ++i) {
+        CollisionBody box;
+        box.shape = CollisionShape::Box;
+        box.isStatic = true;
+        box.position = glm::vec3(coord(rng), 0.5f, coord(rng));
+        box.halfExtents = glm::vec3(0.6f);
+        system.addBody(box);
+    }
+    std::vector<CharacterMove> characters(kCharacters);
+    std::vector<BodyMove> moves(kCharacters);
+    std::vector<glm::vec3> headings(kCharacters);
+    for(int i = 0; i < kCharacters; ++i) {
+        CollisionBody body;
+        body.shape = CollisionShape::Capsule;
+        body.radius = 0.3f;
+        body.height = 1.8f;
+        body.position = glm::vec3(coord(rng), 2.0f, coord(rng));
+        characters[i].body = moves[i].body = system.addBody(body);
+        const float a = angle(rng);
+        headings[i] = glm::vec3(std::cos(a), 0.0f, std::sin(a));
+    }
+    std::vector<CollisionHandle> found(kCharacters + kBoxes + 1);
+    const std::span<CharacterMove> one(characters.data(), 1);
+    const std::span<BodyMove> few(moves.data(), 20);
+
+    // Walk back and forth so the crowd stays on the ground. Each kind of frame first runs until
+    // its scratch buffers have grown to fit it: the crowd has landed and walked both ways.
+    int frame = 0;
+    auto warmFrames = [&](auto&& work) {
+        for(int f = 0; f < kWarmupFrames + kWarmFrames; ++f, ++frame) {
+            if(f == kWarmupFrames) g_allocations = 0;
+            const float sign = (frame / 10) % 2 ? -1.0f : 1.0f;
+            for(int i = 0; i < kCharacters; ++i) {
+                characters[i].velocity = glm::vec3(headings[i].x * 3.0f * sign, characters[i].velocity.y, headings[i].z * 3.0f * sign);
+                moves[i].target = positionOf(system, moves[i].body) + headings[i] * (0.05f * sign);
+            }
+            work();
+        }
+        return g_allocations.load();
+    };
+    const size_t oneAllocations = warmFrames([&] { system.moveCharacters(one, 1.0f / 60.0f); });
+    const size_t fewAllocations = warmFrames([&] {
+        for(BodyMove& move : few) move.position = move.target;
+        system.resolveMovements(few);
+    });
+    const size_t queryAllocations = warmFrames([&] {
+        const glm::vec3 from = positionOf(system, characters[0].body);
+        system.queryRadius(from, 4.0f, found);
+        system.resolveMovement(characters[0].body, from, from + headings[0]);
+    });
+    std::cout << "  " << kWarmFrames << " warm frames: allocations for one character " << oneAllocations
+              << ", " << few.size() << " moves " << fewAllocations << ", queries " << queryAllocations << std::endl;
+    check(oneAllocations == 0, "a one-character moveCharacters frame allocates nothing");
+    check(fewAllocations == 0, "a small resolveMovements batch allocates nothing");
+    check(queryAllocations == 0, "queryRadius and resolveMovement allocate nothing");
+
+    // Large batches only stay on the caller when the pool has a single lane; with more, the
+    // pool's parallelFor allocates its batch
+    const unsigned lanes = ThreadPool::shared().concurrency();
+    if(lanes == 1) {
+        const size_t crowdAllocations = warmFrames([&] { system.moveCharacters(characters, 1.0f / 60.0f); });
+        const size_t batchAllocations = warmFrames([&] { system.resolveMovements(moves); });
+        std::cout << "  single-lane pool: allocations for " << kCharacters << " characters " << crowdAllocations
+                  << ", " << kCharacters << " moves " << batchAllocations << std::endl;
+        check(crowdAllocations == 0, "a crowd moveCharacters frame allocates nothing on one lane");
+        check(batchAllocations == 0, "a crowd resolveMovements frame allocates nothing on one lane");
+    } else {
+        std::cout << "  " << lanes << " pool lanes: crowd frames run on the pool and are not counted" << std::endl;
+    }
+}
+}
+
+int main() {
+    testWarmFrames();
+    ThreadPool onePool(1), widePool(7);
+    for(uint32_t seed : {1u, 2u, 3u}) {
+        testScene(10, 4, seed, onePool, widePool);
+        testScene(200, 50, seed, onePool, widePool);
+        testScene(800, 50, seed, onePool, widePool);
+        testScene(3000, 750, seed, onePool, widePool);
+    }
+    return testResult("CollisionIslands");
+}
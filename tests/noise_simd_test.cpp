@@ -0,0 +1,103 @@
+// Every FractalNoise kernel the CPU supports must match the scalar path, which is the glm
+// reference itself. The kernels promise bit-identical results, so the tolerance is zero ulps;
+// the largest ulp and absolute differences are printed either way.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "check.h"
+#include "util/Noise.h"
+
+namespace {
+constexpr int64_t kMaxUlps = 0;
+
+// Floats mapped to integers that are consecutive for consecutive floats
+int64_t orderedBits(float f) {
+    int32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits < 0 ? static_cast<int64_t>(INT32_MIN) - bits : bits;
+}
+
+struct Difference {
+    int64_t maxUlps = 0;
+    float maxAbs = 0.0f;
+};
+
+Difference compare(const std::vector<float>& expected, const std::vector<float>& actual) {
+    Difference d;
+    for(size_t i = 0; i < expected.size(); ++i) {
+        d.maxUlps = std::max(d.maxUlps, std::abs(orderedBits(expected[i]) - orderedBits(actual[i])));
+        d.maxAbs = std::max(d.maxAbs, std::abs(expected[i] - actual[i]));
+    }
+    return d;
+}
+
+// Random coordinates across the ranges the terrain uses, plus lattice points, cell edges, signed
+// zeros and large magnitudes where floor() and the permutation wrap are easiest to get wrong
+std::vector<float> coordinates(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> wide(-5000.0f, 5000.0f), narrow(-4.0f, 4.0f);
+    std::vector<float> out;
+    const float edges[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 289.0f, -289.0f, 1e-7f, -1e-7f,
+                           std::nextafter(1.0f, 0.0f), std::nextafter(-1.0f, 0.0f), 65536.5f, -98765.25f};
+    for(float e : edges) out.push_back(e);
+    while(out.size() < count) out.push_back(out.size() % 2 ? wide(rng) : narrow(rng));
+    return out;
+}
+}
+
+int main() {
+    const FractalNoise noise(42);
+    const size_t count = 200000;
+    const std::vector<float> xs = coordinates(count, 1), zs = coordinates(count, 2);
+    constexpr int kGridSide = 181;
+    const std::vector<float> gridXs(xs.begin(), xs.begin() + kGridSide), gridZs(zs.begin(), zs.begin() + kGridSide);
+    const NoiseGrid grid{kGridSide, kGridSide};
+
+    // Outputs of one kernel level: fill, point batches, and the raw perlin / simplex batches
+    struct Outputs {
+        std::vector<float> fill, sample, perlin, simplex;
+    };
+    auto run = [&](NoiseSimdLevel level) {
+        FractalNoise::setSimdLevel(level);
+        Outputs o{std::vector<float>(static_cast<size_t>(kGridSide) * kGridSide), std::vector<float>(count),
+                  std::vector<float>(count), std::vector<float>(count)};
+        noise.fill(grid, gridXs.data(), gridZs.data(), o.fill.data());
+        noise.sample(xs.data(), zs.data(), o.sample.data(), count);
+        FractalNoise::perlin(xs.data(), zs.data(), o.perlin.data(), count);
+        FractalNoise::simplex(xs.data(), zs.data(), o.simplex.data(), count);
+        return o;
+    };
+
+    const Outputs scalar = run(NoiseSimdLevel::Scalar);
+    // The scalar fill itself against single-point samples
+    std::vector<float> points(scalar.fill.size());
+    for(int row = 0; row < kGridSide; ++row) {
+        for(int col = 0; col < kGridSide; ++col) points[static_cast<size_t>(row) * kGridSide + col] = noise.sample(gridXs[col], gridZs[row]);
+    }
+    check(compare(points, scalar.fill).maxUlps == 0, "scalar fill matches FractalNoise::sample");
+
+    const NoiseSimdLevel detected = FractalNoise::detectedSimdLevel();
+    for(NoiseSimdLevel level : {NoiseSimdLevel::SSE41, NoiseSimdLevel::AVX2}) {
+        if(static_cast<int>(level) > static_cast<int>(detected)) {
+            std::cout << "  " << FractalNoise::simdLevelName(level) << ": not supported by this CPU, skipped" << std::endl;
+            continue;
+        }
+        const Outputs simd = run(level);
+        const std::pair<const char*, Difference> results[] = {
+            {"fill", compare(scalar.fill, simd.fill)},
+            {"sample", compare(scalar.sample, simd.sample)},
+            {"perlin", compare(scalar.perlin, simd.perlin)},
+            {"simplex", compare(scalar.simplex, simd.simplex)},
+        };
+        for(const auto& [name, d] : results) {
+            std::cout << "  " << FractalNoise::simdLevelName(level) << " " << name << ": max " << d.maxUlps
+                      << " ulps, max abs " << d.maxAbs << std::endl;
+            check(d.maxUlps <= kMaxUlps, name);
+        }
+    }
+    FractalNoise::setSimdLevel(detected);
+    return testResult("NoiseSimd");
+}
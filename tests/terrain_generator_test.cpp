@@ -0,0 +1,94 @@
+// TerrainHeightGenerator must reproduce the original per-texel heightmap loop bit for bit, for
+// whole maps and for any rectangle it is asked to fill (streamed pages, parallel row tiles).
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <glm/glm.hpp>
+#include "check.h"
+#include "scene/TerrainGenerator.h"
+
+namespace {
+constexpr float kWorldSize = 200.0f;
+
+// The heightmap loop as it was before generation was batched, one noise call per term
+float baselineHeight(const FractalNoise& noise, int x, int z, int resolution, float worldScale) {
+    float u = (float)x / (resolution - 1);
+    float v = (float)z / (resolution - 1);
+    float wx = u * worldScale - worldScale / 2.0f;
+    float wz = v * worldScale - worldScale / 2.0f;
+
+    float h = 0.0f;
+    float amplitude = 0.020f;
+    float frequency = 0.28f;
+    for (int octave = 0; octave < 2; ++octave) {
+        h += noise.sample(wx * frequency, wz * frequency) * amplitude;
+        amplitude *= 0.5f;
+        frequency *= 1.5f;
+    }
+    float hills = noise.sample(wx * 0.12f, wz * 0.12f) * 0.07f;
+    h += hills;
+
+    float valleyCenter = 0.0f;
+    float valleyWidth = worldScale * 0.4f;
+    float distToValley = std::abs(wz - valleyCenter);
+    float valleyDepth = std::exp(-distToValley * distToValley / (2.0f * valleyWidth * valleyWidth)) * 0.06f;
+    float erosion = noise.sample(wx * 0.5f, wz * 0.2f) * 0.008f;
+    h -= (valleyDepth + erosion);
+
+    float plateauEdge = glm::smoothstep(-worldScale * 0.5f, worldScale * 0.1f, wx);
+    float plateauNoise = noise.sample(wx * 0.6f, wz * 0.6f) * 0.012f;
+    float sideElevation = (plateauEdge + plateauNoise) * 0.20f;
+    h += sideElevation;
+
+    float hill1 = std::exp(-((wx + worldScale * 0.3f)*(wx + worldScale * 0.3f) + wz*wz) /
+        (2.0f * (worldScale * 0.25f)*(worldScale * 0.25f))) * 0.10f;
+    float hill2 = std::exp(-((wx - worldScale * 0.25f)*(wx - worldScale * 0.25f) + (wz + worldScale * 0.2f)*(wz + worldScale * 0.2f)) /
+        (2.0f * (worldScale * 0.30f)*(worldScale * 0.30f))) * 0.08f;
+    h += hill1 + hill2;
+
+    float detail = noise.sample(wx * 2.0f, wz * 2.0f) * 0.006f;
+    h += detail;
+
+    float patchMask = noise.sample(wx * 0.07f, wz * 0.07f) * 0.5f + 0.5f;
+    h += patchMask * 0.02f;
+
+    return std::max(0.0f, std::min(1.0f, h));
+}
+
+// Compares a filled rectangle with the baseline; returns the number of texels that differ
+int countMismatches(const TerrainHeightGenerator& generator, int x0, int z0, int width, int height) {
+    const FractalNoise noise(42);
+    std::vector<float> filled(static_cast<size_t>(width) * height);
+    generator.fill(x0, z0, width, height, filled.data(), width);
+    int mismatches = 0;
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            const float expected = baselineHeight(noise, x0 + col, z0 + row, generator.resolution(), generator.worldSize());
+            const float actual = filled[static_cast<size_t>(row) * width + col];
+            if (std::memcmp(&expected, &actual, sizeof(float)) != 0) ++mismatches;
+        }
+    }
+    return mismatches;
+}
+}
+
+int main() {
+    for (int resolution : {129, 257}) {
+        const TerrainHeightGenerator generator(resolution, kWorldSize);
+        const int mismatches = countMismatches(generator, 0, 0, resolution, resolution);
+        std::cout << "  " << resolution << "x" << resolution << " whole map: " << mismatches << " texels differ" << std::endl;
+        check(mismatches == 0, "whole map matches the baseline loop");
+    }
+
+    // Odd rectangles of a large map, as streamed pages and row tiles ask for them
+    const TerrainHeightGenerator large(1025, kWorldSize);
+    const int rects[][4] = {{0, 0, 37, 5}, {1000, 3, 25, 9}, {511, 511, 64, 64}, {7, 1020, 1018, 5}};
+    for (const auto& r : rects) {
+        const int mismatches = countMismatches(large, r[0], r[1], r[2], r[3]);
+        std::cout << "  1025 rect (" << r[0] << ", " << r[1] << ") " << r[2] << "x" << r[3] << ": "
+                  << mismatches << " texels differ" << std::endl;
+        check(mismatches == 0, "rectangle matches the baseline loop");
+    }
+    return testResult("TerrainGenerator");
+}
@@ -0,0 +1,212 @@
+// TerrainRaycaster against a brute-force march along each ray over the bilinear surface of
+// TerrainSampler::height: raycast() and segmentBlocked() must find the crossing the march finds,
+// raycastBatch() must match raycast() bit for bit, and MonsterAI::detectsPlayer must lose sight
+// of a player behind a ridge.
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "check.h"
+#include "scene/TerrainRaycast.h"
+#include "scene/TerrainSampler.h"
+#include "systems/MonsterAI.h"
+
+namespace {
+constexpr int kResolution = 129;
+constexpr float kWorldSize = 256.0f;
+constexpr float kHeightScale = 40.0f;
+constexpr float kMarchStep = 0.02f;   // world units between brute-force samples
+constexpr float kDistanceTolerance = 2.0f * kMarchStep;
+// A ray that only skims the surface between two march samples (or dips under it by less than
+// this) is a graze: either answer is right
+constexpr float kGrazeDepth = 1e-2f;  // world units
+
+// Rolling hills plus a ridge along z at x = 0, normalized to [0, 1]
+std::shared_ptr<const TerrainSampler> hills() {
+    std::vector<float> heights(static_cast<size_t>(kResolution) * kResolution);
+    for(int z = 0; z < kResolution; ++z) {
+        for(int x = 0; x < kResolution; ++x) {
+            const float wx = (x / float(kResolution - 1) - 0.5f) * kWorldSize;
+            const float wz = (z / float(kResolution - 1) - 0.5f) * kWorldSize;
+            const float rolling = 0.05f * (std::sin(wx * 0.11f) * std::cos(wz * 0.07f) + 1.0f);
+            const float ridge = 0.8f * std::exp(-wx * wx / 18.0f);
+            heights[static_cast<size_t>(z) * kResolution + x] = std::min(rolling + ridge, 1.0f);
+        }
+    }
+    return std::make_shared<const TerrainSampler>(std::move(heights), kResolution, kWorldSize, kHeightScale);
+}
+
+// Height of the ray above the surface at t; rays off the map are never under it
+float clearance(const TerrainSampler& s, const TerrainRay& ray, float t) {
+    const glm::vec3 p = ray.origin + ray.direction * t;
+    const float half = 0.5f * kWorldSize;
+    if(std::abs(p.x) > half || std::abs(p.z) > half) return 1e30f;
+    return p.y - s.height(p.x, p.z);
+}
+
+struct March {
+    bool hit = false;
+    float distance = 0.0f;
+    float depth = 0.0f;  // how far the first sample under the surface is below it
+};
+
+// First sample at or under the surface, refined by bisection against the one before it
+March march(const TerrainSampler& s, const TerrainRay& ray) {
+    March result;
+    const float length = glm::length(ray.direction);
+    const int steps = length > 0.0f ? static_cast<int>(std::ceil(ray.maxDistance * length / kMarchStep)) : 0;
+    float previous = 0.0f;
+    for(int i = 0; i <= steps; ++i) {
+        const float t = steps ? ray.maxDistance * i / steps : 0.0f;
+        const float c = clearance(s, ray, t);
+        if(c > 0.0f) {
+            previous = t;
+            continue;
+        }
+        result.hit = true;
+        result.depth = -c;
+        if(i == 0) return result;
+        float lo = previous, hi = t;
+        for(int k = 0; k < 40; ++k) {
+            const float mid = 0.5f * (lo + hi);
+            (clearance(s, ray, mid) > 0.0f ? lo : hi) = mid;
+        }
+        result.distance = hi;
+        return result;
+    }
+    return result;
+}
+
+struct Agreement {
+    size_t rays = 0, hits = 0, grazes = 0, failures = 0;
+};
+
+void compare(const TerrainSampler& s, const TerrainRay& ray, bool castHit, float castDistance, Agreement& out) {
+    const March truth = march(s, ray);
+    ++out.rays;
+    out.hits += truth.hit;
+    if(truth.hit == castHit && (!castHit || std::abs(truth.distance - castDistance) * glm::length(ray.direction) <= kDistanceTolerance)) {
+        return;
+    }
+    // The cast found an earlier touch the march stepped over, or the march dipped under by a hair
+    const bool castEarlier = castHit && (!truth.hit || castDistance < truth.distance);
+    const bool grazed = castEarlier ? std::abs(clearance(s, ray, castDistance)) <= kGrazeDepth : truth.depth <= kGrazeDepth;
+    if(grazed) {
+        ++out.grazes;
+    } else if(++out.failures <= 5) {
+        std::cout << "  mismatch: origin (" << ray.origin.x << ", " << ray.origin.y << ", " << ray.origin.z << ") dir ("
+                  << ray.direction.x << ", " << ray.direction.y << ", " << ray.direction.z << ") max " << ray.maxDistance
+                  << ": cast " << castHit << " at " << castDistance << ", march " << truth.hit << " at " << truth.distance << std::endl;
+    }
+}
+
+// Rays from above the surface, on and off the map, pointing anywhere (straight down and level
+// included), and a few starting under the surface
+std::vector<TerrainRay> randomRays(const TerrainSampler& s, size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(-0.6f * kWorldSize, 0.6f * kWorldSize), unit(-1.0f, 1.0f), lift(-2.0f, 30.0f),
+        length(5.0f, 200.0f);
+    std::vector<TerrainRay> rays(count);
+    for(size_t i = 0; i < count; ++i) {
+        TerrainRay& ray = rays[i];
+        ray.origin = glm::vec3(coord(rng), 0.0f, coord(rng));
+        ray.origin.y = s.height(ray.origin.x, ray.origin.z) + lift(rng);
+        switch(i % 8) {
+            case 0: ray.direction = glm::vec3(0.0f, -1.0f, 0.0f); break;
+            case 1: ray.direction = glm::normalize(glm::vec3(unit(rng), 0.0f, unit(rng))); break;
+            default: ray.direction = glm::normalize(glm::vec3(unit(rng), unit(rng) - 0.3f, unit(rng))); break;
+        }
+        ray.maxDistance = length(rng);
+    }
+    return rays;
+}
+
+void report(const char* label, const Agreement& a) {
+    std::cout << "  " << label << ": " << a.rays << " rays, " << a.hits << " hits, " << a.grazes << " grazes, "
+              << a.failures << " failures" << std::endl;
+}
+
+void testRaycast(const TerrainRaycaster& caster) {
+    const TerrainSampler& s = *caster.sampler();
+    const std::vector<TerrainRay> rays = randomRays(s, 4000, 3u);
+    Agreement agreement;
+    for(const TerrainRay& ray : rays) {
+        TerrainRayHit hit;
+        caster.raycast(ray, hit);
+        compare(s, ray, hit.hit, hit.distance, agreement);
+    }
+    report("raycast", agreement);
+    check(agreement.failures == 0, "raycast() finds the first crossing of the surface");
+    check(agreement.grazes * 100 <= agreement.rays, "raycast() disagrees with the march on grazes only");
+}
+
+void testSegments(const TerrainRaycaster& caster) {
+    const TerrainSampler& s = *caster.sampler();
+    // Eye-height pairs across the map, many of them across the ridge
+    std::mt19937 rng(5u);
+    std::uniform_real_distribution<float> coord(-0.45f * kWorldSize, 0.45f * kWorldSize), eye(0.5f, 20.0f);
+    Agreement agreement;
+    for(int i = 0; i < 4000; ++i) {
+        glm::vec3 a(coord(rng), 0.0f, coord(rng)), b(coord(rng), 0.0f, coord(rng));
+        a.y = s.height(a.x, a.z) + eye(rng);
+        b.y = s.height(b.x, b.z) + eye(rng);
+        const bool blocked = caster.segmentBlocked(a, b);
+        TerrainRay ray;
+        ray.origin = a;
+        ray.direction = b - a;
+        ray.maxDistance = 1.0f;
+        TerrainRayHit hit;
+        caster.raycast(ray, hit);
+        compare(s, ray, blocked, hit.distance, agreement);
+    }
+    report("segmentBlocked", agreement);
+    check(agreement.failures == 0, "segmentBlocked() matches the march along the segment");
+    check(agreement.grazes * 100 <= agreement.rays, "segmentBlocked() disagrees with the march on grazes only");
+}
+
+void testBatch(const TerrainRaycaster& caster) {
+    // Large enough to be spread over the pool, with an uneven tail
+    const std::vector<TerrainRay> rays = randomRays(*caster.sampler(), 20011, 9u);
+    std::vector<TerrainRayHit> batch(rays.size());
+    caster.raycastBatch(rays, batch);
+    size_t mismatches = 0;
+    for(size_t i = 0; i < rays.size(); ++i) {
+        TerrainRayHit single;
+        caster.raycast(rays[i], single);
+        mismatches += single.hit != batch[i].hit || single.distance != batch[i].distance ||
+                      single.position != batch[i].position || single.normal != batch[i].normal;
+    }
+    // A short hit span limits the batch
+    std::vector<TerrainRayHit> few(3);
+    caster.raycastBatch(rays, few);
+    for(size_t i = 0; i < few.size(); ++i) mismatches += few[i].hit != batch[i].hit || few[i].distance != batch[i].distance;
+    std::cout << "  raycastBatch: " << rays.size() << " rays, " << mismatches << " mismatches against raycast()" << std::endl;
+    check(mismatches == 0, "raycastBatch() matches raycast() exactly");
+}
+
+void testLineOfSight(const TerrainRaycaster& caster) {
+    const TerrainSampler& s = *caster.sampler();
+    auto ground = [&](float x, float z) { return glm::vec3(x, s.height(x, z), z); };
+    auto lineBlocked = [&](const glm::vec3& a, const glm::vec3& b) { return caster.segmentBlocked(a, b); };
+    MonsterAI monster;
+    monster.setPatrolPath({{ground(-20.0f, 10.0f)}});
+    const glm::vec3 acrossRidge = ground(20.0f, 10.0f), sameSide = ground(-30.0f, 16.0f), farAway = ground(-90.0f, 10.0f);
+    check(monster.detectsPlayer(acrossRidge, 50.0f), "without a line test the ridge does not hide the player");
+    check(!monster.detectsPlayer(acrossRidge, 50.0f, lineBlocked), "the ridge hides the player");
+    check(monster.detectsPlayer(sameSide, 50.0f, lineBlocked), "a player on the same side is seen");
+    check(!monster.detectsPlayer(farAway, 50.0f, lineBlocked), "a player out of range is not seen");
+    check(monster.detectsPlayer(sameSide, 50.0f, nullptr), "an empty line test only checks the range");
+}
+}
+
+int main() {
+    const TerrainRaycaster caster(hills());
+    testRaycast(caster);
+    testSegments(caster);
+    testBatch(caster);
+    testLineOfSight(caster);
+    return testResult("TerrainRaycast");
+}
@@ -0,0 +1,193 @@
+// WaveSampler must reproduce the water vertex shader (kWaterVertex in core/Game.cpp): the test
+// evaluates that formula independently in double precision, with GL_LINEAR filtering of half
+// float textures (repeat for the wave layers and the FFT ocean tile, clamp for the shore field
+// at shoreFieldUV), and compares displacement() against it. heights() must match height() bit for bit: with SSE2 the
+// batch runs four points at a time for power-of-two layers, otherwise it is the scalar loop.
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <glm/gtc/packing.hpp>
+#include "check.h"
+#include "scene/OceanSpectrum.h"
+#include "scene/ShoreDistanceField.h"
+#include "scene/TerrainSampler.h"
+#include "scene/WaveSampler.h"
+
+namespace {
+// Float vs double evaluation of the same texels; the layers are white noise, the worst case
+constexpr double kMaxReferenceError = 1e-3;  // world units
+constexpr float kWaterLevel = 10.0f;
+constexpr float kExtent = 384.0f;
+constexpr float kWorldSize = 256.0f;
+constexpr int kShoreRes = 65;
+constexpr float kOceanPatch = 64.0f;
+
+double half(float v) {
+    return glm::unpackHalf1x16(glm::packHalf1x16(v));
+}
+
+// texture() with GL_LINEAR at (u, v): texel centers at (i + 0.5) / n
+double sampleLinear(const std::vector<double>& texels, int n, double u, double v, bool repeat) {
+    double tx = u * n - 0.5, tz = v * n - 0.5;
+    if(!repeat) {
+        tx = std::clamp(tx, 0.0, n - 1.0);
+        tz = std::clamp(tz, 0.0, n - 1.0);
+    }
+    const double x0 = std::floor(tx), z0 = std::floor(tz);
+    const double fx = tx - x0, fz = tz - z0;
+    auto texel = [&](double x, double z) {
+        int ix = static_cast<int>(x), iz = static_cast<int>(z);
+        if(repeat) {
+            ix = ((ix % n) + n) % n;
+            iz = ((iz % n) + n) % n;
+        } else {
+            ix = std::min(ix, n - 1);
+            iz = std::min(iz, n - 1);
+        }
+        return texels[static_cast<size_t>(iz) * n + ix];
+    };
+    const double top = texel(x0, z0) + (texel(x0 + 1, z0) - texel(x0, z0)) * fx;
+    const double bottom = texel(x0, z0 + 1) + (texel(x0 + 1, z0 + 1) - texel(x0, z0 + 1)) * fx;
+    return top + (bottom - top) * fz;
+}
+
+double smoothstep(double e0, double e1, double x) {
+    const double t = std::clamp((x - e0) / (e1 - e0), 0.0, 1.0);
+    return t * t * (3.0 - 2.0 * t);
+}
+
+// The shader's inputs, as the GPU sees them after the half float upload
+struct Reference {
+    std::vector<double> wave0, wave1, shore, ocean;
+    int size = 0;
+    int oceanSize = 0;
+    WaveSettings s;
+
+    // kWaterVertex: aUV = xz / uWaterExtent + 0.5, then the layer blend and the shore scale
+    double displacement(float x, float z, float time) const {
+        const double u = x / static_cast<double>(kExtent) + 0.5, v = z / static_cast<double>(kExtent) + 0.5;
+        const double h0 = sampleLinear(wave0, size, u * s.layer0Tiling + s.layer0Speed.x * double(time),
+                                       v * s.layer0Tiling + s.layer0Speed.y * double(time), true) * s.layer0Strength;
+        const double h1 = sampleLinear(wave1, size, u * s.layer1Tiling + s.layer1Speed.x * double(time),
+                                       v * s.layer1Tiling + s.layer1Speed.y * double(time), true) * s.layer1Strength;
+        const double blend = smoothstep(0.0, 1.0, (h0 - h1) * s.blendSharpness * 0.5 + 0.5);
+        double height = (h0 + (h1 - h0) * blend) * s.gain;
+        double shoreScale = 1.0;
+        if(!shore.empty()) {
+            // shoreFieldUV(): the lattice-aligned field spans the first to last texel centers
+            const double n = kShoreRes;
+            const double su = (x / double(kWorldSize) + 0.5) * (n - 1.0) / n + 0.5 / n;
+            const double sv = (z / double(kWorldSize) + 0.5) * (n - 1.0) / n + 0.5 / n;
+            const double dist = sampleLinear(shore, kShoreRes, su, sv, false);
+            shoreScale = s.shoreMinScale + (1.0 - s.shoreMinScale) * smoothstep(0.0, s.shoreFade, dist);
+            height *= shoreScale;
+        }
+        if(!ocean.empty()) {
+            // pos += textureLod(uOceanDisplacement, aPos.xz / uOceanPatchSize).xyz * (uOceanStrength * shoreScale)
+            const double detail = sampleLinear(ocean, oceanSize, x / double(kOceanPatch), z / double(kOceanPatch), true);
+            height += detail * s.oceanStrength * shoreScale;
+        }
+        return height;
+    }
+};
+
+std::vector<float> whiteNoise(int size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    std::vector<float> texels(static_cast<size_t>(size) * size);
+    for(float& t : texels) t = value(rng);
+    return texels;
+}
+
+// A ramp rising along x, so the shoreline crosses the middle of the map
+std::shared_ptr<const ShoreDistanceField> rampShore() {
+    std::vector<float> heights(static_cast<size_t>(kShoreRes) * kShoreRes);
+    for(int z = 0; z < kShoreRes; ++z) {
+        for(int x = 0; x < kShoreRes; ++x) heights[static_cast<size_t>(z) * kShoreRes + x] = x / float(kShoreRes - 1);
+    }
+    auto terrain = std::make_shared<const TerrainSampler>(std::move(heights), kShoreRes, kWorldSize, 2.0f * kWaterLevel);
+    return std::make_shared<const ShoreDistanceField>(terrain, kWaterLevel);
+}
+
+// One evaluated FFT tile, as Ocean hands it to the sampler after an upload
+std::shared_ptr<const OceanFrame> oceanTile() {
+    OceanSettings settings;
+    settings.resolution = 64;
+    settings.patchSize = kOceanPatch;
+    OceanSpectrum spectrum(settings);
+    auto frame = std::make_shared<OceanFrame>();
+    spectrum.evaluate(3.5f, *frame);
+    return frame;
+}
+
+void testSampler(const char* label, int size, bool withShore, bool withOcean) {
+    const std::vector<float> layer0 = whiteNoise(size, 11u + size), layer1 = whiteNoise(size, 23u + size);
+    WaveSettings settings;
+    settings.oceanStrength = 0.8f;
+    const std::shared_ptr<const ShoreDistanceField> shore = withShore ? rampShore() : nullptr;
+    const std::shared_ptr<const OceanFrame> ocean = withOcean ? oceanTile() : nullptr;
+    std::shared_ptr<const WaveSampler> sampler =
+        WaveSampler(layer0, layer1, size, settings, kWaterLevel, kExtent).withShore(shore)->withOcean(ocean, kOceanPatch);
+
+    Reference ref;
+    ref.size = size;
+    ref.s = settings;
+    for(float t : layer0) ref.wave0.push_back(half(t));
+    for(float t : layer1) ref.wave1.push_back(half(t));
+    if(shore) {
+        const std::vector<float>& texels = shore->texels();
+        for(size_t i = 0; i < texels.size(); i += 2) ref.shore.push_back(half(texels[i]));
+    }
+    if(ocean) {
+        // Height is the second half of each (x offset, height, z offset, Jacobian) texel
+        ref.oceanSize = ocean->size;
+        for(uint64_t bits : ocean->displacement) ref.ocean.push_back(glm::unpackHalf1x16(static_cast<uint16_t>(bits >> 16)));
+    }
+
+    // Random points on and past the water extent, plus the shoreline and the map corners
+    std::mt19937 rng(7u + size);
+    std::uniform_real_distribution<float> coord(-0.75f * kExtent, 0.75f * kExtent);
+    std::vector<float> xs, zs;
+    for(int i = 0; i < 4000; ++i) {
+        xs.push_back(coord(rng));
+        zs.push_back(coord(rng));
+    }
+    for(float c : {-kWorldSize * 0.5f, 0.0f, kWorldSize * 0.5f}) {
+        for(float d : {-kWorldSize * 0.5f, -1.0f, 0.0f, 1.0f, kWorldSize * 0.5f}) {
+            xs.push_back(d);
+            zs.push_back(c);
+        }
+    }
+    xs.push_back(0.0f);  // odd count: the batch has a scalar tail
+    zs.push_back(0.0f);
+
+    double maxError = 0.0;
+    size_t batchMismatches = 0;
+    std::vector<float> batch(xs.size());
+    for(float time : {0.0f, 1.7f, 93.25f, 1800.0f}) {
+        for(size_t i = 0; i < xs.size(); ++i) {
+            maxError = std::max(maxError, std::abs(sampler->displacement(xs[i], zs[i], time) - ref.displacement(xs[i], zs[i], time)));
+        }
+        sampler->heights(xs.data(), zs.data(), time, batch.data(), batch.size());
+        for(size_t i = 0; i < xs.size(); ++i) {
+            if(batch[i] != sampler->height(xs[i], zs[i], time)) ++batchMismatches;
+        }
+    }
+    std::cout << "  " << label << ": max |displacement - shader formula| " << maxError
+              << ", heights() vs height() mismatches " << batchMismatches << std::endl;
+    check(maxError <= kMaxReferenceError, "displacement() follows the water vertex shader");
+    check(batchMismatches == 0, "heights() matches height() exactly");
+}
+}
+
+int main() {
+    testSampler("64^2 layers, no shore", 64, false, false);
+    testSampler("64^2 layers, shore field", 64, true, false);
+    testSampler("64^2 layers, shore field, ocean tile", 64, true, true);
+    // Not a power of two: heights() takes the scalar loop
+    testSampler("48^2 layers, shore field, ocean tile", 48, true, true);
+    return testResult("WaveSampler");
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+
+// Best wall time of `repeats` runs of fn, in milliseconds. The best run is the one least
+// disturbed by the rest of the machine, which is what comparisons between runs want.
+template <typename Fn>
+double bestMs(int repeats, Fn&& fn) {
+    double best = 1e300;
+    for(int i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
@@ -0,0 +1,253 @@
+// CollisionSystem broadphase against the linear scan it replaced. Bodies (spheres, capsules and
+// boxes) are scattered at a fixed density, so a query touches about the same number of bodies
+// at every scene size. The scan tests every body with the same exact shape tests, and its
+// answers are checked against the tree's; its resolveMovement is the original one-pass
+// push-out over all bodies, the per-move cost the tree removed. A second table times a frame of
+// moves for a crowd, resolveMovement one body at a time against resolveMovements' islands.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "bench.h"
+#include "systems/CollisionGeometry.h"
+#include "systems/CollisionSystem.h"
+#include "util/ThreadPool.h"
+
+namespace {
+constexpr float kAreaPerBody = 16.0f;  // square world units
+constexpr int kQueries = 1000;
+constexpr float kQueryRadius = 3.0f;
+constexpr float kRayLength = 20.0f;
+constexpr float kMoveLength = 1.5f;
+constexpr float kCrowdStep = 0.05f;  // one frame of walking
+volatile float g_sink;  // keeps the timed results alive
+
+// Same core segment as CollisionSystem: from the base up, radius in from either end
+void coreSegment(const CollisionBody& body, glm::vec3& a, glm::vec3& b) {
+    a = b = body.position;
+    if(body.shape != CollisionShape::Capsule) return;
+    a.y += body.radius;
+    b.y += std::max(body.height - body.radius, body.radius);
+}
+
+// Every body in a flat array, tested one by one
+struct LinearScan {
+    std::vector<CollisionBody> bodies;
+
+    size_t queryRadius(const glm::vec3& center, float radius) const {
+        size_t count = 0;
+        for(const CollisionBody& body : bodies) {
+            glm::vec3 closest;
+            float reach = radius;
+            if(body.shape == CollisionShape::Box) {
+                closest = closestPointOnAabb(center, Aabb::around(body.position, body.halfExtents));
+            } else {
+                glm::vec3 a, b;
+                coreSegment(body, a, b);
+                closest = closestPointOnSegment(center, a, b);
+                reach += body.radius;
+            }
+            const glm::vec3 d = center - closest;
+            count += glm::dot(d, d) <= reach * reach;
+        }
+        return count;
+    }
+
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDistance, float& distance) const {
+        bool hit = false;
+        distance = maxDistance;
+        for(const CollisionBody& body : bodies) {
+            float t = 0.0f;
+            bool touched;
+            if(body.shape == CollisionShape::Box) {
+                touched = rayCastAabb(origin, dir, distance, Aabb::around(body.position, body.halfExtents), t);
+            } else {
+                glm::vec3 a, b;
+                coreSegment(body, a, b);
+                touched = a == b ? rayCastSphere(origin, dir, distance, a, body.radius, t)
+                                 : rayCastCapsule(origin, dir, distance, a, b, body.radius, t);
+            }
+            if(touched && t <= distance) {
+                distance = t;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    // The original resolveMovement: push the target out of every overlapping body in one pass
+    glm::vec3 resolveMovement(size_t index, const glm::vec3& from, const glm::vec3& to) const {
+        const glm::vec3 movement = to - from;
+        if(glm::length(movement) < 1e-6f) return to;
+        glm::vec3 resolved = to;
+        for(size_t i = 0; i < bodies.size(); ++i) {
+            if(i == index) continue;
+            const float combined = bodies[index].radius + bodies[i].radius;
+            const glm::vec3 toOther = bodies[i].position - resolved;
+            const float dist = glm::length(toOther);
+            if(dist < combined && dist > 1e-6f) {
+                const glm::vec3 push = toOther / dist;
+                resolved -= push * (combined - dist + 0.01f);
+                if(!bodies[i].isStatic) resolved = movement + push * glm::dot(movement, -push);
+            }
+        }
+        return resolved;
+    }
+};
+
+std::vector<CollisionBody> scatter(int count, float half, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(-half, half), size(0.3f, 0.9f);
+    std::vector<CollisionBody> bodies(count);
+    for(int i = 0; i < count; ++i) {
+        CollisionBody& body = bodies[i];
+        const int kind = i % 3;
+        body.shape = kind == 0 ? CollisionShape::Sphere : kind == 1 ? CollisionShape::Capsule : CollisionShape::Box;
+        body.position = glm::vec3(coord(rng), 0.0f, coord(rng));
+        body.radius = size(rng);
+        body.height = 1.8f;
+        body.halfExtents = glm::vec3(size(rng), size(rng), size(rng));
+        body.isStatic = kind == 2;
+    }
+    return bodies;
+}
+
+// Every dynamic body takes one step of kCrowdStep per frame, turning back every other frame so
+// the crowd stays where it was scattered
+void crowdFrames(int count) {
+    const float half = 0.5f * std::sqrt(count * kAreaPerBody);
+    const std::vector<CollisionBody> bodies = scatter(count, half, 4321u + count);
+    CollisionSystem serial, batch;
+    std::vector<CollisionHandle> movers;
+    std::vector<BodyMove> moves;
+    std::vector<glm::vec3> dirs;
+    std::mt19937 rng(77u + count);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    for(const CollisionBody& body : bodies) {
+        const CollisionHandle handle = serial.addBody(body);
+        const CollisionHandle batchHandle = batch.addBody(body);
+        if(body.isStatic) continue;
+        movers.push_back(handle);
+        moves.push_back({batchHandle, body.position, body.position});
+        const float a = angle(rng);
+        dirs.push_back(glm::vec3(std::cos(a), 0.0f, std::sin(a)) * kCrowdStep);
+    }
+
+    int serialFrame = 0, batchFrame = 0;
+    float drift = 0.0f;
+    const double serialMs = bestMs(6, [&] {
+        const float sign = serialFrame++ % 2 ? -1.0f : 1.0f;
+        for(size_t i = 0; i < movers.size(); ++i) {
+            CollisionBody body;
+            serial.getBody(movers[i], body);
+            serial.updateBodyPosition(movers[i], serial.resolveMovement(movers[i], body.position, body.position + dirs[i] * sign));
+        }
+    });
+    const double batchMs = bestMs(6, [&] {
+        const float sign = batchFrame++ % 2 ? -1.0f : 1.0f;
+        for(size_t i = 0; i < moves.size(); ++i) moves[i].target = moves[i].position + dirs[i] * sign;
+        batch.resolveMovements(moves);
+    });
+    for(size_t i = 0; i < movers.size(); ++i) {
+        CollisionBody body;
+        serial.getBody(movers[i], body);
+        drift = std::max(drift, glm::length(body.position - moves[i].position));
+    }
+    std::printf("%7zu  %13.3f  %17.3f  %g\n", movers.size(), serialMs, batchMs, drift);
+}
+}
+
+int main() {
+    std::printf("[CollisionBench] %d queries per row; times per query in microseconds\n", kQueries);
+    std::printf("%7s  %-22s %-24s %-22s %-28s %s\n", "bodies", "build ms (tree/scan)", "queryRadius (tree/scan)",
+                "raycast (tree/scan)", "resolveMovement (tree/scan)", "mismatches");
+    for(int count : {10, 100, 1000, 10000, 100000}) {
+        const float half = 0.5f * std::sqrt(count * kAreaPerBody);
+        const std::vector<CollisionBody> bodies = scatter(count, half, 1234u + count);
+        const int repeats = count >= 10000 ? 1 : 5;
+
+        CollisionSystem tree;
+        std::vector<CollisionHandle> handles;
+        const double treeBuild = bestMs(repeats, [&] {
+            tree.clear();
+            handles.clear();
+            for(const CollisionBody& body : bodies) handles.push_back(tree.addBody(body));
+        });
+        LinearScan scan;
+        const double scanBuild = bestMs(repeats, [&] {
+            scan.bodies.clear();
+            for(const CollisionBody& body : bodies) scan.bodies.push_back(body);
+        });
+
+        std::mt19937 rng(99u + count);
+        std::uniform_real_distribution<float> coord(-half, half), angle(0.0f, 6.2831853f);
+        std::vector<glm::vec3> points(kQueries), dirs(kQueries);
+        for(int q = 0; q < kQueries; ++q) {
+            points[q] = glm::vec3(coord(rng), 1.0f, coord(rng));
+            const float a = angle(rng);
+            dirs[q] = glm::vec3(std::cos(a), 0.0f, std::sin(a));
+        }
+
+        size_t mismatches = 0;
+        std::vector<CollisionHandle> found(count);
+        for(int q = 0; q < kQueries; ++q) {
+            mismatches += tree.queryRadius(points[q], kQueryRadius, found) != scan.queryRadius(points[q], kQueryRadius);
+            CollisionHit hit;
+            float distance = 0.0f;
+            const bool treeHit = tree.raycast(points[q], dirs[q], kRayLength, hit);
+            const bool scanHit = scan.raycast(points[q], dirs[q], kRayLength, distance);
+            // Boxes go through rayCastRoundedAabb in the tree and rayCastAabb here: equal up to rounding
+            mismatches += treeHit != scanHit || (treeHit && std::abs(hit.distance - distance) > 1e-3f);
+        }
+
+        size_t sink = 0;
+        const double treeRadius = bestMs(repeats, [&] {
+            for(int q = 0; q < kQueries; ++q) sink += tree.queryRadius(points[q], kQueryRadius, found);
+        });
+        const double scanRadius = bestMs(repeats, [&] {
+            for(int q = 0; q < kQueries; ++q) sink += scan.queryRadius(points[q], kQueryRadius);
+        });
+        const double treeRay = bestMs(repeats, [&] {
+            CollisionHit hit;
+            for(int q = 0; q < kQueries; ++q) sink += tree.raycast(points[q], dirs[q], kRayLength, hit);
+        });
+        const double scanRay = bestMs(repeats, [&] {
+            float distance;
+            for(int q = 0; q < kQueries; ++q) sink += scan.raycast(points[q], dirs[q], kRayLength, distance);
+        });
+
+        // Movers are the dynamic bodies; neither resolveMovement changes any state
+        std::vector<size_t> movers;
+        for(size_t i = 0; i < bodies.size(); ++i) {
+            if(!bodies[i].isStatic) movers.push_back(i);
+        }
+        float checksum = 0.0f;
+        const double treeMove = bestMs(repeats, [&] {
+            for(int q = 0; q < kQueries; ++q) {
+                const size_t i = movers[q % movers.size()];
+                const glm::vec3 from = bodies[i].position;
+                checksum += tree.resolveMovement(handles[i], from, from + dirs[q] * kMoveLength).x;
+            }
+        });
+        const double scanMove = bestMs(repeats, [&] {
+            for(int q = 0; q < kQueries; ++q) {
+                const size_t i = movers[q % movers.size()];
+                const glm::vec3 from = bodies[i].position;
+                checksum += scan.resolveMovement(i, from, from + dirs[q] * kMoveLength).x;
+            }
+        });
+
+        const double perQuery = 1000.0 / kQueries;  // ms per batch -> us per query
+        std::printf("%7d  %8.2f / %-11.2f %8.2f / %-13.2f %8.2f / %-11.2f %8.2f / %-17.2f %zu\n", count,
+                    treeBuild, scanBuild, treeRadius * perQuery, scanRadius * perQuery, treeRay * perQuery,
+                    scanRay * perQuery, treeMove * perQuery, scanMove * perQuery, mismatches);
+        g_sink = static_cast<float>(sink) + checksum;
+    }
+
+    std::printf("\n[CollisionBench] one frame of crowd moves in milliseconds, %u pool lane(s)\n",
+                ThreadPool::shared().concurrency());
+    std::printf("%7s  %13s  %17s  %s\n", "movers", "resolveMovement", "resolveMovements", "max drift");
+    for(int count : {750, 3000, 12000}) crowdFrames(count);
+    return 0;
+}
@@ -0,0 +1,41 @@
+// FractalNoise throughput at every kernel level the CPU supports: separable grid fills (the
+// terrain's access pattern), point batches and the raw perlin / simplex primitives.
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "bench.h"
+#include "util/Noise.h"
+
+int main() {
+    const FractalNoise noise(42);
+    constexpr int kSide = 1024;
+    constexpr size_t kCount = static_cast<size_t>(kSide) * kSide;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-500.0f, 500.0f);
+    std::vector<float> xs(kCount), zs(kCount), out(kCount);
+    for(size_t i = 0; i < kCount; ++i) {
+        xs[i] = coord(rng);
+        zs[i] = coord(rng);
+    }
+    const NoiseGrid grid{kSide, kSide};
+
+    const NoiseSimdLevel detected = FractalNoise::detectedSimdLevel();
+    std::printf("[NoiseBench] %d samples per pass, Msamples/s (higher is better)\n", static_cast<int>(kCount));
+    std::printf("%-8s %10s %10s %10s %10s\n", "level", "fill", "sample", "perlin", "simplex");
+    for(NoiseSimdLevel level : {NoiseSimdLevel::Scalar, NoiseSimdLevel::SSE41, NoiseSimdLevel::AVX2}) {
+        if(static_cast<int>(level) > static_cast<int>(detected)) {
+            std::printf("%-8s not supported by this CPU\n", FractalNoise::simdLevelName(level));
+            continue;
+        }
+        FractalNoise::setSimdLevel(level);
+        auto rate = [&](double ms) { return static_cast<double>(kCount) / (ms * 1e3); };
+        const double fill = bestMs(3, [&] { noise.fill(grid, xs.data(), zs.data(), out.data()); });
+        const double sample = bestMs(3, [&] { noise.sample(xs.data(), zs.data(), out.data(), kCount); });
+        const double perlin = bestMs(3, [&] { FractalNoise::perlin(xs.data(), zs.data(), out.data(), kCount); });
+        const double simplex = bestMs(3, [&] { FractalNoise::simplex(xs.data(), zs.data(), out.data(), kCount); });
+        std::printf("%-8s %10.1f %10.1f %10.1f %10.1f\n", FractalNoise::simdLevelName(level),
+                    rate(fill), rate(sample), rate(perlin), rate(simplex));
+    }
+    FractalNoise::setSimdLevel(detected);
+    return 0;
+}
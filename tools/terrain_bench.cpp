@@ -0,0 +1,32 @@
+// Heightmap generation time at the terrain sizes the game uses, on one thread and spread over
+// the shared pool in row tiles the way Terrain::generateHeightMap does it.
+#include <cstdio>
+#include <vector>
+#include "bench.h"
+#include "scene/TerrainGenerator.h"
+#include "util/ThreadPool.h"
+
+int main() {
+    constexpr float kWorldSize = 200.0f;
+    constexpr int kRowsPerTask = 4;
+    ThreadPool& pool = ThreadPool::shared();
+    std::printf("[TerrainBench] %s noise, %u pool threads\n",
+                FractalNoise::simdLevelName(FractalNoise::simdLevel()), pool.concurrency());
+    for (int resolution : {257, 1025, 4097}) {
+        const TerrainHeightGenerator generator(resolution, kWorldSize);
+        std::vector<float> heights(static_cast<size_t>(resolution) * resolution);
+        const int repeats = resolution > 1025 ? 1 : 3;
+        const double serial = bestMs(repeats, [&] {
+            generator.fill(0, 0, resolution, resolution, heights.data(), resolution);
+        });
+        const double parallel = bestMs(repeats, [&] {
+            pool.parallelFor(0, resolution, kRowsPerTask, [&](int zBegin, int zEnd) {
+                generator.fill(0, zBegin, resolution, zEnd - zBegin, &heights[static_cast<size_t>(zBegin) * resolution], resolution);
+            });
+        });
+        const double texels = static_cast<double>(resolution) * resolution;
+        std::printf("%5d x %-5d  1 thread %9.1f ms (%6.1f ns/texel)  pool %9.1f ms (%6.1f ns/texel)\n",
+                    resolution, resolution, serial, serial * 1e6 / texels, parallel, parallel * 1e6 / texels);
+    }
+    return 0;
+}